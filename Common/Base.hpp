@@ -3,8 +3,8 @@
 #include <cstdint>
 #include <string_view>
 
-#include "spdlog/spdlog.h"
 #include <LESDK/Init.hpp>
+#include "Common/Logging.hpp"
 
 
 // ! Common macros.
@@ -36,13 +36,6 @@
 // ! Logger / assertion interface.
 // ========================================
 
-#define LEASI_TRACE(...)                    SPDLOG_TRACE(__VA_ARGS__)
-#define LEASI_DEBUG(...)                    SPDLOG_DEBUG(__VA_ARGS__)
-#define LEASI_INFO(...)                     SPDLOG_INFO(__VA_ARGS__)
-#define LEASI_WARN(...)                     SPDLOG_WARN(__VA_ARGS__)
-#define LEASI_ERROR(...)                    SPDLOG_ERROR(__VA_ARGS__)
-#define LEASI_CRIT(...)                     SPDLOG_CRITICAL(__VA_ARGS__)
-
 namespace Common
 {
     void InitializeLoggerDefault();
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "spdlog/spdlog.h"
+
+// Note that this header intentionally does not depend on LESDK, so that code which
+// only needs logging can also be built for tools running outside of the game.
+
+
+// ! Logger interface.
+// ========================================
+
+#define LEASI_TRACE(...)                    SPDLOG_TRACE(__VA_ARGS__)
+#define LEASI_DEBUG(...)                    SPDLOG_DEBUG(__VA_ARGS__)
+#define LEASI_INFO(...)                     SPDLOG_INFO(__VA_ARGS__)
+#define LEASI_WARN(...)                     SPDLOG_WARN(__VA_ARGS__)
+#define LEASI_ERROR(...)                    SPDLOG_ERROR(__VA_ARGS__)
+#define LEASI_CRIT(...)                     SPDLOG_CRITICAL(__VA_ARGS__)
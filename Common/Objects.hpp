@@ -7,6 +7,61 @@
 namespace Common
 {
 
+    /// @brief      Retrieves the slot index of the given object within the global object array.
+    inline int GetObjectIndex(UObject const* const Object)
+    {
+        return Object->ObjectInternalInteger;
+    }
+
+    /// @brief      Checks whether the given object still occupies the given slot in the global object array.
+    /// @remarks    Only the pointer value is compared, so this is safe to call with dangling pointers.
+    /// @param[in]  Object - A possibly destroyed object pointer.
+    /// @param[in]  Index - The slot index recorded while the object was known to be alive.
+    inline bool IsObjectAlive(UObject const* const Object, int const Index)
+    {
+        return Index >= 0 && Index < static_cast<int>(UObject::GObjObjects->Count())
+            && UObject::GObjObjects->GetData()[Index] == Object;
+    }
+
+
+    /// @brief      Recognizes script functions of a given name by pointer identity.
+    /// @remarks    The last function seen with the name is remembered, so that the hot path is a pointer
+    ///             comparison, and otherwise a name index comparison - no strings are ever built.
+    ///             Once the remembered function is destroyed, e.g. with its package, it is resolved again.
+    ///             Must be constructed after the name table is available, e.g. as a static local.
+    class FunctionIdentity final : public NonCopyable
+    {
+        SFXName         FunctionName;
+        UObject const*  Resolved{ nullptr };
+        int             ResolvedIndex{ -1 };
+
+    public:
+
+        /// @param[in]  InFunctionName - Name of the function, regardless of its declaring class.
+        explicit FunctionIdentity(wchar_t const* const InFunctionName)
+            : FunctionName{ InFunctionName, 0 }
+        {
+        }
+
+        /// @brief      Checks whether the given object is a function with the name.
+        bool Matches(UObject const* const Function)
+        {
+            if (Function == nullptr)
+                return false;
+
+            if (Function == Resolved && IsObjectAlive(Function, ResolvedIndex))
+                return true;
+
+            if (!(Function->Name == FunctionName))
+                return false;
+
+            Resolved = Function;
+            ResolvedIndex = GetObjectIndex(Function);
+            return true;
+        }
+    };
+
+
     /// @brief      Unreal-style iterator filtering objects by a specific type.
     /// @tparam     T - A type derived from @c UObject of which all filtered objects must be.
     /// @tparam     bAllowDerived - Whether filtered objects are allowed to have types derived from the given type.
@@ -117,4 +172,28 @@ namespace Common
 
         return nullptr;
     }
+
+
+    /// @brief      Remembers the first non-default object of a type, e.g. the engine, instead of scanning the
+    ///             global object array on every use. Once the object is destroyed, it is looked up again.
+    /// @tparam     T - A type derived from @c UObject , see @ref FindFirstObject .
+    template<std::derived_from<UObject> T>
+    class CachedObject final : public NonCopyable
+    {
+        T*              Resolved{ nullptr };
+        int             ResolvedIndex{ -1 };
+
+    public:
+
+        /// @returns    The remembered object if still alive, otherwise the one found now, or @c nullptr .
+        T* Get()
+        {
+            if (Resolved != nullptr && IsObjectAlive(Resolved, ResolvedIndex))
+                return Resolved;
+
+            Resolved = FindFirstObject<T>();
+            ResolvedIndex = Resolved != nullptr ? GetObjectIndex(Resolved) : -1;
+            return Resolved;
+        }
+    };
 }
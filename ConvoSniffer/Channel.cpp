@@ -0,0 +1,419 @@
+#include <algorithm>
+#include <chrono>
+#include <string_view>
+#include <utility>
+
+#include "Common/Logging.hpp"
+#include "ConvoSniffer/Channel.hpp"
+
+
+namespace ConvoSniffer
+{
+    // ! EventChannel implementation.
+    // ========================================
+
+    EventChannel::EventChannel(char const* const InHost, int const InPort, HttpClient::OverflowPolicy const InPolicy)
+        : Stream{ InHost, InPort, "/ingest", k_transportTimeoutMs }
+        , Policy{ InPolicy }
+        , Overflow{}
+        , bOverflowing{ false }
+        , ProcessThread{}
+        , bWantsExit{}
+        , bWorkerSleeping{ false }
+        , Counters{}
+        , SpareEvents{}
+        , KeybindsEvent{}
+        , GraphEvent{}
+        , NodeEvent{}
+        , QueueEvent{}
+        , Snapshot{}
+        , bPublished{ false }
+        , bResyncPending{ true }
+        , Incoming{}
+        , Batch{}
+        , SpentEvents{}
+    {
+        SpareEvents.reserve(k_channelEventPoolSize);
+        SpentEvents.reserve(k_channelEventPoolSize);
+        Batch.reserve(k_channelRingSize);
+
+        ProcessThread = std::thread(&EventChannel::ProcessMain, this);
+    }
+
+    EventChannel::~EventChannel() noexcept
+    {
+        bWantsExit.test_and_set();
+        WakeWorker();
+
+        if (ProcessThread.joinable())
+            ProcessThread.join();
+
+        Stream.Disconnect();
+    }
+
+    std::string EventChannel::AcquireEvent()
+    {
+        if (SpareEvents.empty())
+            return std::string{};
+
+        std::string Text = std::move(SpareEvents.back());
+        SpareEvents.pop_back();
+        Text.clear();
+        return Text;
+    }
+
+    void EventChannel::Publish(ChannelTopic const InTopic, std::string&& InEvent)
+    {
+        if (bWantsExit.test())
+            return;
+
+        Counters.Published.fetch_add(1, std::memory_order_relaxed);
+        Event Pending{ InTopic, std::move(InEvent), std::chrono::steady_clock::now() };
+
+        // The ring only fills up while the worker is stuck writing to a server which stopped reading.
+        // Once it did, events keep overflowing until the worker took them, so that they stay in order.
+        bool bPushed = false;
+        if (!bOverflowing.load(std::memory_order_relaxed))
+        {
+            auto const BlockDeadline = Pending.PublishedAt + std::chrono::milliseconds(k_blockingQueueMaxMs);
+            while (!(bPushed = EventRing.TryPush(Pending)) && Policy == HttpClient::OverflowPolicy::Block
+                && std::chrono::steady_clock::now() < BlockDeadline)
+            {
+                WakeWorker();
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+
+        if (!bPushed)
+        {
+            std::scoped_lock OverflowLock(OverflowMutex);
+            FoldOverflow(Overflow, Pending);
+            bOverflowing.store(true, std::memory_order_relaxed);
+            Counters.Overflowed.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        WakeWorker();
+
+        // Either a superseded overflowed event, or one handed back by the worker through the slot.
+        if (Pending.Text.capacity() > std::string{}.capacity() && SpareEvents.size() < k_channelEventPoolSize)
+            SpareEvents.push_back(std::move(Pending.Text));
+    }
+
+    EventChannel::Stats EventChannel::GetStats()
+    {
+        Stats Result{};
+        Result.QueueDepth = EventRing.SizeApprox();
+        Result.Published = Counters.Published.load(std::memory_order_relaxed);
+        Result.Overflowed = Counters.Overflowed.load(std::memory_order_relaxed);
+        Result.Sent = Counters.Sent.load(std::memory_order_relaxed);
+        Result.Resyncs = Counters.Resyncs.load(std::memory_order_relaxed);
+        Result.Connections = Counters.Connections.load(std::memory_order_relaxed);
+        Result.BytesSent = Counters.BytesSent.load(std::memory_order_relaxed);
+        Result.Errors = Counters.Errors.load(std::memory_order_relaxed);
+        Result.QueueLatency = Counters.QueueLatency.GetSnapshot();
+        return Result;
+    }
+
+    void EventChannel::WakeWorker()
+    {
+        // Pairs with the fence in WaitForWork: either the worker sees the new event,
+        // or this sees the worker going to sleep and notifies it.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (bWorkerSleeping.load(std::memory_order_relaxed))
+        {
+            std::scoped_lock WakeLock(WakeMutex);
+            WakeCondition.notify_one();
+        }
+    }
+
+    void EventChannel::WaitForWork(std::chrono::steady_clock::time_point const InUntil)
+    {
+        std::unique_lock WakeLock(WakeMutex);
+        bWorkerSleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        auto const HasWork = [this]() -> bool
+            {
+                return EventRing.SizeApprox() > 0 || bOverflowing.load(std::memory_order_relaxed) || bWantsExit.test();
+            };
+
+        if (InUntil == std::chrono::steady_clock::time_point::max())
+            WakeCondition.wait(WakeLock, HasWork);
+        else
+            WakeCondition.wait_until(WakeLock, InUntil, HasWork);
+
+        bWorkerSleeping.store(false, std::memory_order_relaxed);
+    }
+
+    void EventChannel::ProcessMain()
+    {
+        int BackoffMs = k_reconnectBackoffMinMs;
+        std::chrono::steady_clock::time_point NextConnectAt{};
+
+        while (!bWantsExit.test())
+        {
+            DrainRing();
+
+            // Nothing to tell the server before the first event.
+            if (!bPublished)
+            {
+                WaitForWork(std::chrono::steady_clock::time_point::max());
+                continue;
+            }
+
+            if (!Stream.IsConnected())
+            {
+                RequestResync();
+
+                // Keep taking events from the ring while backing off, so that the producer is not held up.
+                if (std::chrono::steady_clock::now() < NextConnectAt)
+                {
+                    WaitForWork(NextConnectAt);
+                    continue;
+                }
+
+                if (!Stream.Connect())
+                {
+                    LEASI_WARN("failed to open companion channel, retrying in {} ms: {}", BackoffMs, Stream.GetLastError());
+                    NextConnectAt = std::chrono::steady_clock::now() + std::chrono::milliseconds(BackoffMs);
+                    BackoffMs = (std::min)(BackoffMs * 2, k_reconnectBackoffMaxMs);
+                    continue;
+                }
+
+                LEASI_INFO("opened companion channel");
+                BackoffMs = k_reconnectBackoffMinMs;
+                Counters.Connections.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            if (!bResyncPending && Batch.empty())
+            {
+                WaitForWork(std::chrono::steady_clock::now() + std::chrono::milliseconds(k_channelPollMs));
+                DrainRing();
+            }
+
+            if (!Stream.Poll())
+            {
+                LEASI_WARN("companion channel closed: {}", Stream.GetLastError());
+                Counters.Errors.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            // The snapshot already covers everything taken since the resync was requested.
+            if (bResyncPending)
+            {
+                BuildSnapshot();
+                Stream.AppendText(Snapshot);
+            }
+            else
+            {
+                for (Event const& Item : Batch)
+                    Stream.AppendText(Item.Text);
+            }
+
+            if (!Stream.Flush())
+            {
+                LEASI_WARN("failed to write to companion channel: {}", Stream.GetLastError());
+                Counters.Errors.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            auto const WrittenAt = std::chrono::steady_clock::now();
+            for (Event& Item : Batch)
+            {
+                Counters.QueueLatency.Record(WrittenAt - Item.PublishedAt);
+                ReleaseEvent(std::move(Item.Text));
+            }
+
+            if (bResyncPending)
+                Counters.Resyncs.fetch_add(1, std::memory_order_relaxed);
+
+            Counters.Sent.fetch_add(bResyncPending ? 1 : Batch.size(), std::memory_order_relaxed);
+            Counters.BytesSent.store(Stream.GetBytesSent(), std::memory_order_relaxed);
+            Batch.clear();
+            bResyncPending = false;
+        }
+    }
+
+    void EventChannel::DrainRing()
+    {
+        while (true)
+        {
+            // Hand a spent buffer back to the producer through the slot being emptied. What was taken
+            // before has been moved out by now, which leaves a string with its inline capacity only.
+            if (!SpentEvents.empty() && Incoming.Text.capacity() < SpentEvents.back().capacity())
+            {
+                Incoming.Text = std::move(SpentEvents.back());
+                SpentEvents.pop_back();
+            }
+
+            if (!EventRing.TryPop(Incoming))
+                break;
+
+            TakeEvent(Incoming);
+        }
+
+        if (!bOverflowing.load(std::memory_order_relaxed))
+            return;
+
+        std::scoped_lock OverflowLock(OverflowMutex);
+
+        // Whatever made it into the ring before the producer started overflowing comes first.
+        while (EventRing.TryPop(Incoming))
+            TakeEvent(Incoming);
+
+        ApplyOverflow();
+        bOverflowing.store(false, std::memory_order_relaxed);
+
+        // Overflowed events were never queued one by one, only the state they leave behind is sent.
+        RequestResync();
+        bPublished = true;
+    }
+
+    void EventChannel::TakeEvent(Event& InEvent)
+    {
+        ApplyEvent(InEvent);
+        bPublished = true;
+
+        if (bResyncPending)
+        {
+            ReleaseEvent(std::move(InEvent.Text));
+            InEvent.Text.clear();
+            return;
+        }
+
+        Batch.push_back(std::move(InEvent));
+    }
+
+    void EventChannel::ApplyEvent(Event const& InEvent)
+    {
+        switch (InEvent.Topic)
+        {
+        case ChannelTopic::Keybinds:
+            KeybindsEvent = InEvent.Text;
+            break;
+        case ChannelTopic::Graph:
+            GraphEvent = InEvent.Text;
+            NodeEvent.clear();
+            QueueEvent.clear();
+            break;
+        case ChannelTopic::End:
+            GraphEvent.clear();
+            NodeEvent.clear();
+            QueueEvent.clear();
+            break;
+        case ChannelTopic::Node:
+            NodeEvent = InEvent.Text;
+            QueueEvent.clear();
+            break;
+        case ChannelTopic::Queue:
+            QueueEvent = InEvent.Text;
+            break;
+        }
+    }
+
+    void EventChannel::FoldOverflow(OverflowState& InOutState, Event& InEvent)
+    {
+        // Same effects as ApplyEvent, the swapped out buffer goes back to the producer's pool.
+        switch (InEvent.Topic)
+        {
+        case ChannelTopic::Keybinds:
+            std::swap(InOutState.KeybindsEvent, InEvent.Text);
+            break;
+        case ChannelTopic::Graph:
+            std::swap(InOutState.GraphEvent, InEvent.Text);
+            InOutState.NodeEvent.clear();
+            InOutState.QueueEvent.clear();
+            InOutState.bConversationReset = true;
+            break;
+        case ChannelTopic::End:
+            InOutState.GraphEvent.clear();
+            InOutState.NodeEvent.clear();
+            InOutState.QueueEvent.clear();
+            InOutState.bConversationReset = true;
+            break;
+        case ChannelTopic::Node:
+            std::swap(InOutState.NodeEvent, InEvent.Text);
+            InOutState.QueueEvent.clear();
+            break;
+        case ChannelTopic::Queue:
+            std::swap(InOutState.QueueEvent, InEvent.Text);
+            break;
+        }
+    }
+
+    void EventChannel::ApplyOverflow()
+    {
+        // Buffers are swapped rather than copied, so that both sides keep their capacity.
+        if (!Overflow.KeybindsEvent.empty())
+            KeybindsEvent.swap(Overflow.KeybindsEvent);
+
+        if (Overflow.bConversationReset)
+        {
+            GraphEvent.clear();
+            NodeEvent.clear();
+            QueueEvent.clear();
+        }
+
+        if (!Overflow.GraphEvent.empty())
+            GraphEvent.swap(Overflow.GraphEvent);
+
+        if (!Overflow.NodeEvent.empty())
+        {
+            NodeEvent.swap(Overflow.NodeEvent);
+            QueueEvent.clear();
+        }
+
+        if (!Overflow.QueueEvent.empty())
+            QueueEvent.swap(Overflow.QueueEvent);
+
+        Overflow.KeybindsEvent.clear();
+        Overflow.GraphEvent.clear();
+        Overflow.NodeEvent.clear();
+        Overflow.QueueEvent.clear();
+        Overflow.bConversationReset = false;
+    }
+
+    void EventChannel::BuildSnapshot()
+    {
+        auto const AppendLine = [this](std::string_view const Line) -> void
+            {
+                if (Line.empty())
+                    return;
+                if (!Snapshot.empty())
+                    Snapshot.push_back('\n');
+                Snapshot.append(Line);
+            };
+
+        Snapshot.clear();
+        AppendLine(KeybindsEvent);
+
+        if (GraphEvent.empty())
+        {
+            AppendLine(R"({"type":"end"})");
+            return;
+        }
+
+        AppendLine(GraphEvent);
+        AppendLine(NodeEvent);
+        AppendLine(QueueEvent);
+    }
+
+    void EventChannel::RequestResync()
+    {
+        for (Event& Item : Batch)
+            ReleaseEvent(std::move(Item.Text));
+
+        Batch.clear();
+        bResyncPending = true;
+    }
+
+    void EventChannel::ReleaseEvent(std::string&& InEvent)
+    {
+        if (SpentEvents.size() < k_channelEventPoolSize)
+        {
+            InEvent.clear();
+            SpentEvents.push_back(std::move(InEvent));
+        }
+    }
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ConvoSniffer/Http.hpp"
+#include "ConvoSniffer/Ring.hpp"
+#include "ConvoSniffer/Stats.hpp"
+#include "ConvoSniffer/Transport.hpp"
+
+// Note that this header intentionally does not depend on LESDK, so that the channel
+// can be exercised outside of the game, see the Loopback folder.
+
+
+namespace ConvoSniffer
+{
+    // Number of events handed from the producer to the worker without waiting for it, a power of two.
+    static constexpr std::size_t k_channelRingSize = 256;
+
+    // Number of event buffers kept around for reuse.
+    static constexpr std::size_t k_channelEventPoolSize = 16;
+
+    // Interval at which an idle channel checks whether the server closed the connection.
+    static constexpr int k_channelPollMs = 1000;
+
+    /// @brief      Kind of state carried by a channel event, which replaces the previous one of its kind.
+    enum class ChannelTopic : std::uint8_t
+    {
+        Keybinds,       // @c keybinds event.
+        Graph,          // @c graph event, which starts a conversation, clearing its node.
+        End,            // @c end event, which clears everything but keybinds.
+        Node,           // @c node event, which also clears the queued reply.
+        Queue,          // @c queue event.
+    };
+
+    /// @brief      Pushes JSON-lines events to the companion server over a single WebSocket connection.
+    /// @remarks    The worker thread keeps the latest event of each @ref ChannelTopic . Whenever the
+    ///             connection is (re-)established, it sends them instead of any events still queued,
+    ///             so the server catches up even if it restarted or events were lost.
+    /// @remarks    Events are handed to the worker through a lock-free ring. Under the blocking
+    ///             @ref HttpClient::OverflowPolicy , publishing waits a bounded time for room in it.
+    ///             Events which still do not fit are folded into one pending event per topic behind
+    ///             a mutex, and the worker resends its state once it took them.
+    class EventChannel final
+    {
+    public:
+
+        struct Stats final
+        {
+            std::size_t     QueueDepth{ 0 };
+            std::uint64_t   Published{ 0 };
+            std::uint64_t   Overflowed{ 0 };        // Events which did not fit into the ring.
+            std::uint64_t   Sent{ 0 };
+            std::uint64_t   Resyncs{ 0 };           // Snapshots sent after connecting or overflowing.
+            std::uint64_t   Connections{ 0 };
+            std::uint64_t   BytesSent{ 0 };
+            std::uint64_t   Errors{ 0 };            // Connections lost or failed to write to.
+
+            LatencyHistogram::Snapshot QueueLatency{};      // From publishing to being written.
+        };
+
+        /// @param[in]  InHost - Host name or address of the companion server.
+        /// @param[in]  InPort - TCP port of the companion server.
+        /// @param[in]  InPolicy - Whether publishing waits for room in a full ring, only blocking matters.
+        EventChannel(char const* InHost, int InPort, HttpClient::OverflowPolicy InPolicy = HttpClient::OverflowPolicy::DropCoalescible);
+        EventChannel(EventChannel const&) = delete;
+        EventChannel& operator=(EventChannel const&) = delete;
+        ~EventChannel() noexcept;
+
+        /// @brief      Takes an empty event buffer, which keeps its capacity from an earlier event.
+        /// @remarks    Only called from the thread which publishes events.
+        std::string AcquireEvent();
+
+        /// @brief      Queues an event to be sent by the worker thread.
+        /// @remarks    Only called from a single thread, usually the game thread.
+        /// @param[in]  InTopic - Kind of state the event replaces.
+        /// @param[in]  InEvent - Single JSON object, without a trailing newline, preferably from @ref AcquireEvent .
+        void Publish(ChannelTopic InTopic, std::string&& InEvent);
+
+        Stats GetStats();
+
+    private:
+
+        struct Event final
+        {
+            ChannelTopic    Topic{};
+            std::string     Text{};
+            std::chrono::steady_clock::time_point PublishedAt{};
+        };
+
+        // Latest overflowed event of each topic, folded the same way the worker applies events.
+        struct OverflowState final
+        {
+            std::string     KeybindsEvent{};
+            std::string     GraphEvent{};
+            std::string     NodeEvent{};
+            std::string     QueueEvent{};
+            bool            bConversationReset{ false };    // Whether a graph or end event overflowed.
+        };
+
+        // Each counter is only written by one side, @c Published and @c Overflowed by the producer.
+        struct SharedCounters final
+        {
+            std::atomic<std::uint64_t>  Published{ 0 };
+            std::atomic<std::uint64_t>  Overflowed{ 0 };
+            std::atomic<std::uint64_t>  Sent{ 0 };
+            std::atomic<std::uint64_t>  Resyncs{ 0 };
+            std::atomic<std::uint64_t>  Connections{ 0 };
+            std::atomic<std::uint64_t>  BytesSent{ 0 };
+            std::atomic<std::uint64_t>  Errors{ 0 };
+            LatencyHistogram            QueueLatency{};
+        };
+
+        void ProcessMain();
+        void DrainRing();
+        void TakeEvent(Event& InEvent);
+        void ApplyEvent(Event const& InEvent);
+        void ApplyOverflow();
+        void BuildSnapshot();
+        void RequestResync();
+        void ReleaseEvent(std::string&& InEvent);
+        void WaitForWork(std::chrono::steady_clock::time_point Until);
+        void WakeWorker();
+
+        static void FoldOverflow(OverflowState& InOutState, Event& InEvent);
+
+        WebSocketStream             Stream;
+        HttpClient::OverflowPolicy  Policy;
+
+        SpscRing<Event, k_channelRingSize> EventRing;
+        std::mutex                  OverflowMutex;
+        OverflowState               Overflow;       // Guarded by @ref OverflowMutex .
+        std::atomic_bool            bOverflowing;   // Whether the producer bypasses the ring, to keep events in order.
+        std::thread                 ProcessThread;
+        std::atomic_flag            bWantsExit;
+
+        // Lets the worker sleep while there is nothing to do, the producer only notifies while it does.
+        std::mutex                  WakeMutex;
+        std::condition_variable     WakeCondition;
+        std::atomic_bool            bWorkerSleeping;
+
+        SharedCounters              Counters;
+
+        // Only touched by the producer.
+        std::vector<std::string>    SpareEvents;    // Returned by the worker through the ring slots.
+
+        // Only touched by the worker thread, latest event of each topic which is in effect.
+        std::string                 KeybindsEvent;
+        std::string                 GraphEvent;
+        std::string                 NodeEvent;
+        std::string                 QueueEvent;
+        std::string                 Snapshot;       // Reused between resyncs.
+        bool                        bPublished;     // Whether there is anything to tell the server yet.
+        bool                        bResyncPending; // Whether the next write sends the snapshot instead of the batch.
+        Event                       Incoming;
+        std::vector<Event>          Batch;
+        std::vector<std::string>    SpentEvents;
+    };
+}
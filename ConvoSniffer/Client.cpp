@@ -1,197 +1,175 @@
 #include <Windows.h>
-#include <wininet.h>
+
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
 
 #include <simdutf.h>
 
 #include "Common/Objects.hpp"
 #include "ConvoSniffer/Client.hpp"
+#include "ConvoSniffer/Conditionals.hpp"
+#include "ConvoSniffer/Config.hpp"
+#include "ConvoSniffer/Keybinds.hpp"
 #include "ConvoSniffer/Profile.hpp"
+#include "ConvoSniffer/World.hpp"
 
 
-namespace ConvoSniffer
+namespace
 {
-    SnifferClient* gp_snifferClient = nullptr;
-    bool gb_renderScaleform = false;
+    constexpr bool k_useEventChannel = CNVSNF_EVENT_CHANNEL != 0;
+    constexpr bool k_useDashboard = CNVSNF_DASHBOARD_SERVER != 0;
 
+    // Companion dashboard page, embedded at configure time.
+    constexpr unsigned char k_dashboardPage[] = {
+#include "ConvoSniffer/DashboardPage.inl"
+    };
 
-    // ! HttpClient implementation.
-    // ========================================
+    // Interval at which a stats summary is logged, checked whenever the conversation moves on.
+    constexpr int k_statsLogIntervalMs = 60000;
 
-    HttpClient::HttpClient(char const* const InHost, int const InPort)
-        : Host{}
-        , Port{ InPort }
-        , RequestQueue{}
-        , RequestIndex{}
-        , ProcessThread{}
-        , bWantsExit{}
+    constexpr auto k_overflowPolicy = static_cast<ConvoSniffer::HttpClient::OverflowPolicy>(CNVSNF_QUEUE_OVERFLOW_POLICY);
+
+    void AppendAscii(std::string& OutString, wchar_t const* InString)
     {
-        LEASI_CHECKW(InHost != nullptr, L"", L"");
-        Host.AppendAnsi(InHost);
+        while (InString != nullptr && *InString != L'\0')
+            OutString.push_back(static_cast<char>(*InString++ & 0x7F));
+    }
 
-        Win32Internet = InternetOpenW(L"ConvoSniffer-LE1.asi", 0u, NULL, NULL, 0u);
-        LEASI_CHECKW(Win32Internet != NULL, L"failed to initialize internet handle: {}", GetLastError());
+    double ToMilliseconds(std::chrono::nanoseconds const InDuration)
+    {
+        return std::chrono::duration<double, std::milli>(InDuration).count();
+    }
 
-        Win32Session = InternetConnectW(Win32Internet, *Host, (uint16_t)Port, NULL, NULL, INTERNET_SERVICE_HTTP, 0u, NULL);
-        LEASI_CHECKW(Win32Session != NULL, L"failed to initialize http session: {}", GetLastError());
+    void LogHistogram(wchar_t const* const InStage, ConvoSniffer::LatencyHistogram::Snapshot const& InSnapshot)
+    {
+        LEASI_INFO(L"  {:<8} n = {}, mean = {:.3f} ms, p50 = {:.3f} ms, p90 = {:.3f} ms, p99 = {:.3f} ms, max = {:.3f} ms",
+            InStage, InSnapshot.Count, ToMilliseconds(InSnapshot.GetMean()), ToMilliseconds(InSnapshot.GetQuantile(0.50)),
+            ToMilliseconds(InSnapshot.GetQuantile(0.90)), ToMilliseconds(InSnapshot.GetQuantile(0.99)), ToMilliseconds(InSnapshot.Max));
+    }
 
-        ProcessThread = std::thread([this]() -> void
-            {
-                while (!bWantsExit.test())
-                {
-                    std::unique_lock QueueLock(QueueMutex);
-
-                    if (!RequestQueue.empty())
-                    {
-                        Request const HttpRequest = RequestQueue.front();
-                        RequestQueue.pop_front();
-                        QueueLock.unlock();
-
-                        LEASI_INFO(L"request[{}]: method = {}, path = {}", HttpRequest.Index, HttpRequest.Method, *HttpRequest.Path);
-
-                        Response HttpResponse{};
-                        if (SendHttp(HttpRequest, &HttpResponse))
-                        {
-                            if (HttpResponse.Status < 400 || HttpResponse.Status >= 600)
-                            {
-                                LEASI_INFO(L"response[{}]: status = {}, text = {}", HttpRequest.Index, HttpResponse.Status, *HttpResponse.Body);
-                            }
-                            else
-                            {
-                                LEASI_ERROR(L"response[{}]: status = {}, text = {}", HttpRequest.Index, HttpResponse.Status, *HttpResponse.Body);
-                            }
-                        }
-                    }
-                    else
-                    {
-                        RequestCondition.wait(QueueLock);
-                    }
-                }
-            });
+    void AppendInteger(std::string& OutString, long long const InValue)
+    {
+        char Digits[24];
+        auto const Result = std::to_chars(std::begin(Digits), std::end(Digits), InValue);
+        OutString.append(Digits, Result.ptr);
     }
 
-    HttpClient::~HttpClient() noexcept
+    void AppendJsonString(std::string& OutString, std::string_view const InString)
     {
-        bWantsExit.test_and_set();
-        RequestCondition.notify_all();
+        OutString.push_back('"');
 
-        if (InternetCloseHandle(Win32Session) == FALSE)
+        for (char const C : InString)
         {
-            // TODO: Log last error code...
+            switch (C)
+            {
+            case '"': OutString.append("\\\""); break;
+            case '\\': OutString.append("\\\\"); break;
+            case '\n': OutString.append("\\n"); break;
+            case '\r': OutString.append("\\r"); break;
+            case '\t': OutString.append("\\t"); break;
+            default:
+                if (static_cast<unsigned char>(C) < 0x20)
+                {
+                    char Escaped[8];
+                    std::snprintf(Escaped, sizeof Escaped, "\\u%04x", static_cast<unsigned>(C));
+                    OutString.append(Escaped);
+                }
+                else
+                {
+                    OutString.push_back(C);
+                }
+            }
         }
 
-        if (InternetCloseHandle(Win32Internet) == FALSE)
-        {
-            // TODO: Log last error code...
-        }
+        OutString.push_back('"');
     }
 
-    void HttpClient::QueueRequest(wchar_t const* const InMethod, wchar_t const* const InPath, FString&& InBody)
+    void AppendJsonString(std::string& OutString, wchar_t const* const InString)
     {
-        LEASI_CHECKW(InMethod != nullptr, L"", L"");
-        LEASI_CHECKW(InPath != nullptr, L"", L"");
-
-        if (!bWantsExit.test())
-        {
-            std::unique_lock QueueLock(QueueMutex);
-            RequestQueue.push_back(Request{ RequestIndex++, InMethod, FString(InPath), std::move(InBody) });
-
-            QueueLock.unlock();
-            RequestCondition.notify_all();
-        }
+        // Only used for enumerator names, which never need escaping.
+        OutString.push_back('"');
+        AppendAscii(OutString, InString);
+        OutString.push_back('"');
     }
+}
 
-    bool HttpClient::SendHttp(Request const& InRequest, Response* const OutResponse) const
+namespace ConvoSniffer
+{
+    std::atomic<SnifferClient*> gp_snifferClient{ nullptr };
+    bool gb_renderScaleform = false;
+
+    namespace
     {
-        bool bSuccess = true;
+        std::thread g_clientLauncher{};
+    }
 
-        HINTERNET const Request = HttpOpenRequestW(
-            Win32Session,
-            InRequest.Method,
-            *InRequest.Path,
-            L"HTTP/1.1",
-            NULL,
-            NULL,
-            0u,
-            NULL
-        );
 
-        if (Request == NULL)
-        {
-            LEASI_ERROR(L"failed to initialize http request {}", GetLastError());
-            return false;
-        }
-
-        std::string BodyUtf8{};
-        if (!StringToUtf8(InRequest.Body, BodyUtf8))
-        {
-            LEASI_ERROR(L"failed to convert http request body to utf-8");
-            bSuccess = false;
-        }
+    // ! Client lifetime.
+    // ========================================
 
-        if (bSuccess && HttpSendRequestW(Request, NULL, 0u, BodyUtf8.data(), (DWORD)BodyUtf8.length()) == FALSE)
+    void LaunchSnifferClient(char const* const InHost, int const InPort)
+    {
+        if (g_clientLauncher.joinable())
         {
-            LEASI_ERROR(L"failed to send http request {}", GetLastError());
-            bSuccess = false;
+            LEASI_WARN("sniffer client already launched");
+            return;
         }
 
-        if (bSuccess && OutResponse != nullptr)
-        {
-            DWORD CodeBufferSize = sizeof(OutResponse->Status);
-
-            if (!HttpQueryInfoW(Request, HTTP_QUERY_STATUS_CODE | HTTP_QUERY_FLAG_NUMBER,
-                &OutResponse->Status, &CodeBufferSize, 0u))
+        g_clientLauncher = std::thread{ [InHost, InPort]() -> void
             {
-                LEASI_BREAK_SAFE();
-                bSuccess = false;
-            }
+                auto const Start = std::chrono::steady_clock::now();
+                auto const Client = new SnifferClient(InHost, InPort);
+                gp_snifferClient.store(Client, std::memory_order_release);
 
-            // TODO: Read to EOF here...
+                LEASI_INFO(L"sniffer client started in {:.1f} ms",
+                    std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - Start).count());
+            } };
+    }
 
-            DWORD TextBufferSize = 1024;
-            std::string TextBuffer(TextBufferSize, '\0');
+    void ShutdownSnifferClient()
+    {
+        if (g_clientLauncher.joinable())
+            g_clientLauncher.join();
 
-            if (!InternetReadFile(Request, TextBuffer.data(), TextBufferSize, &TextBufferSize))
-            {
-                LEASI_BREAK_SAFE();
-                bSuccess = false;
-            }
+        delete gp_snifferClient.exchange(nullptr);
+    }
 
-            TextBuffer.resize(TextBufferSize);
-            if (!StringFromUtf8(OutResponse->Body, TextBuffer))
-            {
-                LEASI_ERROR(L"failed to convert http response body from utf-8");
-                bSuccess = false;
-            }
-        }
 
-        if (InternetCloseHandle(Request) == FALSE)
-        {
-            LEASI_ERROR(L"failed to close http request: {}", GetLastError());
-        }
+    // ! String helpers.
+    // ========================================
 
-        return bSuccess;
+    bool StringToUtf8(FString const& InString, std::string& OutString)
+    {
+        OutString.clear();
+        return AppendUtf8(InString, OutString);
     }
 
-    bool HttpClient::StringToUtf8(FString const& InString, std::string& OutString)
+    bool AppendUtf8(FString const& InString, std::string& OutString)
     {
         auto const Chars = reinterpret_cast<char16_t const*>(InString.Chars());
         auto const Length = static_cast<std::size_t>(InString.Length());
 
+        if (Length == 0)
+            return true;
+
         if (!simdutf::validate_utf16le(Chars, Length))
             return false;
 
-        auto const OutLength = simdutf::utf8_length_from_utf16le(Chars, Length);
-
-        if (OutLength != 0)
-        {
-            OutString.resize(OutLength);
-            simdutf::convert_utf16le_to_utf8(Chars, Length, OutString.data());
-        }
+        // Encode in place past the current end, growing capacity only when it runs out.
+        std::size_t const Offset = OutString.size();
+        OutString.resize(Offset + simdutf::utf8_length_from_utf16le(Chars, Length));
+        simdutf::convert_valid_utf16le_to_utf8(Chars, Length, OutString.data() + Offset);
 
         return true;
     }
 
-    bool HttpClient::StringFromUtf8(FString& OutString, std::string const& InString)
+    bool StringFromUtf8(FString& OutString, std::string const& InString)
     {
         auto const Chars = InString.c_str();
         auto const Length = InString.length();
@@ -215,10 +193,45 @@ namespace ConvoSniffer
     // ========================================
 
     SnifferClient::SnifferClient(char const* const InHost, int const InPort)
-        : Http{ InHost, InPort }
+        : Http{ InHost, InPort, k_overflowPolicy }
+        , Events{ InHost, InPort, k_overflowPolicy }
+        , Dashboard{}
         , Conversation{ nullptr }
         , nCurrentEntry{ -1 }
+        , Bundles{}
+        , KeybindsEvent{}
+        , KeybindsNotification{}
+        , BuildLatency{}
+        , EnqueueLatency{}
+        , nObservations{ 0 }
+        , LastStatsLog{ std::chrono::steady_clock::now() }
+        , Recorder{}
+        , RecordBody{}
     {
+        KeybindsEvent.assign(R"({"type":"keybinds","keybinds":[)");
+        for (std::string const& Label : g_keybindTable.GetLabels())
+        {
+            if (KeybindsEvent.back() != '[')
+                KeybindsEvent.push_back(',');
+            AppendJsonString(KeybindsEvent, Label);
+        }
+        KeybindsEvent.append("]}");
+
+        if (k_useDashboard)
+        {
+            KeybindsNotification.assign(R"({"SetKeybinds":{"keybinds":)");
+            KeybindsNotification.append(KeybindsEvent, KeybindsEvent.find('['));
+            KeybindsNotification.append("}");
+
+            std::string_view const Page{ reinterpret_cast<char const*>(k_dashboardPage), sizeof k_dashboardPage };
+            Dashboard = std::make_unique<DashboardServer>(CNVSNF_DASHBOARD_PORT, Page);
+
+            if (Dashboard->IsListening())
+                LEASI_INFO("serving dashboard on port {}", Dashboard->GetPort());
+            else
+                LEASI_ERROR("failed to start dashboard server: {}", Dashboard->GetLastError());
+        }
+
         SendKeybinds();
     }
 
@@ -253,11 +266,23 @@ namespace ConvoSniffer
             // For when the server starts after the game.
             SendKeybinds();
 
+            // Strings resolved for the previous conversation may have gone stale since.
+            Bundles.clear();
+            g_stringCache.Validate(InConversation);
+
             Conversation = InConversation;
-            Http.QueueRequest(L"POST", L"/conversation", FString());
             nCurrentEntry = -1;
             bInitialReplies = false;
 
+            Recorder.Record(SessionEvent::Start);
+
+            if (k_useDashboard)
+                Dashboard->Publish(DashboardTopic::Start, R"({"Conversation":{"start":true}})");
+            else if (k_useEventChannel)
+                PublishGraph();
+            else
+                Http.QueueRequest("POST", "/conversation", Http.AcquireBody());
+
             if (!gb_renderScaleform)
             {
                 Common::FindFirstObject<UConsole>()
@@ -275,10 +300,20 @@ namespace ConvoSniffer
     {
         if (Conversation == InConversation)
         {
-            Http.QueueRequest(L"DELETE", L"/conversation", FString());
             Conversation = nullptr;
             nCurrentEntry = -1;
 
+            Recorder.Record(SessionEvent::End);
+
+            if (k_useDashboard)
+                Dashboard->Publish(DashboardTopic::End, R"({"Conversation":{"start":false}})");
+            else if (k_useEventChannel)
+                Events.Publish(ChannelTopic::End, R"({"type":"end"})");
+            else
+                Http.QueueRequest("DELETE", "/conversation", Http.AcquireBody());
+
+            LogStatsSummary();
+
             if (!gb_renderScaleform)
             {
                 Common::FindFirstObject<UConsole>()
@@ -308,7 +343,35 @@ namespace ConvoSniffer
                 ? InConversation->m_lstCurrentReplyIndices(Reply)
                 : 15;
 
-            Http.QueueRequest(L"POST", L"/conversation/replies/queue", FString::Printf(L"%d", Index));
+            if (Recorder.IsRecording())
+            {
+                RecordBody.clear();
+                AppendInteger(RecordBody, Index);
+                Recorder.Record(SessionEvent::Queue, RecordBody);
+            }
+
+            if (k_useDashboard)
+            {
+                std::string Message = Dashboard->AcquireMessage();
+                Message.append(R"({"QueueReply":{"index":)");
+                AppendInteger(Message, Index);
+                Message.append("}}");
+                Dashboard->Publish(DashboardTopic::Queue, std::move(Message));
+            }
+            else if (k_useEventChannel)
+            {
+                std::string QueueEvent = Events.AcquireEvent();
+                QueueEvent.append(R"({"type":"queue","index":)");
+                AppendInteger(QueueEvent, Index);
+                QueueEvent.append("}");
+                Events.Publish(ChannelTopic::Queue, std::move(QueueEvent));
+            }
+            else
+            {
+                std::string Body = Http.AcquireBody();
+                AppendInteger(Body, Index);
+                Http.QueueRequest("POST", "/conversation/replies/queue", std::move(Body));
+            }
         }
         else
         {
@@ -323,9 +386,15 @@ namespace ConvoSniffer
         {
             if (nCurrentEntry != InConversation->m_nCurrentEntry)
             {
-                SendReplyUpdate();
+                auto const ObservedAt = std::chrono::steady_clock::now();
+                nObservations++;
+
+                SendReplyUpdate(ObservedAt);
                 nCurrentEntry = InConversation->m_nCurrentEntry;
                 bInitialReplies = true;
+
+                if (ObservedAt - LastStatsLog >= std::chrono::milliseconds(k_statsLogIntervalMs))
+                    LogStatsSummary();
             }
         }
         else
@@ -346,38 +415,300 @@ namespace ConvoSniffer
 
     void SnifferClient::SendKeybinds()
     {
-        // Let's hard-code the keybinds for now...
-        Http.QueueRequest(L"PUT", L"/keybinds", L"0;1;2;3;4;5;6;7;8;9;A;B;C;D;E;F");
+        constexpr bool bUseHttp = !k_useDashboard && !k_useEventChannel;
+
+        if (bUseHttp || Recorder.IsRecording())
+        {
+            std::string Body = Http.AcquireBody();
+            for (std::string const& Label : g_keybindTable.GetLabels())
+            {
+                if (!Body.empty())
+                    Body.push_back(';');
+                Body.append(Label);
+            }
+
+            Recorder.Record(SessionEvent::Keybinds, Body);
+
+            if (bUseHttp)
+            {
+                Http.QueueRequest("PUT", "/keybinds", std::move(Body), true);
+                return;
+            }
+        }
+
+        if (k_useDashboard)
+            Dashboard->Publish(DashboardTopic::Keybinds, std::string{ KeybindsNotification });
+        else
+            Events.Publish(ChannelTopic::Keybinds, std::string{ KeybindsEvent });
+    }
+
+    void SnifferClient::SendReplyUpdate(std::chrono::steady_clock::time_point const InObservedAt)
+    {
+        if (k_useDashboard)
+        {
+            CollectReplies(Conversation, Bundles);
+
+            std::string Message = Dashboard->AcquireMessage();
+            FormatDashboardReplies(Bundles, Message);
+
+            auto const BuiltAt = std::chrono::steady_clock::now();
+            BuildLatency.Record(BuiltAt - InObservedAt);
+
+            if (Recorder.IsRecording())
+            {
+                FormatReplyUpdate(Bundles, RecordBody);
+                Recorder.Record(SessionEvent::Replies, RecordBody);
+            }
+
+            Dashboard->Publish(DashboardTopic::Replies, std::move(Message));
+            EnqueueLatency.Record(std::chrono::steady_clock::now() - BuiltAt);
+        }
+        else if (k_useEventChannel)
+        {
+            PublishNode(InObservedAt);
+
+            // Recordings are replayed over HTTP, so they need the body even though it is not sent.
+            if (Recorder.IsRecording())
+            {
+                CollectReplies(Conversation, Bundles);
+                FormatReplyUpdate(Bundles, RecordBody);
+                Recorder.Record(SessionEvent::Replies, RecordBody);
+            }
+        }
+        else
+        {
+            CollectReplies(Conversation, Bundles);
+
+            std::string Body = Http.AcquireBody();
+            FormatReplyUpdate(Bundles, Body);
+
+            auto const BuiltAt = std::chrono::steady_clock::now();
+            BuildLatency.Record(BuiltAt - InObservedAt);
+
+            Recorder.Record(SessionEvent::Replies, Body);
+            Http.QueueRequest("PUT", "/conversation/replies", std::move(Body), true);
+            EnqueueLatency.Record(std::chrono::steady_clock::now() - BuiltAt);
+        }
+    }
+
+    void SnifferClient::LogStats()
+    {
+        LEASI_INFO(L"conversation stats: {} node changes observed", nObservations);
+        LogHistogram(L"build", BuildLatency.GetSnapshot());
+        LogHistogram(L"enqueue", EnqueueLatency.GetSnapshot());
+
+        StringCache::Stats const Strings = g_stringCache.GetStats();
+        LEASI_INFO(L"  strings: entries = {}, lookups = {}, misses = {}, flushes = {}",
+            Strings.Entries, Strings.Lookups, Strings.Misses, Strings.Flushes);
+
+        if (k_useDashboard)
+        {
+            DashboardServer::Stats const Stats = Dashboard->GetStats();
+            LogHistogram(L"handoff", Stats.HandoffLatency);
+            LEASI_INFO(L"  dashboard: browsers = {}, published = {}, overflowed = {}, connections = {}, disconnects = {}, overruns = {}, pages = {}, bytes = {}",
+                Stats.Clients, Stats.Published, Stats.Overflowed, Stats.Connections, Stats.Disconnects, Stats.Overruns, Stats.PageRequests, Stats.BytesSent);
+        }
+        else if (k_useEventChannel)
+        {
+            EventChannel::Stats const Stats = Events.GetStats();
+            LogHistogram(L"write", Stats.QueueLatency);
+            LEASI_INFO(L"  channel: depth = {}, published = {}, overflowed = {}, sent = {}, resyncs = {}, connections = {}, errors = {}, bytes = {}",
+                Stats.QueueDepth, Stats.Published, Stats.Overflowed, Stats.Sent, Stats.Resyncs, Stats.Connections, Stats.Errors, Stats.BytesSent);
+        }
+        else
+        {
+            HttpClient::Stats const Stats = Http.GetStats();
+            LogHistogram(L"queue", Stats.QueueLatency);
+            LogHistogram(L"exchange", Stats.ExchangeLatency);
+            LEASI_INFO(L"  http: depth = {} (max {}), queued = {}, coalesced = {}, dropped = {}, sent = {}, failed = {}, retried = {}, connections = {}, bytes = {}",
+                Stats.QueueDepth, Stats.MaxQueueDepth, Stats.Queued, Stats.Coalesced, Stats.Dropped, Stats.Sent, Stats.Failed, Stats.Retried, Stats.Connections, Stats.BytesSent);
+        }
     }
 
-    void SnifferClient::SendReplyUpdate()
+    void SnifferClient::ToggleRecording()
     {
-        FString Buffer{};
-        BuildReplyUpdate(Conversation, Buffer);
-        SendReplyUpdate(std::move(Buffer));
+        if (Recorder.IsRecording())
+        {
+            std::uint64_t const Records = Recorder.GetRecordCount();
+            Recorder.Stop();
+
+            if (Recorder.GetLastError().empty())
+                LEASI_INFO(L"stopped recording after {} events", Records);
+            else
+                LEASI_ERROR("stopped recording after {} events: {}", Records, Recorder.GetLastError());
+            return;
+        }
+
+        if (!Recorder.Start(CNVSNF_RECORD_FILE))
+        {
+            LEASI_ERROR("failed to start recording: {}", Recorder.GetLastError());
+            return;
+        }
+
+        LEASI_INFO(L"recording outbound events to {}", CNVSNF_RECORD_FILE);
+
+        // Replays have to start from the same state the companion is in.
+        SendKeybinds();
+
+        if (Conversation != nullptr)
+        {
+            Recorder.Record(SessionEvent::Start);
+            if (nCurrentEntry >= 0)
+            {
+                CollectReplies(Conversation, Bundles);
+                FormatReplyUpdate(Bundles, RecordBody);
+                Recorder.Record(SessionEvent::Replies, RecordBody);
+            }
+        }
+    }
+
+    void SnifferClient::LogStatsSummary()
+    {
+        LastStatsLog = std::chrono::steady_clock::now();
+
+        LatencyHistogram::Snapshot const Build = BuildLatency.GetSnapshot();
+        LatencyHistogram::Snapshot const Enqueue = EnqueueLatency.GetSnapshot();
+
+        if (k_useDashboard)
+        {
+            DashboardServer::Stats const Stats = Dashboard->GetStats();
+            LEASI_INFO(L"stats: nodes = {}, build p99 = {:.3f} ms, enqueue p99 = {:.3f} ms, handoff p99 = {:.3f} ms, browsers = {}, overruns = {}, bytes = {}",
+                nObservations, ToMilliseconds(Build.GetQuantile(0.99)), ToMilliseconds(Enqueue.GetQuantile(0.99)),
+                ToMilliseconds(Stats.HandoffLatency.GetQuantile(0.99)), Stats.Clients, Stats.Overruns, Stats.BytesSent);
+        }
+        else if (k_useEventChannel)
+        {
+            EventChannel::Stats const Stats = Events.GetStats();
+            LEASI_INFO(L"stats: nodes = {}, build p99 = {:.3f} ms, enqueue p99 = {:.3f} ms, write p99 = {:.3f} ms, depth = {}, errors = {}, bytes = {}",
+                nObservations, ToMilliseconds(Build.GetQuantile(0.99)), ToMilliseconds(Enqueue.GetQuantile(0.99)),
+                ToMilliseconds(Stats.QueueLatency.GetQuantile(0.99)), Stats.QueueDepth, Stats.Errors, Stats.BytesSent);
+        }
+        else
+        {
+            HttpClient::Stats const Stats = Http.GetStats();
+            LEASI_INFO(L"stats: nodes = {}, build p99 = {:.3f} ms, enqueue p99 = {:.3f} ms, queue p99 = {:.3f} ms, exchange p99 = {:.3f} ms, depth = {}, failed = {}, dropped = {}, bytes = {}",
+                nObservations, ToMilliseconds(Build.GetQuantile(0.99)), ToMilliseconds(Enqueue.GetQuantile(0.99)),
+                ToMilliseconds(Stats.QueueLatency.GetQuantile(0.99)), ToMilliseconds(Stats.ExchangeLatency.GetQuantile(0.99)),
+                Stats.QueueDepth, Stats.Failed, Stats.Dropped, Stats.BytesSent);
+        }
+    }
+
+    void SnifferClient::PublishGraph()
+    {
+        auto const Start = std::chrono::steady_clock::now();
+
+        std::string GraphEvent{};
+        auto const AppendText = [this, &GraphEvent](int const StrRef) -> void
+            {
+                StringCache::Entry const& Item = g_stringCache.Find(Conversation, StrRef);
+                if (!Item.bUtf8Valid)
+                    LEASI_ERROR(L"failed to convert conversation string to utf-8: {}", *Item.Text);
+                AppendJsonString(GraphEvent, Item.Utf8);
+            };
+
+        // The graph implies the start of a conversation, and is all the server needs to resolve nodes.
+        GraphEvent.assign(R"({"type":"graph","illegal_style":)");
+        AppendJsonString(GraphEvent, GuiStyleToString(GUI_STYLE_ILLEGAL));
+
+        GraphEvent.append(R"(,"entries":[)");
+        for (UINT nEntry = 0; nEntry < Conversation->m_EntryList.Count(); ++nEntry)
+        {
+            FBioDialogEntryNode const& Entry = Conversation->m_EntryList(nEntry);
+
+            GraphEvent.append(nEntry != 0 ? ",[" : "[");
+            for (UINT nLink = 0; nLink < Entry.ReplyListNew.Count(); ++nLink)
+            {
+                FBioDialogReplyListDetails const& Details = Entry.ReplyListNew(nLink);
+
+                GraphEvent.append(nLink != 0 ? R"(,{"reply":)" : R"({"reply":)");
+                AppendInteger(GraphEvent, Details.nIndex);
+                GraphEvent.append(R"(,"category":)");
+                AppendJsonString(GraphEvent, ReplyCategoryToString(static_cast<EReplyCategory>(Details.Category)));
+                GraphEvent.append(R"(,"paraphrase":)");
+                AppendText(Details.srParaphrase);
+                GraphEvent.append("}");
+            }
+            GraphEvent.append("]");
+        }
+
+        GraphEvent.append(R"(],"replies":[)");
+        for (UINT nReply = 0; nReply < Conversation->m_ReplyList.Count(); ++nReply)
+        {
+            FBioDialogReplyNode const& Reply = Conversation->m_ReplyList(nReply);
+
+            GraphEvent.append(nReply != 0 ? R"(,{"style":)" : R"({"style":)");
+            AppendJsonString(GraphEvent, GuiStyleToString(static_cast<EConvGUIStyles>(Reply.eGUIStyle)));
+            GraphEvent.append(R"(,"text":)");
+            AppendText(Reply.srText);
+            GraphEvent.append("}");
+        }
+        GraphEvent.append("]}");
+
+        LEASI_DEBUG(L"conversation graph: {} entries, {} replies, {} bytes in {:.3f} ms",
+            Conversation->m_EntryList.Count(), Conversation->m_ReplyList.Count(), GraphEvent.size(),
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - Start).count());
+
+        Events.Publish(ChannelTopic::Graph, std::move(GraphEvent));
     }
 
-    void SnifferClient::SendReplyUpdate(FString&& InBuffer)
+    void SnifferClient::PublishNode(std::chrono::steady_clock::time_point const InObservedAt)
     {
-        Http.QueueRequest(L"PUT", L"/conversation/replies", std::move(InBuffer));
+        int const nEntry = Conversation->m_nCurrentEntry;
+        unsigned SlotMask = 0;
+        unsigned IllegalMask = 0;
+
+        if (nEntry >= 0 && nEntry < static_cast<int>(Conversation->m_EntryList.Count()))
+        {
+            ABioWorldInfo* const WorldInfo = g_worldCache.Resolve(Conversation);
+            LEASI_CHECKW(WorldInfo != nullptr, L"failed to retrieve world info", L"");
+
+            FBioDialogEntryNode const& Entry = Conversation->m_EntryList(nEntry);
+            for (int const Index : Conversation->m_lstCurrentReplyIndices)
+            {
+                if (Index < 0 || Index >= static_cast<int>(k_maxReplySlots) || Index >= static_cast<int>(Entry.ReplyListNew.Count()))
+                    continue;
+
+                FBioDialogReplyListDetails const& Details = Entry.ReplyListNew(Index);
+                LEASI_CHECKW(static_cast<UINT>(Details.nIndex) < Conversation->m_ReplyList.Count(), L"reply index out of bounds", L"");
+
+                // Only conditions depend on game state, everything else is in the graph already.
+                SlotMask |= 1u << Index;
+                if (!CheckReplyCondition(WorldInfo, Conversation, Conversation->m_ReplyList(Details.nIndex)))
+                    IllegalMask |= 1u << Index;
+            }
+        }
+
+        std::string NodeEvent = Events.AcquireEvent();
+        NodeEvent.append(R"({"type":"node","node":)");
+        AppendInteger(NodeEvent, nEntry);
+        NodeEvent.append(R"(,"slots":)");
+        AppendInteger(NodeEvent, SlotMask);
+        NodeEvent.append(R"(,"illegal":)");
+        AppendInteger(NodeEvent, IllegalMask);
+        NodeEvent.append("}");
+
+        auto const BuiltAt = std::chrono::steady_clock::now();
+        BuildLatency.Record(BuiltAt - InObservedAt);
+
+        Events.Publish(ChannelTopic::Node, std::move(NodeEvent));
+        EnqueueLatency.Record(std::chrono::steady_clock::now() - BuiltAt);
     }
 
-    void SnifferClient::BuildReplyUpdate
+    void SnifferClient::CollectReplies
     (
-        UBioConversation* const     InConversation,
-        FString&                    OutBuffer
+        UBioConversation* const         InConversation,
+        std::vector<ReplyBundle>&       OutBundles
     )
     {
-        OutBuffer.Clear();
-        OutBuffer.Reserve(1024);
+        OutBundles.clear();
 
-        UEngine* const Engine = Common::FindFirstObject<UEngine>();
-        LEASI_CHECKW(Engine != nullptr, L"failed to retrieve engine", L"");
-        ABioWorldInfo* const WorldInfo = Engine->GetCurrentWorldInfo()->Cast<ABioWorldInfo>();
+        ABioWorldInfo* const WorldInfo = g_worldCache.Resolve(InConversation);
         LEASI_CHECKW(WorldInfo != nullptr, L"failed to retrieve world info", L"");
 
         int const nCurrentEntry = InConversation->m_nCurrentEntry;
-        std::vector<ReplyBundle> ReplyBundles{};
+        std::vector<ReplyBundle>& ReplyBundles = OutBundles;
+
+        ConditionalTable::Stats const StatsBefore = g_conditionalTable.GetStats();
 
         if (nCurrentEntry >= 0 && nCurrentEntry < static_cast<int>(InConversation->m_EntryList.Count()))
         {
@@ -396,28 +727,103 @@ namespace ConvoSniffer
                 Bundle.Index = Index;
                 Bundle.Style = GuiStyleToString(static_cast<EConvGUIStyles>(Reply.eGUIStyle));
                 Bundle.Category = ReplyCategoryToString(static_cast<EReplyCategory>(Details.Category));
-                Bundle.Paraphrase = InConversation->GetStringInfo(Details.srParaphrase).sText;
-                Bundle.Text = InConversation->GetStringInfo(Reply.srText).sText;
+                Bundle.Paraphrase = &g_stringCache.Find(InConversation, Details.srParaphrase);
+                Bundle.Text = &g_stringCache.Find(InConversation, Reply.srText);
 
                 if (!CheckReplyCondition(WorldInfo, InConversation, Reply))
                     Bundle.Style = GuiStyleToString(GUI_STYLE_ILLEGAL);
 
-                if (Bundle.Text.Empty()) ReplyBundles.pop_back();
-                if (Bundle.Text.Contains(L"\n")) LEASI_BREAK_SAFE();
+                if (Bundle.Text->Text.Contains(L"\n")) LEASI_BREAK_SAFE();
+                if (Bundle.Text->Text.Empty()) ReplyBundles.pop_back();
             }
         }
 
-        OutBuffer.AppendFormat(L"%llu\n", ReplyBundles.size());
+        ConditionalTable::Stats const StatsAfter = g_conditionalTable.GetStats();
+        if (std::uint64_t const Lookups = StatsAfter.Lookups - StatsBefore.Lookups; Lookups != 0)
+        {
+            double const Spent = StatsAfter.LookupSeconds - StatsBefore.LookupSeconds;
+            LEASI_DEBUG(L"node {}: {} conditionals looked up in {:.1f} us, {} rebuilds, {} remembered misses",
+                nCurrentEntry, Lookups, Spent * 1e6, StatsAfter.Rebuilds - StatsBefore.Rebuilds, StatsAfter.Misses - StatsBefore.Misses);
+        }
+    }
+
+    void SnifferClient::FormatReplyUpdate
+    (
+        std::vector<ReplyBundle> const& InBundles,
+        std::string&                    OutBody
+    )
+    {
+        OutBody.clear();
+        AppendInteger(OutBody, static_cast<long long>(InBundles.size()));
+        OutBody.push_back('\n');
+
+        for (ReplyBundle const& Bundle : InBundles)
+        {
+            OutBody.push_back('\n');
+            AppendInteger(OutBody, Bundle.Index);
+            OutBody.push_back('\n');
+            AppendAscii(OutBody, Bundle.Style);
+            OutBody.push_back('\n');
+            AppendAscii(OutBody, Bundle.Category);
+            OutBody.push_back('\n');
+
+            if (!Bundle.Paraphrase->bUtf8Valid)
+                LEASI_ERROR(L"failed to convert paraphrase of reply {} to utf-8", Bundle.Index);
+            OutBody.append(Bundle.Paraphrase->Utf8).push_back('\n');
+
+            if (!Bundle.Text->bUtf8Valid)
+                LEASI_ERROR(L"failed to convert text of reply {} to utf-8", Bundle.Index);
+            OutBody.append(Bundle.Text->Utf8).push_back('\n');
+        }
+    }
+
+    void SnifferClient::FormatDashboardReplies
+    (
+        std::vector<ReplyBundle> const& InBundles,
+        std::string&                    OutMessage
+    )
+    {
+        // The dashboard lays replies out by slot, with blank ones in between.
+        ReplyBundle const* Slots[k_maxReplySlots]{};
+        for (ReplyBundle const& Bundle : InBundles)
+        {
+            if (Bundle.Index >= 0 && Bundle.Index < static_cast<int>(k_maxReplySlots))
+                Slots[Bundle.Index] = &Bundle;
+        }
+
+        auto const AppendText = [&OutMessage](ReplyBundle const& InBundle, StringCache::Entry const& InText) -> void
+            {
+                if (!InText.bUtf8Valid)
+                    LEASI_ERROR(L"failed to convert text of reply {} to utf-8", InBundle.Index);
+                AppendJsonString(OutMessage, InText.Utf8);
+            };
 
-        for (ReplyBundle const& Bundle : ReplyBundles)
+        OutMessage.assign(R"({"UpdateReplies":{"replies":[)");
+        for (std::size_t nSlot = 0; nSlot < k_maxReplySlots; ++nSlot)
         {
-            OutBuffer.AppendFormat(L"\n");
-            OutBuffer.AppendFormat(L"%d\n", Bundle.Index);
-            OutBuffer.AppendFormat(L"%s\n", Bundle.Style);
-            OutBuffer.AppendFormat(L"%s\n", Bundle.Category);
-            OutBuffer.AppendFormat(L"%s\n", *Bundle.Paraphrase);
-            OutBuffer.AppendFormat(L"%s\n", *Bundle.Text);
+            if (nSlot != 0)
+                OutMessage.push_back(',');
+
+            ReplyBundle const* const Bundle = Slots[nSlot];
+            if (Bundle == nullptr)
+            {
+                OutMessage.append(R"({"id":0,"style":"","category":"","paraphrase":"","text":"","queued":false})");
+                continue;
+            }
+
+            OutMessage.append(R"({"id":)");
+            AppendInteger(OutMessage, Bundle->Index);
+            OutMessage.append(R"(,"style":)");
+            AppendJsonString(OutMessage, Bundle->Style);
+            OutMessage.append(R"(,"category":)");
+            AppendJsonString(OutMessage, Bundle->Category);
+            OutMessage.append(R"(,"paraphrase":)");
+            AppendText(*Bundle, *Bundle->Paraphrase);
+            OutMessage.append(R"(,"text":)");
+            AppendText(*Bundle, *Bundle->Text);
+            OutMessage.append(R"(,"queued":false})");
         }
+        OutMessage.append("]}}");
     }
 
     bool SnifferClient::CheckReplyCondition
@@ -432,37 +838,21 @@ namespace ConvoSniffer
 
         wchar_t const* const ConditionalType = InReply.bFireConditional ? L"conditional" : L"bool";
 
-        LEASI_TRACE(L"Evaluating reply: {}", *InConversation->GetStringInfo(InReply.srText).sText);
+        LEASI_TRACE(L"Evaluating reply: {}", *g_stringCache.Find(InConversation, InReply.srText).Text);
         LEASI_TRACE(L"  id = {}, param = {}, type = {}", InReply.nConditionalFunc, InReply.nConditionalParam, ConditionalType);
 
         if (InReply.bFireConditional)
         {
             if (InReply.nConditionalFunc >= 0)
             {
-                SFXName const ClassName(L"BioAutoConditionals", 0);
-                SFXName const FunctionName(*FString::Printf(L"F%d", InReply.nConditionalFunc), 0);
-
-                Common::TypedObjectIterator<UFunction> Iterator{};
-                for (; Iterator; ++Iterator)
+                ConditionalTable::Target const Target = g_conditionalTable.Find(InReply.nConditionalFunc);
+                if (Target.Function != nullptr)
                 {
-                    UFunction* const    Function = *Iterator;
-                    UClass* const       Class = Function->Outer ? Function->Outer->Cast<UClass>() : nullptr;
-
-                    if (Function->Name == FunctionName && Class != nullptr && Class->Name == ClassName)
-                    {
-                        LEASI_CHECKW((Function->FunctionFlags & 0x400) == 0,
-                            L"native conditional: {}", *Function->GetFullName());
-
-                        UObject* const      Context = Class->ClassDefaultObject;
-                        ConditionalParms    Parms{ WorldInfo, InReply.nConditionalParam, 0u };
-
-                        Context->ProcessEvent(Function, &Parms, NULL);
-
-                        if (Parms.ReturnValue == FALSE)
-                            return false;
+                    ConditionalParms Parms{ WorldInfo, InReply.nConditionalParam, 0u };
+                    Target.Context->ProcessEvent(Target.Function, &Parms, NULL);
 
-                        break;
-                    }
+                    if (Parms.ReturnValue == FALSE)
+                        return false;
                 }
             }
         }
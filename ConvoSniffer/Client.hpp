@@ -1,63 +1,45 @@
 #pragma once
 
 #include <atomic>
-#include <condition_variable>
-#include <deque>
-#include <mutex>
-#include <thread>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include <LESDK/Headers.hpp>
 #include "Common/Base.hpp"
+#include "ConvoSniffer/Channel.hpp"
+#include "ConvoSniffer/Dashboard.hpp"
+#include "ConvoSniffer/Http.hpp"
+#include "ConvoSniffer/Recorder.hpp"
+#include "ConvoSniffer/Stats.hpp"
+#include "ConvoSniffer/Strings.hpp"
 
 namespace ConvoSniffer
 {
     class SnifferClient;
 
-    extern SnifferClient*       gp_snifferClient;
+    /// @remarks    Null until the client has been created by @ref LaunchSnifferClient , hooks do nothing until then.
+    extern std::atomic<SnifferClient*> gp_snifferClient;
     extern bool                 gb_renderScaleform;
 
-    class HttpClient final : public NonCopyable
-    {
-    public:
+    /// @brief      Creates the client on a background thread, publishing it in @ref gp_snifferClient once done.
+    /// @remarks    Called once from the game thread when the engine starts running script, so that neither
+    ///             plugin attach nor the game thread waits for connections to be set up.
+    void LaunchSnifferClient(char const* InHost, int InPort);
 
-        HttpClient(char const* InHost, int InPort);
-        ~HttpClient() noexcept;
+    /// @brief      Waits for a launch in progress and destroys the client, if any.
+    void ShutdownSnifferClient();
 
-        void QueueRequest(wchar_t const* InMethod, wchar_t const* InPath, FString&& InBody);
+    /// @brief      Converts a string to UTF-8, replacing the contents of @c OutString .
+    bool StringToUtf8(FString const& InString, std::string& OutString);
 
-    private:
-
-        struct Request final
-        {
-            int             Index{};
-            wchar_t const*  Method{};
-            FString         Path{};
-            FString         Body{};
-        };
-
-        struct Response final
-        {
-            DWORD           Status{};
-            FString         Body{};
-        };
+    /// @brief      Converts a string to UTF-8, appending it to @c OutString .
+    bool AppendUtf8(FString const& InString, std::string& OutString);
 
-        bool SendHttp(Request const& InRequest, Response* OutResponse = nullptr) const;
-        static bool StringToUtf8(FString const& InString, std::string& OutString);
-        static bool StringFromUtf8(FString& OutString, std::string const& InString);
-
-        LPVOID                      Win32Internet;
-        LPVOID                      Win32Session;
-
-        FString                     Host;
-        int                         Port;
-
-        std::mutex                  QueueMutex;
-        std::condition_variable     RequestCondition;
-        std::deque<Request>         RequestQueue;
-        int                         RequestIndex;
-        std::thread                 ProcessThread;
-        std::atomic_flag            bWantsExit;
-    };
+    /// @brief      Converts a UTF-8 string, replacing the contents of @c OutString .
+    bool StringFromUtf8(FString& OutString, std::string const& InString);
 
     class SnifferClient final : public NonCopyable
     {
@@ -77,11 +59,31 @@ namespace ConvoSniffer
         void OnUpdateConversation(UBioConversation* InConversation);
         void OnVeryFrequentUpdateConversation();
 
+        /// @brief      Logs latency histograms of every stage between a node change and the companion server.
+        void LogStats();
+
+        /// @brief      Starts or stops recording outbound events, for replaying them outside of the game.
+        void ToggleRecording();
+
     private:
 
+        struct ReplyBundle final
+        {
+            int                 Index;
+            wchar_t const*      Style;
+            wchar_t const*      Category;
+            StringCache::Entry const* Paraphrase;     // Owned by @ref g_stringCache .
+            StringCache::Entry const* Text;
+        };
+
+        static constexpr std::size_t k_maxReplySlots = 16;
+
         void SendKeybinds();
-        void SendReplyUpdate();
-        void SendReplyUpdate(FString&& InBuffer);
+        void SendReplyUpdate(std::chrono::steady_clock::time_point InObservedAt);
+        void LogStatsSummary();
+
+        void PublishGraph();
+        void PublishNode(std::chrono::steady_clock::time_point InObservedAt);
 
         struct ConditionalParms final
         {
@@ -90,21 +92,28 @@ namespace ConvoSniffer
             unsigned long       ReturnValue;
         };
 
-        static void BuildReplyUpdate(UBioConversation* InConversation, FString& OutBuffer);
+        static void CollectReplies(UBioConversation* InConversation, std::vector<ReplyBundle>& OutBundles);
+        static void FormatReplyUpdate(std::vector<ReplyBundle> const& InBundles, std::string& OutBody);
+        static void FormatDashboardReplies(std::vector<ReplyBundle> const& InBundles, std::string& OutMessage);
         static bool CheckReplyCondition(ABioWorldInfo* WorldInfo, UBioConversation* InConversation, FBioDialogReplyNode const& InReply);
 
-        struct ReplyBundle final
-        {
-            int                 Index;
-            wchar_t const*      Style;
-            wchar_t const*      Category;
-            FString             Paraphrase;
-            FString             Text;
-        };
-
         HttpClient              Http;
+        EventChannel            Events;
+        std::unique_ptr<DashboardServer> Dashboard;     // Only created when serving the dashboard in-process.
         UBioConversation*       Conversation;
         int                     nCurrentEntry;
         bool                    bInitialReplies;
+
+        std::vector<ReplyBundle> Bundles;       // Reused between reply updates.
+        std::string             KeybindsEvent;  // Labels of the configured keybinds, for the event channel.
+        std::string             KeybindsNotification;   // Same labels, as the dashboard expects them.
+
+        LatencyHistogram        BuildLatency;   // From observing a node change to its update being built.
+        LatencyHistogram        EnqueueLatency; // From the update being built to it being queued.
+        std::uint64_t           nObservations;  // Node changes observed.
+        std::chrono::steady_clock::time_point LastStatsLog;
+
+        SessionRecorder         Recorder;
+        std::string             RecordBody;     // Reply update body, only built for the recorder when using the event channel.
     };
 }
@@ -0,0 +1,138 @@
+#include <chrono>
+#include <utility>
+
+#include "Common/Objects.hpp"
+#include "ConvoSniffer/Conditionals.hpp"
+
+
+namespace
+{
+    /// Parses the conditional id out of a @c F<n> function name, returns -1 for any other name.
+    int ParseConditionalId(FString const& InName)
+    {
+        wchar_t const* Chars = *InName;
+        if (Chars == nullptr || *Chars++ != L'F' || *Chars == L'\0')
+            return -1;
+
+        int Id = 0;
+        for (; *Chars != L'\0'; ++Chars)
+        {
+            if (*Chars < L'0' || *Chars > L'9' || Id > 0x0FFFFFFF)
+                return -1;
+            Id = Id * 10 + static_cast<int>(*Chars - L'0');
+        }
+
+        return Id;
+    }
+}
+
+namespace ConvoSniffer
+{
+    ConditionalTable g_conditionalTable{};
+
+
+    // ! ConditionalTable implementation.
+    // ========================================
+
+    ConditionalTable::Target ConditionalTable::Find(int const Id)
+    {
+        auto const Start = std::chrono::steady_clock::now();
+        Counters.Lookups++;
+
+        if (!bBuilt || (Context != nullptr && !Common::IsObjectAlive(Context, ContextIndex)))
+            Rebuild();
+
+        auto Iter = Functions.find(Id);
+        bool const bStale = Iter != Functions.end() && !IsValid(Iter->second);
+
+        // An id missed before is only looked for again once in a while, a new one right away.
+        bool const bMaybeLoaded = Iter == Functions.end() && ObjectCount != UObject::GObjObjects->Count()
+            && (!Missing.contains(Id) || Start - LastRebuild >= k_missRebuildInterval);
+
+        if (Iter == Functions.end() && !bMaybeLoaded && Missing.contains(Id))
+            Counters.Misses++;
+
+        if (bStale || bMaybeLoaded)
+        {
+            Rebuild();
+            Iter = Functions.find(Id);
+        }
+
+        if (Iter == Functions.end())
+            Missing.insert(Id);
+
+        Target Result{};
+        if (Iter != Functions.end() && Context != nullptr)
+        {
+            Result.Function = Iter->second.Function;
+            Result.Context = Context;
+        }
+
+        Counters.LookupSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+        return Result;
+    }
+
+    void ConditionalTable::Invalidate()
+    {
+        Functions.clear();
+        Missing.clear();
+        Context = nullptr;
+        ContextIndex = -1;
+        ObjectCount = 0;
+        bBuilt = false;
+    }
+
+    bool ConditionalTable::IsValid(Entry const& InEntry) const
+    {
+        return Common::IsObjectAlive(InEntry.Function, InEntry.FunctionIndex);
+    }
+
+    void ConditionalTable::Rebuild()
+    {
+        auto const Start = std::chrono::steady_clock::now();
+
+        // Unknown ids stay remembered, so that alternating between them does not rebuild every time.
+        std::unordered_set<int> StillMissing = std::move(Missing);
+        Invalidate();
+        Missing = std::move(StillMissing);
+
+        SFXName const ClassName(L"BioAutoConditionals", 0);
+        UClass* ConditionalsClass = nullptr;
+
+        for (Common::TypedObjectIterator<UFunction> Iterator{}; Iterator; ++Iterator)
+        {
+            UFunction* const    Function = *Iterator;
+            UClass* const       Class = Function->Outer ? Function->Outer->Cast<UClass>() : nullptr;
+
+            if (Class == nullptr || !(Class->Name == ClassName))
+                continue;
+
+            int const Id = ParseConditionalId(Function->Name.ToString());
+            if (Id < 0)
+                continue;
+
+            LEASI_CHECKW((Function->FunctionFlags & 0x400) == 0,
+                L"native conditional: {}", *Function->GetFullName());
+
+            Functions.insert_or_assign(Id, Entry{ Function, Common::GetObjectIndex(Function) });
+            ConditionalsClass = Class;
+        }
+
+        if (ConditionalsClass != nullptr && ConditionalsClass->ClassDefaultObject != nullptr)
+        {
+            Context = ConditionalsClass->ClassDefaultObject;
+            ContextIndex = Common::GetObjectIndex(Context);
+        }
+
+        ObjectCount = UObject::GObjObjects->Count();
+        bBuilt = true;
+        LastRebuild = std::chrono::steady_clock::now();
+
+        Counters.Rebuilds++;
+        Counters.Functions = Functions.size();
+        Counters.LastRebuildSeconds = std::chrono::duration<double>(LastRebuild - Start).count();
+
+        LEASI_DEBUG(L"conditional table rebuilt: {} functions in {:.3f} ms",
+            Functions.size(), Counters.LastRebuildSeconds * 1000);
+    }
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+
+#include <LESDK/Headers.hpp>
+#include "Common/Base.hpp"
+
+
+namespace ConvoSniffer
+{
+    /// @brief      Lazily built lookup of @c BioAutoConditionals.F<n> functions by conditional id.
+    /// @remarks    The table is populated in a single pass over the global object array, instead of one
+    ///             pass per evaluated reply. It is rebuilt when a cached function or default object is no
+    ///             longer alive, or when an unknown id is requested after the object array has changed.
+    /// @remarks    The object array grows all the time during play, so unknown ids are remembered, and
+    ///             looking one up again only rebuilds once @ref k_missRebuildInterval has passed.
+    class ConditionalTable final : public NonCopyable
+    {
+    public:
+
+        struct Target final
+        {
+            UFunction*          Function{ nullptr };
+            UObject*            Context{ nullptr };         // Class default object of BioAutoConditionals.
+        };
+
+        struct Stats final
+        {
+            std::uint64_t       Lookups{ 0 };
+            std::uint64_t       Rebuilds{ 0 };
+            std::uint64_t       Misses{ 0 };                // Lookups of remembered unknown ids which did not rebuild.
+            std::uint64_t       Functions{ 0 };             // Number of conditionals found by the last rebuild.
+            double              LookupSeconds{ 0. };
+            double              LastRebuildSeconds{ 0. };
+        };
+
+        /// @brief      Finds a conditional function and the object to invoke it on.
+        /// @param[in]  Id - Conditional id as stored in @c FBioDialogReplyNode::nConditionalFunc .
+        /// @return     Function and context pointers, both @c nullptr if no such conditional is loaded.
+        Target Find(int Id);
+
+        /// @brief      Drops all cached pointers, forcing a rebuild on the next lookup.
+        void Invalidate();
+
+        Stats GetStats() const noexcept { return Counters; }
+
+    private:
+
+        static constexpr std::chrono::milliseconds k_missRebuildInterval{ 500 };
+
+        struct Entry final
+        {
+            UFunction*          Function{ nullptr };
+            int                 FunctionIndex{ -1 };
+        };
+
+        bool IsValid(Entry const& InEntry) const;
+        void Rebuild();
+
+        std::unordered_map<int, Entry>  Functions{};
+        std::unordered_set<int>         Missing{};                  // Ids no rebuild found, until invalidated.
+        UObject*                        Context{ nullptr };
+        int                             ContextIndex{ -1 };
+        UINT                            ObjectCount{ 0 };           // Object array size at the last rebuild.
+        bool                            bBuilt{ false };
+        std::chrono::steady_clock::time_point LastRebuild{};
+
+        Stats                           Counters{};
+    };
+
+    extern ConditionalTable g_conditionalTable;
+}
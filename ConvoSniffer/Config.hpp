@@ -18,3 +18,59 @@
 #ifndef CNVSNF_PROFILE_CONVO
     #define CNVSNF_PROFILE_CONVO 1
 #endif
+
+/// @def    CNVSNF_COMPANION_HOST
+/// @brief  Host name of the companion server.
+#ifndef CNVSNF_COMPANION_HOST
+    #define CNVSNF_COMPANION_HOST "localhost"
+#endif
+
+/// @def    CNVSNF_COMPANION_PORT
+/// @brief  TCP port of the companion server.
+#ifndef CNVSNF_COMPANION_PORT
+    #define CNVSNF_COMPANION_PORT 21830
+#endif
+
+/// @def    CNVSNF_WININET_TRANSPORT
+/// @brief  Toggles sending requests over WinINet, which cannot pipeline them, instead of a plain socket.
+#ifndef CNVSNF_WININET_TRANSPORT
+    #define CNVSNF_WININET_TRANSPORT 0
+#endif
+
+/// @def    CNVSNF_EVENT_CHANNEL
+/// @brief  Toggles pushing events to the companion server over a WebSocket, instead of one HTTP request each.
+#ifndef CNVSNF_EVENT_CHANNEL
+    #define CNVSNF_EVENT_CHANNEL 1
+#endif
+
+/// @def    CNVSNF_QUEUE_OVERFLOW_POLICY
+/// @brief  What happens to companion server requests while the backlog is full,
+///         0 drops the oldest, 1 drops the oldest coalescing one, 2 blocks the game thread for a while.
+///         The event channel only distinguishes blocking, and otherwise resends its state once it caught up.
+#ifndef CNVSNF_QUEUE_OVERFLOW_POLICY
+    #define CNVSNF_QUEUE_OVERFLOW_POLICY 1
+#endif
+
+/// @def    CNVSNF_KEYBINDS_FILE
+/// @brief  Path of the file binding input keys to reply slots, relative to the game's working directory.
+#ifndef CNVSNF_KEYBINDS_FILE
+    #define CNVSNF_KEYBINDS_FILE L"convosniffer.le1.keybinds.ini"
+#endif
+
+/// @def    CNVSNF_RECORD_FILE
+/// @brief  Path of the session recording toggled by @c cs.record , relative to the game's working directory.
+#ifndef CNVSNF_RECORD_FILE
+    #define CNVSNF_RECORD_FILE L"convosniffer.le1.rec"
+#endif
+
+/// @def    CNVSNF_DASHBOARD_SERVER
+/// @brief  Toggles serving the dashboard from within the game, instead of sending events to the companion server.
+#ifndef CNVSNF_DASHBOARD_SERVER
+    #define CNVSNF_DASHBOARD_SERVER 0
+#endif
+
+/// @def    CNVSNF_DASHBOARD_PORT
+/// @brief  TCP port the in-process dashboard server listens on, the same as the companion server by default.
+#ifndef CNVSNF_DASHBOARD_PORT
+    #define CNVSNF_DASHBOARD_PORT 21830
+#endif
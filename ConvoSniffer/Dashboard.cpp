@@ -0,0 +1,739 @@
+#if defined(_WIN32)
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+#else
+    #include <arpa/inet.h>
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <sys/select.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <iterator>
+#include <mutex>
+#include <utility>
+
+#include "Common/Logging.hpp"
+#include "ConvoSniffer/Dashboard.hpp"
+#include "ConvoSniffer/Transport.hpp"
+
+
+namespace
+{
+#if defined(_WIN32)
+    using SocketHandle = SOCKET;
+    constexpr std::intptr_t k_invalidSocket = static_cast<std::intptr_t>(INVALID_SOCKET);
+
+    constexpr int k_sendFlags = 0;
+
+    int GetSocketError() { return ::WSAGetLastError(); }
+    bool IsWouldBlock(int const Error) { return Error == WSAEWOULDBLOCK; }
+    void CloseSocket(std::intptr_t const Handle) { ::closesocket(static_cast<SocketHandle>(Handle)); }
+
+    bool SetNonBlocking(std::intptr_t const Handle)
+    {
+        u_long Enable = 1;
+        return ::ioctlsocket(static_cast<SocketHandle>(Handle), FIONBIO, &Enable) == 0;
+    }
+
+    bool InitializeSockets()
+    {
+        static std::once_flag s_once{};
+        static bool s_bInitialized = false;
+
+        std::call_once(s_once, []() -> void
+            {
+                WSADATA Data{};
+                s_bInitialized = ::WSAStartup(MAKEWORD(2, 2), &Data) == 0;
+            });
+
+        return s_bInitialized;
+    }
+#else
+    using SocketHandle = int;
+    constexpr std::intptr_t k_invalidSocket = -1;
+    constexpr int k_sendFlags = MSG_NOSIGNAL;   // Report a closed peer as an error instead of raising SIGPIPE.
+
+    int GetSocketError() { return errno; }
+    bool IsWouldBlock(int const Error) { return Error == EAGAIN || Error == EWOULDBLOCK; }
+    void CloseSocket(std::intptr_t const Handle) { ::close(static_cast<SocketHandle>(Handle)); }
+    bool SetNonBlocking(std::intptr_t const Handle) { return ::fcntl(static_cast<SocketHandle>(Handle), F_SETFL, O_NONBLOCK) == 0; }
+    bool InitializeSockets() { return true; }
+#endif
+
+    // Upper bound for the request head of a browser, and for a frame received from one.
+    constexpr std::size_t k_maxRequestSize = 16 * 1024;
+
+    bool EqualsNoCase(std::string_view const Lhs, std::string_view const Rhs)
+    {
+        return Lhs.size() == Rhs.size() && std::equal(Lhs.begin(), Lhs.end(), Rhs.begin(),
+            [](char const A, char const B) -> bool
+            {
+                auto const Lower = [](char const C) -> char { return (C >= 'A' && C <= 'Z') ? static_cast<char>(C + ('a' - 'A')) : C; };
+                return Lower(A) == Lower(B);
+            });
+    }
+
+    std::string_view Trim(std::string_view Value)
+    {
+        while (!Value.empty() && (Value.front() == ' ' || Value.front() == '\t')) Value.remove_prefix(1);
+        while (!Value.empty() && (Value.back() == ' ' || Value.back() == '\t')) Value.remove_suffix(1);
+        return Value;
+    }
+
+    /// Checks whether a comma-separated header value contains the given token, e.g. @c Connection: keep-alive, Upgrade .
+    bool HasToken(std::string_view Value, std::string_view const Token)
+    {
+        while (!Value.empty())
+        {
+            std::size_t const Comma = Value.find(',');
+            if (EqualsNoCase(Trim(Value.substr(0, Comma)), Token))
+                return true;
+            Value.remove_prefix(Comma == std::string_view::npos ? Value.size() : Comma + 1);
+        }
+
+        return false;
+    }
+}
+
+namespace ConvoSniffer
+{
+    // ! DashboardServer implementation.
+    // ========================================
+
+    DashboardServer::DashboardServer(int const InPort, std::string_view const InPage)
+        : Port{ InPort }
+        , Page{ InPage }
+        , ListenSocket{ k_invalidSocket }
+        , WakeSocket{ k_invalidSocket }
+        , WakeSender{ k_invalidSocket }
+    {
+        SpareMessages.reserve(k_dashboardMessagePoolSize);
+
+        if (Listen())
+        {
+            bListening = true;
+            ServeThread = std::thread(&DashboardServer::ServeMain, this);
+        }
+    }
+
+    DashboardServer::~DashboardServer()
+    {
+        bWantsExit.store(true);
+        WakeServer();
+
+        if (ServeThread.joinable())
+            ServeThread.join();
+
+        for (Client& Browser : Clients)
+            Disconnect(Browser);
+
+        for (std::intptr_t const Socket : { ListenSocket, WakeSocket, WakeSender })
+        {
+            if (Socket != k_invalidSocket)
+                CloseSocket(Socket);
+        }
+    }
+
+    std::string DashboardServer::AcquireMessage()
+    {
+        if (SpareMessages.empty())
+            return std::string{};
+
+        std::string Message = std::move(SpareMessages.back());
+        SpareMessages.pop_back();
+        Message.clear();
+        return Message;
+    }
+
+    void DashboardServer::Publish(DashboardTopic const InTopic, std::string&& InMessage)
+    {
+        if (!bListening)
+            return;
+
+        Counters.Published.fetch_add(1, std::memory_order_relaxed);
+        Update Pending{ InTopic, std::move(InMessage), std::chrono::steady_clock::now() };
+
+        // The ring only fills up while the server thread is busy writing to browsers. Once it did,
+        // updates keep overflowing until the server thread took them, so that browsers see them in order.
+        if (bOverflowing.load(std::memory_order_relaxed) || !UpdateRing.TryPush(Pending))
+        {
+            std::scoped_lock OverflowLock(OverflowMutex);
+            OverflowUpdates.push_back(std::move(Pending));
+            bOverflowing.store(true, std::memory_order_relaxed);
+            Counters.Overflowed.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        WakeServer();
+
+        // A message the server thread handed back through the slot, unless the update overflowed.
+        if (Pending.Message.capacity() > std::string{}.capacity() && SpareMessages.size() < k_dashboardMessagePoolSize)
+            SpareMessages.push_back(std::move(Pending.Message));
+    }
+
+    DashboardServer::Stats DashboardServer::GetStats()
+    {
+        Stats Result{};
+        Result.Clients = Counters.Clients.load(std::memory_order_relaxed);
+        Result.Published = Counters.Published.load(std::memory_order_relaxed);
+        Result.Overflowed = Counters.Overflowed.load(std::memory_order_relaxed);
+        Result.Connections = Counters.Connections.load(std::memory_order_relaxed);
+        Result.PageRequests = Counters.PageRequests.load(std::memory_order_relaxed);
+        Result.Disconnects = Counters.Disconnects.load(std::memory_order_relaxed);
+        Result.Overruns = Counters.Overruns.load(std::memory_order_relaxed);
+        Result.BytesSent = Counters.BytesSent.load(std::memory_order_relaxed);
+        Result.HandoffLatency = HandoffLatency.GetSnapshot();
+        return Result;
+    }
+
+    bool DashboardServer::Listen()
+    {
+        if (!InitializeSockets())
+        {
+            Fail("startup");
+            return false;
+        }
+
+        ListenSocket = static_cast<std::intptr_t>(::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP));
+        if (ListenSocket == k_invalidSocket)
+        {
+            Fail("socket");
+            return false;
+        }
+
+#if !defined(_WIN32)
+        // Allow restarting right away while old connections linger, Winsock would allow stealing the port instead.
+        int const Reuse = 1;
+        ::setsockopt(static_cast<SocketHandle>(ListenSocket), SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<char const*>(&Reuse), sizeof Reuse);
+#endif
+
+        // Like the companion server, listen on every interface so that the dashboard can be opened on another device.
+        sockaddr_in Address{};
+        Address.sin_family = AF_INET;
+        Address.sin_addr.s_addr = htonl(INADDR_ANY);
+        Address.sin_port = htons(static_cast<unsigned short>(Port));
+
+        if (::bind(static_cast<SocketHandle>(ListenSocket), reinterpret_cast<sockaddr const*>(&Address), sizeof Address) != 0)
+        {
+            Fail("bind");
+            return false;
+        }
+
+        if (::listen(static_cast<SocketHandle>(ListenSocket), SOMAXCONN) != 0 || !SetNonBlocking(ListenSocket))
+        {
+            Fail("listen");
+            return false;
+        }
+
+        socklen_t Length = sizeof Address;
+        ::getsockname(static_cast<SocketHandle>(ListenSocket), reinterpret_cast<sockaddr*>(&Address), &Length);
+        Port = ntohs(Address.sin_port);
+
+        // The producer wakes the event loop up by sending a datagram to itself over loopback.
+        WakeSocket = static_cast<std::intptr_t>(::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP));
+        WakeSender = static_cast<std::intptr_t>(::socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP));
+        if (WakeSocket == k_invalidSocket || WakeSender == k_invalidSocket)
+        {
+            Fail("wake socket");
+            return false;
+        }
+
+        sockaddr_in WakeAddress{};
+        WakeAddress.sin_family = AF_INET;
+        WakeAddress.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        WakeAddress.sin_port = 0;
+
+        Length = sizeof WakeAddress;
+        if (::bind(static_cast<SocketHandle>(WakeSocket), reinterpret_cast<sockaddr const*>(&WakeAddress), sizeof WakeAddress) != 0
+            || ::getsockname(static_cast<SocketHandle>(WakeSocket), reinterpret_cast<sockaddr*>(&WakeAddress), &Length) != 0
+            || ::connect(static_cast<SocketHandle>(WakeSender), reinterpret_cast<sockaddr const*>(&WakeAddress), sizeof WakeAddress) != 0
+            || !SetNonBlocking(WakeSocket) || !SetNonBlocking(WakeSender))
+        {
+            Fail("wake socket");
+            return false;
+        }
+
+        return true;
+    }
+
+    void DashboardServer::WakeServer()
+    {
+        // Pairs with the fence in ServeMain: either the server sees the new update,
+        // or this sees the server going to sleep and wakes it up.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (bServerSleeping.load(std::memory_order_relaxed) && WakeSender != k_invalidSocket)
+        {
+            char const Signal = 0;
+            ::send(static_cast<SocketHandle>(WakeSender), &Signal, 1, 0);
+        }
+    }
+
+    void DashboardServer::ServeMain()
+    {
+        while (!bWantsExit.load(std::memory_order_relaxed))
+        {
+            fd_set ReadSet{};
+            fd_set WriteSet{};
+            FD_ZERO(&ReadSet);
+            FD_ZERO(&WriteSet);
+
+            SocketHandle MaxHandle = (std::max)(static_cast<SocketHandle>(ListenSocket), static_cast<SocketHandle>(WakeSocket));
+            FD_SET(static_cast<SocketHandle>(WakeSocket), &ReadSet);
+
+            // Browsers beyond the limit wait in the listen backlog.
+            if (Clients.size() < k_dashboardMaxClients)
+                FD_SET(static_cast<SocketHandle>(ListenSocket), &ReadSet);
+
+            for (Client const& Browser : Clients)
+            {
+                auto const Handle = static_cast<SocketHandle>(Browser.Socket);
+                FD_SET(Handle, &ReadSet);
+                if (Browser.SendOffset < Browser.SendBuffer.size())
+                    FD_SET(Handle, &WriteSet);
+                MaxHandle = (std::max)(MaxHandle, Handle);
+            }
+
+            bServerSleeping.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            timeval Timeout{ k_dashboardPollMs / 1000, (k_dashboardPollMs % 1000) * 1000 };
+            if (UpdateRing.SizeApprox() != 0 || bOverflowing.load(std::memory_order_relaxed) || bWantsExit.load(std::memory_order_relaxed))
+                Timeout = timeval{};
+
+            int const Ready = ::select(static_cast<int>(MaxHandle + 1), &ReadSet, &WriteSet, nullptr, &Timeout);
+            bServerSleeping.store(false, std::memory_order_relaxed);
+
+            if (Ready < 0)
+            {
+                LEASI_WARN("dashboard server failed to wait for sockets, error = {}", GetSocketError());
+                std::this_thread::sleep_for(std::chrono::milliseconds(k_dashboardPollMs));
+                continue;
+            }
+
+            if (FD_ISSET(static_cast<SocketHandle>(WakeSocket), &ReadSet))
+            {
+                char Signals[64];
+                while (::recv(static_cast<SocketHandle>(WakeSocket), Signals, sizeof Signals, 0) > 0) {}
+            }
+
+            DrainUpdates();
+
+            if (FD_ISSET(static_cast<SocketHandle>(ListenSocket), &ReadSet))
+                Accept();
+
+            // Writes are attempted right away instead of waiting for the next select, to save a round trip.
+            for (Client& Browser : Clients)
+            {
+                if (Browser.Socket == k_invalidSocket)
+                    continue;
+
+                bool bOpen = true;
+                if (FD_ISSET(static_cast<SocketHandle>(Browser.Socket), &ReadSet))
+                    bOpen = Receive(Browser);
+                if (bOpen && Browser.SendOffset < Browser.SendBuffer.size())
+                    bOpen = Send(Browser);
+                if (bOpen && Browser.bClosing && Browser.SendBuffer.empty())
+                    bOpen = false;
+
+                if (!bOpen)
+                    Disconnect(Browser);
+            }
+
+            std::erase_if(Clients, [](Client const& Browser) -> bool { return Browser.Socket == k_invalidSocket; });
+        }
+    }
+
+    void DashboardServer::DrainUpdates()
+    {
+        // Taking an update leaves the previous one's message in the slot, for the producer to reuse.
+        while (UpdateRing.TryPop(Incoming))
+            ApplyUpdate(Incoming);
+
+        if (!bOverflowing.load(std::memory_order_relaxed))
+            return;
+
+        {
+            std::scoped_lock OverflowLock(OverflowMutex);
+
+            // Whatever made it into the ring before the producer started overflowing comes first.
+            while (UpdateRing.TryPop(Incoming))
+                OverflowBatch.push_back(std::move(Incoming));
+
+            std::move(OverflowUpdates.begin(), OverflowUpdates.end(), std::back_inserter(OverflowBatch));
+            OverflowUpdates.clear();
+            bOverflowing.store(false, std::memory_order_relaxed);
+        }
+
+        for (Update const& Overflowed : OverflowBatch)
+            ApplyUpdate(Overflowed);
+        OverflowBatch.clear();
+    }
+
+    void DashboardServer::ApplyUpdate(Update const& InUpdate)
+    {
+        switch (InUpdate.Topic)
+        {
+        case DashboardTopic::Keybinds:
+            KeybindsMessage = InUpdate.Message;
+            break;
+        case DashboardTopic::Start:
+            StartMessage = InUpdate.Message;
+            RepliesMessage.clear();
+            QueueMessage.clear();
+            break;
+        case DashboardTopic::End:
+            StartMessage.clear();
+            RepliesMessage.clear();
+            QueueMessage.clear();
+            break;
+        case DashboardTopic::Replies:
+            RepliesMessage = InUpdate.Message;
+            QueueMessage.clear();
+            break;
+        case DashboardTopic::Queue:
+            QueueMessage = InUpdate.Message;
+            break;
+        }
+
+        Broadcast(InUpdate.Message);
+        HandoffLatency.Record(std::chrono::steady_clock::now() - InUpdate.PublishedAt);
+    }
+
+    void DashboardServer::Accept()
+    {
+        while (Clients.size() < k_dashboardMaxClients)
+        {
+            auto const Handle = static_cast<std::intptr_t>(::accept(static_cast<SocketHandle>(ListenSocket), nullptr, nullptr));
+            if (Handle == k_invalidSocket)
+            {
+                if (int const Error = GetSocketError(); !IsWouldBlock(Error))
+                    LEASI_WARN("dashboard server failed to accept a connection, error = {}", Error);
+                break;
+            }
+
+            if (!SetNonBlocking(Handle))
+            {
+                CloseSocket(Handle);
+                continue;
+            }
+
+            // Notifications are small and latency sensitive, don't let Nagle hold them back.
+            int const NoDelay = 1;
+            ::setsockopt(static_cast<SocketHandle>(Handle), IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<char const*>(&NoDelay), sizeof NoDelay);
+
+            Clients.push_back(Client{ Handle });
+        }
+    }
+
+    bool DashboardServer::Receive(Client& InClient)
+    {
+        for (;;)
+        {
+            char Chunk[4096];
+            auto const Read = ::recv(static_cast<SocketHandle>(InClient.Socket), Chunk, sizeof Chunk, 0);
+
+            if (Read > 0)
+            {
+                InClient.ReceiveBuffer.append(Chunk, static_cast<std::size_t>(Read));
+                if (InClient.ReceiveBuffer.size() > k_maxRequestSize + sizeof Chunk)
+                    return false;
+                continue;
+            }
+
+            if (Read < 0 && IsWouldBlock(GetSocketError()))
+                break;
+
+            return false;
+        }
+
+        return InClient.bUpgraded ? HandleFrames(InClient) : HandleRequest(InClient);
+    }
+
+    bool DashboardServer::Send(Client& InClient)
+    {
+        while (InClient.SendOffset < InClient.SendBuffer.size())
+        {
+            std::size_t const Remaining = InClient.SendBuffer.size() - InClient.SendOffset;
+            int const Chunk = static_cast<int>((std::min)(Remaining, std::size_t{ 1 } << 20));
+            auto const Sent = ::send(static_cast<SocketHandle>(InClient.Socket), InClient.SendBuffer.data() + InClient.SendOffset, Chunk, k_sendFlags);
+
+            if (Sent > 0)
+            {
+                InClient.SendOffset += static_cast<std::size_t>(Sent);
+                Counters.BytesSent.fetch_add(static_cast<std::uint64_t>(Sent), std::memory_order_relaxed);
+                continue;
+            }
+
+            if (Sent < 0 && IsWouldBlock(GetSocketError()))
+                break;
+
+            return false;
+        }
+
+        // Keep the buffer around for the next messages, only moving unwritten data to the front.
+        if (InClient.SendOffset == InClient.SendBuffer.size())
+        {
+            InClient.SendBuffer.clear();
+            InClient.SendOffset = 0;
+        }
+        else if (InClient.SendOffset >= InClient.SendBuffer.size() / 2)
+        {
+            InClient.SendBuffer.erase(0, InClient.SendOffset);
+            InClient.SendOffset = 0;
+        }
+
+        return true;
+    }
+
+    bool DashboardServer::HandleRequest(Client& InClient)
+    {
+        // Only one request is answered per connection.
+        if (InClient.bClosing)
+        {
+            InClient.ReceiveBuffer.clear();
+            return true;
+        }
+
+        std::size_t const HeaderEnd = InClient.ReceiveBuffer.find("\r\n\r\n");
+        if (HeaderEnd == std::string::npos)
+            return InClient.ReceiveBuffer.size() <= k_maxRequestSize;
+
+        // Whatever follows the request head is ignored, the dashboard only answers bodiless requests.
+        std::string_view Headers{ InClient.ReceiveBuffer.data(), HeaderEnd + 2 };
+        std::size_t LineEnd = Headers.find("\r\n");
+        std::string_view const RequestLine = Headers.substr(0, LineEnd);
+
+        std::size_t const MethodEnd = RequestLine.find(' ');
+        std::size_t const PathEnd = RequestLine.find(' ', MethodEnd + 1);
+        if (MethodEnd == std::string_view::npos || PathEnd == std::string_view::npos)
+        {
+            Respond(InClient, "400 Bad Request", "text/plain", "malformed request line");
+            return true;
+        }
+
+        std::string_view const Method = RequestLine.substr(0, MethodEnd);
+        std::string_view Path = RequestLine.substr(MethodEnd + 1, PathEnd - MethodEnd - 1);
+        Path = Path.substr(0, Path.find('?'));
+
+        bool bUpgrade = false;
+        bool bConnectionUpgrade = false;
+        std::string_view Key{};
+
+        for (Headers.remove_prefix(LineEnd + 2); !Headers.empty(); Headers.remove_prefix(LineEnd + 2))
+        {
+            LineEnd = Headers.find("\r\n");
+            std::string_view const Line = Headers.substr(0, LineEnd);
+            std::size_t const Colon = Line.find(':');
+            if (Colon == std::string_view::npos)
+                continue;
+
+            std::string_view const Name = Trim(Line.substr(0, Colon));
+            std::string_view const Value = Trim(Line.substr(Colon + 1));
+
+            if (EqualsNoCase(Name, "upgrade"))
+                bUpgrade = EqualsNoCase(Value, "websocket");
+            else if (EqualsNoCase(Name, "connection"))
+                bConnectionUpgrade = HasToken(Value, "upgrade");
+            else if (EqualsNoCase(Name, "sec-websocket-key"))
+                Key = Value;
+        }
+
+        if (Method != "GET")
+        {
+            Respond(InClient, "405 Method Not Allowed", "text/plain", "only GET is supported");
+        }
+        else if (Path == "/")
+        {
+            Counters.PageRequests.fetch_add(1, std::memory_order_relaxed);
+            Respond(InClient, "200 OK", "text/html; charset=utf-8", Page);
+        }
+        else if (Path == "/hello")
+        {
+            Respond(InClient, "200 OK", "text/plain; charset=utf-8", "Hello, world!!!");
+        }
+        else if (Path != "/socket")
+        {
+            Respond(InClient, "404 Not Found", "text/plain", "not found");
+        }
+        else if (!bUpgrade || !bConnectionUpgrade || Key.empty())
+        {
+            Respond(InClient, "400 Bad Request", "text/plain", "expected a websocket upgrade");
+        }
+        else
+        {
+            InClient.SendBuffer.append("HTTP/1.1 101 Switching Protocols\r\n");
+            InClient.SendBuffer.append("Upgrade: websocket\r\n");
+            InClient.SendBuffer.append("Connection: Upgrade\r\n");
+            InClient.SendBuffer.append("Sec-WebSocket-Accept: ").append(GetWebSocketAccept(Key)).append("\r\n\r\n");
+
+            InClient.bUpgraded = true;
+            Counters.Connections.fetch_add(1, std::memory_order_relaxed);
+            Counters.Clients.fetch_add(1, std::memory_order_relaxed);
+
+            // Anything after the request head is already part of the frame stream.
+            InClient.ReceiveBuffer.erase(0, HeaderEnd + 4);
+            SendState(InClient);
+            return HandleFrames(InClient);
+        }
+
+        InClient.ReceiveBuffer.clear();
+        return true;
+    }
+
+    bool DashboardServer::HandleFrames(Client& InClient)
+    {
+        std::string& Buffer = InClient.ReceiveBuffer;
+        std::size_t Offset = 0;
+
+        for (;;)
+        {
+            std::size_t const Available = Buffer.size() - Offset;
+            if (Available < 2)
+                break;
+
+            auto const Byte = [&](std::size_t const Index) -> std::uint64_t { return static_cast<unsigned char>(Buffer[Offset + Index]); };
+
+            unsigned char const Opcode = static_cast<unsigned char>(Byte(0) & 0x0F);
+            std::uint64_t Length = Byte(1) & 0x7F;
+            std::size_t Header = 2;
+
+            // Browsers always mask their frames.
+            if ((Byte(1) & 0x80) == 0)
+                return false;
+
+            if (Length == 126)
+            {
+                if (Available < 4) break;
+                Length = (Byte(2) << 8) | Byte(3);
+                Header = 4;
+            }
+            else if (Length == 127)
+            {
+                if (Available < 10) break;
+                Length = 0;
+                for (std::size_t i = 2; i < 10; ++i)
+                    Length = (Length << 8) | Byte(i);
+                Header = 10;
+            }
+
+            if (Length > k_maxRequestSize)
+                return false;
+
+            std::size_t const MaskOffset = Header;
+            Header += 4;
+            if (Available < Header + Length)
+                break;
+
+            std::string Payload = Buffer.substr(Offset + Header, static_cast<std::size_t>(Length));
+            for (std::size_t i = 0; i < Payload.size(); ++i)
+                Payload[i] = static_cast<char>(Payload[i] ^ Buffer[Offset + MaskOffset + (i & 3)]);
+
+            Offset += Header + static_cast<std::size_t>(Length);
+
+            if (Opcode == 0x8)
+            {
+                // Echo the status code back and close once it has been written.
+                AppendFrame(InClient.SendBuffer, 0x8, std::string_view{ Payload }.substr(0, 2));
+                InClient.bClosing = true;
+                break;
+            }
+
+            if (Opcode == 0x9)
+                AppendFrame(InClient.SendBuffer, 0xA, Payload);
+        }
+
+        Buffer.erase(0, Offset);
+        return true;
+    }
+
+    void DashboardServer::Broadcast(std::string_view const Message)
+    {
+        for (Client& Browser : Clients)
+        {
+            if (!Browser.bUpgraded || Browser.bClosing || Browser.Socket == k_invalidSocket)
+                continue;
+
+            if (Browser.SendBuffer.size() - Browser.SendOffset > k_dashboardMaxBacklog)
+            {
+                LEASI_WARN("dashboard browser fell {} bytes behind, disconnecting it", Browser.SendBuffer.size() - Browser.SendOffset);
+                Counters.Overruns.fetch_add(1, std::memory_order_relaxed);
+                Disconnect(Browser);
+                continue;
+            }
+
+            AppendFrame(Browser.SendBuffer, 0x1, Message);
+        }
+    }
+
+    void DashboardServer::SendState(Client& InClient)
+    {
+        // Same order the companion server syncs new browsers in.
+        for (std::string const* const Message : { &KeybindsMessage, &StartMessage, &RepliesMessage, &QueueMessage })
+        {
+            if (!Message->empty())
+                AppendFrame(InClient.SendBuffer, 0x1, *Message);
+        }
+    }
+
+    void DashboardServer::Respond(Client& InClient, std::string_view const Status, std::string_view const ContentType, std::string_view const Body)
+    {
+        // Browsers only fetch the page once, so connections are not kept alive.
+        InClient.SendBuffer.append("HTTP/1.1 ").append(Status).append("\r\n");
+        InClient.SendBuffer.append("Content-Type: ").append(ContentType).append("\r\n");
+        InClient.SendBuffer.append("Content-Length: ").append(std::to_string(Body.size())).append("\r\n");
+        InClient.SendBuffer.append("Cache-Control: no-store\r\n");
+        InClient.SendBuffer.append("Connection: close\r\n\r\n");
+        InClient.SendBuffer.append(Body);
+        InClient.bClosing = true;
+    }
+
+    void DashboardServer::Disconnect(Client& InClient)
+    {
+        if (InClient.Socket == k_invalidSocket)
+            return;
+
+        CloseSocket(std::exchange(InClient.Socket, k_invalidSocket));
+
+        if (InClient.bUpgraded)
+        {
+            Counters.Clients.fetch_sub(1, std::memory_order_relaxed);
+            Counters.Disconnects.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    void DashboardServer::Fail(char const* const Stage)
+    {
+        LastError.assign(Stage).append(" failed, error = ").append(std::to_string(GetSocketError()));
+    }
+
+    void DashboardServer::AppendFrame(std::string& OutBuffer, unsigned char const Opcode, std::string_view const Payload)
+    {
+        std::uint64_t const Length = Payload.size();
+
+        // Final fragment, never masked as required for server frames.
+        OutBuffer.push_back(static_cast<char>(0x80 | Opcode));
+        if (Length < 126)
+        {
+            OutBuffer.push_back(static_cast<char>(Length));
+        }
+        else if (Length <= 0xFFFF)
+        {
+            OutBuffer.push_back(static_cast<char>(126));
+            for (int Shift = 8; Shift >= 0; Shift -= 8)
+                OutBuffer.push_back(static_cast<char>((Length >> Shift) & 0xFF));
+        }
+        else
+        {
+            OutBuffer.push_back(static_cast<char>(127));
+            for (int Shift = 56; Shift >= 0; Shift -= 8)
+                OutBuffer.push_back(static_cast<char>((Length >> Shift) & 0xFF));
+        }
+
+        OutBuffer.append(Payload);
+    }
+}
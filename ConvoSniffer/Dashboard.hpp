@@ -0,0 +1,177 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "ConvoSniffer/Ring.hpp"
+#include "ConvoSniffer/Stats.hpp"
+
+// Note that this header intentionally does not depend on LESDK, so that the dashboard
+// can be served and exercised outside of the game, see the Loopback folder.
+
+
+namespace ConvoSniffer
+{
+    // Number of updates handed from the game thread to the server thread without waiting for it, a power of two.
+    static constexpr std::size_t k_dashboardRingSize = 256;
+
+    // Number of browsers served at once, well below the 64 sockets a Winsock select can wait on.
+    static constexpr std::size_t k_dashboardMaxClients = 32;
+
+    // Bytes queued for a browser which stopped reading, before it is disconnected.
+    static constexpr std::size_t k_dashboardMaxBacklog = 4 * 1024 * 1024;
+
+    // Number of message buffers kept around for reuse by the producer.
+    static constexpr std::size_t k_dashboardMessagePoolSize = 16;
+
+    // Interval at which an idle server thread wakes up on its own.
+    static constexpr int k_dashboardPollMs = 1000;
+
+    /// @brief      Kind of state carried by a dashboard update, which replaces the previous one of its kind.
+    enum class DashboardTopic : std::uint8_t
+    {
+        Keybinds,       // @c SetKeybinds notification.
+        Start,          // @c Conversation notification which starts one, clearing replies.
+        End,            // @c Conversation notification which ends one, clearing everything but keybinds.
+        Replies,        // @c UpdateReplies notification, which also clears the queued reply.
+        Queue,          // @c QueueReply notification.
+    };
+
+    /// @brief      In-process replacement for the companion server, serving the dashboard page and
+    ///             pushing notifications to browsers over WebSockets.
+    /// @remarks    A single thread runs a non-blocking event loop over the listening socket and every
+    ///             browser connection. The game thread hands updates over through a lock-free ring and
+    ///             only ever makes a system call to wake the server thread up when it is asleep. Updates
+    ///             which do not fit into the ring go to an overflow list behind a mutex instead.
+    /// @remarks    The server keeps the latest update of each @ref DashboardTopic , which is what browsers
+    ///             are sent when they connect, so that they catch up with a conversation in progress.
+    class DashboardServer final
+    {
+    public:
+
+        struct Stats final
+        {
+            std::size_t     Clients{ 0 };
+            std::uint64_t   Published{ 0 };
+            std::uint64_t   Overflowed{ 0 };        // Updates which did not fit into the ring.
+            std::uint64_t   Connections{ 0 };       // WebSocket connections accepted.
+            std::uint64_t   PageRequests{ 0 };
+            std::uint64_t   Disconnects{ 0 };       // WebSocket connections closed, for any reason.
+            std::uint64_t   Overruns{ 0 };          // Browsers dropped for falling behind.
+            std::uint64_t   BytesSent{ 0 };
+
+            LatencyHistogram::Snapshot HandoffLatency{};    // From publishing to being framed for every browser.
+        };
+
+        /// @param[in]  InPort - TCP port to listen on, or zero to pick any free one.
+        /// @param[in]  InPage - Dashboard page served at @c / , which must outlive the server.
+        DashboardServer(int InPort, std::string_view InPage);
+        DashboardServer(DashboardServer const&) = delete;
+        DashboardServer& operator=(DashboardServer const&) = delete;
+        ~DashboardServer();
+
+        /// @brief      Whether the server is listening, see @ref GetLastError otherwise.
+        bool IsListening() const noexcept { return bListening; }
+        int GetPort() const noexcept { return Port; }
+        std::string const& GetLastError() const noexcept { return LastError; }
+
+        /// @brief      Takes an empty message buffer, which keeps its capacity from an earlier update.
+        /// @remarks    Only called from the thread which publishes updates.
+        std::string AcquireMessage();
+
+        /// @brief      Hands an update to the server thread, only called by a single producer thread.
+        /// @param[in]  InTopic - Kind of state the update replaces.
+        /// @param[in]  InMessage - JSON notification, sent to browsers as a single text message,
+        ///             preferably from @ref AcquireMessage .
+        void Publish(DashboardTopic InTopic, std::string&& InMessage);
+
+        Stats GetStats();
+
+    private:
+
+        struct Update final
+        {
+            DashboardTopic  Topic{};
+            std::string     Message{};
+            std::chrono::steady_clock::time_point PublishedAt{};
+        };
+
+        struct Client final
+        {
+            std::intptr_t   Socket;
+            bool            bUpgraded{ false };     // Speaks WebSocket, otherwise still sending its request.
+            bool            bClosing{ false };      // Closes once everything queued has been written.
+            std::string     ReceiveBuffer{};
+            std::string     SendBuffer{};
+            std::size_t     SendOffset{ 0 };        // Start of unwritten data in @ref SendBuffer .
+        };
+
+        struct SharedCounters final
+        {
+            std::atomic<std::size_t>    Clients{ 0 };
+            std::atomic<std::uint64_t>  Published{ 0 };
+            std::atomic<std::uint64_t>  Overflowed{ 0 };
+            std::atomic<std::uint64_t>  Connections{ 0 };
+            std::atomic<std::uint64_t>  PageRequests{ 0 };
+            std::atomic<std::uint64_t>  Disconnects{ 0 };
+            std::atomic<std::uint64_t>  Overruns{ 0 };
+            std::atomic<std::uint64_t>  BytesSent{ 0 };
+        };
+
+        bool Listen();
+        void WakeServer();
+        void ServeMain();
+
+        void DrainUpdates();
+        void ApplyUpdate(Update const& InUpdate);
+        void Accept();
+        bool Receive(Client& InClient);
+        bool Send(Client& InClient);
+        bool HandleRequest(Client& InClient);
+        bool HandleFrames(Client& InClient);
+        void Broadcast(std::string_view Message);
+        void SendState(Client& InClient);
+        void Respond(Client& InClient, std::string_view Status, std::string_view ContentType, std::string_view Body);
+        void Disconnect(Client& InClient);
+        void Fail(char const* Stage);
+
+        static void AppendFrame(std::string& OutBuffer, unsigned char Opcode, std::string_view Payload);
+
+        int                         Port;
+        std::string_view            Page;
+        std::string                 LastError{};
+        bool                        bListening{ false };
+
+        std::intptr_t               ListenSocket;
+        std::intptr_t               WakeSocket;             // Datagrams to it only interrupt the event loop.
+        std::intptr_t               WakeSender;             // Owned by the producer.
+        std::vector<std::string>    SpareMessages{};        // Owned by the producer, returned by the server thread through the ring slots.
+
+        SpscRing<Update, k_dashboardRingSize> UpdateRing{};
+        std::mutex                  OverflowMutex;
+        std::vector<Update>         OverflowUpdates{};      // Guarded by @ref OverflowMutex .
+        std::atomic_bool            bOverflowing{ false };  // Whether the producer bypasses the ring, to keep updates in order.
+        std::atomic_bool            bServerSleeping{ false };
+        std::atomic_bool            bWantsExit{ false };
+        std::thread                 ServeThread{};
+
+        // Owned by the server thread, latest update of each topic which is in effect.
+        std::vector<Client>         Clients{};
+        Update                      Incoming{};
+        std::vector<Update>         OverflowBatch{};
+        std::string                 KeybindsMessage{};
+        std::string                 StartMessage{};
+        std::string                 RepliesMessage{};
+        std::string                 QueueMessage{};
+
+        SharedCounters              Counters{};
+        LatencyHistogram            HandoffLatency{};
+    };
+}
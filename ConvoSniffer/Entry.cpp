@@ -1,7 +1,9 @@
 #include "Common/Base.hpp"
 #include "ConvoSniffer/Client.hpp"
+#include "ConvoSniffer/Config.hpp"
 #include "ConvoSniffer/Entry.hpp"
 #include "ConvoSniffer/Hooks.hpp"
+#include "ConvoSniffer/Keybinds.hpp"
 
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
@@ -31,16 +33,14 @@ SPI_IMPLEMENT_ATTACH
     ::ConvoSniffer::InitializeGlobals(Init);
     ::ConvoSniffer::InitializeHooks(Init);
 
-    ::Sleep(3 * 1000);
-    ::ConvoSniffer::gp_snifferClient = new ConvoSniffer::SnifferClient("localhost", 21830);
-
+    // The client is launched by hooks once the engine runs, see UObject_CallFunction_hook.
     return true;
 }
 
 SPI_IMPLEMENT_DETACH
 {
     LEASI_UNUSED(InterfacePtr);
-    delete std::exchange(::ConvoSniffer::gp_snifferClient, nullptr);
+    ::ConvoSniffer::ShutdownSnifferClient();
     ::LESDK::TerminateConsole();
     return true;
 }
@@ -76,6 +76,9 @@ namespace ConvoSniffer
         //GWorld = Init.ResolveTyped<UWorld*>(BUILTIN_GWORLD_RIP);
         //CHECK_RESOLVED(GWorld);
 
+        // Has to be done before the input hook is installed, keys are resolved once the engine runs.
+        g_keybindTable.Load(CNVSNF_KEYBINDS_FILE);
+
         LEASI_INFO("globals initialized");
     }
 
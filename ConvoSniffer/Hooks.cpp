@@ -1,8 +1,8 @@
 #include "Common/Objects.hpp"
 #include "ConvoSniffer/Client.hpp"
 #include "ConvoSniffer/Config.hpp"
-#include "ConvoSniffer/Client.hpp"
 #include "ConvoSniffer/Hooks.hpp"
+#include "ConvoSniffer/Keybinds.hpp"
 #include "ConvoSniffer/Profile.hpp"
 
 
@@ -27,28 +27,12 @@ namespace ConvoSniffer
 #if defined(CNVSNF_PROFILE_CONVO) && CNVSNF_PROFILE_CONVO
         if (gb_renderProfile)
         {
-            do {
-                ABioHUD* const BioHUD = Context->Cast<ABioHUD>();
-                if (BioHUD != nullptr && Function->GetName().Equals(L"PostRender"))
-                {
-                    UEngine* const Engine = Common::FindFirstObject<UEngine, true>();
-                    if (Engine == nullptr) break;
-
-                    AWorldInfo* const WorldInfo = Engine->GetCurrentWorldInfo();
-                    if (WorldInfo == nullptr) break;
-
-                    ABioWorldInfo* const BioWorldInfo = WorldInfo->Cast<ABioWorldInfo>();
-                    if (BioWorldInfo == nullptr) break;
-
-                    {
-                        UCanvas* const Canvas = BioHUD->Canvas;
-                        UBioConversation* const Conversation = BioWorldInfo->m_oCurrentConversation;
+            static Common::FunctionIdentity s_postRender{ L"PostRender" };
 
-                        if (Canvas != nullptr && Conversation != nullptr)
-                            ProfileConversation(Canvas, Conversation);
-                    }
-                }
-            } while (false);
+            // Engine and world lookups, as well as formatting, are cached by the profiler.
+            ABioHUD* const BioHUD = s_postRender.Matches(Function) ? Context->Cast<ABioHUD>() : nullptr;
+            if (BioHUD != nullptr)
+                ProfileConversation(BioHUD);
         }
 #endif
     }
@@ -80,22 +64,37 @@ namespace ConvoSniffer
         }
 #endif
 
+        SnifferClient* const Client = gp_snifferClient.load(std::memory_order_acquire);
+        if (Client == nullptr)
+        {
+            // Script running means the engine is up, which is when the client gets created, off the game thread.
+            static bool sb_clientLaunched = false;
+            if (!std::exchange(sb_clientLaunched, true))
+            {
+                // Key names are only safe to look up now, and input is ignored until the client exists.
+                g_keybindTable.ResolveKeys();
+                LaunchSnifferClient(CNVSNF_COMPANION_HOST, CNVSNF_COMPANION_PORT);
+            }
+            return;
+        }
+
         bool bUpdateConversationHandled = false;
 
+        static Common::FunctionIdentity s_updateConversation{ L"UpdateConversation" };
+
         UBioConversation* const Conversation = Context->CastDirect<UBioConversation>();
-        if (Conversation != nullptr && Stack->Node != nullptr && gp_snifferClient != nullptr)
+        if (Conversation != nullptr)
         {
-            FString const Name = Stack->Node->GetName();
-            if (Name.Equals(L"UpdateConversation"))
+            if (s_updateConversation.Matches(Stack->Node))
             {
-                gp_snifferClient->OnUpdateConversation(Conversation);
+                Client->OnUpdateConversation(Conversation);
                 bUpdateConversationHandled = true;
             }
         }
 
         if (!bUpdateConversationHandled)
         {
-            gp_snifferClient->OnVeryFrequentUpdateConversation();
+            Client->OnVeryFrequentUpdateConversation();
             bUpdateConversationHandled = true;
         }
     }
@@ -114,6 +113,8 @@ namespace ConvoSniffer
             LEASI_INFO(L"Available extra commands:");
             LEASI_INFO(L" - cs.profile - toggles profiler rendering (in convos)");
             LEASI_INFO(L" - cs.hud - toggles scaleform rendering (in convos)");
+            LEASI_INFO(L" - cs.stats - logs latency and throughput of companion updates");
+            LEASI_INFO(L" - cs.record - toggles recording of companion updates, for replaying them");
         }
 
         if (Command != nullptr)
@@ -131,6 +132,20 @@ namespace ConvoSniffer
                     LEASI_INFO(L"Toggle user interface.");
                     gb_renderScaleform = !gb_renderScaleform;
                 }
+                else if (Cmd.Equals(L"cs.stats", true))
+                {
+                    if (SnifferClient* const Client = gp_snifferClient.load(std::memory_order_acquire); Client != nullptr)
+                        Client->LogStats();
+                    else
+                        LEASI_INFO(L"Sniffer client not started yet.");
+                }
+                else if (Cmd.Equals(L"cs.record", true))
+                {
+                    if (SnifferClient* const Client = gp_snifferClient.load(std::memory_order_acquire); Client != nullptr)
+                        Client->ToggleRecording();
+                    else
+                        LEASI_INFO(L"Sniffer client not started yet.");
+                }
             }
         }
 
@@ -153,41 +168,27 @@ namespace ConvoSniffer
         DWORD const                     Unknown2
     )
     {
-        if (gp_snifferClient && gp_snifferClient->InConversation())
+        SnifferClient* const Client = gp_snifferClient.load(std::memory_order_acquire);
+        if (Client != nullptr && Client->InConversation())
         {
             // Only interested in "released" key events.
             if (EventType == 1)
             {
-                FString const   KeyStr = Key.ToString();
-                bool            bKeyHandled = false;
-
-                LEASI_DEBUG(L"UGameViewportClient::InputKey => {} (released)", *KeyStr);
-
-                if (false) {}
-                else if (KeyStr.Equals(L"Zero")) bKeyHandled = gp_snifferClient->QueueReplyMapped(0);
-                else if (KeyStr.Equals(L"One")) bKeyHandled = gp_snifferClient->QueueReplyMapped(1);
-                else if (KeyStr.Equals(L"Two")) bKeyHandled = gp_snifferClient->QueueReplyMapped(2);
-                else if (KeyStr.Equals(L"Three")) bKeyHandled = gp_snifferClient->QueueReplyMapped(3);
-                else if (KeyStr.Equals(L"Four")) bKeyHandled = gp_snifferClient->QueueReplyMapped(4);
-                else if (KeyStr.Equals(L"Five")) bKeyHandled = gp_snifferClient->QueueReplyMapped(5);
-                else if (KeyStr.Equals(L"Six")) bKeyHandled = gp_snifferClient->QueueReplyMapped(6);
-                else if (KeyStr.Equals(L"Seven")) bKeyHandled = gp_snifferClient->QueueReplyMapped(7);
-                else if (KeyStr.Equals(L"Eight")) bKeyHandled = gp_snifferClient->QueueReplyMapped(8);
-                else if (KeyStr.Equals(L"Nine")) bKeyHandled = gp_snifferClient->QueueReplyMapped(9);
-                else if (KeyStr.Equals(L"A")) bKeyHandled = gp_snifferClient->QueueReplyMapped(10);
-                else if (KeyStr.Equals(L"B")) bKeyHandled = gp_snifferClient->QueueReplyMapped(11);
-                else if (KeyStr.Equals(L"C")) bKeyHandled = gp_snifferClient->QueueReplyMapped(12);
-                else if (KeyStr.Equals(L"D")) bKeyHandled = gp_snifferClient->QueueReplyMapped(13);
-                else if (KeyStr.Equals(L"E")) bKeyHandled = gp_snifferClient->QueueReplyMapped(14);
-                else if (KeyStr.Equals(L"F")) bKeyHandled = gp_snifferClient->QueueReplyMapped(15);
-                
-                else if (!gb_renderScaleform && KeyStr.Equals(L"SpaceBar"))
+                int const Slot = g_keybindTable.FindSlot(Key);
+                bool      bKeyHandled = false;
+
+                if (Slot >= 0)
+                {
+                    LEASI_DEBUG(L"UGameViewportClient::InputKey => slot {} (released)", Slot);
+                    bKeyHandled = Client->QueueReplyMapped(Slot);
+                }
+                else if (!gb_renderScaleform && g_keybindTable.IsSkipKey(Key))
                 {
                     // Special case: replace the skip-node binding disabled when GFx is hidden.
-                    gp_snifferClient->GetActiveConversation()->SkipNode();
+                    Client->GetActiveConversation()->SkipNode();
                 }
 
-                // Allow the engine to handle 0-9, A-F keys even if we're using them...
+                // Allow the engine to handle bound keys even if we're using them...
                 LEASI_UNUSED(bKeyHandled);
             }
         }
@@ -212,8 +213,8 @@ namespace ConvoSniffer
 
 #endif
 
-        if (gp_snifferClient)
-            gp_snifferClient->OnStartConversation(Context);
+        if (SnifferClient* const Client = gp_snifferClient.load(std::memory_order_acquire); Client != nullptr)
+            Client->OnStartConversation(Context);
 
         return Result;
     }
@@ -221,8 +222,8 @@ namespace ConvoSniffer
     t_UBioConversation_EndConversation* UBioConversation_EndConversation_orig = nullptr;
     void UBioConversation_EndConversation_hook(UBioConversation* const Context)
     {
-        if (gp_snifferClient)
-            gp_snifferClient->OnEndConversation(Context);
+        if (SnifferClient* const Client = gp_snifferClient.load(std::memory_order_acquire); Client != nullptr)
+            Client->OnEndConversation(Context);
 
         UBioConversation_EndConversation_orig(Context);
 
@@ -246,8 +247,8 @@ namespace ConvoSniffer
     t_UBioConversation_QueueReply* UBioConversation_QueueReply_orig = nullptr;
     UBOOL UBioConversation_QueueReply_hook(UBioConversation* const Context, int const Reply)
     {
-        if (gp_snifferClient)
-            gp_snifferClient->OnQueueReply(Context, Reply);
+        if (SnifferClient* const Client = gp_snifferClient.load(std::memory_order_acquire); Client != nullptr)
+            Client->OnQueueReply(Context, Reply);
 
         UBOOL const Result = UBioConversation_QueueReply_orig(Context, Reply);
 
@@ -0,0 +1,368 @@
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <utility>
+
+#include "Common/Logging.hpp"
+#include "ConvoSniffer/Config.hpp"
+#include "ConvoSniffer/Http.hpp"
+
+
+namespace ConvoSniffer
+{
+    // ! HttpClient implementation.
+    // ========================================
+
+    HttpClient::HttpClient(char const* const InHost, int const InPort, OverflowPolicy const InPolicy, AckObserver InObserver)
+        : Link{}
+        , Policy{ InPolicy }
+        , Observer{ std::move(InObserver) }
+        , ProcessThread{}
+        , bWantsExit{}
+        , ExitDeadline{}
+        , bWorkerSleeping{ false }
+        , Counters{}
+        , RequestIndex{}
+        , SpareBodies{}
+        , Backlog{}
+        , SpentBodies{}
+        , Incoming{}
+        , Batch{}
+        , Requests{}
+        , Responses{}
+    {
+        // Requests in flight are put back when the connection is lost, which may exceed the bound briefly.
+        Backlog.reserve(k_requestBacklogSize + k_transportPipelineDepth);
+        SpareBodies.reserve(k_bodyPoolSize);
+        SpentBodies.reserve(k_bodyPoolSize);
+        Batch.reserve(k_transportPipelineDepth);
+        Requests.reserve(k_transportPipelineDepth);
+        Responses.resize(k_transportPipelineDepth);
+
+#if defined(CNVSNF_WININET_TRANSPORT) && CNVSNF_WININET_TRANSPORT
+        Link = std::make_unique<WinInetTransport>(InHost, InPort);
+#else
+        Link = std::make_unique<SocketTransport>(InHost, InPort, k_transportTimeoutMs, k_transportPipelineDepth);
+#endif
+
+        ProcessThread = std::thread(&HttpClient::ProcessMain, this);
+    }
+
+    HttpClient::~HttpClient() noexcept
+    {
+        ExitDeadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(k_shutdownDrainMs);
+        bWantsExit.test_and_set();
+        WakeWorker();
+
+        // The worker stops sending at the deadline, but may be in the middle of an exchange,
+        // which is bounded by the transport timeout.
+        if (ProcessThread.joinable())
+            ProcessThread.join();
+
+        Link.reset();
+    }
+
+    std::string HttpClient::AcquireBody()
+    {
+        if (SpareBodies.empty())
+            return std::string{};
+
+        std::string Body = std::move(SpareBodies.back());
+        SpareBodies.pop_back();
+        Body.clear();
+        return Body;
+    }
+
+    void HttpClient::QueueRequest(char const* const InMethod, char const* const InPath, std::string&& InBody, bool const bInCoalesce)
+    {
+        if (bWantsExit.test())
+            return;
+
+        Counters.Queued.fetch_add(1, std::memory_order_relaxed);
+        Request Pending{ RequestIndex++, InMethod, InPath, std::move(InBody), bInCoalesce, 0, std::chrono::steady_clock::now() };
+
+        // The ring only fills up while the worker is stuck in an exchange, or holds back under the blocking policy.
+        // Blocking is bounded, a server which stopped answering must not freeze the producer.
+        auto const BlockDeadline = Pending.QueuedAt + std::chrono::milliseconds(k_blockingQueueMaxMs);
+        while (!RequestRing.TryPush(Pending))
+        {
+            if (Policy != OverflowPolicy::Block || std::chrono::steady_clock::now() >= BlockDeadline)
+            {
+                LEASI_WARN("request[{}]: dropped, request ring is full", Pending.Index);
+                Counters.Dropped.fetch_add(1, std::memory_order_relaxed);
+                break;
+            }
+
+            WakeWorker();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        WakeWorker();
+
+        // Either the dropped body, or one handed back by the worker through the slot.
+        if (Pending.Body.capacity() > std::string{}.capacity() && SpareBodies.size() < k_bodyPoolSize)
+            SpareBodies.push_back(std::move(Pending.Body));
+    }
+
+    HttpClient::Stats HttpClient::GetStats()
+    {
+        Stats Result{};
+        Result.QueueDepth = Counters.QueueDepth.load(std::memory_order_relaxed) + RequestRing.SizeApprox();
+        Result.MaxQueueDepth = Counters.MaxQueueDepth.load(std::memory_order_relaxed);
+        Result.Queued = Counters.Queued.load(std::memory_order_relaxed);
+        Result.Coalesced = Counters.Coalesced.load(std::memory_order_relaxed);
+        Result.Dropped = Counters.Dropped.load(std::memory_order_relaxed);
+        Result.Sent = Counters.Sent.load(std::memory_order_relaxed);
+        Result.Failed = Counters.Failed.load(std::memory_order_relaxed);
+        Result.Retried = Counters.Retried.load(std::memory_order_relaxed);
+        Result.Connections = Counters.Connections.load(std::memory_order_relaxed);
+        Result.BytesSent = Counters.BytesSent.load(std::memory_order_relaxed);
+        Result.QueueLatency = Counters.QueueLatency.GetSnapshot();
+        Result.ExchangeLatency = Counters.ExchangeLatency.GetSnapshot();
+        return Result;
+    }
+
+    void HttpClient::WakeWorker()
+    {
+        // Pairs with the fence in WaitForWork: either the worker sees the new request,
+        // or this sees the worker going to sleep and notifies it.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        if (bWorkerSleeping.load(std::memory_order_relaxed))
+        {
+            std::scoped_lock WakeLock(WakeMutex);
+            WakeCondition.notify_one();
+        }
+    }
+
+    void HttpClient::WaitForWork(std::chrono::steady_clock::time_point const InUntil)
+    {
+        std::unique_lock WakeLock(WakeMutex);
+        bWorkerSleeping.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        // Only wake up for something the worker can act on. Requests it holds back under the blocking policy,
+        // or an exit it already knows about, would otherwise keep it spinning until the deadline.
+        bool const bCanTake = Policy != OverflowPolicy::Block || Backlog.size() < k_requestBacklogSize;
+        bool const bExiting = bWantsExit.test();
+        auto const HasWork = [this, bCanTake, bExiting]() -> bool
+            {
+                return (bCanTake && RequestRing.SizeApprox() > 0) || (!bExiting && bWantsExit.test());
+            };
+
+        if (InUntil == std::chrono::steady_clock::time_point::max())
+            WakeCondition.wait(WakeLock, HasWork);
+        else
+            WakeCondition.wait_until(WakeLock, InUntil, HasWork);
+
+        bWorkerSleeping.store(false, std::memory_order_relaxed);
+    }
+
+    void HttpClient::ProcessMain()
+    {
+        int BackoffMs = k_reconnectBackoffMinMs;
+        std::chrono::steady_clock::time_point NextConnectAt{};
+
+        for (;;)
+        {
+            DrainRing();
+
+            bool const bExiting = bWantsExit.test();
+            if (bExiting && (Backlog.empty() || std::chrono::steady_clock::now() >= ExitDeadline))
+                break;
+
+            if (Backlog.empty())
+            {
+                WaitForWork(std::chrono::steady_clock::time_point::max());
+                continue;
+            }
+
+            if (!Link->IsConnected())
+            {
+                // Keep taking requests from the ring while backing off, so that the producer is not held up.
+                if (std::chrono::steady_clock::now() < NextConnectAt)
+                {
+                    WaitForWork(bExiting ? (std::min)(NextConnectAt, ExitDeadline) : NextConnectAt);
+                    continue;
+                }
+
+                if (!Link->Connect())
+                {
+                    LEASI_WARN("failed to reach companion server, retrying in {} ms: {}", BackoffMs, Link->GetLastError());
+                    NextConnectAt = std::chrono::steady_clock::now() + std::chrono::milliseconds(BackoffMs);
+                    BackoffMs = (std::min)(BackoffMs * 2, k_reconnectBackoffMaxMs);
+                    continue;
+                }
+
+                LEASI_INFO("connected to companion server");
+                BackoffMs = k_reconnectBackoffMinMs;
+                Counters.Connections.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            auto const Count = static_cast<std::ptrdiff_t>((std::min)(Backlog.size(), Link->GetPipelineDepth()));
+
+            Batch.clear();
+            Batch.insert(Batch.end(), std::make_move_iterator(Backlog.begin()), std::make_move_iterator(Backlog.begin() + Count));
+            Backlog.erase(Backlog.begin(), Backlog.begin() + Count);
+            Counters.QueueDepth.store(Backlog.size(), std::memory_order_relaxed);
+
+            ProcessBatch();
+        }
+
+        std::size_t const Unsent = Backlog.size() + RequestRing.SizeApprox();
+        if (Unsent > 0)
+        {
+            LEASI_WARN("dropped {} unsent requests at shutdown", Unsent);
+            Counters.Dropped.fetch_add(Unsent, std::memory_order_relaxed);
+        }
+    }
+
+    void HttpClient::DrainRing()
+    {
+        // Under the blocking policy, leaving requests in the ring is what holds up the producer.
+        while (Policy != OverflowPolicy::Block || Backlog.size() < k_requestBacklogSize)
+        {
+            // Hand a spent body back to the producer through the slot being emptied. What was taken
+            // before has been moved out by now, which leaves a string with its inline capacity only.
+            if (!SpentBodies.empty() && Incoming.Body.capacity() < SpentBodies.back().capacity())
+            {
+                Incoming.Body = std::move(SpentBodies.back());
+                SpentBodies.pop_back();
+            }
+
+            if (!RequestRing.TryPop(Incoming))
+                break;
+
+            AddToBacklog(Incoming);
+        }
+
+        Counters.QueueDepth.store(Backlog.size(), std::memory_order_relaxed);
+        if (Backlog.size() > Counters.MaxQueueDepth.load(std::memory_order_relaxed))
+            Counters.MaxQueueDepth.store(Backlog.size(), std::memory_order_relaxed);
+    }
+
+    void HttpClient::AddToBacklog(Request& InRequest)
+    {
+        if (InRequest.bCoalesce)
+        {
+            // Only look back as far as the last ordered request, replacing anything before it
+            // would reorder the update relative to e.g. a conversation start or end.
+            for (auto Iter = Backlog.rbegin(); Iter != Backlog.rend() && Iter->bCoalesce; ++Iter)
+            {
+                if (std::strcmp(Iter->Method, InRequest.Method) == 0 && std::strcmp(Iter->Path, InRequest.Path) == 0)
+                {
+                    LEASI_TRACE("request[{}]: coalesced into request[{}]", Iter->Index, InRequest.Index);
+
+                    // The replaced body stays with the incoming request, and goes back to the producer.
+                    Iter->Index = InRequest.Index;
+                    std::swap(Iter->Body, InRequest.Body);
+                    InRequest.Body.clear();
+                    Counters.Coalesced.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+            }
+        }
+
+        if (Backlog.size() >= k_requestBacklogSize)
+        {
+            auto Victim = Backlog.begin();
+            if (Policy == OverflowPolicy::DropCoalescible)
+            {
+                auto const Found = std::find_if(Backlog.begin(), Backlog.end(), [](Request const& Item) -> bool { return Item.bCoalesce; });
+                if (Found != Backlog.end())
+                    Victim = Found;
+            }
+
+            LEASI_WARN("request[{}]: dropped, {} requests are waiting", Victim->Index, Backlog.size());
+            ReleaseBody(std::move(Victim->Body));
+            Backlog.erase(Victim);
+            Counters.Dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        Backlog.push_back(std::move(InRequest));
+    }
+
+    void HttpClient::ProcessBatch()
+    {
+        std::uint64_t Failed = 0;
+        std::uint64_t BytesSent = 0;
+        auto const SentAt = std::chrono::steady_clock::now();
+
+        Requests.clear();
+        for (Request& HttpRequest : Batch)
+        {
+            LEASI_INFO("request[{}]: method = {}, path = {}, body = {} bytes", HttpRequest.Index, HttpRequest.Method, HttpRequest.Path, HttpRequest.Body.size());
+            HttpRequest.Attempts++;
+            Requests.push_back(TransportRequest{ HttpRequest.Method, HttpRequest.Path, HttpRequest.Body });
+            BytesSent += HttpRequest.Body.size();
+
+            if (HttpRequest.Attempts == 1)
+                Counters.QueueLatency.Record(SentAt - HttpRequest.QueuedAt);
+        }
+
+        std::size_t const Acknowledged = Link->Exchange(Requests, Responses);
+
+        // Pipelined responses are only seen together, so they share the time of the last one.
+        auto const ReceivedAt = std::chrono::steady_clock::now();
+        Counters.BytesSent.fetch_add(BytesSent, std::memory_order_relaxed);
+
+        for (std::size_t i = 0; i < Acknowledged; ++i)
+        {
+            TransportResponse const& HttpResponse = Responses[i];
+
+            if (HttpResponse.Status < 400 || HttpResponse.Status >= 600)
+            {
+                LEASI_INFO("response[{}]: status = {}, text = {}", Batch[i].Index, HttpResponse.Status, HttpResponse.Body);
+            }
+            else
+            {
+                LEASI_ERROR("response[{}]: status = {}, text = {}", Batch[i].Index, HttpResponse.Status, HttpResponse.Body);
+                Failed++;
+            }
+
+            Counters.ExchangeLatency.Record(ReceivedAt - SentAt);
+
+            if (Observer)
+                Observer(Acknowledgement{ Batch[i].Index, HttpResponse.Status, ReceivedAt - Batch[i].QueuedAt });
+
+            ReleaseBody(std::move(Batch[i].Body));
+        }
+
+        Counters.Sent.fetch_add(Acknowledged, std::memory_order_relaxed);
+
+        if (Acknowledged < Batch.size())
+        {
+            LEASI_WARN("lost companion server connection with {} requests in flight: {}", Batch.size() - Acknowledged, Link->GetLastError());
+
+            // Put the remaining requests back in front of the backlog, in their original order.
+            auto Retry = Backlog.begin();
+            for (std::size_t i = Acknowledged; i < Batch.size(); ++i)
+            {
+                if (Batch[i].Attempts < k_requestMaxAttempts)
+                {
+                    Retry = Backlog.insert(Retry, std::move(Batch[i])) + 1;
+                    Counters.Retried.fetch_add(1, std::memory_order_relaxed);
+                }
+                else
+                {
+                    LEASI_ERROR("request[{}]: giving up after {} attempts", Batch[i].Index, Batch[i].Attempts);
+                    ReleaseBody(std::move(Batch[i].Body));
+                    Failed++;
+                }
+            }
+
+            Counters.QueueDepth.store(Backlog.size(), std::memory_order_relaxed);
+        }
+
+        Counters.Failed.fetch_add(Failed, std::memory_order_relaxed);
+    }
+
+    void HttpClient::ReleaseBody(std::string&& InBody)
+    {
+        if (SpentBodies.size() < k_bodyPoolSize)
+        {
+            InBody.clear();
+            SpentBodies.push_back(std::move(InBody));
+        }
+    }
+}
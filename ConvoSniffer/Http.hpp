@@ -0,0 +1,193 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "ConvoSniffer/Ring.hpp"
+#include "ConvoSniffer/Stats.hpp"
+#include "ConvoSniffer/Transport.hpp"
+
+// Note that this header intentionally does not depend on LESDK, so that the request queue
+// can be driven against a loopback server outside of the game, see the Loopback folder.
+
+
+namespace ConvoSniffer
+{
+    // Initial and maximum delay between attempts to reach the companion server.
+    static constexpr int k_reconnectBackoffMinMs = 250;
+    static constexpr int k_reconnectBackoffMaxMs = 8000;
+
+    // Send / receive timeout of the companion server connection.
+    static constexpr int k_transportTimeoutMs = 3000;
+
+    // Number of requests sent to the companion server before waiting for responses.
+    static constexpr std::size_t k_transportPipelineDepth = 8;
+
+    // Number of times a request is sent over a connection which then fails, before it is given up on.
+    static constexpr int k_requestMaxAttempts = 3;
+
+    // Number of body buffers kept around for reuse.
+    static constexpr std::size_t k_bodyPoolSize = 2 * k_transportPipelineDepth;
+
+    // Number of requests handed from the producer to the worker without waiting for it, a power of two.
+    // The worker only takes requests between exchanges, so this has to cover a transport timeout.
+    static constexpr std::size_t k_requestRingSize = 1024;
+
+    // Number of unsent requests kept by the worker, before the overflow policy applies.
+    static constexpr std::size_t k_requestBacklogSize = 256;
+
+    // Time queueing a request waits for room under the blocking policy, before dropping it instead.
+    static constexpr int k_blockingQueueMaxMs = 100;
+
+    // Time the worker keeps sending queued requests for when the client is destroyed.
+    static constexpr int k_shutdownDrainMs = 1000;
+
+    /// @brief      Sends requests to the companion server from a worker thread.
+    /// @remarks    The connection is kept alive between requests, and up to @ref Transport::GetPipelineDepth
+    ///             queued requests are sent before waiting for their responses. If the server goes away,
+    ///             requests in flight are queued again and the worker reconnects with exponential backoff.
+    /// @remarks    Requests are handed to the worker through a lock-free ring, so that queueing never waits
+    ///             for the worker. The worker keeps unsent requests in a bounded backlog, and applies
+    ///             the @ref OverflowPolicy once that is full.
+    class HttpClient final
+    {
+    public:
+
+        /// @brief      What happens to requests while the backlog is full.
+        /// @remarks    If the ring itself fills up while the worker waits for a response, the drop policies
+        ///             drop the request being queued instead, since the producer cannot reach older ones.
+        enum class OverflowPolicy
+        {
+            DropOldest,         // Discard the oldest unsent request.
+            DropCoalescible,    // Discard the oldest unsent coalescing request, or the oldest one if none.
+            Block,              // Make @ref QueueRequest wait for room, up to @ref k_blockingQueueMaxMs , then drop.
+        };
+
+        /// @brief      Outcome of a request which got a response.
+        struct Acknowledgement final
+        {
+            int                     Index{};
+            unsigned                Status{};
+            std::chrono::nanoseconds Latency{};     // From queueing, or from first queueing if coalesced into.
+        };
+
+        using AckObserver = std::function<void(Acknowledgement const&)>;
+
+        /// @param[in]  InHost - Host name or address of the companion server.
+        /// @param[in]  InPort - TCP port of the companion server.
+        /// @param[in]  InPolicy - How to make room in a full backlog.
+        /// @param[in]  InObserver - Optional callback, invoked on the worker thread for every response.
+        HttpClient(char const* InHost, int InPort, OverflowPolicy InPolicy = OverflowPolicy::DropCoalescible, AckObserver InObserver = {});
+        HttpClient(HttpClient const&) = delete;
+        HttpClient& operator=(HttpClient const&) = delete;
+        ~HttpClient() noexcept;
+
+        struct Stats final
+        {
+            std::size_t     QueueDepth{ 0 };
+            std::size_t     MaxQueueDepth{ 0 };
+            std::uint64_t   Queued{ 0 };
+            std::uint64_t   Coalesced{ 0 };         // Unsent requests replaced by a newer one for the same resource.
+            std::uint64_t   Dropped{ 0 };           // Unsent requests discarded by the overflow policy or at shutdown.
+            std::uint64_t   Sent{ 0 };
+            std::uint64_t   Failed{ 0 };            // Requests answered with an error status, or given up on.
+            std::uint64_t   Retried{ 0 };           // Requests in flight when the connection was lost.
+            std::uint64_t   Connections{ 0 };       // Connections established to the server.
+            std::uint64_t   BytesSent{ 0 };         // Request bodies, including resent ones.
+
+            LatencyHistogram::Snapshot QueueLatency{};      // From queueing to being sent.
+            LatencyHistogram::Snapshot ExchangeLatency{};   // From being sent to the response.
+        };
+
+        /// @brief      Takes an empty body buffer, which keeps its capacity from an earlier request.
+        /// @remarks    Only called from the thread which queues requests.
+        std::string AcquireBody();
+
+        /// @brief      Queues a request to be sent by the worker thread.
+        /// @remarks    Only called from a single thread, usually the game thread.
+        /// @param[in]  InMethod - HTTP method, must be a string literal.
+        /// @param[in]  InPath - Resource path, must be a string literal.
+        /// @param[in]  InBody - UTF-8 encoded request body, preferably from @ref AcquireBody .
+        /// @param[in]  bInCoalesce - Whether the request replaces an unsent one with the same method and path.
+        ///                           Requests are never moved across non-coalescing ones, which keeps
+        ///                           conversation lifecycle events in order with the updates around them.
+        void QueueRequest(char const* InMethod, char const* InPath, std::string&& InBody, bool bInCoalesce = false);
+
+        Stats GetStats();
+
+    private:
+
+        struct Request final
+        {
+            int             Index{};
+            char const*     Method{};
+            char const*     Path{};
+            std::string     Body{};
+            bool            bCoalesce{ false };
+            int             Attempts{ 0 };
+            std::chrono::steady_clock::time_point QueuedAt{};
+        };
+
+        void ProcessMain();
+        void ProcessBatch();
+        void DrainRing();
+        void AddToBacklog(Request& InRequest);
+        void WaitForWork(std::chrono::steady_clock::time_point Until);
+        void WakeWorker();
+        void ReleaseBody(std::string&& InBody);
+
+        // Each counter is only written by one side, @c Queued by the producer and the rest by the worker.
+        struct SharedCounters final
+        {
+            std::atomic<std::size_t>    QueueDepth{ 0 };
+            std::atomic<std::size_t>    MaxQueueDepth{ 0 };
+            std::atomic<std::uint64_t>  Queued{ 0 };
+            std::atomic<std::uint64_t>  Coalesced{ 0 };
+            std::atomic<std::uint64_t>  Dropped{ 0 };
+            std::atomic<std::uint64_t>  Sent{ 0 };
+            std::atomic<std::uint64_t>  Failed{ 0 };
+            std::atomic<std::uint64_t>  Retried{ 0 };
+            std::atomic<std::uint64_t>  Connections{ 0 };
+            std::atomic<std::uint64_t>  BytesSent{ 0 };
+            LatencyHistogram            QueueLatency{};
+            LatencyHistogram            ExchangeLatency{};
+        };
+
+        std::unique_ptr<Transport>  Link;
+        OverflowPolicy              Policy;
+        AckObserver                 Observer;
+
+        SpscRing<Request, k_requestRingSize> RequestRing;
+        std::thread                 ProcessThread;
+        std::atomic_flag            bWantsExit;
+        std::chrono::steady_clock::time_point ExitDeadline;     // Written before @ref bWantsExit is set.
+
+        // Lets the worker sleep while there is nothing to do, the producer only notifies while it does.
+        std::mutex                  WakeMutex;
+        std::condition_variable     WakeCondition;
+        std::atomic_bool            bWorkerSleeping;
+
+        SharedCounters              Counters;
+
+        // Only touched by the producer.
+        int                         RequestIndex;
+        std::vector<std::string>    SpareBodies;    // Returned by the worker through the ring slots.
+
+        // Only touched by the worker thread, and reused between batches.
+        std::vector<Request>            Backlog;    // Kept as a vector so that its storage is reused.
+        std::vector<std::string>        SpentBodies;
+        Request                         Incoming;
+        std::vector<Request>            Batch;
+        std::vector<TransportRequest>   Requests;
+        std::vector<TransportResponse>  Responses;
+    };
+}
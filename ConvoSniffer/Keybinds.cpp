@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#include "ConvoSniffer/Keybinds.hpp"
+
+
+namespace
+{
+    struct DefaultBinding final
+    {
+        char const*     KeyName;
+        char const*     Label;
+    };
+
+    constexpr DefaultBinding k_defaultBindings[] = {
+        { "Zero", "0" }, { "One", "1" }, { "Two", "2" }, { "Three", "3" },
+        { "Four", "4" }, { "Five", "5" }, { "Six", "6" }, { "Seven", "7" },
+        { "Eight", "8" }, { "Nine", "9" }, { "A", "A" }, { "B", "B" },
+        { "C", "C" }, { "D", "D" }, { "E", "E" }, { "F", "F" },
+    };
+
+    constexpr char const* k_defaultSkipKeyName = "SpaceBar";
+
+    /// Key names are plain ASCII, as are the names they are looked up as.
+    std::wstring Widen(std::string const& InString)
+    {
+        return std::wstring(InString.begin(), InString.end());
+    }
+}
+
+namespace ConvoSniffer
+{
+    KeybindTable g_keybindTable{};
+
+
+    // ! KeybindTable implementation.
+    // ========================================
+
+    void KeybindTable::Load(wchar_t const* const InPath)
+    {
+        static_assert(std::size(k_defaultBindings) == k_slotCount);
+
+        for (std::size_t i = 0; i < k_slotCount; ++i)
+        {
+            KeyNames[i] = k_defaultBindings[i].KeyName;
+            Labels[i] = k_defaultBindings[i].Label;
+        }
+
+        SkipKeyName = k_defaultSkipKeyName;
+
+        // Each line binds a slot, e.g. "10 = A" or "0 = NumPadZero Num0", or the skip key, e.g. "skip = SpaceBar".
+        std::ifstream File{ std::filesystem::path{ InPath } };
+        if (!File)
+        {
+            LEASI_INFO(L"no keybinds file at {}, using default keybinds", InPath);
+        }
+
+        std::string Line{};
+        for (int nLine = 1; std::getline(File, Line); ++nLine)
+        {
+            if (std::size_t const Comment = Line.find_first_of(";#"); Comment != std::string::npos)
+                Line.erase(Comment);
+
+            char Target[16]{};
+            char KeyName[64]{};
+            char Label[64]{};
+
+            int const Fields = std::sscanf(Line.c_str(), " %15[^= ] = %63s %63s", Target, KeyName, Label);
+            if (Fields <= 0)
+                continue;
+
+            if (Fields >= 2 && std::strcmp(Target, "skip") == 0)
+            {
+                SkipKeyName = KeyName;
+                continue;
+            }
+
+            int Slot = -1;
+            auto const Parsed = std::from_chars(Target, Target + std::strlen(Target), Slot);
+
+            if (Fields < 2 || Parsed.ec != std::errc{} || *Parsed.ptr != '\0' || Slot < 0 || Slot >= static_cast<int>(k_slotCount))
+            {
+                LEASI_WARN(L"{}:{}: expected '<slot> = <key> [label]' with a slot below {}", InPath, nLine, k_slotCount);
+                continue;
+            }
+
+            KeyNames[static_cast<std::size_t>(Slot)] = KeyName;
+            Labels[static_cast<std::size_t>(Slot)] = Fields == 3 ? Label : KeyName;
+        }
+    }
+
+    int KeybindTable::FindSlot(SFXName const& InKey) const noexcept
+    {
+        if (!bResolved)
+            return -1;
+
+        std::uint64_t const Key = ToKey(InKey);
+
+        auto const Iter = std::lower_bound(SlotsByKey.begin(), SlotsByKey.end(), Key,
+            [](std::pair<std::uint64_t, int> const& Item, std::uint64_t const Value) -> bool { return Item.first < Value; });
+
+        return Iter != SlotsByKey.end() && Iter->first == Key ? Iter->second : -1;
+    }
+
+    bool KeybindTable::IsSkipKey(SFXName const& InKey) const noexcept
+    {
+        return bResolved && bSkipBound && ToKey(InKey) == SkipKey;
+    }
+
+    std::uint64_t KeybindTable::ToKey(SFXName const& InName) noexcept
+    {
+        // Names compare by their pool entry and instance number, which together fit in one integer.
+        static_assert(sizeof(SFXName) == sizeof(std::uint64_t), "unexpected SFXName layout");
+
+        std::uint64_t Key{};
+        std::memcpy(&Key, &InName, sizeof Key);
+        return Key;
+    }
+
+    void KeybindTable::ResolveKeys()
+    {
+        SlotsByKey.clear();
+
+        for (std::size_t i = 0; i < k_slotCount; ++i)
+        {
+            std::uint64_t const Key = ToKey(SFXName(Widen(KeyNames[i]).c_str(), 0));
+
+            auto const Duplicate = std::find_if(SlotsByKey.begin(), SlotsByKey.end(),
+                [Key](std::pair<std::uint64_t, int> const& Item) -> bool { return Item.first == Key; });
+
+            if (Duplicate != SlotsByKey.end())
+            {
+                LEASI_WARN("key {} is bound to slots {} and {}, keeping the first", KeyNames[i], Duplicate->second, i);
+                continue;
+            }
+
+            SlotsByKey.emplace_back(Key, static_cast<int>(i));
+        }
+
+        std::sort(SlotsByKey.begin(), SlotsByKey.end());
+
+        bSkipBound = !SkipKeyName.empty();
+        if (bSkipBound)
+            SkipKey = ToKey(SFXName(Widen(SkipKeyName).c_str(), 0));
+
+        bResolved = true;
+        LEASI_INFO("keybinds: {} slots bound, skip = {}", SlotsByKey.size(), bSkipBound ? SkipKeyName : "<none>");
+    }
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <LESDK/Headers.hpp>
+#include "Common/Base.hpp"
+
+
+namespace ConvoSniffer
+{
+    /// @brief      Maps input key names to reply slots, loaded once from a config file.
+    /// @remarks    Keys are matched by their @c SFXName value, so handling a key event is a binary search
+    ///             over a handful of integers, without converting the name to a string.
+    class KeybindTable final : public NonCopyable
+    {
+    public:
+
+        static constexpr std::size_t k_slotCount = 16;
+
+        /// @brief      Loads bindings from the given file, keeping the defaults for any slot it does not bind.
+        /// @remarks    Must be called before input hooks are installed. Only key names are read, see
+        ///             @ref ResolveKeys . A missing file is not an error, invalid lines are logged and skipped.
+        void Load(wchar_t const* InPath);
+
+        /// @brief      Looks up the loaded key names as names of the engine, which keys are then matched by.
+        /// @remarks    Must be called on the game thread once the engine runs, as it may add to the name table.
+        ///             No key is bound to anything until then.
+        void ResolveKeys();
+
+        /// @brief      Finds the reply slot bound to a key.
+        /// @return     Slot index, or -1 if the key is not bound to a slot.
+        int FindSlot(SFXName const& InKey) const noexcept;
+
+        /// @brief      Whether the key replaces the skip-node binding, for when GFx is hidden.
+        bool IsSkipKey(SFXName const& InKey) const noexcept;
+
+        /// @brief      Labels shown by the companion for each slot, e.g. "0" for the @c Zero key.
+        std::array<std::string, k_slotCount> const& GetLabels() const noexcept { return Labels; }
+
+    private:
+
+        static std::uint64_t ToKey(SFXName const& InName) noexcept;
+
+        std::array<std::string, k_slotCount>    KeyNames{};
+        std::array<std::string, k_slotCount>    Labels{};
+        std::string                             SkipKeyName{};
+
+        std::vector<std::pair<std::uint64_t, int>> SlotsByKey{};   // Sorted by key.
+        std::uint64_t                           SkipKey{ 0 };
+        bool                                    bSkipBound{ false };
+        bool                                    bResolved{ false };
+    };
+
+    extern KeybindTable g_keybindTable;
+}
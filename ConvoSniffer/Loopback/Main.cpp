@@ -0,0 +1,957 @@
+// Replays synthetic or recorded conversations through HttpClient against the stand-in server, and reports
+// request throughput and enqueue-to-acknowledgement latency, also while the server stalls or restarts.
+//
+// The driver runs on a Linux host, outside of the game and of the CMake project, e.g. from this folder:
+//   g++ -std=c++20 -O2 -pthread -I../.. -I../../External/spdlog/include Main.cpp Server.cpp ../Channel.cpp ../Dashboard.cpp ../Http.cpp ../Recorder.cpp ../Stats.cpp ../Transport.cpp -o loopback
+//   ./loopback [conversations] [nodes per conversation] [node interval in us]
+//   ./loopback contention [requests]
+//   ./loopback replay <recording> [1x|max] [repeat] [port]
+//   ./loopback synthesize <recording> [conversations] [nodes per conversation] [node interval in us]
+//   ./loopback dashboard [updates] [browsers] [update interval in us] [port]
+//   ./loopback allocations [replies]
+//
+// Recordings come from the cs.record console command in game. Replays go to the stand-in server,
+// or to a companion server already listening on localhost if a port is given.
+//
+// The dashboard mode serves the companion page from the in-process server, and measures the latency
+// from publishing an update to browsers receiving it. With a port given, it keeps serving afterwards,
+// so that the page can be checked in an actual browser.
+//
+// The allocations mode queues replies the same way as SnifferClient::OnQueueReply , through the
+// request client, the dashboard and the event channel at once, and fails if the producer thread
+// still allocates once their buffers have been recycled.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "Common/Logging.hpp"
+#include "ConvoSniffer/Channel.hpp"
+#include "ConvoSniffer/Dashboard.hpp"
+#include "ConvoSniffer/Http.hpp"
+#include "ConvoSniffer/Loopback/Server.hpp"
+#include "ConvoSniffer/Recorder.hpp"
+
+
+// Counts allocations per thread, for the allocations mode. Kept out of line, so that GCC does not
+// mistake the replacement pairs for mismatched malloc and delete calls.
+static thread_local std::uint64_t t_allocations = 0;
+
+[[gnu::noinline]] void* operator new(std::size_t const Size)
+{
+    t_allocations++;
+    if (void* const Memory = std::malloc(Size != 0 ? Size : 1))
+        return Memory;
+    throw std::bad_alloc{};
+}
+
+[[gnu::noinline]] void operator delete(void* const Memory) noexcept
+{
+    std::free(Memory);
+}
+
+[[gnu::noinline]] void operator delete(void* const Memory, std::size_t) noexcept
+{
+    std::free(Memory);
+}
+
+
+namespace
+{
+    using namespace ConvoSniffer;
+    using namespace std::chrono_literals;
+
+    struct Options final
+    {
+        int                         Conversations{ 200 };
+        int                         Nodes{ 20 };
+        std::chrono::microseconds   Interval{ 0 };
+    };
+
+    struct Scenario final
+    {
+        char const*                 Name;
+        std::chrono::microseconds   Interval;
+        HttpClient::OverflowPolicy  Policy;
+        std::function<void(Loopback::StandInServer&)> Disrupt;     // Invoked halfway through, if set.
+    };
+
+    /// Collects acknowledgements from the client's worker thread.
+    class AckRecorder final
+    {
+    public:
+
+        void Record(HttpClient::Acknowledgement const& InAck)
+        {
+            std::scoped_lock Lock(Mutex);
+            Latencies.push_back(InAck.Latency);
+            if (InAck.Status >= 400)
+                Errors++;
+        }
+
+        std::size_t GetCount()
+        {
+            std::scoped_lock Lock(Mutex);
+            return Latencies.size();
+        }
+
+        std::size_t GetErrors()
+        {
+            std::scoped_lock Lock(Mutex);
+            return Errors;
+        }
+
+        /// Returns the latency at the given quantile, in milliseconds.
+        double GetQuantile(double const Quantile)
+        {
+            std::scoped_lock Lock(Mutex);
+            if (Latencies.empty())
+                return 0.0;
+
+            std::sort(Latencies.begin(), Latencies.end());
+            auto const Index = static_cast<std::size_t>(Quantile * static_cast<double>(Latencies.size() - 1));
+            return std::chrono::duration<double, std::milli>(Latencies[Index]).count();
+        }
+
+    private:
+
+        std::mutex                              Mutex;
+        std::vector<std::chrono::nanoseconds>   Latencies{};
+        std::size_t                             Errors{ 0 };
+    };
+
+    /// Formats a reply update the same way as SnifferClient::FormatReplyUpdate .
+    void FormatReplies(std::mt19937& Random, std::string& OutBody)
+    {
+        static char const* const k_styles[] = { "GUI_STYLE_NONE", "GUI_STYLE_CHARM", "GUI_STYLE_INTIMIDATE", "GUI_STYLE_ILLEGAL" };
+        static char const* const k_categories[] = { "REPLY_CATEGORY_DEFAULT", "REPLY_CATEGORY_AGREE", "REPLY_CATEGORY_DISAGREE", "REPLY_CATEGORY_INVESTIGATE" };
+
+        int const Count = std::uniform_int_distribution<int>(2, 6)(Random);
+
+        OutBody.clear();
+        OutBody.append(std::to_string(Count)).push_back('\n');
+
+        for (int i = 0; i < Count; ++i)
+        {
+            OutBody.push_back('\n');
+            OutBody.append(std::to_string(i)).push_back('\n');
+            OutBody.append(k_styles[Random() % std::size(k_styles)]).push_back('\n');
+            OutBody.append(k_categories[Random() % std::size(k_categories)]).push_back('\n');
+            OutBody.append("Paraphrase of reply ").append(std::to_string(i)).push_back('\n');
+            OutBody.append(80 + Random() % 160, 'x').push_back('\n');
+        }
+    }
+
+    /// Reads notifications pushed by the dashboard server, like the page does in a browser.
+    class DashboardBrowser final
+    {
+    public:
+
+        using MessageObserver = std::function<void(std::string_view)>;
+
+        DashboardBrowser(int const InPort, MessageObserver InObserver)
+            : Observer{ std::move(InObserver) }
+        {
+            Socket = ::socket(AF_INET, SOCK_STREAM, 0);
+
+            sockaddr_in Address{};
+            Address.sin_family = AF_INET;
+            Address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            Address.sin_port = htons(static_cast<unsigned short>(InPort));
+
+            if (::connect(Socket, reinterpret_cast<sockaddr const*>(&Address), sizeof Address) != 0)
+            {
+                ::close(std::exchange(Socket, -1));
+                return;
+            }
+
+            // Sample handshake from RFC 6455, which also checks the accept key the server computes.
+            std::string_view const Request =
+                "GET /socket HTTP/1.1\r\nHost: localhost\r\nUpgrade: websocket\r\nConnection: keep-alive, Upgrade\r\n"
+                "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\nSec-WebSocket-Version: 13\r\n\r\n";
+            ::send(Socket, Request.data(), Request.size(), MSG_NOSIGNAL);
+
+            ReadThread = std::thread(&DashboardBrowser::ReadMain, this);
+        }
+
+        DashboardBrowser(DashboardBrowser const&) = delete;
+        DashboardBrowser& operator=(DashboardBrowser const&) = delete;
+
+        ~DashboardBrowser()
+        {
+            if (Socket >= 0)
+                ::shutdown(Socket, SHUT_RDWR);
+            if (ReadThread.joinable())
+                ReadThread.join();
+            if (Socket >= 0)
+                ::close(Socket);
+        }
+
+        bool IsUpgraded() const noexcept { return bUpgraded.load(); }
+
+    private:
+
+        void ReadMain()
+        {
+            std::string Buffer{};
+            char Chunk[64 * 1024];
+
+            for (;;)
+            {
+                auto const Read = ::recv(Socket, Chunk, sizeof Chunk, 0);
+                if (Read <= 0)
+                    return;
+                Buffer.append(Chunk, static_cast<std::size_t>(Read));
+
+                if (!bUpgraded.load())
+                {
+                    std::size_t const HeaderEnd = Buffer.find("\r\n\r\n");
+                    if (HeaderEnd == std::string::npos)
+                        continue;
+
+                    std::string_view const Headers{ Buffer.data(), HeaderEnd };
+                    if (Headers.substr(0, 12) != "HTTP/1.1 101" || Headers.find("Sec-WebSocket-Accept: s3pPLMBiTxaQ9kYGzzhZRbK+xOo=") == std::string_view::npos)
+                    {
+                        std::printf("unexpected handshake response:\n%.*s\n", static_cast<int>(Headers.size()), Headers.data());
+                        return;
+                    }
+
+                    Buffer.erase(0, HeaderEnd + 4);
+                    bUpgraded.store(true);
+                }
+
+                // Server frames are never masked.
+                std::size_t Offset = 0;
+                for (;;)
+                {
+                    std::size_t const Available = Buffer.size() - Offset;
+                    if (Available < 2)
+                        break;
+
+                    auto const Byte = [&](std::size_t const Index) -> std::size_t { return static_cast<unsigned char>(Buffer[Offset + Index]); };
+                    std::size_t Length = Byte(1) & 0x7F;
+                    std::size_t Header = 2;
+
+                    if (Length == 126)
+                    {
+                        if (Available < 4) break;
+                        Length = (Byte(2) << 8) | Byte(3);
+                        Header = 4;
+                    }
+                    else if (Length == 127)
+                    {
+                        if (Available < 10) break;
+                        Length = 0;
+                        for (std::size_t i = 2; i < 10; ++i)
+                            Length = (Length << 8) | Byte(i);
+                        Header = 10;
+                    }
+
+                    if (Available < Header + Length)
+                        break;
+
+                    if ((Byte(0) & 0x0F) == 0x1)
+                        Observer(std::string_view{ Buffer.data() + Offset + Header, Length });
+                    Offset += Header + Length;
+                }
+
+                Buffer.erase(0, Offset);
+            }
+        }
+
+        int                         Socket{ -1 };
+        MessageObserver             Observer;
+        std::atomic_bool            bUpgraded{ false };
+        std::thread                 ReadThread{};
+    };
+
+    /// Request queue as HttpClient had it before the ring, i.e. a vector behind a mutex which both the
+    /// producer and the worker take for every request, kept for comparison in the contention benchmark.
+    class LegacyClient final
+    {
+    public:
+
+        LegacyClient(char const* const InHost, int const InPort)
+            : Link{ InHost, InPort, k_transportTimeoutMs, k_transportPipelineDepth }
+        {
+            Responses.resize(k_transportPipelineDepth);
+            ProcessThread = std::thread(&LegacyClient::ProcessMain, this);
+        }
+
+        ~LegacyClient()
+        {
+            {
+                std::scoped_lock QueueLock(QueueMutex);
+                bWantsExit = true;
+            }
+
+            RequestCondition.notify_all();
+            ProcessThread.join();
+        }
+
+        std::string AcquireBody()
+        {
+            std::scoped_lock QueueLock(QueueMutex);
+            if (BodyPool.empty())
+                return std::string{};
+
+            std::string Body = std::move(BodyPool.back());
+            BodyPool.pop_back();
+            return Body;
+        }
+
+        void QueueRequest(char const* const InMethod, char const* const InPath, std::string&& InBody, bool const bInCoalesce = false)
+        {
+            std::unique_lock QueueLock(QueueMutex);
+            Counters.Queued++;
+
+            if (bInCoalesce)
+            {
+                for (auto Iter = RequestQueue.rbegin(); Iter != RequestQueue.rend() && Iter->bCoalesce; ++Iter)
+                {
+                    if (std::strcmp(Iter->Method, InMethod) == 0 && std::strcmp(Iter->Path, InPath) == 0)
+                    {
+                        std::swap(Iter->Body, InBody);
+                        Counters.Coalesced++;
+                        ReleaseBody(std::move(InBody));
+                        return;
+                    }
+                }
+            }
+
+            RequestQueue.push_back(Request{ InMethod, InPath, std::move(InBody), bInCoalesce });
+            Counters.MaxQueueDepth = (std::max)(Counters.MaxQueueDepth, RequestQueue.size());
+
+            QueueLock.unlock();
+            RequestCondition.notify_all();
+        }
+
+        HttpClient::Stats GetStats()
+        {
+            std::scoped_lock QueueLock(QueueMutex);
+            return Counters;
+        }
+
+    private:
+
+        struct Request final
+        {
+            char const*     Method{};
+            char const*     Path{};
+            std::string     Body{};
+            bool            bCoalesce{ false };
+        };
+
+        void ProcessMain()
+        {
+            std::vector<Request> Batch{};
+            std::vector<TransportRequest> Requests{};
+
+            std::unique_lock QueueLock(QueueMutex);
+            while (!bWantsExit)
+            {
+                if (RequestQueue.empty())
+                {
+                    RequestCondition.wait(QueueLock);
+                    continue;
+                }
+
+                auto const Count = static_cast<std::ptrdiff_t>((std::min)(RequestQueue.size(), k_transportPipelineDepth));
+                Batch.clear();
+                Batch.insert(Batch.end(), std::make_move_iterator(RequestQueue.begin()), std::make_move_iterator(RequestQueue.begin() + Count));
+                RequestQueue.erase(RequestQueue.begin(), RequestQueue.begin() + Count);
+                QueueLock.unlock();
+
+                if (!Link.IsConnected())
+                    Link.Connect();
+
+                Requests.clear();
+                for (Request const& Item : Batch)
+                    Requests.push_back(TransportRequest{ Item.Method, Item.Path, Item.Body });
+
+                std::size_t const Acknowledged = Link.Exchange(Requests, Responses);
+
+                QueueLock.lock();
+                Counters.Sent += Acknowledged;
+                Counters.Failed += Batch.size() - Acknowledged;
+                for (Request& Item : Batch)
+                    ReleaseBody(std::move(Item.Body));
+            }
+        }
+
+        void ReleaseBody(std::string&& InBody)
+        {
+            if (BodyPool.size() < k_bodyPoolSize)
+            {
+                InBody.clear();
+                BodyPool.push_back(std::move(InBody));
+            }
+        }
+
+        SocketTransport                 Link;
+        std::vector<TransportResponse>  Responses{};
+
+        std::mutex                      QueueMutex;
+        std::condition_variable         RequestCondition;
+        std::vector<Request>            RequestQueue{};
+        std::vector<std::string>        BodyPool{};
+        HttpClient::Stats               Counters{};
+        bool                            bWantsExit{ false };
+        std::thread                     ProcessThread{};
+    };
+
+    /// Queues requests back to back from one thread, and reports how long each QueueRequest call took.
+    template<typename ClientType>
+    void RunContention(char const* const InName, ClientType& InClient, int const InRequests)
+    {
+        std::mt19937 Random{ 1234 };
+        std::vector<std::chrono::nanoseconds> Latencies{};
+        Latencies.reserve(static_cast<std::size_t>(InRequests));
+
+        auto const Start = std::chrono::steady_clock::now();
+        InClient.QueueRequest("POST", "/conversation", InClient.AcquireBody());
+
+        for (int i = 0; i < InRequests; ++i)
+        {
+            std::string Body = InClient.AcquireBody();
+            bool const bOrdered = i % 4 == 3;
+
+            if (bOrdered)
+                Body.assign(std::to_string(Random() % 6));
+            else
+                FormatReplies(Random, Body);
+
+            auto const Before = std::chrono::steady_clock::now();
+            if (bOrdered)
+                InClient.QueueRequest("POST", "/conversation/replies/queue", std::move(Body));
+            else
+                InClient.QueueRequest("PUT", "/conversation/replies", std::move(Body), true);
+            Latencies.push_back(std::chrono::steady_clock::now() - Before);
+        }
+
+        auto const Deadline = std::chrono::steady_clock::now() + 60s;
+        HttpClient::Stats Stats = InClient.GetStats();
+        while (Stats.Sent + Stats.Failed + Stats.Coalesced + Stats.Dropped < Stats.Queued && std::chrono::steady_clock::now() < Deadline)
+        {
+            std::this_thread::sleep_for(1ms);
+            Stats = InClient.GetStats();
+        }
+
+        double const Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+
+        std::sort(Latencies.begin(), Latencies.end());
+        auto const Quantile = [&Latencies](double const InQuantile) -> double
+        {
+            auto const Index = static_cast<std::size_t>(InQuantile * static_cast<double>(Latencies.size() - 1));
+            return std::chrono::duration<double, std::micro>(Latencies[Index]).count();
+        };
+
+        std::printf("%-18s %8llu %9llu %7llu %8zu %9.0f %8.2f %8.2f %9.2f\n",
+            InName,
+            static_cast<unsigned long long>(Stats.Sent), static_cast<unsigned long long>(Stats.Coalesced),
+            static_cast<unsigned long long>(Stats.Dropped), Stats.MaxQueueDepth,
+            static_cast<double>(Stats.Sent) / Seconds,
+            Quantile(0.50), Quantile(0.99), Quantile(1.0));
+    }
+
+    void RunContention(int const InRequests)
+    {
+        std::printf("%d requests from one thread, QueueRequest latency in us\n\n", InRequests);
+        std::printf("%-18s %8s %9s %7s %8s %9s %8s %8s %9s\n",
+            "queue", "sent", "coalesced", "dropped", "maxdepth", "sent/s", "p50", "p99", "max");
+
+        {
+            Loopback::StandInServer Server{ 0 };
+            LegacyClient Client{ "127.0.0.1", Server.GetPort() };
+            RunContention("mutex+vector", Client, InRequests);
+        }
+
+        {
+            Loopback::StandInServer Server{ 0 };
+            HttpClient Client{ "127.0.0.1", Server.GetPort(), HttpClient::OverflowPolicy::DropCoalescible };
+            RunContention("ring/drop-coalesce", Client, InRequests);
+        }
+
+        {
+            Loopback::StandInServer Server{ 0 };
+            HttpClient Client{ "127.0.0.1", Server.GetPort(), HttpClient::OverflowPolicy::Block };
+            RunContention("ring/block", Client, InRequests);
+        }
+    }
+
+    /// Waits until every request is either acknowledged, coalesced into a later one, dropped, or given up on.
+    HttpClient::Stats WaitUntilSettled(HttpClient& InClient, AckRecorder& InAcks)
+    {
+        auto const Deadline = std::chrono::steady_clock::now() + 60s;
+        for (;;)
+        {
+            HttpClient::Stats const Stats = InClient.GetStats();
+            std::size_t const GivenUp = Stats.Failed - InAcks.GetErrors();
+
+            if (InAcks.GetCount() + Stats.Coalesced + Stats.Dropped + GivenUp >= Stats.Queued || std::chrono::steady_clock::now() > Deadline)
+                return Stats;
+
+            std::this_thread::sleep_for(1ms);
+        }
+    }
+
+    void RunScenario(Options const& InOptions, Scenario const& InScenario)
+    {
+        Loopback::StandInServer Server{ 0 };
+        if (!Server.IsListening())
+        {
+            std::printf("%-10s failed to start server: %s\n", InScenario.Name, Server.GetLastError().c_str());
+            return;
+        }
+
+        AckRecorder Acks{};
+        auto const Start = std::chrono::steady_clock::now();
+
+        {
+            HttpClient Client{ "127.0.0.1", Server.GetPort(), InScenario.Policy, [&Acks](HttpClient::Acknowledgement const& Ack) { Acks.Record(Ack); } };
+            std::mt19937 Random{ 1234 };
+
+            std::string Body = Client.AcquireBody();
+            Body.assign("0;1;2;3;4;5;6;7;8;9;A;B;C;D;E;F");
+            Client.QueueRequest("PUT", "/keybinds", std::move(Body), true);
+
+            for (int Conversation = 0; Conversation < InOptions.Conversations; ++Conversation)
+            {
+                if (InScenario.Disrupt && Conversation == InOptions.Conversations / 2)
+                    InScenario.Disrupt(Server);
+
+                Client.QueueRequest("POST", "/conversation", Client.AcquireBody());
+
+                for (int Node = 0; Node < InOptions.Nodes; ++Node)
+                {
+                    Body = Client.AcquireBody();
+                    FormatReplies(Random, Body);
+                    Client.QueueRequest("PUT", "/conversation/replies", std::move(Body), true);
+
+                    if (Random() % 4 == 0)
+                    {
+                        Body = Client.AcquireBody();
+                        Body.assign(std::to_string(Random() % 6));
+                        Client.QueueRequest("POST", "/conversation/replies/queue", std::move(Body));
+                    }
+
+                    if (InScenario.Interval.count() > 0)
+                        std::this_thread::sleep_for(InScenario.Interval);
+                }
+
+                Client.QueueRequest("DELETE", "/conversation", Client.AcquireBody());
+            }
+
+            HttpClient::Stats const Stats = WaitUntilSettled(Client, Acks);
+            std::size_t const Acked = Acks.GetCount();
+            double const Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+            Loopback::StandInServer::Stats const ServerStats = Server.GetStats();
+
+            std::printf("%-10s %8llu %8zu %9llu %7llu %7llu %6llu %5llu %9.0f %8.3f %8.3f %8.3f %6llu\n",
+                InScenario.Name,
+                static_cast<unsigned long long>(Stats.Queued), Acked,
+                static_cast<unsigned long long>(Stats.Coalesced), static_cast<unsigned long long>(Stats.Dropped),
+                static_cast<unsigned long long>(Stats.Retried),
+                static_cast<unsigned long long>(Stats.Failed), static_cast<unsigned long long>(Stats.Connections),
+                static_cast<double>(Acked) / Seconds,
+                Acks.GetQuantile(0.50), Acks.GetQuantile(0.99), Acks.GetQuantile(1.0),
+                static_cast<unsigned long long>(ServerStats.Rejected));
+        }
+    }
+
+    /// Feeds a recording through HttpClient, at the recorded pace or as fast as the client takes it.
+    int RunReplay(char const* const InPath, bool const bInRealtime, int const InRepeat, int const InPort)
+    {
+        std::unique_ptr<Loopback::StandInServer> Server{};
+        int Port = InPort;
+
+        if (Port <= 0)
+        {
+            Server = std::make_unique<Loopback::StandInServer>(0);
+            if (!Server->IsListening())
+            {
+                std::printf("failed to start server: %s\n", Server->GetLastError().c_str());
+                return 1;
+            }
+            Port = Server->GetPort();
+        }
+
+        AckRecorder Acks{};
+        std::uint64_t Events = 0;
+        auto const Start = std::chrono::steady_clock::now();
+
+        // Blocking keeps every recorded request when replaying faster than the server answers.
+        HttpClient::OverflowPolicy const Policy = bInRealtime ? HttpClient::OverflowPolicy::DropCoalescible : HttpClient::OverflowPolicy::Block;
+        HttpClient Client{ "127.0.0.1", Port, Policy, [&Acks](HttpClient::Acknowledgement const& Ack) { Acks.Record(Ack); } };
+
+        SessionReader::Record Item{};
+        std::chrono::microseconds Base{ 0 };
+
+        for (int Pass = 0; Pass < InRepeat; ++Pass)
+        {
+            SessionReader Reader{ InPath };
+            if (!Reader.IsOpen())
+            {
+                std::printf("%s: %s\n", InPath, Reader.GetLastError().c_str());
+                return 1;
+            }
+
+            while (Reader.Next(Item))
+            {
+                SessionRequest const Request = GetSessionRequest(Item.Event);
+                if (Request.Method == nullptr)
+                {
+                    std::printf("%s: skipping unknown event %u\n", InPath, static_cast<unsigned>(Item.Event));
+                    continue;
+                }
+
+                if (bInRealtime)
+                    std::this_thread::sleep_until(Start + Base + Item.Offset);
+
+                std::string Body = Client.AcquireBody();
+                Body.assign(Item.Payload);
+                Client.QueueRequest(Request.Method, Request.Path, std::move(Body), Request.bCoalesce);
+                Events++;
+            }
+
+            if (!Reader.GetLastError().empty())
+                std::printf("%s: %s\n", InPath, Reader.GetLastError().c_str());
+
+            Base += Item.Offset;
+        }
+
+        double const Queueing = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+        HttpClient::Stats const Stats = WaitUntilSettled(Client, Acks);
+        double const Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+
+        std::printf("%llu events in %.3f s (recorded %.3f s per pass), settled after %.3f s\n\n",
+            static_cast<unsigned long long>(Events), Queueing, std::chrono::duration<double>(Item.Offset).count(), Seconds);
+        std::printf("%8s %9s %7s %6s %9s %9s %8s %8s %8s %6s\n",
+            "acked", "coalesced", "dropped", "failed", "bytes", "acks/s", "p50", "p99", "max", "errors");
+        std::printf("%8zu %9llu %7llu %6llu %9llu %9.0f %8.3f %8.3f %8.3f %6zu\n",
+            Acks.GetCount(),
+            static_cast<unsigned long long>(Stats.Coalesced), static_cast<unsigned long long>(Stats.Dropped),
+            static_cast<unsigned long long>(Stats.Failed), static_cast<unsigned long long>(Stats.BytesSent),
+            static_cast<double>(Acks.GetCount()) / Seconds,
+            Acks.GetQuantile(0.50), Acks.GetQuantile(0.99), Acks.GetQuantile(1.0), Acks.GetErrors());
+
+        return 0;
+    }
+
+    /// Writes a recording of synthetic conversations, for trying out replays without the game.
+    int RunSynthesize(char const* const InPath, Options const& InOptions)
+    {
+        SessionRecorder Recorder{};
+        if (!Recorder.Start(InPath))
+        {
+            std::printf("%s: %s\n", InPath, Recorder.GetLastError().c_str());
+            return 1;
+        }
+
+        std::mt19937 Random{ 1234 };
+        std::string Body{};
+
+        Recorder.Record(SessionEvent::Keybinds, "0;1;2;3;4;5;6;7;8;9;A;B;C;D;E;F");
+
+        for (int Conversation = 0; Conversation < InOptions.Conversations; ++Conversation)
+        {
+            Recorder.Record(SessionEvent::Start);
+
+            for (int Node = 0; Node < InOptions.Nodes; ++Node)
+            {
+                FormatReplies(Random, Body);
+                Recorder.Record(SessionEvent::Replies, Body);
+
+                if (Random() % 4 == 0)
+                    Recorder.Record(SessionEvent::Queue, std::to_string(Random() % 6));
+
+                if (InOptions.Interval.count() > 0)
+                    std::this_thread::sleep_for(InOptions.Interval);
+            }
+
+            Recorder.Record(SessionEvent::End);
+        }
+
+        std::uint64_t const Records = Recorder.GetRecordCount();
+        Recorder.Stop();
+
+        if (!Recorder.GetLastError().empty())
+        {
+            std::printf("%s: %s\n", InPath, Recorder.GetLastError().c_str());
+            return 1;
+        }
+
+        std::printf("%s: %llu events\n", InPath, static_cast<unsigned long long>(Records));
+        return 0;
+    }
+
+    /// Publishes reply updates to the in-process dashboard server, and measures when browsers receive them.
+    int RunDashboard(int const InUpdates, int const InBrowsers, std::chrono::microseconds const InInterval, int const InPort)
+    {
+        std::ifstream PageFile{ "../convosniffer/src/index.html", std::ios::binary };
+        std::stringstream PageStream{};
+        PageStream << PageFile.rdbuf();
+        std::string const Page = PageFile ? PageStream.str() : std::string{ "<!doctype html><p>index.html not found</p>" };
+
+        DashboardServer Server{ InPort, Page };
+        if (!Server.IsListening())
+        {
+            std::printf("failed to start dashboard server: %s\n", Server.GetLastError().c_str());
+            return 1;
+        }
+
+        // Updates carry their sequence number in the paraphrase of the first reply.
+        auto const PublishTimes = std::make_unique<std::atomic<std::int64_t>[]>(static_cast<std::size_t>(InUpdates));
+        std::atomic<int> Synced{ 0 };
+        std::mutex LatencyMutex;
+        std::vector<std::chrono::nanoseconds> Latencies{};
+
+        auto const Observe = [&](std::string_view const Message) -> void
+            {
+                auto const ReceivedAt = std::chrono::steady_clock::now().time_since_epoch().count();
+
+                if (Message.starts_with(R"({"SetKeybinds")"))
+                {
+                    Synced++;
+                    return;
+                }
+
+                std::size_t const Marker = Message.find("update ");
+                if (Marker == std::string_view::npos)
+                    return;
+
+                int const Sequence = std::atoi(Message.data() + Marker + 7);
+                if (Sequence < 0 || Sequence >= InUpdates)
+                    return;
+
+                std::scoped_lock Lock(LatencyMutex);
+                Latencies.emplace_back(ReceivedAt - PublishTimes[static_cast<std::size_t>(Sequence)].load());
+            };
+
+        Server.Publish(DashboardTopic::Keybinds, R"({"SetKeybinds":{"keybinds":["0","1","2","3","4","5","6","7","8","9","A","B","C","D","E","F"]}})");
+        Server.Publish(DashboardTopic::Start, R"({"Conversation":{"start":true}})");
+
+        std::vector<std::unique_ptr<DashboardBrowser>> Browsers{};
+        for (int i = 0; i < InBrowsers; ++i)
+            Browsers.push_back(std::make_unique<DashboardBrowser>(Server.GetPort(), Observe));
+
+        auto Deadline = std::chrono::steady_clock::now() + 5s;
+        while (Synced.load() < InBrowsers && std::chrono::steady_clock::now() < Deadline)
+            std::this_thread::sleep_for(1ms);
+
+        if (Synced.load() < InBrowsers)
+        {
+            std::printf("only %d of %d browsers connected\n", Synced.load(), InBrowsers);
+            return 1;
+        }
+
+        std::mt19937 Random{ 1234 };
+        for (int Sequence = 0; Sequence < InUpdates; ++Sequence)
+        {
+            std::string Message{ R"({"UpdateReplies":{"replies":[{"id":0,"style":"NONE","category":"DEFAULT","paraphrase":"update )" };
+            Message.append(std::to_string(Sequence)).append(R"(","text":")").append(80 + Random() % 160, 'x').append(R"(","queued":false}]}})");
+
+            PublishTimes[static_cast<std::size_t>(Sequence)].store(std::chrono::steady_clock::now().time_since_epoch().count());
+            Server.Publish(DashboardTopic::Replies, std::move(Message));
+
+            if (InInterval.count() > 0)
+                std::this_thread::sleep_for(InInterval);
+        }
+
+        std::size_t const Expected = static_cast<std::size_t>(InUpdates) * static_cast<std::size_t>(InBrowsers);
+        Deadline = std::chrono::steady_clock::now() + 10s;
+        for (;;)
+        {
+            {
+                std::scoped_lock Lock(LatencyMutex);
+                if (Latencies.size() >= Expected || std::chrono::steady_clock::now() > Deadline)
+                    break;
+            }
+            std::this_thread::sleep_for(1ms);
+        }
+
+        DashboardServer::Stats const Stats = Server.GetStats();
+        auto const Milliseconds = [](std::chrono::nanoseconds const InDuration) -> double { return std::chrono::duration<double, std::milli>(InDuration).count(); };
+
+        std::scoped_lock Lock(LatencyMutex);
+        std::sort(Latencies.begin(), Latencies.end());
+        auto const Quantile = [&Latencies](double const InQuantile) -> std::chrono::nanoseconds
+            {
+                return Latencies.empty() ? std::chrono::nanoseconds{} : Latencies[static_cast<std::size_t>(InQuantile * static_cast<double>(Latencies.size() - 1))];
+            };
+
+        std::printf("%d updates to %d browsers, latency in ms from publishing to receiving\n\n", InUpdates, InBrowsers);
+        std::printf("%9s %8s %8s %8s %11s %11s %8s %10s\n", "received", "p50", "p99", "max", "handoff p50", "handoff p99", "overflow", "bytes");
+        std::printf("%9zu %8.3f %8.3f %8.3f %11.3f %11.3f %8llu %10llu\n",
+            Latencies.size(), Milliseconds(Quantile(0.50)), Milliseconds(Quantile(0.99)), Milliseconds(Quantile(1.0)),
+            Milliseconds(Stats.HandoffLatency.GetQuantile(0.50)), Milliseconds(Stats.HandoffLatency.GetQuantile(0.99)),
+            static_cast<unsigned long long>(Stats.Overflowed), static_cast<unsigned long long>(Stats.BytesSent));
+
+        if (InPort > 0)
+        {
+            std::printf("\nserving http://localhost:%d until interrupted\n", Server.GetPort());
+            for (;;)
+                std::this_thread::sleep_for(1s);
+        }
+
+        return Latencies.size() == Expected ? 0 : 1;
+    }
+
+    /// Appends a decimal integer the same way as the client does.
+    void AppendInteger(std::string& OutString, long long const InValue)
+    {
+        char Digits[24];
+        auto const Result = std::to_chars(std::begin(Digits), std::end(Digits), InValue);
+        OutString.append(Digits, Result.ptr);
+    }
+
+    int RunAllocations(int const InReplies)
+    {
+        Loopback::StandInServer Server{ 0 };
+        HttpClient Client{ "127.0.0.1", Server.GetPort(), HttpClient::OverflowPolicy::DropCoalescible };
+        DashboardServer Dashboard{ 0, "" };
+        EventChannel Events{ "127.0.0.1", Dashboard.GetPort() };
+
+        if (!Server.IsListening() || !Dashboard.IsListening())
+        {
+            std::printf("failed to start servers: %s%s\n", Server.GetLastError().c_str(), Dashboard.GetLastError().c_str());
+            return 1;
+        }
+
+        Client.QueueRequest("POST", "/conversation", Client.AcquireBody());
+
+        // Formats a queued reply like SnifferClient::OnQueueReply , for every way of reaching the server.
+        auto const QueueReply = [&](int const Index) -> void
+            {
+                std::string Body = Client.AcquireBody();
+                AppendInteger(Body, Index);
+                Client.QueueRequest("POST", "/conversation/replies/queue", std::move(Body));
+
+                std::string Message = Dashboard.AcquireMessage();
+                Message.append(R"({"QueueReply":{"index":)");
+                AppendInteger(Message, Index);
+                Message.append("}}");
+                Dashboard.Publish(DashboardTopic::Queue, std::move(Message));
+
+                std::string QueueEvent = Events.AcquireEvent();
+                QueueEvent.append(R"({"type":"queue","index":)");
+                AppendInteger(QueueEvent, Index);
+                QueueEvent.append("}");
+                Events.Publish(ChannelTopic::Queue, std::move(QueueEvent));
+            };
+
+        // Warm up until every ring slot went around at least once, at a pace the workers keep up with.
+        int const Warmup = 4 * static_cast<int>((std::max)({ k_requestRingSize, k_dashboardRingSize, k_channelRingSize }));
+        for (int i = 0; i < Warmup; ++i)
+        {
+            QueueReply(i % 6);
+            std::this_thread::sleep_for(50us);
+        }
+
+        std::uint64_t const Before = t_allocations;
+        for (int i = 0; i < InReplies; ++i)
+        {
+            QueueReply(i % 6);
+            std::this_thread::sleep_for(50us);
+        }
+        std::uint64_t const Allocations = t_allocations - Before;
+
+        HttpClient::Stats const HttpStats = Client.GetStats();
+        DashboardServer::Stats const DashboardStats = Dashboard.GetStats();
+        EventChannel::Stats const ChannelStats = Events.GetStats();
+
+        std::printf("%d queued replies after %d to warm up, allocations on the producer thread\n\n", InReplies, Warmup);
+        std::printf("%11s %8s %8s %8s %11s\n", "allocations", "dropped", "overflow", "channel", "per reply");
+        std::printf("%11llu %8llu %8llu %8llu %11.3f\n", static_cast<unsigned long long>(Allocations),
+            static_cast<unsigned long long>(HttpStats.Dropped), static_cast<unsigned long long>(DashboardStats.Overflowed),
+            static_cast<unsigned long long>(ChannelStats.Overflowed), static_cast<double>(Allocations) / InReplies);
+
+        return Allocations == 0 ? 0 : 1;
+    }
+}
+
+int main(int const Argc, char** const Argv)
+{
+    // Per-request logging would dominate the measurement.
+    spdlog::set_level(spdlog::level::err);
+
+    if (Argc > 1 && std::strcmp(Argv[1], "contention") == 0)
+    {
+        // Dropping requests makes the server reject the ones depending on them, which is expected here.
+        spdlog::set_level(spdlog::level::critical);
+        RunContention(Argc > 2 ? std::max(1, std::atoi(Argv[2])) : 100000);
+        return 0;
+    }
+
+    if (Argc > 2 && std::strcmp(Argv[1], "replay") == 0)
+    {
+        bool const bRealtime = Argc <= 3 || std::strcmp(Argv[3], "max") != 0;
+        return RunReplay(Argv[2], bRealtime, Argc > 4 ? std::max(1, std::atoi(Argv[4])) : 1, Argc > 5 ? std::atoi(Argv[5]) : 0);
+    }
+
+    if (Argc > 1 && std::strcmp(Argv[1], "dashboard") == 0)
+    {
+        return RunDashboard(Argc > 2 ? std::max(1, std::atoi(Argv[2])) : 10000, Argc > 3 ? std::max(1, std::atoi(Argv[3])) : 4,
+            std::chrono::microseconds(Argc > 4 ? std::max(0, std::atoi(Argv[4])) : 200), Argc > 5 ? std::atoi(Argv[5]) : 0);
+    }
+
+    if (Argc > 1 && std::strcmp(Argv[1], "allocations") == 0)
+    {
+        return RunAllocations(Argc > 2 ? std::max(1, std::atoi(Argv[2])) : 10000);
+    }
+
+    if (Argc > 2 && std::strcmp(Argv[1], "synthesize") == 0)
+    {
+        Options Synthetic{};
+        if (Argc > 3) Synthetic.Conversations = std::max(1, std::atoi(Argv[3]));
+        if (Argc > 4) Synthetic.Nodes = std::max(1, std::atoi(Argv[4]));
+        if (Argc > 5) Synthetic.Interval = std::chrono::microseconds(std::max(0, std::atoi(Argv[5])));
+        return RunSynthesize(Argv[2], Synthetic);
+    }
+
+    Options Opts{};
+    if (Argc > 1) Opts.Conversations = std::max(1, std::atoi(Argv[1]));
+    if (Argc > 2) Opts.Nodes = std::max(1, std::atoi(Argv[2]));
+    if (Argc > 3) Opts.Interval = std::chrono::microseconds(std::max(0, std::atoi(Argv[3])));
+
+    Scenario const Scenarios[] = {
+        { "burst", 0us, HttpClient::OverflowPolicy::Block, {} },
+        { "paced", Opts.Interval.count() > 0 ? Opts.Interval : 200us, HttpClient::OverflowPolicy::DropCoalescible, {} },
+        { "stall", Opts.Interval.count() > 0 ? Opts.Interval : 200us, HttpClient::OverflowPolicy::DropCoalescible,
+            [](Loopback::StandInServer& Server) { Server.Stall(std::chrono::milliseconds(k_transportTimeoutMs + 1000)); } },
+        { "restart", Opts.Interval.count() > 0 ? Opts.Interval : 200us, HttpClient::OverflowPolicy::DropCoalescible,
+            [](Loopback::StandInServer& Server) { Server.DropConnections(); } },
+    };
+
+    std::printf("%d conversations x %d nodes, latency in ms from queueing to response\n\n", Opts.Conversations, Opts.Nodes);
+    std::printf("%-10s %8s %8s %9s %7s %7s %6s %5s %9s %8s %8s %8s %6s\n",
+        "scenario", "queued", "acked", "coalesced", "dropped", "retried", "failed", "conns", "acks/s", "p50", "p99", "max", "errors");
+
+    for (Scenario const& Item : Scenarios)
+        RunScenario(Opts, Item);
+
+    return 0;
+}
@@ -0,0 +1,428 @@
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <utility>
+
+#include "ConvoSniffer/Loopback/Server.hpp"
+
+
+namespace
+{
+    constexpr std::size_t k_maxReplies = 16;
+    constexpr std::size_t k_maxHeaderLength = 16 * 1024;
+
+    std::int64_t GetTicks()
+    {
+        return std::chrono::steady_clock::now().time_since_epoch().count();
+    }
+
+    bool SendAll(int const Socket, std::string_view Data)
+    {
+        while (!Data.empty())
+        {
+            ssize_t const Sent = ::send(Socket, Data.data(), Data.size(), MSG_NOSIGNAL);
+            if (Sent <= 0)
+                return false;
+            Data.remove_prefix(static_cast<std::size_t>(Sent));
+        }
+
+        return true;
+    }
+
+    bool EqualsNoCase(std::string_view const Left, std::string_view const Right)
+    {
+        return Left.size() == Right.size() && std::equal(Left.begin(), Left.end(), Right.begin(),
+            [](char const A, char const B) -> bool { return (A | 0x20) == (B | 0x20); });
+    }
+
+    std::string_view Trim(std::string_view Text)
+    {
+        while (!Text.empty() && (Text.front() == ' ' || Text.front() == '\t' || Text.front() == '\r'))
+            Text.remove_prefix(1);
+        while (!Text.empty() && (Text.back() == ' ' || Text.back() == '\t' || Text.back() == '\r'))
+            Text.remove_suffix(1);
+        return Text;
+    }
+
+    template<typename T>
+    bool ParseNumber(std::string_view const Text, T& OutValue)
+    {
+        auto const Result = std::from_chars(Text.data(), Text.data() + Text.size(), OutValue);
+        return Result.ec == std::errc{} && Result.ptr == Text.data() + Text.size() && !Text.empty();
+    }
+
+    /// Splits off the next line of a reply manifest, like Rust's @c str::lines with trimming.
+    bool PopLine(std::string_view& InOutText, std::string_view& OutLine)
+    {
+        if (InOutText.empty())
+            return false;
+
+        std::size_t const End = InOutText.find('\n');
+        OutLine = Trim(InOutText.substr(0, End));
+        InOutText.remove_prefix(End == std::string_view::npos ? InOutText.size() : End + 1);
+        return true;
+    }
+
+    char const* GetReason(unsigned const Status)
+    {
+        switch (Status)
+        {
+        case 200: return "OK";
+        case 204: return "No Content";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        default: return "Internal Server Error";
+        }
+    }
+}
+
+namespace ConvoSniffer::Loopback
+{
+    // ! StandInServer implementation.
+    // ========================================
+
+    StandInServer::StandInServer(int const InPort)
+        : Port{ InPort }
+        , ListenSocket{ -1 }
+    {
+        int const Socket = ::socket(AF_INET, SOCK_STREAM, 0);
+        if (Socket < 0)
+        {
+            LastError.assign("socket failed: ").append(std::strerror(errno));
+            return;
+        }
+
+        int const Reuse = 1;
+        ::setsockopt(Socket, SOL_SOCKET, SO_REUSEADDR, &Reuse, sizeof Reuse);
+
+        sockaddr_in Address{};
+        Address.sin_family = AF_INET;
+        Address.sin_port = htons(static_cast<std::uint16_t>(InPort));
+        Address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+        socklen_t AddressLength = sizeof Address;
+        if (::bind(Socket, reinterpret_cast<sockaddr*>(&Address), sizeof Address) != 0 || ::listen(Socket, 16) != 0
+            || ::getsockname(Socket, reinterpret_cast<sockaddr*>(&Address), &AddressLength) != 0)
+        {
+            LastError.assign("bind failed: ").append(std::strerror(errno));
+            ::close(Socket);
+            return;
+        }
+
+        Port = ntohs(Address.sin_port);
+        ListenSocket = Socket;
+        AcceptThread = std::thread(&StandInServer::AcceptMain, this);
+    }
+
+    StandInServer::~StandInServer()
+    {
+        bWantsExit = true;
+        StallUntil = 0;
+
+        if (ListenSocket >= 0)
+            ::shutdown(ListenSocket, SHUT_RDWR);
+        if (AcceptThread.joinable())
+            AcceptThread.join();
+        if (ListenSocket >= 0)
+            ::close(ListenSocket);
+
+        DropConnections();
+
+        std::vector<std::thread> Threads{};
+        {
+            std::scoped_lock ConnectionLock(ConnectionMutex);
+            Threads.swap(ConnectionThreads);
+        }
+
+        for (std::thread& Thread : Threads)
+            Thread.join();
+    }
+
+    void StandInServer::Stall(std::chrono::milliseconds const Duration)
+    {
+        auto const Until = std::chrono::steady_clock::now() + Duration;
+        StallUntil = Until.time_since_epoch().count();
+    }
+
+    void StandInServer::DropConnections()
+    {
+        std::scoped_lock ConnectionLock(ConnectionMutex);
+
+        // Serving threads notice the shutdown, and close their sockets themselves.
+        for (int const Socket : ConnectionSockets)
+            ::shutdown(Socket, SHUT_RDWR);
+    }
+
+    StandInServer::Stats StandInServer::GetStats()
+    {
+        std::scoped_lock StateLock(StateMutex);
+        return Counters;
+    }
+
+    void StandInServer::AcceptMain()
+    {
+        while (!bWantsExit)
+        {
+            int const Socket = ::accept(ListenSocket, nullptr, nullptr);
+            if (Socket < 0)
+            {
+                if (errno == EINTR || errno == ECONNABORTED)
+                    continue;
+                break;
+            }
+
+            int const NoDelay = 1;
+            ::setsockopt(Socket, IPPROTO_TCP, TCP_NODELAY, &NoDelay, sizeof NoDelay);
+
+            {
+                std::scoped_lock StateLock(StateMutex);
+                Counters.Connections++;
+            }
+
+            std::scoped_lock ConnectionLock(ConnectionMutex);
+            ConnectionSockets.push_back(Socket);
+            ConnectionThreads.emplace_back(&StandInServer::ServeMain, this, Socket);
+        }
+    }
+
+    void StandInServer::ServeMain(int const Socket)
+    {
+        std::string Buffer{};
+        std::string Response{};
+        std::string Text{};
+
+        auto const Receive = [&]() -> bool
+            {
+                char Chunk[4096];
+                ssize_t const Read = ::recv(Socket, Chunk, sizeof Chunk, 0);
+                if (Read <= 0)
+                    return false;
+                Buffer.append(Chunk, static_cast<std::size_t>(Read));
+                return true;
+            };
+
+        bool bOpen = true;
+        while (bOpen && !bWantsExit)
+        {
+            std::size_t HeaderEnd = std::string::npos;
+            while ((HeaderEnd = Buffer.find("\r\n\r\n")) == std::string::npos)
+            {
+                if (Buffer.size() > k_maxHeaderLength || !Receive())
+                {
+                    bOpen = false;
+                    break;
+                }
+            }
+
+            if (!bOpen)
+                break;
+
+            std::string_view Head{ Buffer.data(), HeaderEnd };
+            std::string_view RequestLine = Head.substr(0, Head.find("\r\n"));
+
+            std::size_t const MethodEnd = RequestLine.find(' ');
+            std::size_t const PathEnd = RequestLine.find(' ', MethodEnd + 1);
+            if (MethodEnd == std::string_view::npos || PathEnd == std::string_view::npos)
+                break;
+
+            std::string const Method{ RequestLine.substr(0, MethodEnd) };
+            std::string const Path{ RequestLine.substr(MethodEnd + 1, PathEnd - MethodEnd - 1) };
+
+            std::size_t ContentLength = 0;
+            bool bClose = false;
+
+            for (std::string_view Headers = Head.substr(RequestLine.size()); !Headers.empty();)
+            {
+                std::size_t const LineEnd = Headers.find("\r\n", 2);
+                std::string_view const Line = Trim(Headers.substr(2, LineEnd == std::string_view::npos ? std::string_view::npos : LineEnd - 2));
+                Headers.remove_prefix(LineEnd == std::string_view::npos ? Headers.size() : LineEnd);
+
+                std::size_t const Colon = Line.find(':');
+                if (Colon == std::string_view::npos)
+                    continue;
+
+                std::string_view const Name = Trim(Line.substr(0, Colon));
+                std::string_view const Value = Trim(Line.substr(Colon + 1));
+
+                if (EqualsNoCase(Name, "Content-Length"))
+                    ParseNumber(Value, ContentLength);
+                else if (EqualsNoCase(Name, "Connection"))
+                    bClose = EqualsNoCase(Value, "close");
+            }
+
+            std::size_t const BodyStart = HeaderEnd + 4;
+            while (Buffer.size() - BodyStart < ContentLength)
+            {
+                if (!Receive())
+                {
+                    bOpen = false;
+                    break;
+                }
+            }
+
+            if (!bOpen)
+                break;
+
+            WaitWhileStalled();
+
+            Text.clear();
+            unsigned const Status = Handle(Method, Path, std::string_view{ Buffer }.substr(BodyStart, ContentLength), Text);
+            Buffer.erase(0, BodyStart + ContentLength);
+
+            char Length[24];
+            auto const LengthEnd = std::to_chars(std::begin(Length), std::end(Length), Text.size()).ptr;
+
+            Response.assign("HTTP/1.1 ").append(std::to_string(Status)).append(" ").append(GetReason(Status)).append("\r\n");
+            Response.append("Content-Length: ").append(Length, LengthEnd).append("\r\n");
+            Response.append(bClose ? "Connection: close\r\n\r\n" : "\r\n").append(Text);
+
+            bOpen = SendAll(Socket, Response) && !bClose;
+        }
+
+        std::scoped_lock ConnectionLock(ConnectionMutex);
+        ConnectionSockets.erase(std::remove(ConnectionSockets.begin(), ConnectionSockets.end(), Socket), ConnectionSockets.end());
+        ::close(Socket);
+    }
+
+    void StandInServer::WaitWhileStalled()
+    {
+        while (!bWantsExit && GetTicks() < StallUntil)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    unsigned StandInServer::Handle(std::string_view const Method, std::string_view const Path, std::string_view const Body, std::string& OutText)
+    {
+        unsigned Status = 404;
+
+        if (Path == "/conversation" && Method == "POST")
+            Status = StartConversation();
+        else if (Path == "/conversation" && Method == "DELETE")
+            Status = EndConversation();
+        else if (Path == "/conversation/replies" && Method == "PUT")
+            Status = UpdateReplies(Body, OutText);
+        else if (Path == "/conversation/replies/queue" && Method == "POST")
+            Status = QueueReply(Body, OutText);
+        else if (Path == "/keybinds" && Method == "PUT")
+            Status = UpdateKeybinds(Body, OutText);
+
+        std::scoped_lock StateLock(StateMutex);
+        Counters.Requests++;
+        if (Status >= 400)
+            Counters.Rejected++;
+
+        return Status;
+    }
+
+    unsigned StandInServer::StartConversation()
+    {
+        std::scoped_lock StateLock(StateMutex);
+
+        // Like the real server, reset instead of failing when out of sync.
+        bConversation = true;
+        QueuedReplies = {};
+        Counters.Conversations++;
+        return 204;
+    }
+
+    unsigned StandInServer::EndConversation()
+    {
+        std::scoped_lock StateLock(StateMutex);
+
+        bConversation = false;
+        QueuedReplies = {};
+        return 204;
+    }
+
+    unsigned StandInServer::UpdateReplies(std::string_view Body, std::string& OutText)
+    {
+        std::string_view Line{};
+        std::size_t Count = 0;
+
+        if (!PopLine(Body, Line) || !ParseNumber(Line, Count) || Count >= k_maxReplies)
+        {
+            OutText.assign("invalid count line");
+            return 500;
+        }
+
+        for (std::size_t i = 0; i < Count; ++i)
+        {
+            std::string_view Separator{}, Index{}, Style{}, Category{}, Paraphrase{}, Text{};
+            std::size_t ReplyIndex = 0;
+
+            if (!PopLine(Body, Separator) || !PopLine(Body, Index) || !PopLine(Body, Style)
+                || !PopLine(Body, Category) || !PopLine(Body, Paraphrase) || !PopLine(Body, Text))
+            {
+                OutText.assign("failed to pop lines for reply ").append(std::to_string(i));
+                return 500;
+            }
+
+            if (!Separator.empty() || !ParseNumber(Index, ReplyIndex) || ReplyIndex >= k_maxReplies)
+            {
+                OutText.assign("invalid manifest for reply ").append(std::to_string(i));
+                return 500;
+            }
+        }
+
+        std::scoped_lock StateLock(StateMutex);
+
+        // Implicitly create the conversation when out of sync, like the real server.
+        bConversation = true;
+        QueuedReplies = {};
+        return 204;
+    }
+
+    unsigned StandInServer::QueueReply(std::string_view const Body, std::string& OutText)
+    {
+        int Index = -1;
+        if (!ParseNumber(Trim(Body), Index) || Index < 0 || Index >= static_cast<int>(k_maxReplies))
+        {
+            OutText.assign("invalid index");
+            return 500;
+        }
+
+        std::scoped_lock StateLock(StateMutex);
+
+        if (!bConversation)
+        {
+            OutText.assign("conversation not started");
+            return 500;
+        }
+
+        QueuedReplies[static_cast<std::size_t>(Index)] = true;
+        return 204;
+    }
+
+    unsigned StandInServer::UpdateKeybinds(std::string_view Body, std::string& OutText)
+    {
+        std::array<std::string, k_maxReplies> Names{};
+        std::size_t Count = 0;
+
+        for (;;)
+        {
+            std::size_t const End = Body.find(';');
+            if (Count < k_maxReplies)
+                Names[Count].assign(Body.substr(0, End));
+            Count++;
+
+            if (End == std::string_view::npos)
+                break;
+            Body.remove_prefix(End + 1);
+        }
+
+        if (Count != k_maxReplies)
+        {
+            OutText.assign("invalid keybind count");
+            return 500;
+        }
+
+        std::scoped_lock StateLock(StateMutex);
+        Keybinds = std::move(Names);
+        return 204;
+    }
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Note that the loopback server only builds on POSIX hosts, it is not part of the game build.
+
+
+namespace ConvoSniffer::Loopback
+{
+    /// @brief      Minimal stand-in for the companion server, speaking its HTTP protocol on localhost.
+    /// @remarks    Implements @c /conversation , @c /conversation/replies , @c /conversation/replies/queue
+    ///             and @c /keybinds with the same validation as the real server, over keep-alive connections
+    ///             which may pipeline requests. Server stalls and restarts can be simulated at any time.
+    class StandInServer final
+    {
+    public:
+
+        struct Stats final
+        {
+            std::uint64_t   Requests{ 0 };
+            std::uint64_t   Rejected{ 0 };          // Requests answered with an error status.
+            std::uint64_t   Connections{ 0 };
+            std::uint64_t   Conversations{ 0 };
+        };
+
+        /// @param[in]  InPort - TCP port to listen on, or zero to pick any free one.
+        explicit StandInServer(int InPort);
+        StandInServer(StandInServer const&) = delete;
+        StandInServer& operator=(StandInServer const&) = delete;
+        ~StandInServer();
+
+        /// @brief      Whether the server is listening, see @ref GetLastError otherwise.
+        bool IsListening() const noexcept { return ListenSocket >= 0; }
+        int GetPort() const noexcept { return Port; }
+        std::string const& GetLastError() const noexcept { return LastError; }
+
+        /// @brief      Stops answering requests for a while, leaving connections open.
+        void Stall(std::chrono::milliseconds Duration);
+
+        /// @brief      Closes all open connections, as if the server restarted.
+        void DropConnections();
+
+        Stats GetStats();
+
+    private:
+
+        void AcceptMain();
+        void ServeMain(int Socket);
+        void WaitWhileStalled();
+        unsigned Handle(std::string_view Method, std::string_view Path, std::string_view Body, std::string& OutText);
+
+        unsigned StartConversation();
+        unsigned EndConversation();
+        unsigned UpdateReplies(std::string_view Body, std::string& OutText);
+        unsigned QueueReply(std::string_view Body, std::string& OutText);
+        unsigned UpdateKeybinds(std::string_view Body, std::string& OutText);
+
+        int                         Port;
+        int                         ListenSocket;
+        std::string                 LastError{};
+
+        std::thread                 AcceptThread{};
+        std::atomic_bool            bWantsExit{ false };
+        std::atomic<std::int64_t>   StallUntil{ 0 };        // Steady clock ticks.
+
+        std::mutex                  ConnectionMutex;
+        std::vector<int>            ConnectionSockets{};
+        std::vector<std::thread>    ConnectionThreads{};
+
+        std::mutex                  StateMutex;
+        bool                        bConversation{ false };
+        std::array<bool, 16>        QueuedReplies{};
+        std::array<std::string, 16> Keybinds{};
+        Stats                       Counters{};             // Guarded by @ref StateMutex .
+    };
+}
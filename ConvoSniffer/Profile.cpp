@@ -1,85 +1,181 @@
+#include <vector>
+
 #include "ConvoSniffer/Profile.hpp"
+#include "ConvoSniffer/Strings.hpp"
+#include "ConvoSniffer/World.hpp"
 
 namespace ConvoSniffer
 {
     bool gb_renderProfile = false;
 
-    void ProfileConversation(UCanvas* const Canvas, UBioConversation* const Conversation)
+    namespace
     {
-        int const Width = Canvas->SizeX;
-        //int const Height = Canvas->SizeY;
-
-        static float   s_profilePadding{ 40.f };
-        static float   s_profilePaddingSmall{ 10.f };
-        static FColor   s_profileColorMain{ 0xff, 0xff, 0xff, 0xff };
-        static FColor   s_profileColorEmphasis{ 0x00, 0xff, 0xff, 0xff };
-
-        Canvas->CurX = Canvas->CurY = s_profilePadding;
-        Canvas->DrawColor = s_profileColorMain;
-        Canvas->DrawTextScaled(FString::Printf(L"ConvoSniffer (LE1) profiler / build = %s", L"" __TIMESTAMP__), 1.f, 1.f);
-        Canvas->CurX = s_profilePadding;
-        Canvas->CurY += s_profilePaddingSmall;
-
-        Canvas->Draw2DLine(s_profilePadding, Canvas->CurY + s_profilePaddingSmall, Width - s_profilePadding, Canvas->CurY + s_profilePaddingSmall, s_profileColorMain);
-        Canvas->CurX = s_profilePadding;
-        Canvas->CurY += s_profilePadding;
-
-        Canvas->DrawTextScaled(FString::Printf(L"Need to display replies: %d",
-            (int)Conversation->NeedToDisplayReplies()), 1.f, 1.f);
-        Canvas->CurX = s_profilePadding;
-        Canvas->CurY += s_profilePaddingSmall;
-        Canvas->CurY += s_profilePaddingSmall;
-
-        Canvas->DrawTextScaled(L"Replies:", 1.f, 1.f);
-        Canvas->CurX = s_profilePadding;
-        Canvas->CurY += s_profilePaddingSmall;
-        Canvas->CurY += s_profilePaddingSmall;
-
-        int const   nCurrentEntry = Conversation->m_nCurrentEntry;
-        int         nReplyCount = 0;
-
-        if (nCurrentEntry >= 0 && nCurrentEntry < static_cast<int>(Conversation->m_EntryList.Count()))
+        float const     k_profilePadding{ 40.f };
+        float const     k_profilePaddingSmall{ 10.f };
+        FColor const    k_profileColorMain{ 0xff, 0xff, 0xff, 0xff };
+        FColor const    k_profileColorEmphasis{ 0x00, 0xff, 0xff, 0xff };
+
+        /// Lines drawn by the profiler, and the conversation state they were formatted from.
+        class ProfileCache final : public NonCopyable
         {
-            FBioDialogEntryNode const& CurrentEntry = Conversation->m_EntryList(nCurrentEntry);
-            for (int Index : Conversation->m_lstCurrentReplyIndices)
+        public:
+
+            /// Returns the world the given HUD belongs to, only looking it up again when the HUD changes.
+            ABioWorldInfo* ResolveWorld(ABioHUD* const BioHUD)
             {
-                if (Index == -1) continue;
-                FBioDialogReplyListDetails const& Details = CurrentEntry.ReplyListNew(Index);
+                return Worlds.Resolve(BioHUD);
+            }
 
-                LEASI_CHECKW(static_cast<UINT>(Details.nIndex) < Conversation->m_ReplyList.Count(), L"reply index out of bounds", L"");
-                FBioDialogReplyNode const& Reply = Conversation->m_ReplyList(Details.nIndex);
+            /// Rebuilds the lines if the conversation changed since they were formatted.
+            void Refresh(UBioConversation* const Conversation)
+            {
+                int const bNeedToDisplay = static_cast<int>(Conversation->NeedToDisplayReplies());
+
+                if (Conversation == CachedConversation && Conversation->m_nCurrentEntry == nCachedEntry
+                    && bNeedToDisplay == bCachedNeedToDisplay && !RepliesChanged(Conversation))
+                {
+                    return;
+                }
+
+                CachedConversation = Conversation;
+                nCachedEntry = Conversation->m_nCurrentEntry;
+                bCachedNeedToDisplay = bNeedToDisplay;
+
+                CachedIndices.clear();
+                for (int const Index : Conversation->m_lstCurrentReplyIndices)
+                    CachedIndices.push_back(Index);
+
+                NeedToDisplayLine = FString::Printf(L"Need to display replies: %d", bNeedToDisplay);
+                Lines.clear();
+                nReplyCount = 0;
+
+                if (nCachedEntry >= 0 && nCachedEntry < static_cast<int>(Conversation->m_EntryList.Count()))
+                {
+                    FBioDialogEntryNode const& CurrentEntry = Conversation->m_EntryList(nCachedEntry);
+                    for (int const Index : CachedIndices)
+                    {
+                        if (Index == -1) continue;
+                        FBioDialogReplyListDetails const& Details = CurrentEntry.ReplyListNew(Index);
+
+                        LEASI_CHECKW(static_cast<UINT>(Details.nIndex) < Conversation->m_ReplyList.Count(), L"reply index out of bounds", L"");
+                        FBioDialogReplyNode const& Reply = Conversation->m_ReplyList(Details.nIndex);
+
+                        if (Reply.bNonTextLine) continue;
+
+                        FString const&          ReplyParaphrase = g_stringCache.Find(Conversation, Details.srParaphrase).Text;
+                        FString const&          ReplyText = g_stringCache.Find(Conversation, Reply.srText).Text;
+                        EConvGUIStyles const    ReplyStyle = static_cast<EConvGUIStyles>(Reply.eGUIStyle);
+
+                        if (!ReplyText.Empty()) nReplyCount++;
+
+                        Line& Item = Lines.emplace_back();
+                        Item.Label = FString::Printf(L"Reply [%d]:", Index);
+                        Item.Detail = FString::Printf(L"Index = %d / Style = %s / Paraphrase = (%d) %s / Text = (%d) %s",
+                            Details.nIndex, GuiStyleToString(ReplyStyle), Details.srParaphrase, *ReplyParaphrase, Reply.srText, *ReplyText);
+                    }
+                }
+            }
 
-                if (Reply.bNonTextLine) continue;
+            void Draw(UCanvas* const Canvas) const
+            {
+                int const Width = Canvas->SizeX;
+
+                Canvas->CurX = Canvas->CurY = k_profilePadding;
+                Canvas->DrawColor = k_profileColorMain;
+                Canvas->DrawTextScaled(TitleLine, 1.f, 1.f);
+                Canvas->CurX = k_profilePadding;
+                Canvas->CurY += k_profilePaddingSmall;
+
+                Canvas->Draw2DLine(k_profilePadding, Canvas->CurY + k_profilePaddingSmall, Width - k_profilePadding, Canvas->CurY + k_profilePaddingSmall, k_profileColorMain);
+                Canvas->CurX = k_profilePadding;
+                Canvas->CurY += k_profilePadding;
+
+                Canvas->DrawTextScaled(NeedToDisplayLine, 1.f, 1.f);
+                Canvas->CurX = k_profilePadding;
+                Canvas->CurY += k_profilePaddingSmall;
+                Canvas->CurY += k_profilePaddingSmall;
+
+                Canvas->DrawTextScaled(L"Replies:", 1.f, 1.f);
+                Canvas->CurX = k_profilePadding;
+                Canvas->CurY += k_profilePaddingSmall;
+                Canvas->CurY += k_profilePaddingSmall;
+
+                for (Line const& Item : Lines)
+                {
+                    Canvas->CurX = k_profilePadding;
+                    Canvas->DrawColor = k_profileColorMain;
+                    Canvas->DrawTextScaled(Item.Label, 1.f, 1.f);
+
+                    Canvas->CurX = 100;
+                    Canvas->DrawColor = k_profileColorEmphasis;
+                    Canvas->DrawTextScaled(Item.Detail, 1.f, 1.f);
+
+                    Canvas->CurY += k_profilePaddingSmall;
+                }
+
+                if (nReplyCount <= 0)
+                {
+                    Canvas->DrawColor = k_profileColorEmphasis;
+
+                    Canvas->DrawTextScaled(L"No valid replies...", 1.f, 1.f);
+                    Canvas->CurX = k_profilePadding;
+                    Canvas->CurY += k_profilePaddingSmall;
+
+                    Canvas->DrawColor = k_profileColorMain;
+                }
+            }
 
-                FString const           ReplyParaphrase = Conversation->GetStringInfo(Details.srParaphrase).sText;
-                FString const           ReplyText = Conversation->GetStringInfo(Reply.srText).sText;
-                EConvGUIStyles const    ReplyStyle = static_cast<EConvGUIStyles>(Reply.eGUIStyle);
+        private:
 
-                if (!ReplyText.Empty()) nReplyCount++;
+            struct Line final
+            {
+                FString     Label;
+                FString     Detail;
+            };
 
-                Canvas->CurX = s_profilePadding;
-                Canvas->DrawColor = s_profileColorMain;
-                Canvas->DrawTextScaled(FString::Printf(L"Reply [%d]:", Index), 1.f, 1.f);
+            bool RepliesChanged(UBioConversation* const Conversation) const
+            {
+                if (Conversation->m_lstCurrentReplyIndices.Count() != CachedIndices.size())
+                    return true;
 
-                Canvas->CurX = 100;
-                Canvas->DrawColor = s_profileColorEmphasis;
-                Canvas->DrawTextScaled(FString::Printf(L"Index = %d / Style = %s / Paraphrase = (%d) %s / Text = (%d) %s",
-                    Details.nIndex, GuiStyleToString(ReplyStyle), Details.srParaphrase, *ReplyParaphrase, Reply.srText, *ReplyText), 1.f, 1.f);
+                for (UINT i = 0; i < Conversation->m_lstCurrentReplyIndices.Count(); ++i)
+                {
+                    if (Conversation->m_lstCurrentReplyIndices(i) != CachedIndices[i])
+                        return true;
+                }
 
-                Canvas->CurY += s_profilePaddingSmall;
+                return false;
             }
-        }
 
-        if (nReplyCount <= 0)
-        {
-            Canvas->DrawColor = s_profileColorEmphasis;
+            WorldCache          Worlds{};
+
+            UBioConversation*   CachedConversation{ nullptr };
+            int                 nCachedEntry{ -1 };
+            int                 bCachedNeedToDisplay{ -1 };
+            std::vector<int>    CachedIndices{};
+
+            FString             TitleLine{ FString::Printf(L"ConvoSniffer (LE1) profiler / build = %s", L"" __TIMESTAMP__) };
+            FString             NeedToDisplayLine{};
+            std::vector<Line>   Lines{};
+            int                 nReplyCount{ 0 };
+        };
+    }
+
+    void ProfileConversation(ABioHUD* const BioHUD)
+    {
+        static ProfileCache s_profileCache{};
+
+        UCanvas* const Canvas = BioHUD->Canvas;
+        if (Canvas == nullptr) return;
+
+        ABioWorldInfo* const BioWorldInfo = s_profileCache.ResolveWorld(BioHUD);
+        if (BioWorldInfo == nullptr) return;
 
-            Canvas->DrawTextScaled(L"No valid replies...", 1.f, 1.f);
-            Canvas->CurX = s_profilePadding;
-            Canvas->CurY += s_profilePaddingSmall;
+        UBioConversation* const Conversation = BioWorldInfo->m_oCurrentConversation;
+        if (Conversation == nullptr) return;
 
-            Canvas->DrawColor = s_profileColorMain;
-        }
+        s_profileCache.Refresh(Conversation);
+        s_profileCache.Draw(Canvas);
     }
 
 }
@@ -59,7 +59,8 @@ namespace ConvoSniffer
 
     extern bool gb_renderProfile;
 
-    /// Renders profiling HUD for the given @c Conversation onto the given @c Canvas instance.
-    void ProfileConversation(UCanvas* Canvas, UBioConversation* Conversation);
+    /// Renders profiling HUD for the current conversation, if any, onto the canvas of the given @c BioHUD instance.
+    /// Formatted lines are cached, and only rebuilt when the conversation moves to another entry or reply set.
+    void ProfileConversation(ABioHUD* BioHUD);
 
 }
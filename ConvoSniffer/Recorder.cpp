@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+
+#include "ConvoSniffer/Recorder.hpp"
+
+
+namespace
+{
+    constexpr std::size_t k_recordHeaderSize = 9;
+
+    void StoreU32(unsigned char* const OutBytes, std::uint32_t const InValue)
+    {
+        for (int i = 0; i < 4; ++i)
+            OutBytes[i] = static_cast<unsigned char>(InValue >> (8 * i));
+    }
+
+    std::uint32_t LoadU32(unsigned char const* const InBytes)
+    {
+        std::uint32_t Value = 0;
+        for (int i = 0; i < 4; ++i)
+            Value |= static_cast<std::uint32_t>(InBytes[i]) << (8 * i);
+        return Value;
+    }
+
+    std::FILE* OpenFile(std::filesystem::path const& InPath, bool const bInWrite)
+    {
+#ifdef _WIN32
+        return ::_wfopen(InPath.c_str(), bInWrite ? L"wb" : L"rb");
+#else
+        return std::fopen(InPath.c_str(), bInWrite ? "wb" : "rb");
+#endif
+    }
+}
+
+namespace ConvoSniffer
+{
+    SessionRequest GetSessionRequest(SessionEvent const InEvent) noexcept
+    {
+        switch (InEvent)
+        {
+        case SessionEvent::Keybinds: return { "PUT", "/keybinds", true };
+        case SessionEvent::Start: return { "POST", "/conversation", false };
+        case SessionEvent::End: return { "DELETE", "/conversation", false };
+        case SessionEvent::Replies: return { "PUT", "/conversation/replies", true };
+        case SessionEvent::Queue: return { "POST", "/conversation/replies/queue", false };
+        default: return { nullptr, nullptr, false };
+        }
+    }
+
+
+    // ! SessionRecorder implementation.
+    // ========================================
+
+    SessionRecorder::~SessionRecorder() noexcept
+    {
+        Stop();
+    }
+
+    bool SessionRecorder::Start(std::filesystem::path const& InPath)
+    {
+        Stop();
+
+        File = OpenFile(InPath, true);
+        if (File == nullptr)
+        {
+            LastError.assign("failed to open recording: ").append(std::strerror(errno));
+            return false;
+        }
+
+        // Events come in bursts of a few small writes, let the C runtime batch them.
+        std::setvbuf(File, nullptr, _IOFBF, 64 * 1024);
+        std::fwrite(k_sessionMagic, 1, sizeof k_sessionMagic, File);
+
+        LastRecord = std::chrono::steady_clock::now();
+        Records = 0;
+        LastError.clear();
+        return true;
+    }
+
+    void SessionRecorder::Stop()
+    {
+        if (File != nullptr)
+        {
+            if (std::fclose(File) != 0)
+                LastError.assign("failed to close recording: ").append(std::strerror(errno));
+            File = nullptr;
+        }
+    }
+
+    void SessionRecorder::Record(SessionEvent const InEvent, std::string_view const InPayload)
+    {
+        if (File == nullptr)
+            return;
+
+        auto const Now = std::chrono::steady_clock::now();
+        auto const Delay = std::chrono::duration_cast<std::chrono::microseconds>(Now - LastRecord).count();
+        LastRecord = Now;
+
+        unsigned char Header[k_recordHeaderSize];
+        StoreU32(Header, static_cast<std::uint32_t>((std::min<std::int64_t>)(Delay, UINT32_MAX)));
+        Header[4] = static_cast<unsigned char>(InEvent);
+        StoreU32(Header + 5, static_cast<std::uint32_t>(InPayload.size()));
+
+        if (std::fwrite(Header, 1, sizeof Header, File) != sizeof Header
+            || std::fwrite(InPayload.data(), 1, InPayload.size(), File) != InPayload.size())
+        {
+            LastError.assign("failed to write recording: ").append(std::strerror(errno));
+            Stop();
+            return;
+        }
+
+        Records++;
+
+        // Keep whole conversations on disk, should the game go away before the recording is stopped.
+        if (InEvent == SessionEvent::End)
+            std::fflush(File);
+    }
+
+
+    // ! SessionReader implementation.
+    // ========================================
+
+    SessionReader::SessionReader(std::filesystem::path const& InPath)
+    {
+        File = OpenFile(InPath, false);
+        if (File == nullptr)
+        {
+            LastError.assign("failed to open recording: ").append(std::strerror(errno));
+            return;
+        }
+
+        char Magic[sizeof k_sessionMagic]{};
+        if (std::fread(Magic, 1, sizeof Magic, File) != sizeof Magic || std::memcmp(Magic, k_sessionMagic, sizeof Magic) != 0)
+        {
+            LastError.assign("not a recording, or recorded with another version");
+            std::fclose(std::exchange(File, nullptr));
+        }
+    }
+
+    SessionReader::~SessionReader() noexcept
+    {
+        if (File != nullptr)
+            std::fclose(File);
+    }
+
+    bool SessionReader::Next(Record& OutRecord)
+    {
+        if (File == nullptr)
+            return false;
+
+        unsigned char Header[k_recordHeaderSize];
+        std::size_t const Read = std::fread(Header, 1, sizeof Header, File);
+        if (Read != sizeof Header)
+        {
+            if (Read != 0)
+                LastError.assign("truncated record header");
+            return false;
+        }
+
+        std::uint32_t const Size = LoadU32(Header + 5);
+        if (Size > k_sessionMaxPayload)
+        {
+            LastError.assign("record payload too large: ").append(std::to_string(Size));
+            return false;
+        }
+
+        OutRecord.Payload.resize(Size);
+        if (std::fread(OutRecord.Payload.data(), 1, Size, File) != Size)
+        {
+            LastError.assign("truncated record payload");
+            return false;
+        }
+
+        Offset += std::chrono::microseconds(LoadU32(Header));
+        OutRecord.Offset = Offset;
+        OutRecord.Event = static_cast<SessionEvent>(Header[4]);
+        return true;
+    }
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+// Note that this header intentionally does not depend on LESDK, so that recordings can be replayed
+// outside of the game, see the Loopback folder.
+
+
+namespace ConvoSniffer
+{
+    /// @brief      Outbound client events, each replayed as the HTTP request it would have been sent as.
+    enum class SessionEvent : std::uint8_t
+    {
+        Keybinds = 1,   // PUT /keybinds, payload is the request body.
+        Start = 2,      // POST /conversation, no payload.
+        End = 3,        // DELETE /conversation, no payload.
+        Replies = 4,    // PUT /conversation/replies, payload is the request body.
+        Queue = 5,      // POST /conversation/replies/queue, payload is the request body.
+    };
+
+    /// @brief      Method, path and whether the request coalesces, for the request an event is sent as.
+    struct SessionRequest final
+    {
+        char const*     Method;
+        char const*     Path;
+        bool            bCoalesce;
+    };
+
+    /// @return     Request the given event is sent as, with null method and path for unknown events.
+    SessionRequest GetSessionRequest(SessionEvent InEvent) noexcept;
+
+    /// @brief      Appends outbound client events with their timing to a compact binary file.
+    /// @remarks    The file starts with @ref k_sessionMagic , followed by records made of a 4-byte delay since
+    ///             the previous record in microseconds, a 1-byte @ref SessionEvent , a 4-byte payload size
+    ///             and the payload, all integers little-endian.
+    class SessionRecorder final
+    {
+    public:
+
+        SessionRecorder() = default;
+        SessionRecorder(SessionRecorder const&) = delete;
+        SessionRecorder& operator=(SessionRecorder const&) = delete;
+        ~SessionRecorder() noexcept;
+
+        /// @brief      Starts recording into the given file, replacing it.
+        /// @return     Whether the file could be opened, see @ref GetLastError otherwise.
+        bool Start(std::filesystem::path const& InPath);
+
+        /// @brief      Flushes and closes the recording, if any.
+        void Stop();
+
+        bool IsRecording() const noexcept { return File != nullptr; }
+        std::uint64_t GetRecordCount() const noexcept { return Records; }
+        std::string const& GetLastError() const noexcept { return LastError; }
+
+        /// @brief      Appends an event, timed from the previous one.
+        void Record(SessionEvent InEvent, std::string_view InPayload = {});
+
+    private:
+
+        std::FILE*                              File{ nullptr };
+        std::chrono::steady_clock::time_point   LastRecord{};
+        std::uint64_t                           Records{ 0 };
+        std::string                             LastError{};
+    };
+
+    /// @brief      Reads back events written by @ref SessionRecorder .
+    class SessionReader final
+    {
+    public:
+
+        struct Record final
+        {
+            std::chrono::microseconds   Offset{ 0 };        // Since the start of the recording.
+            SessionEvent                Event{};
+            std::string                 Payload{};
+        };
+
+        explicit SessionReader(std::filesystem::path const& InPath);
+        SessionReader(SessionReader const&) = delete;
+        SessionReader& operator=(SessionReader const&) = delete;
+        ~SessionReader() noexcept;
+
+        bool IsOpen() const noexcept { return File != nullptr; }
+        std::string const& GetLastError() const noexcept { return LastError; }
+
+        /// @brief      Reads the next record, reusing the payload storage of @c OutRecord .
+        /// @return     Whether a record was read, @ref GetLastError is empty at the end of a valid file.
+        bool Next(Record& OutRecord);
+
+    private:
+
+        std::FILE*                  File{ nullptr };
+        std::chrono::microseconds   Offset{ 0 };
+        std::string                 LastError{};
+    };
+
+    // Leading bytes of a recording, the last one is the format version.
+    static constexpr char k_sessionMagic[8] = { 'C', 'N', 'V', 'S', 'R', 'E', 'C', 1 };
+
+    // Upper bound of a single payload, anything larger means a corrupt recording.
+    static constexpr std::uint32_t k_sessionMaxPayload = 16u << 20;
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+// Note that this header intentionally does not depend on LESDK, like the transports.
+
+
+namespace ConvoSniffer
+{
+    /// @brief      Bounded lock-free queue between exactly one producer thread and one consumer thread.
+    /// @tparam     T - Element type, which must be default-constructible and movable.
+    /// @tparam     N - Capacity, which must be a power of two.
+    /// @remarks    Elements stay constructed in their slots, so that moved-from strings keep their storage
+    ///             and neither side allocates once the ring has warmed up.
+    template<typename T, std::size_t N>
+    class SpscRing final
+    {
+        static_assert(N >= 2 && (N & (N - 1)) == 0, "capacity must be a power of two");
+
+        static constexpr std::size_t k_cacheLine = 64;
+
+        // Indices only ever increase, and are reduced modulo the capacity when accessing slots.
+        // Each is padded onto its own cache line, so that both sides don't invalidate each other.
+        std::atomic<std::size_t>    Head{ 0 };              // Next slot to pop, written by the consumer.
+        char                        HeadPadding[k_cacheLine - sizeof(std::atomic<std::size_t>)]{};
+        std::atomic<std::size_t>    Tail{ 0 };              // Next slot to push, written by the producer.
+        char                        TailPadding[k_cacheLine - sizeof(std::atomic<std::size_t>)]{};
+
+        std::size_t                 CachedHead{ 0 };        // Producer's last view of @ref Head .
+        char                        CachedHeadPadding[k_cacheLine - sizeof(std::size_t)]{};
+        std::size_t                 CachedTail{ 0 };        // Consumer's last view of @ref Tail .
+
+        std::array<T, N>            Slots{};
+
+    public:
+
+        static constexpr std::size_t Capacity = N;
+
+        SpscRing() = default;
+        SpscRing(SpscRing const&) = delete;
+        SpscRing& operator=(SpscRing const&) = delete;
+
+        /// @brief      Moves an element into the ring, only called by the producer.
+        /// @param[in,out] InItem - Element to push, which receives what an earlier @ref TryPop left in the slot.
+        /// @return     Whether there was room, @c InItem is left untouched otherwise.
+        bool TryPush(T& InItem)
+        {
+            std::size_t const Position = Tail.load(std::memory_order_relaxed);
+
+            if (Position - CachedHead == N)
+            {
+                CachedHead = Head.load(std::memory_order_acquire);
+                if (Position - CachedHead == N)
+                    return false;
+            }
+
+            std::swap(Slots[Position & (N - 1)], InItem);
+            Tail.store(Position + 1, std::memory_order_release);
+            return true;
+        }
+
+        /// @brief      Moves the oldest element out of the ring, only called by the consumer.
+        /// @param[out] OutItem - Receives the element, and gives its previous contents to the slot.
+        /// @return     Whether there was an element.
+        bool TryPop(T& OutItem)
+        {
+            std::size_t const Position = Head.load(std::memory_order_relaxed);
+
+            if (Position == CachedTail)
+            {
+                CachedTail = Tail.load(std::memory_order_acquire);
+                if (Position == CachedTail)
+                    return false;
+            }
+
+            std::swap(OutItem, Slots[Position & (N - 1)]);
+            Head.store(Position + 1, std::memory_order_release);
+            return true;
+        }
+
+        /// @brief      Number of elements, which may already be outdated when used by either side.
+        std::size_t SizeApprox() const noexcept
+        {
+            return Tail.load(std::memory_order_acquire) - Head.load(std::memory_order_acquire);
+        }
+
+        /// @brief      Position of the producer, which only ever grows, for waiting on new elements.
+        std::atomic<std::size_t> const& GetTail() const noexcept { return Tail; }
+    };
+}
@@ -0,0 +1,69 @@
+#include <algorithm>
+#include <bit>
+
+#include "ConvoSniffer/Stats.hpp"
+
+
+namespace ConvoSniffer
+{
+    // ! LatencyHistogram implementation.
+    // ========================================
+
+    void LatencyHistogram::Record(std::chrono::nanoseconds const InLatency) noexcept
+    {
+        std::int64_t const Nanoseconds = (std::max)(InLatency.count(), std::int64_t{ 0 });
+        std::size_t const Bucket = (std::min)(static_cast<std::size_t>(std::bit_width(static_cast<std::uint64_t>(Nanoseconds))), k_bucketCount - 1);
+
+        Buckets[Bucket].fetch_add(1, std::memory_order_relaxed);
+        TotalNs.fetch_add(Nanoseconds, std::memory_order_relaxed);
+
+        std::int64_t Max = MaxNs.load(std::memory_order_relaxed);
+        while (Nanoseconds > Max && !MaxNs.compare_exchange_weak(Max, Nanoseconds, std::memory_order_relaxed)) {}
+    }
+
+    LatencyHistogram::Snapshot LatencyHistogram::GetSnapshot() const noexcept
+    {
+        Snapshot Result{};
+
+        for (std::size_t i = 0; i < k_bucketCount; ++i)
+        {
+            Result.Buckets[i] = Buckets[i].load(std::memory_order_relaxed);
+            Result.Count += Result.Buckets[i];
+        }
+
+        Result.Total = std::chrono::nanoseconds(TotalNs.load(std::memory_order_relaxed));
+        Result.Max = std::chrono::nanoseconds(MaxNs.load(std::memory_order_relaxed));
+        return Result;
+    }
+
+    std::chrono::nanoseconds LatencyHistogram::Snapshot::GetQuantile(double const InQuantile) const noexcept
+    {
+        if (Count == 0)
+            return std::chrono::nanoseconds{ 0 };
+
+        // Rank of the sample, counting from one.
+        auto const Rank = (std::max)(std::uint64_t{ 1 }, static_cast<std::uint64_t>(InQuantile * static_cast<double>(Count) + 0.5));
+
+        std::uint64_t Seen = 0;
+        for (std::size_t i = 0; i < k_bucketCount; ++i)
+        {
+            Seen += Buckets[i];
+            if (Seen >= Rank)
+            {
+                if (i == 0 || i == k_bucketCount - 1)
+                    return i == 0 ? std::chrono::nanoseconds{ 0 } : Max;
+                return (std::min)(std::chrono::nanoseconds(std::int64_t{ 1 } << i), Max);
+            }
+        }
+
+        return Max;
+    }
+
+    std::chrono::nanoseconds LatencyHistogram::Snapshot::GetMean() const noexcept
+    {
+        if (Count == 0)
+            return std::chrono::nanoseconds{ 0 };
+
+        return Total / static_cast<std::int64_t>(Count);
+    }
+}
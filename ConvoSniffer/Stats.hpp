@@ -0,0 +1,49 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+// Note that this header intentionally does not depend on LESDK, like the transports.
+
+
+namespace ConvoSniffer
+{
+    /// @brief      Latency histogram with power-of-two buckets, cheap enough to record every request into.
+    /// @remarks    Recording takes a few relaxed atomic operations, so a worker thread may record while
+    ///             the game thread reads. A snapshot may miss samples recorded while it is taken.
+    class LatencyHistogram final
+    {
+    public:
+
+        // Bucket zero holds samples of zero, bucket i those in [2^(i-1), 2^i) ns, the last one anything longer.
+        static constexpr std::size_t k_bucketCount = 36;
+
+        struct Snapshot final
+        {
+            std::array<std::uint64_t, k_bucketCount> Buckets{};
+            std::uint64_t               Count{ 0 };
+            std::chrono::nanoseconds    Total{ 0 };
+            std::chrono::nanoseconds    Max{ 0 };
+
+            /// @brief      Upper bound of the bucket holding the given quantile, clamped to @ref Max .
+            std::chrono::nanoseconds GetQuantile(double InQuantile) const noexcept;
+            std::chrono::nanoseconds GetMean() const noexcept;
+        };
+
+        LatencyHistogram() = default;
+        LatencyHistogram(LatencyHistogram const&) = delete;
+        LatencyHistogram& operator=(LatencyHistogram const&) = delete;
+
+        void Record(std::chrono::nanoseconds InLatency) noexcept;
+        Snapshot GetSnapshot() const noexcept;
+
+    private:
+
+        std::array<std::atomic<std::uint64_t>, k_bucketCount> Buckets{};
+        std::atomic<std::int64_t>   TotalNs{ 0 };
+        std::atomic<std::int64_t>   MaxNs{ 0 };
+    };
+}
@@ -0,0 +1,73 @@
+#include <algorithm>
+
+#include "ConvoSniffer/Client.hpp"
+#include "ConvoSniffer/Strings.hpp"
+
+
+namespace ConvoSniffer
+{
+    StringCache g_stringCache{};
+
+
+    // ! StringCache implementation.
+    // ========================================
+
+    StringCache::Entry const& StringCache::Find(UBioConversation* const InConversation, int const StrRef)
+    {
+        Counters.Lookups++;
+
+        auto const [Iter, bInserted] = Entries.try_emplace(StrRef);
+        Entry& Item = Iter->second;
+
+        if (bInserted)
+        {
+            Counters.Misses++;
+            Counters.Entries = Entries.size();
+
+            Item.Text = InConversation->GetStringInfo(StrRef).sText;
+            Item.bUtf8Valid = StringToUtf8(Item.Text, Item.Utf8);
+            if (!Item.bUtf8Valid)
+                Item.Utf8.clear();
+
+            Canaries[nCanaries++ % k_stringCacheCanaries] = StrRef;
+        }
+
+        return Item;
+    }
+
+    void StringCache::Validate(UBioConversation* const InConversation)
+    {
+        if (Entries.size() > k_stringCacheCapacity)
+        {
+            LEASI_DEBUG(L"string cache flushed at {} entries", Entries.size());
+            Flush();
+            return;
+        }
+
+        // Strings of a changed language or TLK show up as soon as any of them is resolved again.
+        std::size_t const Count = (std::min)(nCanaries, k_stringCacheCanaries);
+        for (std::size_t i = 0; i < Count; ++i)
+        {
+            auto const Iter = Entries.find(Canaries[i]);
+            if (Iter == Entries.end())
+                continue;
+
+            FString const Text = InConversation->GetStringInfo(Canaries[i]).sText;
+            if (!Text.Equals(Iter->second.Text))
+            {
+                LEASI_INFO(L"string cache flushed, string {} changed to: {}", Canaries[i], *Text);
+                Flush();
+                return;
+            }
+        }
+    }
+
+    void StringCache::Flush()
+    {
+        Entries.clear();
+        nCanaries = 0;
+
+        Counters.Flushes++;
+        Counters.Entries = 0;
+    }
+}
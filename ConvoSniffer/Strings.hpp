@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+#include <LESDK/Headers.hpp>
+#include "Common/Base.hpp"
+
+
+namespace ConvoSniffer
+{
+    // Number of cached strings above which the cache is flushed when the next conversation starts.
+    static constexpr std::size_t k_stringCacheCapacity = 4096;
+
+    // Number of recently resolved strings checked against the TLK when a conversation starts.
+    static constexpr std::size_t k_stringCacheCanaries = 4;
+
+    /// @brief      Cache of TLK strings resolved through @c UBioConversation::GetStringInfo , keyed by string ref,
+    ///             together with their UTF-8 encoding for the companion server.
+    /// @remarks    Entries stay put while a conversation is in progress, so that pointers to them may be kept
+    ///             until the next conversation starts. Only then the cache is flushed, if it grew past
+    ///             @ref k_stringCacheCapacity , or if some recently resolved strings no longer match the TLK,
+    ///             i.e. the language changed or a TLK was (un)loaded.
+    /// @remarks    Only used from the game thread.
+    class StringCache final : public NonCopyable
+    {
+    public:
+
+        struct Entry final
+        {
+            FString             Text{};
+            std::string         Utf8{};
+            bool                bUtf8Valid{ false };        // Whether @c Text converted to UTF-8, @c Utf8 is empty otherwise.
+        };
+
+        struct Stats final
+        {
+            std::uint64_t       Lookups{ 0 };
+            std::uint64_t       Misses{ 0 };                // Lookups which resolved the string through the engine.
+            std::uint64_t       Flushes{ 0 };
+            std::uint64_t       Entries{ 0 };
+        };
+
+        /// @brief      Finds a string, resolving and encoding it on first use.
+        /// @param[in]  InConversation - Conversation to resolve the string through on a miss.
+        /// @param[in]  StrRef - TLK string ref, e.g. @c FBioDialogReplyNode::srText .
+        /// @return     Cached entry, which stays valid until the next call to @ref Validate or @ref Flush .
+        Entry const& Find(UBioConversation* InConversation, int StrRef);
+
+        /// @brief      Flushes the cache if it grew too large or went stale, called whenever a conversation starts.
+        void Validate(UBioConversation* InConversation);
+
+        /// @brief      Drops all cached strings.
+        void Flush();
+
+        Stats GetStats() const noexcept { return Counters; }
+
+    private:
+
+        std::unordered_map<int, Entry>  Entries{};
+        int                             Canaries[k_stringCacheCanaries]{};  // Most recently resolved string refs.
+        std::size_t                     nCanaries{ 0 };                     // Number of refs ever put into @ref Canaries .
+
+        Stats                           Counters{};
+    };
+
+    extern StringCache g_stringCache;
+}
@@ -0,0 +1,976 @@
+#if defined(_WIN32)
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+    #include <Windows.h>
+    #include <wininet.h>
+#else
+    #include <cerrno>
+    #include <netdb.h>
+    #include <netinet/in.h>
+    #include <netinet/tcp.h>
+    #include <sys/select.h>
+    #include <sys/socket.h>
+    #include <sys/time.h>
+    #include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <iterator>
+#include <mutex>
+#include <random>
+#include <utility>
+
+#include "ConvoSniffer/Transport.hpp"
+
+
+namespace
+{
+#if defined(_WIN32)
+    using SocketHandle = SOCKET;
+    constexpr std::intptr_t k_invalidSocket = static_cast<std::intptr_t>(INVALID_SOCKET);
+
+    constexpr int k_sendFlags = 0;
+
+    int GetSocketError() { return ::WSAGetLastError(); }
+    void CloseSocket(SocketHandle const Handle) { ::closesocket(Handle); }
+
+    bool InitializeSockets()
+    {
+        static std::once_flag s_once{};
+        static bool s_bInitialized = false;
+
+        std::call_once(s_once, []() -> void
+            {
+                WSADATA Data{};
+                s_bInitialized = ::WSAStartup(MAKEWORD(2, 2), &Data) == 0;
+            });
+
+        return s_bInitialized;
+    }
+#else
+    using SocketHandle = int;
+    constexpr std::intptr_t k_invalidSocket = -1;
+    constexpr int k_sendFlags = MSG_NOSIGNAL;   // Report a closed peer as an error instead of raising SIGPIPE.
+
+    int GetSocketError() { return errno; }
+    void CloseSocket(SocketHandle const Handle) { ::close(Handle); }
+    bool InitializeSockets() { return true; }
+#endif
+
+    /// Opens a blocking TCP connection with send / receive timeouts, returns the failed stage or @c nullptr .
+    char const* OpenSocket(std::string const& Host, int const Port, int const TimeoutMs, std::intptr_t& OutSocket)
+    {
+        if (!InitializeSockets())
+            return "startup";
+
+        addrinfo Hints{};
+        Hints.ai_family = AF_UNSPEC;
+        Hints.ai_socktype = SOCK_STREAM;
+        Hints.ai_protocol = IPPROTO_TCP;
+
+        addrinfo* Addresses = nullptr;
+        std::string const Service = std::to_string(Port);
+        if (::getaddrinfo(Host.c_str(), Service.c_str(), &Hints, &Addresses) != 0)
+            return "resolve";
+
+        SocketHandle Handle{};
+        bool bConnected = false;
+
+        for (addrinfo* Address = Addresses; Address != nullptr && !bConnected; Address = Address->ai_next)
+        {
+            Handle = ::socket(Address->ai_family, Address->ai_socktype, Address->ai_protocol);
+            if (static_cast<std::intptr_t>(Handle) == k_invalidSocket)
+                continue;
+
+            bConnected = ::connect(Handle, Address->ai_addr, static_cast<int>(Address->ai_addrlen)) == 0;
+            if (!bConnected)
+                CloseSocket(Handle);
+        }
+
+        ::freeaddrinfo(Addresses);
+
+        if (!bConnected)
+            return "connect";
+
+        // Requests are small and latency sensitive, don't let Nagle hold them back.
+        int const NoDelay = 1;
+        ::setsockopt(Handle, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<char const*>(&NoDelay), sizeof NoDelay);
+
+#if defined(_WIN32)
+        DWORD const Timeout = static_cast<DWORD>(TimeoutMs);
+#else
+        timeval const Timeout{ TimeoutMs / 1000, (TimeoutMs % 1000) * 1000 };
+#endif
+        ::setsockopt(Handle, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<char const*>(&Timeout), sizeof Timeout);
+        ::setsockopt(Handle, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<char const*>(&Timeout), sizeof Timeout);
+
+        OutSocket = static_cast<std::intptr_t>(Handle);
+        return nullptr;
+    }
+
+    /// Writes all of the given data, returns false if the socket failed.
+    bool SendAllBytes(std::intptr_t const Socket, std::string_view Data)
+    {
+        while (!Data.empty())
+        {
+            int const Chunk = static_cast<int>((std::min)(Data.size(), std::size_t{ 1 } << 20));
+            auto const Sent = ::send(static_cast<SocketHandle>(Socket), Data.data(), Chunk, k_sendFlags);
+
+            if (Sent <= 0)
+                return false;
+
+            Data.remove_prefix(static_cast<std::size_t>(Sent));
+        }
+
+        return true;
+    }
+
+    /// Appends up to 4 KiB read from the socket, returns the recv result.
+    long long ReceiveSome(std::intptr_t const Socket, std::string& Buffer)
+    {
+        std::size_t const Previous = Buffer.size();
+        Buffer.resize(Previous + 4096);
+
+        auto const Read = ::recv(static_cast<SocketHandle>(Socket), Buffer.data() + Previous, 4096, 0);
+        Buffer.resize(Previous + (Read > 0 ? static_cast<std::size_t>(Read) : 0));
+        return static_cast<long long>(Read);
+    }
+
+    /// Checks whether the socket has data to read (or has been closed) without blocking.
+    int IsReadable(std::intptr_t const Socket)
+    {
+        auto const Handle = static_cast<SocketHandle>(Socket);
+
+        fd_set ReadSet{};
+        FD_ZERO(&ReadSet);
+        FD_SET(Handle, &ReadSet);
+
+        timeval Zero{};
+        return ::select(static_cast<int>(Handle + 1), &ReadSet, nullptr, nullptr, &Zero);
+    }
+
+    /// Calculates the SHA-1 digest of the given data, only used for the WebSocket handshake.
+    std::array<unsigned char, 20> Sha1(std::string_view const Data)
+    {
+        std::uint32_t H[5] = { 0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0 };
+        auto const Rotate = [](std::uint32_t const Value, int const Bits) -> std::uint32_t { return (Value << Bits) | (Value >> (32 - Bits)); };
+
+        std::string Message{ Data };
+        Message.push_back(static_cast<char>(0x80));
+        while (Message.size() % 64 != 56)
+            Message.push_back('\0');
+
+        std::uint64_t const BitLength = static_cast<std::uint64_t>(Data.size()) * 8;
+        for (int Shift = 56; Shift >= 0; Shift -= 8)
+            Message.push_back(static_cast<char>((BitLength >> Shift) & 0xFF));
+
+        for (std::size_t Block = 0; Block < Message.size(); Block += 64)
+        {
+            std::uint32_t W[80];
+            for (int i = 0; i < 16; ++i)
+            {
+                auto const Byte = [&](int const j) -> std::uint32_t { return static_cast<unsigned char>(Message[Block + i * 4 + j]); };
+                W[i] = (Byte(0) << 24) | (Byte(1) << 16) | (Byte(2) << 8) | Byte(3);
+            }
+            for (int i = 16; i < 80; ++i)
+                W[i] = Rotate(W[i - 3] ^ W[i - 8] ^ W[i - 14] ^ W[i - 16], 1);
+
+            std::uint32_t A = H[0], B = H[1], C = H[2], D = H[3], E = H[4];
+            for (int i = 0; i < 80; ++i)
+            {
+                std::uint32_t F, K;
+                if (i < 20)      { F = (B & C) | (~B & D);          K = 0x5A827999; }
+                else if (i < 40) { F = B ^ C ^ D;                   K = 0x6ED9EBA1; }
+                else if (i < 60) { F = (B & C) | (B & D) | (C & D); K = 0x8F1BBCDC; }
+                else             { F = B ^ C ^ D;                   K = 0xCA62C1D6; }
+
+                std::uint32_t const Temp = Rotate(A, 5) + F + E + K + W[i];
+                E = D; D = C; C = Rotate(B, 30); B = A; A = Temp;
+            }
+
+            H[0] += A; H[1] += B; H[2] += C; H[3] += D; H[4] += E;
+        }
+
+        std::array<unsigned char, 20> Digest{};
+        for (std::size_t i = 0; i < Digest.size(); ++i)
+            Digest[i] = static_cast<unsigned char>(H[i / 4] >> (24 - 8 * (i % 4)));
+        return Digest;
+    }
+
+    std::string Base64(std::span<unsigned char const> const Data)
+    {
+        static constexpr char k_alphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+        std::string Result{};
+        for (std::size_t i = 0; i < Data.size(); i += 3)
+        {
+            std::uint32_t Group = static_cast<std::uint32_t>(Data[i]) << 16;
+            if (i + 1 < Data.size()) Group |= static_cast<std::uint32_t>(Data[i + 1]) << 8;
+            if (i + 2 < Data.size()) Group |= static_cast<std::uint32_t>(Data[i + 2]);
+
+            Result.push_back(k_alphabet[(Group >> 18) & 0x3F]);
+            Result.push_back(k_alphabet[(Group >> 12) & 0x3F]);
+            Result.push_back(i + 1 < Data.size() ? k_alphabet[(Group >> 6) & 0x3F] : '=');
+            Result.push_back(i + 2 < Data.size() ? k_alphabet[Group & 0x3F] : '=');
+        }
+
+        return Result;
+    }
+
+    // Upper bound for a status line or header, anything longer is treated as a broken stream.
+    constexpr std::size_t k_maxLineLength = 16 * 1024;
+
+    bool EqualsNoCase(std::string_view const Lhs, std::string_view const Rhs)
+    {
+        return Lhs.size() == Rhs.size() && std::equal(Lhs.begin(), Lhs.end(), Rhs.begin(),
+            [](char const A, char const B) -> bool
+            {
+                auto const Lower = [](char const C) -> char { return (C >= 'A' && C <= 'Z') ? static_cast<char>(C + ('a' - 'A')) : C; };
+                return Lower(A) == Lower(B);
+            });
+    }
+
+    std::string_view Trim(std::string_view Value)
+    {
+        while (!Value.empty() && (Value.front() == ' ' || Value.front() == '\t')) Value.remove_prefix(1);
+        while (!Value.empty() && (Value.back() == ' ' || Value.back() == '\t')) Value.remove_suffix(1);
+        return Value;
+    }
+
+    bool ParseUnsigned(std::string_view const Value, int const Base, std::size_t& OutValue)
+    {
+        if (Value.empty())
+            return false;
+
+        OutValue = 0;
+        for (char const C : Value)
+        {
+            int Digit = -1;
+            if (C >= '0' && C <= '9') Digit = C - '0';
+            else if (Base == 16 && C >= 'a' && C <= 'f') Digit = C - 'a' + 10;
+            else if (Base == 16 && C >= 'A' && C <= 'F') Digit = C - 'A' + 10;
+
+            if (Digit < 0 || OutValue > (SIZE_MAX >> 8))
+                return false;
+            OutValue = OutValue * static_cast<std::size_t>(Base) + static_cast<std::size_t>(Digit);
+        }
+
+        return true;
+    }
+}
+
+namespace ConvoSniffer
+{
+    // ! SocketTransport implementation.
+    // ========================================
+
+    SocketTransport::SocketTransport(std::string_view const InHost, int const InPort, int const InTimeoutMs, std::size_t const InPipelineDepth)
+        : Host{ InHost }
+        , Port{ InPort }
+        , TimeoutMs{ InTimeoutMs }
+        , PipelineDepth{ (std::max)(InPipelineDepth, std::size_t{ 1 }) }
+        , Socket{ k_invalidSocket }
+    {
+        // Headers common to all requests, so that framing a request does not format anything but its length.
+        RequestHeaders.append("Host: ").append(Host).append(":").append(std::to_string(Port)).append("\r\n");
+        RequestHeaders.append("Connection: keep-alive\r\n");
+        RequestHeaders.append("Content-Type: text/plain; charset=utf-8\r\n");
+        RequestHeaders.append("Content-Length: ");
+    }
+
+    SocketTransport::~SocketTransport()
+    {
+        Disconnect();
+    }
+
+    bool SocketTransport::Connect()
+    {
+        if (IsConnected())
+            return true;
+
+        if (char const* const Stage = OpenSocket(Host, Port, TimeoutMs, Socket); Stage != nullptr)
+        {
+            Fail(Stage);
+            return false;
+        }
+
+        bServerClosing = false;
+        ReceiveBuffer.clear();
+        ReceiveOffset = 0;
+        return true;
+    }
+
+    void SocketTransport::Disconnect()
+    {
+        if (IsConnected())
+            CloseSocket(static_cast<SocketHandle>(std::exchange(Socket, k_invalidSocket)));
+    }
+
+    bool SocketTransport::IsConnected() const noexcept
+    {
+        return Socket != k_invalidSocket;
+    }
+
+    std::size_t SocketTransport::Exchange(std::span<TransportRequest const> const Requests, std::span<TransportResponse> const OutResponses)
+    {
+        if (!IsConnected() || OutResponses.size() < Requests.size())
+            return 0;
+
+        std::size_t const Count = (std::min)(Requests.size(), PipelineDepth);
+
+        SendBuffer.clear();
+        for (std::size_t i = 0; i < Count; ++i)
+        {
+            TransportRequest const& Request = Requests[i];
+
+            char Length[24];
+            auto const LengthEnd = std::to_chars(std::begin(Length), std::end(Length), Request.Body.size()).ptr;
+
+            SendBuffer.append(Request.Method).append(" ").append(Request.Path).append(" HTTP/1.1\r\n");
+            SendBuffer.append(RequestHeaders).append(Length, LengthEnd).append("\r\n\r\n");
+            SendBuffer.append(Request.Body);
+        }
+
+        if (!SendAll(SendBuffer))
+            return 0;
+
+        std::size_t Received = 0;
+        while (Received < Count && ReceiveResponse(OutResponses[Received]))
+        {
+            Received++;
+
+            if (bServerClosing)
+            {
+                Disconnect();
+                break;
+            }
+        }
+
+        return Received;
+    }
+
+    bool SocketTransport::SendAll(std::string_view const Data)
+    {
+        if (SendAllBytes(Socket, Data))
+            return true;
+
+        Fail("send");
+        return false;
+    }
+
+    bool SocketTransport::Receive()
+    {
+        if (!IsConnected())
+            return false;
+
+        // Drop parsed data before growing the buffer.
+        if (ReceiveOffset != 0)
+        {
+            ReceiveBuffer.erase(0, ReceiveOffset);
+            ReceiveOffset = 0;
+        }
+
+        std::size_t const Previous = ReceiveBuffer.size();
+        ReceiveBuffer.resize(Previous + 4096);
+
+        auto const Read = ::recv(static_cast<SocketHandle>(Socket), ReceiveBuffer.data() + Previous, 4096, 0);
+        ReceiveBuffer.resize(Previous + (Read > 0 ? static_cast<std::size_t>(Read) : 0));
+
+        if (Read <= 0)
+        {
+            Fail(Read == 0 ? "closed" : "recv");
+            return false;
+        }
+
+        return true;
+    }
+
+    bool SocketTransport::ReceiveLine(std::string_view& OutLine)
+    {
+        std::size_t Searched = ReceiveOffset;
+        for (;;)
+        {
+            std::size_t const End = ReceiveBuffer.find("\r\n", Searched);
+            if (End != std::string::npos)
+            {
+                OutLine = std::string_view{ ReceiveBuffer }.substr(ReceiveOffset, End - ReceiveOffset);
+                ReceiveOffset = End + 2;
+                return true;
+            }
+
+            if (ReceiveBuffer.size() - ReceiveOffset > k_maxLineLength)
+            {
+                Fail("line length");
+                return false;
+            }
+
+            // Keep the scan position relative to the unparsed data, which may move.
+            std::size_t const Parsed = ReceiveBuffer.size() - ReceiveOffset;
+            if (!Receive())
+                return false;
+            Searched = ReceiveOffset + (Parsed > 0 ? Parsed - 1 : 0);
+        }
+    }
+
+    bool SocketTransport::ReceiveBytes(std::size_t const Count, std::string& OutData)
+    {
+        while (ReceiveBuffer.size() - ReceiveOffset < Count)
+        {
+            if (!Receive())
+                return false;
+        }
+
+        OutData.append(ReceiveBuffer, ReceiveOffset, Count);
+        ReceiveOffset += Count;
+        return true;
+    }
+
+    bool SocketTransport::ReceiveResponse(TransportResponse& OutResponse)
+    {
+        OutResponse.Status = 0;
+        OutResponse.Body.clear();
+
+        std::string_view Line{};
+        bool bChunked = false;
+        bool bHasLength = false;
+        std::size_t Length = 0;
+
+        // Skip any informational responses.
+        do
+        {
+            if (!ReceiveLine(Line))
+                return false;
+
+            // Status line, e.g. "HTTP/1.1 204 No Content".
+            std::size_t Status = 0;
+            if (Line.size() < 12 || Line.substr(0, 5) != "HTTP/" || !ParseUnsigned(Line.substr(9, 3), 10, Status))
+            {
+                Fail("status line");
+                Disconnect();
+                return false;
+            }
+
+            OutResponse.Status = static_cast<unsigned>(Status);
+
+            for (;;)
+            {
+                if (!ReceiveLine(Line))
+                    return false;
+                if (Line.empty())
+                    break;
+
+                std::size_t const Colon = Line.find(':');
+                if (Colon == std::string_view::npos)
+                    continue;
+
+                std::string_view const Name = Trim(Line.substr(0, Colon));
+                std::string_view const Value = Trim(Line.substr(Colon + 1));
+
+                if (EqualsNoCase(Name, "content-length"))
+                    bHasLength = ParseUnsigned(Value, 10, Length);
+                else if (EqualsNoCase(Name, "transfer-encoding"))
+                    bChunked = EqualsNoCase(Value, "chunked");
+                else if (EqualsNoCase(Name, "connection"))
+                    bServerClosing = EqualsNoCase(Value, "close");
+            }
+        }
+        while (OutResponse.Status >= 100 && OutResponse.Status < 200);
+
+        if (OutResponse.Status == 204 || OutResponse.Status == 304)
+            return true;
+
+        if (bChunked)
+        {
+            for (;;)
+            {
+                std::size_t ChunkSize = 0;
+                if (!ReceiveLine(Line) || !ParseUnsigned(Trim(Line.substr(0, Line.find(';'))), 16, ChunkSize))
+                {
+                    Fail("chunk size");
+                    Disconnect();
+                    return false;
+                }
+
+                if (ChunkSize == 0)
+                    break;
+
+                if (!ReceiveBytes(ChunkSize, OutResponse.Body) || !ReceiveLine(Line))
+                    return false;
+            }
+
+            // Skip trailers up to the terminating empty line.
+            do
+            {
+                if (!ReceiveLine(Line))
+                    return false;
+            }
+            while (!Line.empty());
+
+            return true;
+        }
+
+        if (bHasLength)
+            return ReceiveBytes(Length, OutResponse.Body);
+
+        // Body is delimited by the server closing the connection.
+        OutResponse.Body.append(ReceiveBuffer, ReceiveOffset);
+        ReceiveOffset = ReceiveBuffer.size();
+        while (Receive())
+        {
+            OutResponse.Body.append(ReceiveBuffer, ReceiveOffset);
+            ReceiveOffset = ReceiveBuffer.size();
+        }
+
+        bServerClosing = true;
+        return true;
+    }
+
+    void SocketTransport::Fail(char const* const Stage)
+    {
+        LastError.assign(Stage).append(" failed, error = ").append(std::to_string(GetSocketError()));
+
+        // A failed socket operation leaves the stream in an unknown state.
+        Disconnect();
+    }
+
+    // ! WebSocketStream implementation.
+    // ========================================
+
+    std::string GetWebSocketAccept(std::string_view const Key)
+    {
+        std::string Challenge{ Key };
+        Challenge.append("258EAFA5-E914-47DA-95CA-C5AB0DC85B11");
+        return Base64(Sha1(Challenge));
+    }
+
+    WebSocketStream::WebSocketStream(std::string_view const InHost, int const InPort, std::string_view const InPath, int const InTimeoutMs)
+        : Host{ InHost }
+        , Port{ InPort }
+        , Path{ InPath }
+        , TimeoutMs{ InTimeoutMs }
+        , Socket{ k_invalidSocket }
+        , MaskState{ ((static_cast<std::uint64_t>(std::random_device{}()) << 32)
+            ^ static_cast<std::uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count())) | 1 }
+    {
+    }
+
+    WebSocketStream::~WebSocketStream()
+    {
+        Disconnect();
+    }
+
+    bool WebSocketStream::Connect()
+    {
+        if (IsConnected())
+            return true;
+
+        if (char const* const Stage = OpenSocket(Host, Port, TimeoutMs, Socket); Stage != nullptr)
+        {
+            LastError.assign(Stage).append(" failed, error = ").append(std::to_string(GetSocketError()));
+            return false;
+        }
+
+        SendBuffer.clear();
+        ReceiveBuffer.clear();
+
+        return Handshake();
+    }
+
+    void WebSocketStream::Disconnect()
+    {
+        if (!IsConnected())
+            return;
+
+        // Status code 1000, normal closure.
+        SendBuffer.clear();
+        AppendFrame(0x8, std::string_view{ "\x03\xE8", 2 });
+        SendAllBytes(Socket, SendBuffer);
+
+        CloseSocket(static_cast<SocketHandle>(std::exchange(Socket, k_invalidSocket)));
+        SendBuffer.clear();
+        ReceiveBuffer.clear();
+    }
+
+    bool WebSocketStream::IsConnected() const noexcept
+    {
+        return Socket != k_invalidSocket;
+    }
+
+    void WebSocketStream::AppendText(std::string_view const Message)
+    {
+        AppendFrame(0x1, Message);
+    }
+
+    bool WebSocketStream::Flush()
+    {
+        if (SendBuffer.empty())
+            return true;
+
+        if (!IsConnected() || !SendAllBytes(Socket, SendBuffer))
+        {
+            Fail("send");
+            return false;
+        }
+
+        BytesSent += SendBuffer.size();
+        SendBuffer.clear();
+        return true;
+    }
+
+    bool WebSocketStream::Poll()
+    {
+        if (!IsConnected())
+            return false;
+
+        for (;;)
+        {
+            int const Readable = IsReadable(Socket);
+            if (Readable < 0)
+            {
+                Fail("poll");
+                return false;
+            }
+
+            if (Readable == 0)
+                break;
+
+            if (long long const Read = ReceiveSome(Socket, ReceiveBuffer); Read <= 0)
+            {
+                Fail(Read == 0 ? "closed" : "recv");
+                return false;
+            }
+        }
+
+        return HandleFrames();
+    }
+
+    void WebSocketStream::AppendFrame(unsigned char const Opcode, std::string_view const Payload)
+    {
+        std::uint64_t const Length = Payload.size();
+
+        // Final fragment, always masked as required for client frames.
+        SendBuffer.push_back(static_cast<char>(0x80 | Opcode));
+        if (Length < 126)
+        {
+            SendBuffer.push_back(static_cast<char>(0x80 | Length));
+        }
+        else if (Length <= 0xFFFF)
+        {
+            SendBuffer.push_back(static_cast<char>(0x80 | 126));
+            for (int Shift = 8; Shift >= 0; Shift -= 8)
+                SendBuffer.push_back(static_cast<char>((Length >> Shift) & 0xFF));
+        }
+        else
+        {
+            SendBuffer.push_back(static_cast<char>(0x80 | 127));
+            for (int Shift = 56; Shift >= 0; Shift -= 8)
+                SendBuffer.push_back(static_cast<char>((Length >> Shift) & 0xFF));
+        }
+
+        // Xorshift is plenty, masking only exists to defeat broken intermediaries.
+        MaskState ^= MaskState >> 12;
+        MaskState ^= MaskState << 25;
+        MaskState ^= MaskState >> 27;
+        std::uint32_t const Key = static_cast<std::uint32_t>((MaskState * 0x2545F4914F6CDD1DULL) >> 32);
+
+        unsigned char Mask[4];
+        for (int i = 0; i < 4; ++i)
+            Mask[i] = static_cast<unsigned char>(Key >> (8 * i));
+        SendBuffer.append(reinterpret_cast<char const*>(Mask), sizeof Mask);
+
+        std::size_t const Start = SendBuffer.size();
+        SendBuffer.append(Payload);
+        for (std::size_t i = 0; i < Payload.size(); ++i)
+            SendBuffer[Start + i] = static_cast<char>(SendBuffer[Start + i] ^ Mask[i & 3]);
+    }
+
+    bool WebSocketStream::Handshake()
+    {
+        unsigned char Nonce[16];
+        for (unsigned char& Byte : Nonce)
+        {
+            MaskState ^= MaskState << 13;
+            MaskState ^= MaskState >> 7;
+            MaskState ^= MaskState << 17;
+            Byte = static_cast<unsigned char>(MaskState >> 24);
+        }
+
+        std::string const Key = Base64(Nonce);
+        std::string Request{};
+        Request.append("GET ").append(Path).append(" HTTP/1.1\r\n");
+        Request.append("Host: ").append(Host).append(":").append(std::to_string(Port)).append("\r\n");
+        Request.append("Upgrade: websocket\r\n");
+        Request.append("Connection: Upgrade\r\n");
+        Request.append("Sec-WebSocket-Key: ").append(Key).append("\r\n");
+        Request.append("Sec-WebSocket-Version: 13\r\n\r\n");
+
+        if (!SendAllBytes(Socket, Request))
+        {
+            Fail("handshake send");
+            return false;
+        }
+
+        std::size_t HeaderEnd = std::string::npos;
+        while ((HeaderEnd = ReceiveBuffer.find("\r\n\r\n")) == std::string::npos)
+        {
+            if (ReceiveBuffer.size() > k_maxLineLength || ReceiveSome(Socket, ReceiveBuffer) <= 0)
+            {
+                Fail("handshake receive");
+                return false;
+            }
+        }
+
+        std::string_view Headers{ ReceiveBuffer.data(), HeaderEnd + 2 };
+        std::size_t LineEnd = Headers.find("\r\n");
+        std::string_view const StatusLine = Headers.substr(0, LineEnd);
+
+        if (StatusLine.size() < 12 || StatusLine.substr(0, 5) != "HTTP/" || StatusLine.substr(9, 3) != "101")
+        {
+            LastError.assign("handshake rejected: ").append(StatusLine);
+            CloseSocket(static_cast<SocketHandle>(std::exchange(Socket, k_invalidSocket)));
+            return false;
+        }
+
+        std::string const Expected = GetWebSocketAccept(Key);
+        bool bAccepted = false;
+
+        for (Headers.remove_prefix(LineEnd + 2); !Headers.empty(); Headers.remove_prefix(LineEnd + 2))
+        {
+            LineEnd = Headers.find("\r\n");
+            std::string_view const Line = Headers.substr(0, LineEnd);
+            std::size_t const Colon = Line.find(':');
+
+            if (Colon != std::string_view::npos && EqualsNoCase(Trim(Line.substr(0, Colon)), "sec-websocket-accept"))
+                bAccepted = Trim(Line.substr(Colon + 1)) == Expected;
+        }
+
+        if (!bAccepted)
+        {
+            LastError.assign("handshake accept key mismatch");
+            CloseSocket(static_cast<SocketHandle>(std::exchange(Socket, k_invalidSocket)));
+            return false;
+        }
+
+        // Anything after the headers is already part of the frame stream.
+        ReceiveBuffer.erase(0, HeaderEnd + 4);
+        return true;
+    }
+
+    bool WebSocketStream::HandleFrames()
+    {
+        std::size_t Offset = 0;
+        bool bReplied = false;
+
+        for (;;)
+        {
+            std::size_t const Available = ReceiveBuffer.size() - Offset;
+            if (Available < 2)
+                break;
+
+            auto const Byte = [&](std::size_t const Index) -> std::uint64_t { return static_cast<unsigned char>(ReceiveBuffer[Offset + Index]); };
+
+            unsigned char const Opcode = static_cast<unsigned char>(Byte(0) & 0x0F);
+            bool const bMasked = (Byte(1) & 0x80) != 0;
+            std::uint64_t Length = Byte(1) & 0x7F;
+            std::size_t Header = 2;
+
+            if (Length == 126)
+            {
+                if (Available < 4) break;
+                Length = (Byte(2) << 8) | Byte(3);
+                Header = 4;
+            }
+            else if (Length == 127)
+            {
+                if (Available < 10) break;
+                Length = 0;
+                for (std::size_t i = 2; i < 10; ++i)
+                    Length = (Length << 8) | Byte(i);
+                Header = 10;
+            }
+
+            if (Length > (1u << 24))
+            {
+                Fail("frame size");
+                return false;
+            }
+
+            std::size_t const MaskOffset = Header;
+            Header += bMasked ? 4 : 0;
+            if (Available < Header + Length)
+                break;
+
+            std::string Payload = ReceiveBuffer.substr(Offset + Header, static_cast<std::size_t>(Length));
+            if (bMasked)
+            {
+                for (std::size_t i = 0; i < Payload.size(); ++i)
+                    Payload[i] = static_cast<char>(Payload[i] ^ ReceiveBuffer[Offset + MaskOffset + (i & 3)]);
+            }
+
+            Offset += Header + static_cast<std::size_t>(Length);
+
+            if (Opcode == 0x8)
+            {
+                // Echo the status code back and drop the connection.
+                SendBuffer.clear();
+                AppendFrame(0x8, std::string_view{ Payload }.substr(0, 2));
+                SendAllBytes(Socket, SendBuffer);
+
+                LastError.assign("closed by server");
+                CloseSocket(static_cast<SocketHandle>(std::exchange(Socket, k_invalidSocket)));
+                SendBuffer.clear();
+                ReceiveBuffer.clear();
+                return false;
+            }
+
+            if (Opcode == 0x9)
+            {
+                AppendFrame(0xA, Payload);
+                bReplied = true;
+            }
+        }
+
+        ReceiveBuffer.erase(0, Offset);
+        return !bReplied || Flush();
+    }
+
+    void WebSocketStream::Fail(char const* const Stage)
+    {
+        LastError.assign(Stage).append(" failed, error = ").append(std::to_string(GetSocketError()));
+
+        if (IsConnected())
+            CloseSocket(static_cast<SocketHandle>(std::exchange(Socket, k_invalidSocket)));
+        SendBuffer.clear();
+        ReceiveBuffer.clear();
+    }
+
+
+#if defined(_WIN32)
+
+    // ! WinInetTransport implementation.
+    // ========================================
+
+    WinInetTransport::WinInetTransport(std::string_view const InHost, int const InPort)
+        : Host{ InHost }
+        , Port{ InPort }
+    {
+    }
+
+    WinInetTransport::~WinInetTransport()
+    {
+        Disconnect();
+    }
+
+    bool WinInetTransport::Connect()
+    {
+        if (IsConnected())
+            return true;
+
+        Win32Internet = ::InternetOpenA("ConvoSniffer-LE1.asi", INTERNET_OPEN_TYPE_PRECONFIG, NULL, NULL, 0u);
+        if (Win32Internet == NULL)
+        {
+            Fail("internet handle");
+            return false;
+        }
+
+        Win32Session = ::InternetConnectA(Win32Internet, Host.c_str(), static_cast<INTERNET_PORT>(Port), NULL, NULL, INTERNET_SERVICE_HTTP, 0u, NULL);
+        if (Win32Session == NULL)
+        {
+            Fail("http session");
+            Disconnect();
+            return false;
+        }
+
+        return true;
+    }
+
+    void WinInetTransport::Disconnect()
+    {
+        if (Win32Session != nullptr)
+            ::InternetCloseHandle(std::exchange(Win32Session, nullptr));
+        if (Win32Internet != nullptr)
+            ::InternetCloseHandle(std::exchange(Win32Internet, nullptr));
+    }
+
+    bool WinInetTransport::IsConnected() const noexcept
+    {
+        return Win32Session != nullptr;
+    }
+
+    std::size_t WinInetTransport::Exchange(std::span<TransportRequest const> const Requests, std::span<TransportResponse> const OutResponses)
+    {
+        std::size_t Received = 0;
+        while (Received < Requests.size() && Received < OutResponses.size() && IsConnected()
+            && ExchangeOne(Requests[Received], OutResponses[Received]))
+        {
+            Received++;
+        }
+
+        return Received;
+    }
+
+    bool WinInetTransport::ExchangeOne(TransportRequest const& InRequest, TransportResponse& OutResponse)
+    {
+        // WinINet wants terminated strings, the buffers keep their capacity between requests.
+        Method.assign(InRequest.Method);
+        Path.assign(InRequest.Path);
+
+        // Keep the underlying connection open between requests of the session.
+        DWORD const Flags = INTERNET_FLAG_KEEP_CONNECTION | INTERNET_FLAG_NO_CACHE_WRITE | INTERNET_FLAG_RELOAD;
+        HINTERNET const Request = ::HttpOpenRequestA(Win32Session, Method.c_str(), Path.c_str(), "HTTP/1.1", NULL, NULL, Flags, NULL);
+        if (Request == NULL)
+        {
+            Fail("open request");
+            return false;
+        }
+
+        bool bSuccess = ::HttpSendRequestA(Request, NULL, 0u, const_cast<char*>(InRequest.Body.data()), static_cast<DWORD>(InRequest.Body.size())) != FALSE;
+        if (!bSuccess)
+            Fail("send request");
+
+        DWORD Status = 0;
+        DWORD StatusSize = sizeof Status;
+        if (bSuccess && !::HttpQueryInfoA(Request, HTTP_QUERY_STATUS_CODE | HTTP_QUERY_FLAG_NUMBER, &Status, &StatusSize, 0u))
+        {
+            Fail("query status");
+            bSuccess = false;
+        }
+
+        // The response has to be drained completely for the connection to be reused.
+        OutResponse.Status = static_cast<unsigned>(Status);
+        OutResponse.Body.clear();
+
+        while (bSuccess)
+        {
+            char Chunk[4096];
+            DWORD Read = 0;
+
+            if (!::InternetReadFile(Request, Chunk, sizeof Chunk, &Read))
+            {
+                Fail("read response");
+                bSuccess = false;
+            }
+            else if (Read == 0)
+            {
+                break;
+            }
+            else
+            {
+                OutResponse.Body.append(Chunk, Read);
+            }
+        }
+
+        ::InternetCloseHandle(Request);
+        return bSuccess;
+    }
+
+    void WinInetTransport::Fail(char const* const Stage)
+    {
+        LastError.assign(Stage).append(" failed, error = ").append(std::to_string(::GetLastError()));
+    }
+
+#endif
+}
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+
+// Note that this header intentionally does not depend on LESDK, so that transports
+// can be built and exercised against a loopback server outside of the game.
+
+
+namespace ConvoSniffer
+{
+    // ! Transport interface.
+    // ========================================
+
+    struct TransportRequest final
+    {
+        std::string_view        Method{};
+        std::string_view        Path{};
+        std::string_view        Body{};         // UTF-8 encoded.
+    };
+
+    struct TransportResponse final
+    {
+        unsigned                Status{ 0 };
+        std::string             Body{};         // UTF-8 encoded.
+    };
+
+    /// @brief      Connection to the companion server, which exchanges HTTP/1.1 requests for responses.
+    class Transport
+    {
+    public:
+
+        Transport() = default;
+        Transport(Transport const&) = delete;
+        Transport& operator=(Transport const&) = delete;
+        virtual ~Transport() = default;
+
+        /// @brief      Opens the connection, does nothing if it is already open.
+        /// @return     Whether the connection is open.
+        virtual bool Connect() = 0;
+
+        /// @brief      Closes the connection, does nothing if it is not open.
+        virtual void Disconnect() = 0;
+
+        virtual bool IsConnected() const noexcept = 0;
+
+        /// @brief      Sends requests in order and receives their responses.
+        /// @param[in]  Requests - Requests to send, at most @ref GetPipelineDepth of them.
+        /// @param[out] OutResponses - Responses, with at least as many elements as @c Requests .
+        /// @return     Number of requests which got a response. If this is less than the number of requests,
+        ///             the connection has been closed and the remaining requests may need to be sent again.
+        virtual std::size_t Exchange(std::span<TransportRequest const> Requests, std::span<TransportResponse> OutResponses) = 0;
+
+        /// @brief      Maximum number of requests which may be sent before reading any responses.
+        virtual std::size_t GetPipelineDepth() const noexcept = 0;
+
+        /// @brief      Describes the last failure of @ref Connect or @ref Exchange .
+        std::string const& GetLastError() const noexcept { return LastError; }
+
+    protected:
+
+        std::string             LastError{};
+    };
+
+
+    // ! Socket transport.
+    // ========================================
+
+    /// @brief      Keep-alive HTTP/1.1 connection over a plain TCP socket, with request pipelining.
+    /// @remarks    Builds on both Winsock and POSIX sockets. Responses may be framed by @c Content-Length ,
+    ///             chunked transfer encoding, or the server closing the connection.
+    class SocketTransport final : public Transport
+    {
+    public:
+
+        /// @param[in]  InHost - Host name or address of the server.
+        /// @param[in]  InPort - TCP port of the server.
+        /// @param[in]  InTimeoutMs - Send and receive timeout, after which the connection is dropped.
+        /// @param[in]  InPipelineDepth - Maximum number of requests in flight.
+        SocketTransport(std::string_view InHost, int InPort, int InTimeoutMs, std::size_t InPipelineDepth);
+        ~SocketTransport() override;
+
+        bool Connect() override;
+        void Disconnect() override;
+        bool IsConnected() const noexcept override;
+
+        std::size_t Exchange(std::span<TransportRequest const> Requests, std::span<TransportResponse> OutResponses) override;
+        std::size_t GetPipelineDepth() const noexcept override { return PipelineDepth; }
+
+    private:
+
+        bool SendAll(std::string_view Data);
+        bool Receive();
+        bool ReceiveResponse(TransportResponse& OutResponse);
+        bool ReceiveLine(std::string_view& OutLine);
+        bool ReceiveBytes(std::size_t Count, std::string& OutData);
+        void Fail(char const* Stage);
+
+        std::string             Host;
+        int                     Port;
+        int                     TimeoutMs;
+        std::size_t             PipelineDepth;
+
+        std::intptr_t           Socket;
+        bool                    bServerClosing{ false };    // Server announced the connection closes after a response.
+
+        std::string             RequestHeaders{};           // Ends with the @c Content-Length field name.
+
+        std::string             SendBuffer{};
+        std::string             ReceiveBuffer{};
+        std::size_t             ReceiveOffset{ 0 };         // Start of unparsed data in @ref ReceiveBuffer .
+    };
+
+
+    // ! WebSocket stream.
+    // ========================================
+
+    /// @brief      Computes the @c Sec-WebSocket-Accept value which answers a handshake key.
+    std::string GetWebSocketAccept(std::string_view Key);
+
+    /// @brief      Outbound WebSocket connection which sends text messages to the server.
+    /// @remarks    Messages from the server are not delivered, only control frames are handled.
+    class WebSocketStream final
+    {
+    public:
+
+        /// @param[in]  InHost - Host name or address of the server.
+        /// @param[in]  InPort - TCP port of the server.
+        /// @param[in]  InPath - Resource path to upgrade, e.g. @c /ingest .
+        /// @param[in]  InTimeoutMs - Send and receive timeout, after which the connection is dropped.
+        WebSocketStream(std::string_view InHost, int InPort, std::string_view InPath, int InTimeoutMs);
+        WebSocketStream(WebSocketStream const&) = delete;
+        WebSocketStream& operator=(WebSocketStream const&) = delete;
+        ~WebSocketStream();
+
+        /// @brief      Opens the connection and performs the upgrade handshake.
+        bool Connect();
+
+        /// @brief      Sends a close frame, if possible, and closes the connection.
+        void Disconnect();
+
+        bool IsConnected() const noexcept;
+
+        /// @brief      Frames a text message, which is written out by the next @ref Flush .
+        void AppendText(std::string_view Message);
+
+        /// @brief      Writes out all framed messages at once.
+        /// @return     Whether the write succeeded, the connection is closed otherwise.
+        bool Flush();
+
+        /// @brief      Handles pending control frames from the server without blocking.
+        /// @return     Whether the connection is still open.
+        bool Poll();
+
+        std::string const& GetLastError() const noexcept { return LastError; }
+        std::uint64_t GetBytesSent() const noexcept { return BytesSent; }
+
+    private:
+
+        void AppendFrame(unsigned char Opcode, std::string_view Payload);
+        bool Handshake();
+        bool HandleFrames();
+        void Fail(char const* Stage);
+
+        std::string             Host;
+        int                     Port;
+        std::string             Path;
+        int                     TimeoutMs;
+
+        std::intptr_t           Socket;
+        std::uint64_t           MaskState;              // Generator state for frame masking keys.
+        std::uint64_t           BytesSent{ 0 };
+
+        std::string             SendBuffer{};
+        std::string             ReceiveBuffer{};
+
+        std::string             LastError{};
+    };
+
+
+#if defined(_WIN32)
+
+    // ! WinINet transport.
+    // ========================================
+
+    /// @brief      Transport over WinINet, which keeps connections alive but cannot pipeline requests.
+    class WinInetTransport final : public Transport
+    {
+    public:
+
+        WinInetTransport(std::string_view InHost, int InPort);
+        ~WinInetTransport() override;
+
+        bool Connect() override;
+        void Disconnect() override;
+        bool IsConnected() const noexcept override;
+
+        std::size_t Exchange(std::span<TransportRequest const> Requests, std::span<TransportResponse> OutResponses) override;
+        std::size_t GetPipelineDepth() const noexcept override { return 1; }
+
+    private:
+
+        bool ExchangeOne(TransportRequest const& Request, TransportResponse& OutResponse);
+        void Fail(char const* Stage);
+
+        std::string             Host;
+        int                     Port;
+
+        std::string             Method{};
+        std::string             Path{};
+
+        void*                   Win32Internet{ nullptr };
+        void*                   Win32Session{ nullptr };
+    };
+
+#endif
+}
@@ -0,0 +1,32 @@
+#include "ConvoSniffer/World.hpp"
+
+
+namespace ConvoSniffer
+{
+    // ! WorldCache implementation.
+    // ========================================
+
+    WorldCache g_worldCache{};
+
+    ABioWorldInfo* WorldCache::Resolve(UObject const* const Key)
+    {
+        if (Key == CachedKey && World != nullptr && Common::IsObjectAlive(World, WorldIndex))
+            return World;
+
+        CachedKey = nullptr;
+        World = nullptr;
+
+        UEngine* const CurrentEngine = Engine.Get();
+        if (CurrentEngine == nullptr) return nullptr;
+
+        AWorldInfo* const WorldInfo = CurrentEngine->GetCurrentWorldInfo();
+        if (WorldInfo == nullptr) return nullptr;
+
+        World = WorldInfo->Cast<ABioWorldInfo>();
+        if (World == nullptr) return nullptr;
+
+        CachedKey = Key;
+        WorldIndex = Common::GetObjectIndex(World);
+        return World;
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <LESDK/Headers.hpp>
+#include "Common/Base.hpp"
+#include "Common/Objects.hpp"
+
+
+namespace ConvoSniffer
+{
+    /// @brief      Resolves the current world info without scanning the global object array every time.
+    /// @remarks    The world is kept for as long as the caller passes the same key object, whose change means
+    ///             the world may have changed too, e.g. the HUD or the conversation in progress.
+    /// @remarks    Only used from the game thread.
+    class WorldCache final : public NonCopyable
+    {
+    public:
+
+        /// @brief      Retrieves the current world, only looking it up again when the key changes or the world is destroyed.
+        /// @param[in]  Key - Object the world is remembered for.
+        /// @return     World info, or @c nullptr if there is no engine or world yet.
+        ABioWorldInfo* Resolve(UObject const* Key);
+
+    private:
+
+        Common::CachedObject<UEngine> Engine{};
+        UObject const*      CachedKey{ nullptr };
+        ABioWorldInfo*      World{ nullptr };
+        int                 WorldIndex{ -1 };
+    };
+
+    /// @brief      World lookups of the client, keyed by the conversation in progress.
+    extern WorldCache g_worldCache;
+}
@@ -5,10 +5,11 @@ use std::sync::Arc;
 
 use anyhow::{anyhow, Context};
 use axum::extract::ConnectInfo;
+use axum::extract::ws::Message;
 use axum::response::{IntoResponse, Response};
 use axum::{extract::{ws::WebSocket, State, WebSocketUpgrade}, http::StatusCode, response::Html, routing::{any, delete, get, post, put}, Router};
 use local_ip_address::local_ip;
-use serde::Serialize;
+use serde::{Deserialize, Serialize};
 use tokio::{net::TcpListener, sync::{broadcast::{self, Sender}, RwLock}};
 use tracing::level_filters::LevelFilter;
 use tracing_subscriber::{layer::SubscriberExt, util::SubscriberInitExt};
@@ -72,6 +73,29 @@ fn main() {
                     state.update_keybinds(&body).await.inspect_err(|e| tracing::error!(?addr, "{}", e))?;
                     Ok((StatusCode::NO_CONTENT, "").into_response())
                 }}))
+                .route("/ingest", any(async |ws: WebSocketUpgrade, State(state): State<AppState>, ConnectInfo(addr): ConnectInfo<SocketAddr>| {
+                    async fn handle_ingest(mut socket: WebSocket, state: AppState, addr: SocketAddr) {
+                        tracing::info!(?addr, "handling new ingest connection");
+
+                        while let Some(Ok(message)) = socket.recv().await {
+                            let text = match message {
+                                Message::Text(text) => text,
+                                Message::Close(_) => break,
+                                _ => continue,
+                            };
+
+                            for line in text.as_str().lines().filter(|line| !line.trim().is_empty()) {
+                                if let Err(e) = state.ingest(line).await {
+                                    tracing::error!(?addr, "{}", e);
+                                }
+                            }
+                        }
+
+                        tracing::info!(?addr, "ingest connection closed");
+                    }
+
+                    ws.on_upgrade(move |socket: WebSocket| handle_ingest(socket, state, addr))
+                }))
                 .route("/socket", any(async |ws: WebSocketUpgrade, State(state): State<AppState>, ConnectInfo(addr): ConnectInfo<SocketAddr>| {
                     async fn handle_socket(mut socket: WebSocket, state: AppState, addr: SocketAddr) {
                         tracing::info!(?addr, "handling new websocket connection");
@@ -217,9 +241,38 @@ impl AppState {
             .map(|_| ())
     }
 
+    /// Applies one event received over the ingest channel.
+    pub async fn ingest(&self, line: &str) -> anyhow::Result<()> {
+        let event: IngestEvent = serde_json::from_str(line).context("invalid ingest event")?;
+        tracing::debug!(?event, "ingesting event");
+
+        match event {
+            IngestEvent::Start => self.start_conversation().await,
+            IngestEvent::Graph(graph) => {
+                tracing::info!(entries = graph.entries.len(), replies = graph.replies.len(), "starting new conversation with graph");
+                self.start_conversation().await?;
+                self.convo.write().await.get_or_insert_with(Conversation::new).graph = Some(graph);
+                Ok(())
+            },
+            IngestEvent::Node { node, slots, illegal } => self.resolve_node(node, slots, illegal).await,
+            IngestEvent::End => self.end_conversation().await,
+            IngestEvent::Keybinds { keybinds } => self.set_keybinds(keybinds).await,
+            IngestEvent::Queue { index } => self.queue_reply_index(index).await,
+            IngestEvent::Replies { node, set, clear } => {
+                tracing::info!(node, set = set.len(), clear = clear.len(), "patching replies for current conversation");
+                self.patch_replies(set, clear).await
+            },
+        }
+    }
+
     /// Queues a reply in the current conversation.
     pub async fn queue_reply(&self, client_string: &str) -> anyhow::Result<()> {
         let index: i32 = client_string.trim().parse().context("invalid index integer")?;
+        self.queue_reply_index(index).await
+    }
+
+    /// Queues a reply in the current conversation by its index.
+    pub async fn queue_reply_index(&self, index: i32) -> anyhow::Result<()> {
         if index < 0 || index >= MAX_REPLIES as i32 { Err(anyhow!("index {} out of bounds", index))?; }
 
         let mut convo = self.convo.write().await;
@@ -258,9 +311,81 @@ impl AppState {
             .map(|_| ())
     }
 
+    /// Updates current conversation's displayed replies from its graph.
+    pub async fn resolve_node(&self, node: i32, slots: u32, illegal: u32) -> anyhow::Result<()> {
+        let mut convo = self.convo.write().await;
+        let convo_ref = convo.as_mut().ok_or_else(|| anyhow!("conversation not started"))?;
+        let graph = convo_ref.graph.as_ref().ok_or_else(|| anyhow!("conversation has no graph"))?;
+
+        let mut replies: [ConversationReply; MAX_REPLIES] = Default::default();
+        if let Some(links) = usize::try_from(node).ok().and_then(|node| graph.entries.get(node)) {
+            for (slot, link) in links.iter().enumerate().take(MAX_REPLIES) {
+                if slots & (1 << slot) == 0 { continue; }
+
+                let reply = graph.replies.get(link.reply).ok_or_else(|| anyhow!("reply {} out of bounds", link.reply))?;
+                if reply.text.is_empty() { continue; }
+
+                replies[slot] = ConversationReply {
+                    id: slot,
+                    style: if illegal & (1 << slot) != 0 { graph.illegal_style.clone() } else { reply.style.clone() },
+                    category: link.category.clone(),
+                    paraphrase: link.paraphrase.clone(),
+                    text: reply.text.clone(),
+                    queued: false,
+                };
+            }
+        }
+
+        tracing::info!(node, "resolved replies for current conversation");
+        convo_ref.replies = replies;
+        self.sender.send(WebNotif::UpdateReplies { replies: convo_ref.replies.to_vec() })
+            .map_err(|e| e.into())
+            .map(|_| ())
+    }
+
+    /// Updates only the given replies of the current conversation, and un-queues all of them.
+    pub async fn patch_replies(&self, set: Vec<IngestReply>, clear: Vec<usize>) -> anyhow::Result<()> {
+        if let Some(&id) = clear.iter().chain(set.iter().map(|reply| &reply.id)).find(|&&id| id >= MAX_REPLIES) {
+            Err(anyhow!("reply index {} out of bounds", id))?;
+        }
+
+        let mut convo = self.convo.write().await;
+        if convo.is_none() {
+            // Implicitly create the conversation instead of hard error if out of sync...
+            self.sender.send(WebNotif::Conversation { start: true })?;
+        }
+        let convo_ref = convo.get_or_insert_with(Conversation::new);
+
+        convo_ref.replies.iter_mut().for_each(|reply| reply.queued = false);
+        clear.iter().for_each(|&id| convo_ref.replies[id].clear());
+
+        let replies: Vec<ConversationReply> = set.into_iter()
+            .map(|reply| {
+                let reply = ConversationReply {
+                    id: reply.id,
+                    style: reply.style,
+                    category: reply.category,
+                    paraphrase: reply.paraphrase,
+                    text: reply.text,
+                    queued: false,
+                };
+                convo_ref.replies[reply.id] = reply.clone();
+                reply
+            })
+            .collect();
+
+        self.sender.send(WebNotif::PatchReplies { replies, cleared: clear })
+            .map_err(|e| e.into())
+            .map(|_| ())
+    }
+
     /// Updates displayed key binding configuration.
     pub async fn update_keybinds(&self, client_string: &str) -> anyhow::Result<()> {
-        let tokens: Vec<String> = client_string.split(';').map(|s| s.to_string()).collect();
+        self.set_keybinds(client_string.split(';').map(|s| s.to_string()).collect()).await
+    }
+
+    /// Updates displayed key binding configuration from a list of names.
+    pub async fn set_keybinds(&self, tokens: Vec<String>) -> anyhow::Result<()> {
         let names: &[String; MAX_REPLIES] = tokens.as_slice().try_into().context("invalid keybind count")?;
 
         self.keybinds.write().await.clone_from(names);
@@ -274,6 +399,8 @@ impl AppState {
 #[derive(Default)]
 pub struct Conversation {
     pub replies: [ConversationReply; MAX_REPLIES],
+    /// Whole conversation, if the game sent it up front.
+    pub graph: Option<ConversationGraph>,
 }
 
 impl Conversation {
@@ -363,4 +490,72 @@ pub enum WebNotif {
     SetKeybinds {
         keybinds: Vec<String>,
     },
+    PatchReplies {
+        replies: Vec<ConversationReply>,
+        cleared: Vec<usize>,
+    },
+}
+
+
+/// Schema for events received from the game over the ingest WebSocket, one JSON object per line.
+#[derive(Debug, Deserialize)]
+#[serde(tag = "type", rename_all = "lowercase")]
+pub enum IngestEvent {
+    Start,
+    /// Starts a conversation, whose nodes are then only sent as [`IngestEvent::Node`].
+    Graph(ConversationGraph),
+    /// Current node, with bitsets of the available reply slots and of those whose condition failed.
+    Node {
+        node: i32,
+        slots: u32,
+        illegal: u32,
+    },
+    End,
+    Keybinds {
+        keybinds: Vec<String>,
+    },
+    Queue {
+        index: i32,
+    },
+    /// Replies which changed since the previous update, relative to the same conversation.
+    Replies {
+        node: i32,
+        #[serde(default)]
+        set: Vec<IngestReply>,
+        #[serde(default)]
+        clear: Vec<usize>,
+    },
+}
+
+/// Reply as sent over the ingest WebSocket.
+#[derive(Debug, Deserialize)]
+pub struct IngestReply {
+    pub id: usize,
+    pub style: String,
+    pub category: String,
+    pub paraphrase: String,
+    pub text: String,
+}
+
+/// Every entry and reply of a conversation, as sent by the game when it starts.
+#[derive(Debug, Deserialize)]
+pub struct ConversationGraph {
+    /// Style given to replies whose condition failed.
+    pub illegal_style: String,
+    /// Links from each entry to its replies, indexed by reply slot.
+    pub entries: Vec<Vec<GraphLink>>,
+    pub replies: Vec<GraphReply>,
+}
+
+#[derive(Debug, Deserialize)]
+pub struct GraphLink {
+    pub reply: usize,
+    pub category: String,
+    pub paraphrase: String,
+}
+
+#[derive(Debug, Deserialize)]
+pub struct GraphReply {
+    pub style: String,
+    pub text: String,
 }
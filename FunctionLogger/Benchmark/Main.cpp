@@ -0,0 +1,411 @@
+// Measures what a hooked call costs the game thread, logging it synchronously like FunctionLogger used to,
+// and queueing it for the background writer, with both overflow policies.
+//
+// The benchmark runs on a Linux host, outside of the game and of the CMake project, e.g. from this folder:
+//   g++ -std=c++20 -O2 -pthread -I../.. -IPosix -I../../External/spdlog/include Main.cpp ../Queue.cpp ../Trace.cpp ../TraceText.cpp -o benchmark
+//   ./benchmark [threads] [calls per thread]
+//   ./benchmark reuse
+//   ./benchmark trace [calls per thread]
+//
+// Calls are made against a fixed set of fake objects, so that names are only resolved while warming up,
+// as happens in game once the level is loaded. Logs are written to the current folder.
+//
+// The reuse mode checks that calls keep their names when another thread names a reused object index
+// in between, with the writer draining that thread first, and fails otherwise.
+//
+// The trace mode records calls into binary trace segments, through the Posix folder which stands in for
+// the few Win32 calls of the writer, then decodes them back and fails if any call or name went missing.
+// The default number of calls fills more than one segment, which checks that segments roll over and are
+// trimmed to what was written. Segment files are removed once checked.
+
+#include <chrono>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <spdlog/sinks/basic_file_sink.h>
+#include <spdlog/spdlog.h>
+
+#include "FunctionLogger/Queue.hpp"
+#include "FunctionLogger/Trace.hpp"
+#include "FunctionLogger/TraceText.hpp"
+
+using namespace FunctionLogger;
+
+
+namespace
+{
+	constexpr std::size_t k_objectCount = 2048;
+	constexpr std::size_t k_functionCount = 512;
+
+	// Calls made back to back before waiting for the writer to catch up, when paced.
+	constexpr std::size_t k_burstCalls = 16 * 1024;
+
+	struct FakeObject final
+	{
+		int                 Index;
+		std::u16string      Name;
+		std::string         NameUtf8;
+	};
+
+	struct Workload final
+	{
+		std::vector<FakeObject>     Objects{};
+		std::vector<FakeObject>     Functions{};
+
+		Workload()
+		{
+			for (std::size_t i = 0; i < k_objectCount; ++i)
+				Add(Objects, static_cast<int>(i), "BIOA_NOR10.TheWorld.PersistentLevel.SFXPawn_Henchman_" + std::to_string(i));
+			for (std::size_t i = 0; i < k_functionCount; ++i)
+				Add(Functions, static_cast<int>(k_objectCount + i), "Function SFXGame.SFXPawn.OnStateTick_" + std::to_string(i));
+		}
+
+		static void Add(std::vector<FakeObject>& Into, int const Index, std::string const& Name)
+		{
+			Into.push_back(FakeObject{ Index, std::u16string(Name.begin(), Name.end()), Name });
+		}
+	};
+
+	void ResolveFakeName(TraceKind, void const* const Object, std::u16string& OutText)
+	{
+		OutText = static_cast<FakeObject const*>(Object)->Name;
+	}
+
+	/// @brief      Runs the same calls on every thread, returning the nanoseconds spent per call in the hook.
+	/// @param[in]  Pause - Called between bursts of calls, not timed.
+	template<typename HookFunc, typename PauseFunc>
+	double RunThreads(Workload const& Load, std::size_t const nThreads, std::size_t const nCalls, HookFunc const& Hook, PauseFunc const& Pause)
+	{
+		std::vector<std::thread> Threads{};
+		std::vector<double> Nanoseconds(nThreads, 0.0);
+
+		for (std::size_t t = 0; t < nThreads; ++t)
+		{
+			Threads.emplace_back([&, t]
+			{
+				for (std::size_t First = 0; First < nCalls; First += k_burstCalls)
+				{
+					auto const Start = std::chrono::steady_clock::now();
+					for (std::size_t i = First; i < nCalls && i < First + k_burstCalls; ++i)
+					{
+						// Cheap stand-in for the call pattern of a game frame, touching every object over and over.
+						FakeObject const& Context = Load.Objects[(i * 7 + t) % k_objectCount];
+						FakeObject const& Function = Load.Functions[(i * 13) % k_functionCount];
+						Hook(Context, Function);
+					}
+					Nanoseconds[t] += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - Start).count();
+
+					Pause();
+				}
+			});
+		}
+
+		for (std::thread& Thread : Threads)
+			Thread.join();
+
+		double Total = 0.0;
+		for (double const Value : Nanoseconds)
+			Total += Value;
+		return Total / static_cast<double>(nThreads * nCalls);
+	}
+
+	std::shared_ptr<spdlog::logger> MakeLogger(char const* const Name, char const* const Path)
+	{
+		auto Logger = spdlog::basic_logger_mt(Name, Path, true);
+		Logger->set_level(spdlog::level::trace);
+		Logger->set_pattern("%v");
+		return Logger;
+	}
+
+	/// @brief      Formats and flushes every call on the hooked thread, which is what hooks used to do.
+	void RunSynchronous(Workload const& Load, std::size_t const nThreads, std::size_t const nCalls)
+	{
+		auto const Logger = MakeLogger("synchronous", "FunctionLog.synchronous.log");
+		auto const Start = std::chrono::steady_clock::now();
+
+		double const PerCall = RunThreads(Load, nThreads, nCalls, [&](FakeObject const& Context, FakeObject const& Function)
+		{
+			auto const Milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - Start).count();
+
+			// Hooks built both names as strings on every call.
+			std::string const ContextPath = Context.NameUtf8;
+			std::string const FunctionName = Function.NameUtf8;
+
+			Logger->log(spdlog::level::trace, "[{:04}.{:03}] [U] {}->{}()", Milliseconds / 1000, Milliseconds % 1000, ContextPath, FunctionName);
+			Logger->flush();
+		}, [] {});
+
+		std::printf("%-12s %10.1f ns/call\n", "synchronous", PerCall);
+		spdlog::drop("synchronous");
+	}
+
+	/// @brief      Queues every call, then reports how long the writer took to catch up.
+	/// @param[in]  bPaced - Whether bursts of calls wait for the writer, so that rings never fill up,
+	///             which is closer to a game doing actual work between calls.
+	void RunQueued(Workload const& Load, std::size_t const nThreads, std::size_t const nCalls, TraceOverflow const Overflow, bool const bPaced)
+	{
+		char const* const Name = bPaced ? "paced" : Overflow == TraceOverflow::Block ? "blocking" : "dropping";
+		std::string const Path = std::string{ "FunctionLog." } + Name + ".log";
+
+		auto const Logger = MakeLogger(Name, Path.c_str());
+		auto Queue = std::make_unique<TraceQueue>(std::make_unique<TextSink>(Logger), &ResolveFakeName, Overflow);
+
+		double const PerCall = RunThreads(Load, nThreads, nCalls, [&](FakeObject const& Context, FakeObject const& Function)
+		{
+			Queue->Record(TraceKind::ScriptCall, &Context, Context.Index, &Function, Function.Index);
+		}, [&]
+		{
+			if (bPaced)
+				Queue->Flush(std::chrono::seconds{ 10 });
+		});
+
+		auto const DrainStart = std::chrono::steady_clock::now();
+		TraceQueue::Stats const Totals = Queue->GetStats();
+		Queue.reset();
+		double const DrainMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - DrainStart).count();
+
+		std::printf("%-12s %10.1f ns/call, %" PRIu64 " calls, %" PRIu64 " dropped, %" PRIu64 " stalls, drained in %.1f ms\n",
+			Name, PerCall, Totals.Calls, Totals.Dropped, Totals.Stalls, DrainMs);
+		spdlog::drop(Name);
+	}
+
+	/// @brief      Keeps every batch of records the writer hands over, in order.
+	class CaptureSink final : public TraceSink
+	{
+	public:
+
+		explicit CaptureSink(std::vector<std::vector<TraceRecord>>& OutWrites)
+			: Writes{ OutWrites }
+		{
+		}
+
+		bool Start(TraceClock const&) override { return true; }
+
+		void Write(TraceRecord const* const Records, std::size_t const Count) override
+		{
+			std::scoped_lock const Lock{ Mutex };
+			Writes.emplace_back(Records, Records + Count);
+		}
+
+		void Flush() override {}
+
+	private:
+
+		std::mutex                                  Mutex;
+		std::vector<std::vector<TraceRecord>>&      Writes;
+	};
+
+	/// @brief      Records a call on this thread, an object at index 5 which another thread later sees replaced,
+	///             and replays what the writer wrote with the other thread's batch first.
+	int RunSlotReuse()
+	{
+		FakeObject const Replaced{ 5, u"TheWorld.PersistentLevel.SFXPawn_0", "TheWorld.PersistentLevel.SFXPawn_0" };
+		FakeObject const Reused{ 5, u"TheWorld.PersistentLevel.SFXPawn_1", "TheWorld.PersistentLevel.SFXPawn_1" };
+		FakeObject const Function{ 9, u"Function SFXGame.SFXPawn.Tick", "Function SFXGame.SFXPawn.Tick" };
+
+		std::vector<std::vector<TraceRecord>> Writes{};
+		{
+			TraceQueue Queue{ std::make_unique<CaptureSink>(Writes), &ResolveFakeName, TraceOverflow::Block };
+
+			// The first call names both indices, the second one refers to the names only.
+			Queue.Record(TraceKind::ScriptCall, &Replaced, Replaced.Index, &Function, Function.Index);
+			Queue.Flush(std::chrono::seconds{ 10 });
+			Queue.Record(TraceKind::ScriptCall, &Replaced, Replaced.Index, &Function, Function.Index);
+			Queue.Flush(std::chrono::seconds{ 10 });
+
+			std::thread Other{ [&]
+			{
+				Queue.Record(TraceKind::ScriptCall, &Reused, Reused.Index, &Function, Function.Index);
+				Queue.Flush(std::chrono::seconds{ 10 });
+			} };
+			Other.join();
+		}
+
+		if (Writes.size() != 3)
+		{
+			std::printf("reuse: expected 3 writes, got %zu\n", Writes.size());
+			return 1;
+		}
+
+		// A pass of the writer may reach the other thread before this one.
+		TraceFormatter Formatter{ true };
+		Formatter.SetClock(Writes[0][0].Tsc, TraceClock::Calibrate().TscFrequency);
+
+		std::string FirstText{}, OtherText{}, SecondText{};
+		Formatter.Append(Writes[0].data(), Writes[0].size(), FirstText);
+		Formatter.Append(Writes[2].data(), Writes[2].size(), OtherText);
+		Formatter.Append(Writes[1].data(), Writes[1].size(), SecondText);
+
+		bool const bPassed = FirstText.find(Replaced.NameUtf8 + "->") != std::string::npos
+			&& OtherText.find(Reused.NameUtf8 + "->") != std::string::npos
+			&& SecondText.find(Replaced.NameUtf8 + "->") != std::string::npos;
+
+		std::printf("%s%s%s%s\n", FirstText.c_str(), OtherText.c_str(), SecondText.c_str(), bPassed ? "reuse: passed" : "reuse: FAILED");
+		return bPassed ? 0 : 1;
+	}
+
+	/// @brief      Reads a segment file back, checking its header and that it was trimmed to whole records.
+	/// @return     Records following the header, or nothing if the segment is missing or malformed.
+	std::vector<TraceRecord> ReadSegment(char const* const Path, std::uint32_t const nSegment, TraceSegmentHeader& OutHeader)
+	{
+		std::vector<TraceRecord> Records{};
+
+		std::FILE* const File = std::fopen(Path, "rb");
+		if (File == nullptr)
+			return Records;
+
+		TraceSegmentHeader& Header = OutHeader;
+		std::fseek(File, 0, SEEK_END);
+		long const Size = std::ftell(File);
+		std::fseek(File, 0, SEEK_SET);
+
+		bool const bValid = Size >= static_cast<long>(sizeof Header)
+			&& (Size - sizeof Header) % sizeof(TraceRecord) == 0
+			&& std::fread(&Header, sizeof Header, 1, File) == 1
+			&& Header.Magic == k_traceMagic && Header.Version == k_traceVersion
+			&& Header.Segment == nSegment && Header.RecordSize == sizeof(TraceRecord);
+
+		if (bValid)
+		{
+			Records.resize((Size - sizeof Header) / sizeof(TraceRecord));
+			if (std::fread(Records.data(), sizeof(TraceRecord), Records.size(), File) != Records.size())
+				Records.clear();
+		}
+		else
+		{
+			std::printf("trace: %s is malformed, %ld bytes\n", Path, Size);
+		}
+
+		std::fclose(File);
+		return Records;
+	}
+
+	/// @brief      Records calls from two threads into binary trace segments, then decodes every segment in order.
+	int RunTrace(Workload const& Load, std::size_t const nCalls)
+	{
+		constexpr std::size_t k_threads = 2;
+
+		auto Queue = std::make_unique<TraceQueue>(std::make_unique<TraceWriter>(L"FunctionLog.bench"), &ResolveFakeName, TraceOverflow::Block);
+		if (!Queue->IsRunning())
+		{
+			std::printf("trace: the writer did not start\n");
+			return 1;
+		}
+
+		double const PerCall = RunThreads(Load, k_threads, nCalls, [&](FakeObject const& Context, FakeObject const& Function)
+		{
+			Queue->Record(TraceKind::ScriptCall, &Context, Context.Index, &Function, Function.Index);
+		}, [] {});
+
+		TraceQueue::Stats const Totals = Queue->GetStats();
+		Queue.reset();
+
+		TraceFormatter Formatter{ true };
+		std::uint64_t StartTsc = 0;
+		std::uint32_t nSegments = 0;
+		std::uint64_t Placeholders = 0;
+		bool bPassed = true;
+
+		for (;; ++nSegments)
+		{
+			char Path[64];
+			std::snprintf(Path, sizeof Path, "FunctionLog.bench.%03u.trace", nSegments);
+			if (std::FILE* const Probe = std::fopen(Path, "rb"))
+				std::fclose(Probe);
+			else
+				break;
+
+			TraceSegmentHeader Header{};
+			std::vector<TraceRecord> const Records = ReadSegment(Path, nSegments, Header);
+			std::remove(Path);
+			if (Records.empty() || (nSegments != 0 && Header.StartTsc != StartTsc))
+			{
+				bPassed = false;
+				continue;
+			}
+
+			if (nSegments == 0)
+			{
+				StartTsc = Header.StartTsc;
+				Formatter.SetClock(Header.StartTsc, Header.TscFrequency);
+			}
+
+			// Formatted in chunks, a chunk ending within a name leaves it to the next one.
+			std::string Text{};
+			std::size_t Position = 0;
+			while (Position < Records.size())
+			{
+				std::size_t const Chunk = (std::min)(Records.size() - Position, std::size_t{ 64 * 1024 });
+				std::size_t const Consumed = Formatter.Append(Records.data() + Position, Chunk, Text);
+				Position += Consumed;
+
+				for (std::size_t Found = Text.find("<"); Found != std::string::npos; Found = Text.find("<", Found + 1))
+					Placeholders += Text.compare(Found, 8, "<object ") == 0 || Text.compare(Found, 10, "<function ") == 0;
+				Text.clear();
+
+				if (Consumed == 0 && Position + GetTraceRecordSpan(Records[Position]) > Records.size())
+				{
+					std::printf("trace: %s ends within a record\n", Path);
+					bPassed = false;
+					break;
+				}
+				if (Consumed != Chunk && Records[Position].Kind != TraceKind::ObjectPath && Records[Position].Kind != TraceKind::FunctionName)
+				{
+					std::printf("trace: %s has a record of kind %u\n", Path, static_cast<unsigned>(Records[Position].Kind));
+					bPassed = false;
+					break;
+				}
+			}
+		}
+
+		// Unless few calls were made, the first segment filled up.
+		bool const bRolledOver = nSegments > 1 || sizeof(TraceSegmentHeader) + Totals.Written * sizeof(TraceRecord) <= k_traceSegmentSize;
+
+		TraceFormatter::Stats const Decoded = Formatter.GetStats();
+		bPassed = bPassed && nSegments != 0 && bRolledOver && Totals.Dropped == 0 && Decoded.Calls == Totals.Calls
+			&& Decoded.Calls == k_threads * nCalls && Placeholders == 0;
+
+		std::printf("%-12s %10.1f ns/call, %" PRIu64 " calls, %u segments, %" PRIu64 " decoded, %" PRIu64 " names, %" PRIu64 " unnamed\n",
+			"trace", PerCall, Totals.Calls, nSegments, Decoded.Calls, Decoded.Names, Placeholders);
+		std::printf("%s\n", bPassed ? "trace: passed" : "trace: FAILED");
+		return bPassed ? 0 : 1;
+	}
+}
+
+
+int main(int argc, char** argv)
+{
+	if (argc > 1 && std::string{ argv[1] } == "reuse")
+		return RunSlotReuse();
+
+	if (argc > 1 && std::string{ argv[1] } == "trace")
+	{
+		std::size_t const nCalls = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 6'000'000;
+		return nCalls != 0 ? RunTrace(Workload{}, nCalls) : 2;
+	}
+
+	std::size_t const nThreads = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2;
+	std::size_t const nCalls = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1'000'000;
+	if (nThreads == 0 || nCalls == 0)
+	{
+		std::fprintf(stderr, "usage: %s [threads] [calls per thread]\n", argv[0]);
+		return 2;
+	}
+
+	Workload const Load{};
+	std::printf("%zu threads, %zu calls each\n", nThreads, nCalls);
+
+	RunSynchronous(Load, nThreads, nCalls);
+	RunQueued(Load, nThreads, nCalls, TraceOverflow::Drop, true);
+	RunQueued(Load, nThreads, nCalls, TraceOverflow::Drop, false);
+	RunQueued(Load, nThreads, nCalls, TraceOverflow::Block, false);
+
+	return 0;
+}
@@ -0,0 +1,287 @@
+#pragma once
+
+// Host stand-in for the few Win32 calls of ../../Trace.cpp , so that the binary trace writer can be built
+// and run by the benchmark on Linux, see its trace mode. Files are mapped with mmap, and what Windows
+// refuses is refused here too, e.g. trimming a file while a view or mapping of it is still open.
+//
+// spdlog only takes wide messages on Windows, so log macros are redirected to stderr for the writer.
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#include <spdlog/fmt/fmt.h>
+#include <spdlog/fmt/xchar.h>
+
+#include "Common/Logging.hpp"
+
+
+// ! Types and constants.
+// ========================================
+
+using BOOL = int;
+using DWORD = std::uint32_t;
+using LONGLONG = std::int64_t;
+using ULONGLONG = std::uint64_t;
+using HANDLE = void*;
+
+union LARGE_INTEGER
+{
+    struct { DWORD LowPart; std::int32_t HighPart; };
+    LONGLONG QuadPart;
+};
+
+union ULARGE_INTEGER
+{
+    struct { DWORD LowPart; DWORD HighPart; };
+    ULONGLONG QuadPart;
+};
+
+inline HANDLE const INVALID_HANDLE_VALUE = reinterpret_cast<HANDLE>(static_cast<std::intptr_t>(-1));
+
+constexpr DWORD GENERIC_READ = 0x80000000;
+constexpr DWORD GENERIC_WRITE = 0x40000000;
+constexpr DWORD FILE_SHARE_READ = 0x1;
+constexpr DWORD CREATE_ALWAYS = 2;
+constexpr DWORD FILE_ATTRIBUTE_NORMAL = 0x80;
+constexpr DWORD PAGE_READWRITE = 0x4;
+constexpr DWORD FILE_MAP_WRITE = 0x2;
+constexpr DWORD FILE_BEGIN = 0;
+
+constexpr DWORD ERROR_INVALID_HANDLE = 6;
+constexpr DWORD ERROR_USER_MAPPED_FILE = 1224;
+
+
+// ! Handle bookkeeping.
+// ========================================
+
+namespace PosixShim
+{
+    enum class HandleKind { File, Mapping };
+
+    struct HandleState final
+    {
+        HandleKind      Kind;
+        int             Descriptor;
+    };
+
+    struct ViewState final
+    {
+        int             Descriptor;
+        std::size_t     Size;
+    };
+
+    struct Registry final
+    {
+        std::mutex                      Mutex;
+        std::map<HANDLE, HandleState>   Handles{};
+        std::map<void*, ViewState>      Views{};
+        std::intptr_t                   NextHandle{ 0x100 };
+
+        // Mappings and views keep a file in use, like they do on Windows.
+        bool IsMapped(int const Descriptor) const
+        {
+            for (auto const& [_, State] : Handles)
+                if (State.Kind == HandleKind::Mapping && State.Descriptor == Descriptor)
+                    return true;
+            for (auto const& [_, State] : Views)
+                if (State.Descriptor == Descriptor)
+                    return true;
+            return false;
+        }
+    };
+
+    inline Registry g_registry{};
+    inline thread_local DWORD t_lastError = 0;
+
+    inline HANDLE AddHandle(HandleKind const Kind, int const Descriptor)
+    {
+        std::scoped_lock const Lock{ g_registry.Mutex };
+        auto const Handle = reinterpret_cast<HANDLE>(g_registry.NextHandle++);
+        g_registry.Handles.emplace(Handle, HandleState{ Kind, Descriptor });
+        return Handle;
+    }
+
+    inline HandleState const* FindHandle(HANDLE const Handle)
+    {
+        auto const Iter = g_registry.Handles.find(Handle);
+        return Iter != g_registry.Handles.end() ? &Iter->second : nullptr;
+    }
+
+    template<typename Char, typename... Args>
+    void Log(char const* const Level, Char const* const Format, Args const&... InArgs)
+    {
+        auto const Message = fmt::format(fmt::runtime(std::basic_string_view<Char>{ Format }), InArgs...);
+
+        // Paths of the benchmark are plain ASCII.
+        std::string Narrow{};
+        for (auto const Unit : Message)
+            Narrow.push_back(static_cast<char>(Unit));
+        std::fprintf(stderr, "[%s] %s\n", Level, Narrow.c_str());
+    }
+}
+
+#undef LEASI_INFO
+#undef LEASI_WARN
+#undef LEASI_ERROR
+#define LEASI_INFO(...)                     ::PosixShim::Log("info", __VA_ARGS__)
+#define LEASI_WARN(...)                     ::PosixShim::Log("warning", __VA_ARGS__)
+#define LEASI_ERROR(...)                    ::PosixShim::Log("error", __VA_ARGS__)
+
+
+// ! Win32 functions.
+// ========================================
+
+inline DWORD GetLastError()
+{
+    return PosixShim::t_lastError;
+}
+
+inline HANDLE CreateFileW(wchar_t const* const Path, DWORD, DWORD, void*, DWORD const Disposition, DWORD, HANDLE)
+{
+    std::string Narrow{};
+    for (wchar_t const* Char = Path; *Char != L'\0'; ++Char)
+        Narrow.push_back(static_cast<char>(*Char));
+
+    int const Flags = O_RDWR | O_CREAT | (Disposition == CREATE_ALWAYS ? O_TRUNC : 0);
+    int const Descriptor = ::open(Narrow.c_str(), Flags, 0644);
+    if (Descriptor < 0)
+    {
+        PosixShim::t_lastError = static_cast<DWORD>(errno);
+        return INVALID_HANDLE_VALUE;
+    }
+
+    return PosixShim::AddHandle(PosixShim::HandleKind::File, Descriptor);
+}
+
+inline HANDLE CreateFileMappingW(HANDLE const File, void*, DWORD, DWORD const SizeHigh, DWORD const SizeLow, wchar_t const*)
+{
+    int Descriptor = -1;
+    {
+        std::scoped_lock const Lock{ PosixShim::g_registry.Mutex };
+        PosixShim::HandleState const* const State = PosixShim::FindHandle(File);
+        if (State == nullptr || State->Kind != PosixShim::HandleKind::File)
+        {
+            PosixShim::t_lastError = ERROR_INVALID_HANDLE;
+            return nullptr;
+        }
+        Descriptor = State->Descriptor;
+    }
+
+    // Mapping more than the file holds grows it, with zeroes.
+    auto const Size = static_cast<off_t>((ULONGLONG{ SizeHigh } << 32) | SizeLow);
+    if (::lseek(Descriptor, 0, SEEK_END) < Size && ::ftruncate(Descriptor, Size) != 0)
+    {
+        PosixShim::t_lastError = static_cast<DWORD>(errno);
+        return nullptr;
+    }
+
+    return PosixShim::AddHandle(PosixShim::HandleKind::Mapping, Descriptor);
+}
+
+inline void* MapViewOfFile(HANDLE const Mapping, DWORD, DWORD, DWORD, std::size_t const Size)
+{
+    std::scoped_lock const Lock{ PosixShim::g_registry.Mutex };
+    PosixShim::HandleState const* const State = PosixShim::FindHandle(Mapping);
+    if (State == nullptr || State->Kind != PosixShim::HandleKind::Mapping)
+    {
+        PosixShim::t_lastError = ERROR_INVALID_HANDLE;
+        return nullptr;
+    }
+
+    void* const View = ::mmap(nullptr, Size, PROT_READ | PROT_WRITE, MAP_SHARED, State->Descriptor, 0);
+    if (View == MAP_FAILED)
+    {
+        PosixShim::t_lastError = static_cast<DWORD>(errno);
+        return nullptr;
+    }
+
+    PosixShim::g_registry.Views.emplace(View, PosixShim::ViewState{ State->Descriptor, Size });
+    return View;
+}
+
+inline BOOL UnmapViewOfFile(void const* const View)
+{
+    std::scoped_lock const Lock{ PosixShim::g_registry.Mutex };
+    auto const Iter = PosixShim::g_registry.Views.find(const_cast<void*>(View));
+    if (Iter == PosixShim::g_registry.Views.end())
+    {
+        PosixShim::t_lastError = ERROR_INVALID_HANDLE;
+        return 0;
+    }
+
+    ::munmap(Iter->first, Iter->second.Size);
+    PosixShim::g_registry.Views.erase(Iter);
+    return 1;
+}
+
+inline BOOL CloseHandle(HANDLE const Handle)
+{
+    std::scoped_lock const Lock{ PosixShim::g_registry.Mutex };
+    auto const Iter = PosixShim::g_registry.Handles.find(Handle);
+    if (Iter == PosixShim::g_registry.Handles.end())
+    {
+        PosixShim::t_lastError = ERROR_INVALID_HANDLE;
+        return 0;
+    }
+
+    if (Iter->second.Kind == PosixShim::HandleKind::File)
+        ::close(Iter->second.Descriptor);
+    PosixShim::g_registry.Handles.erase(Iter);
+    return 1;
+}
+
+inline BOOL SetFilePointerEx(HANDLE const File, LARGE_INTEGER const Distance, LARGE_INTEGER* const NewPosition, DWORD)
+{
+    std::scoped_lock const Lock{ PosixShim::g_registry.Mutex };
+    PosixShim::HandleState const* const State = PosixShim::FindHandle(File);
+    if (State == nullptr || State->Kind != PosixShim::HandleKind::File)
+    {
+        PosixShim::t_lastError = ERROR_INVALID_HANDLE;
+        return 0;
+    }
+
+    off_t const Position = ::lseek(State->Descriptor, static_cast<off_t>(Distance.QuadPart), SEEK_SET);
+    if (Position < 0)
+    {
+        PosixShim::t_lastError = static_cast<DWORD>(errno);
+        return 0;
+    }
+
+    if (NewPosition != nullptr)
+        NewPosition->QuadPart = Position;
+    return 1;
+}
+
+inline BOOL SetEndOfFile(HANDLE const File)
+{
+    std::scoped_lock const Lock{ PosixShim::g_registry.Mutex };
+    PosixShim::HandleState const* const State = PosixShim::FindHandle(File);
+    if (State == nullptr || State->Kind != PosixShim::HandleKind::File)
+    {
+        PosixShim::t_lastError = ERROR_INVALID_HANDLE;
+        return 0;
+    }
+
+    if (PosixShim::g_registry.IsMapped(State->Descriptor))
+    {
+        PosixShim::t_lastError = ERROR_USER_MAPPED_FILE;
+        return 0;
+    }
+
+    if (::ftruncate(State->Descriptor, ::lseek(State->Descriptor, 0, SEEK_CUR)) != 0)
+    {
+        PosixShim::t_lastError = static_cast<DWORD>(errno);
+        return 0;
+    }
+
+    return 1;
+}
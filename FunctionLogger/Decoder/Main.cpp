@@ -0,0 +1,240 @@
+// Decodes binary traces written by FunctionLogger with -functionlogbinary back into the text format of
+// FunctionLog.log, and reports how many records were decoded, and how fast.
+//
+// The decoder runs on a Linux host, outside of the game and of the CMake project, e.g. from this folder:
+//   g++ -std=c++20 -O2 -I../.. Main.cpp ../TraceText.cpp -o decoder
+//   ./decoder [--threads] FunctionLog.*.trace > FunctionLog.log
+//
+// Segments have to be given in order, which is how a shell expands the glob above. With --threads,
+// every line also carries the ID of the thread which made the call.
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <algorithm>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "FunctionLogger/TraceFormat.hpp"
+#include "FunctionLogger/TraceText.hpp"
+
+using namespace FunctionLogger;
+
+
+namespace
+{
+	// Decoded text is written out in chunks of about this size.
+	constexpr std::size_t k_outputChunk = 1 << 20;
+
+	// Records formatted at once, which always fits the longest name.
+	constexpr std::size_t k_inputChunk = 16 * 1024;
+
+	struct Options final
+	{
+		bool                        bThreads{ false };
+		std::vector<char const*>    Segments{};
+	};
+
+	struct Totals final
+	{
+		std::uint64_t   Calls{ 0 };
+		std::uint64_t   Names{ 0 };
+		std::uint64_t   Bytes{ 0 };
+	};
+
+	/// @brief      Decodes names and calls, keeping names across segments of the same trace.
+	class TraceDecoder final
+	{
+	public:
+
+		explicit TraceDecoder(bool const bInThreads)
+			: Formatter{ bInThreads }
+		{
+			Output.reserve(k_outputChunk + 4096);
+			Output.append("[FunctionLogger log initialized]\n");
+		}
+
+		bool Decode(char const* const Path)
+		{
+			int const Descriptor = ::open(Path, O_RDONLY);
+			if (Descriptor < 0)
+			{
+				std::fprintf(stderr, "failed to open %s: %s\n", Path, std::strerror(errno));
+				return false;
+			}
+
+			struct stat Status{};
+			if (::fstat(Descriptor, &Status) != 0 || static_cast<std::size_t>(Status.st_size) < sizeof(TraceSegmentHeader))
+			{
+				std::fprintf(stderr, "%s is not a trace segment\n", Path);
+				::close(Descriptor);
+				return false;
+			}
+
+			auto const Size = static_cast<std::size_t>(Status.st_size);
+			void* const Mapped = ::mmap(nullptr, Size, PROT_READ, MAP_PRIVATE, Descriptor, 0);
+			::close(Descriptor);
+
+			if (Mapped == MAP_FAILED)
+			{
+				std::fprintf(stderr, "failed to map %s: %s\n", Path, std::strerror(errno));
+				return false;
+			}
+
+			::madvise(Mapped, Size, MADV_SEQUENTIAL);
+			bool const bDecoded = DecodeSegment(Path, static_cast<unsigned char const*>(Mapped), Size);
+			::munmap(Mapped, Size);
+			return bDecoded;
+		}
+
+		void Finish(Totals& OutTotals)
+		{
+			Flush();
+			OutTotals.Calls = Formatter.GetStats().Calls;
+			OutTotals.Names = Formatter.GetStats().Names;
+			OutTotals.Bytes = Bytes;
+		}
+
+	private:
+
+		bool DecodeSegment(char const* const Path, unsigned char const* const Data, std::size_t const Size)
+		{
+			TraceSegmentHeader Header{};
+			std::memcpy(&Header, Data, sizeof Header);
+
+			if (Header.Magic != k_traceMagic || Header.Version != k_traceVersion || Header.RecordSize != sizeof(TraceRecord))
+			{
+				std::fprintf(stderr, "%s is not a version %u trace segment\n", Path, k_traceVersion);
+				return false;
+			}
+
+			if (nSegments == 0)
+			{
+				Formatter.SetClock(Header.StartTsc, Header.TscFrequency);
+				StartTsc = Header.StartTsc;
+			}
+			else if (Header.StartTsc != StartTsc)
+			{
+				std::fprintf(stderr, "%s belongs to another trace\n", Path);
+				return false;
+			}
+
+			if (Header.Segment != nSegments)
+				std::fprintf(stderr, "%s is segment %u, expected %u, names may be missing\n", Path, Header.Segment, nSegments);
+			nSegments = Header.Segment + 1;
+
+			auto const* const Records = reinterpret_cast<TraceRecord const*>(Data + sizeof(TraceSegmentHeader));
+			std::size_t const Count = (Size - sizeof(TraceSegmentHeader)) / sizeof(TraceRecord);
+
+			std::size_t Position = 0;
+			while (Position < Count)
+			{
+				std::size_t const Chunk = (std::min)(Count - Position, k_inputChunk);
+				std::size_t const Consumed = Formatter.Append(Records + Position, Chunk, Output);
+				Position += Consumed;
+
+				if (Output.size() >= k_outputChunk)
+					Flush();
+
+				if (Consumed == Chunk)
+					continue;
+
+				// A chunk may end within a name, which is formatted with the next one.
+				TraceRecord const& Stop = Records[Position];
+				if (Stop.Kind == TraceKind::None)
+				{
+					// Zeroed space past the last record of a game which crashed.
+					return true;
+				}
+				if (Stop.Kind == TraceKind::ObjectPath || Stop.Kind == TraceKind::FunctionName)
+				{
+					if (Position + GetTraceRecordSpan(Stop) > Count)
+					{
+						std::fprintf(stderr, "%s ends within a name\n", Path);
+						return true;
+					}
+					continue;
+				}
+
+				std::fprintf(stderr, "%s has a record of unknown kind %u at offset %zu\n", Path,
+					static_cast<unsigned>(Stop.Kind), sizeof(TraceSegmentHeader) + Position * sizeof(TraceRecord));
+				return false;
+			}
+
+			return true;
+		}
+
+		void Flush()
+		{
+			std::fwrite(Output.data(), 1, Output.size(), stdout);
+			Bytes += Output.size();
+			Output.clear();
+		}
+
+		TraceFormatter              Formatter;
+		std::uint32_t               nSegments{ 0 };
+		std::uint64_t               StartTsc{ 0 };
+
+		std::string                 Output{};
+		std::uint64_t               Bytes{ 0 };
+	};
+
+	bool ParseOptions(int const argc, char** const argv, Options& OutOptions)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			std::string_view const Argument{ argv[i] };
+			if (Argument == "--threads")
+				OutOptions.bThreads = true;
+			else if (Argument.starts_with("--"))
+				return false;
+			else
+				OutOptions.Segments.push_back(argv[i]);
+		}
+
+		return !OutOptions.Segments.empty();
+	}
+}
+
+
+int main(int argc, char** argv)
+{
+	Options Opts{};
+	if (!ParseOptions(argc, argv, Opts))
+	{
+		std::fprintf(stderr, "usage: %s [--threads] <segment>...\n", argv[0]);
+		return 2;
+	}
+
+	auto const Start = std::chrono::steady_clock::now();
+
+	TraceDecoder Decoder{ Opts.bThreads };
+	bool bDecoded = true;
+	for (char const* const Segment : Opts.Segments)
+	{
+		if (!Decoder.Decode(Segment))
+		{
+			bDecoded = false;
+			break;
+		}
+	}
+
+	Totals Result{};
+	Decoder.Finish(Result);
+
+	double const Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+	std::fprintf(stderr, "decoded %" PRIu64 " calls and %" PRIu64 " names into %.1f MiB in %.3f s (%.1f M calls/s)\n",
+		Result.Calls, Result.Names, static_cast<double>(Result.Bytes) / (1024.0 * 1024.0), Seconds,
+		Seconds > 0.0 ? static_cast<double>(Result.Calls) / Seconds * 1e-6 : 0.0);
+
+	return bDecoded ? 0 : 1;
+}
@@ -2,6 +2,7 @@
 #include "Common/Base.hpp"
 #include "FunctionLogger/Entry.hpp"
 #include "FunctionLogger/Hooks.hpp"
+#include "FunctionLogger/Trace.hpp"
 
 constexpr auto loggerName = "FunctionLogger";
 
@@ -20,17 +21,48 @@ SPI_IMPLEMENT_ATTACH
 		outputType = Common::ME3TweaksLogger::LogOutput(outputType | Common::ME3TweaksLogger::LogOutput::OutputToConsole);
 		::LESDK::InitializeConsole();
 	}
-	try
+	std::unique_ptr<::FunctionLogger::TraceSink> sink;
+	if (nullptr != std::wcsstr(GetCommandLineW(), L" -functionlogbinary")) {
+		// Binary trace, decoded into FunctionLog.log format offline.
+		sink = std::make_unique<::FunctionLogger::TraceWriter>(L"FunctionLog");
+	}
+	else
 	{
-		::FunctionLogger::FileLogger = std::make_unique<Common::ME3TweaksLogger>(loggerName, outputType, "FunctionLog.log");
+		try
+		{
+			::FunctionLogger::FileLogger = std::make_unique<Common::ME3TweaksLogger>(loggerName, outputType, "FunctionLog.log");
+		}
+		catch (const spdlog::spdlog_ex& ex)
+		{
+			LEASI_ERROR("Failed to create FunctionLog.log: {}", ex.what());
+			return false;
+		}
+
+		sink = std::make_unique<::FunctionLogger::TextSink>(::FunctionLogger::FileLogger->GetLogger());
 	}
-	catch (const spdlog::spdlog_ex& ex)
+
+	// Hooked threads wait for the writer instead of dropping calls when their ring is full.
+	auto const overflow = nullptr != std::wcsstr(GetCommandLineW(), L" -functionlogblock")
+		? ::FunctionLogger::TraceOverflow::Block : ::FunctionLogger::TraceOverflow::Drop;
+
+	::FunctionLogger::Queue = std::make_unique<::FunctionLogger::TraceQueue>(std::move(sink), &::FunctionLogger::ResolveName, overflow);
+	if (!::FunctionLogger::Queue->IsRunning())
 	{
-		LEASI_ERROR("Failed to create FunctionLog.log: {}", ex.what());
+		::FunctionLogger::Queue.reset();
+		::FunctionLogger::FileLogger.reset();
+		spdlog::drop(loggerName);
 		return false;
 	}
 
+	// Write out whatever is still queued when the game crashes.
+	::FunctionLogger::gp_previousFilter = ::SetUnhandledExceptionFilter(::FunctionLogger::FlushOnCrash);
+
 	::FunctionLogger::InitializeGlobals(Init);
+
+	// Compile function filters for every function loaded so far, before any call is checked
+	::FunctionLogger::g_functionFilter.Load(::FunctionLogger::k_functionFilterFile);
+	::FunctionLogger::g_functionFilter.LogRules();
+
 	::FunctionLogger::InitializeHooks(Init);
 
 	return true;
@@ -40,6 +72,11 @@ SPI_IMPLEMENT_DETACH
 {
 	LEASI_UNUSED(InterfacePtr);
 
+	::SetUnhandledExceptionFilter(::FunctionLogger::gp_previousFilter);
+
+	// Drain queued calls, and close the binary trace if any, trimming its last segment
+	::FunctionLogger::Queue.reset();
+
 	// Flush and release file logger
 	if (::FunctionLogger::FileLogger)
 	{
@@ -55,6 +92,16 @@ SPI_IMPLEMENT_DETACH
 
 namespace FunctionLogger
 {
+	LPTOP_LEVEL_EXCEPTION_FILTER gp_previousFilter = nullptr;
+
+	LONG WINAPI FlushOnCrash(EXCEPTION_POINTERS* const ExceptionInfo)
+	{
+		if (Queue && !Queue->Flush(std::chrono::seconds{ 2 }))
+			LEASI_WARN("function log may be missing its last calls");
+
+		return gp_previousFilter != nullptr ? gp_previousFilter(ExceptionInfo) : EXCEPTION_CONTINUE_SEARCH;
+	}
+
 	void InitializeGlobals(::LESDK::Initializer& Init)
 	{
 		Common::InitializeRequiredGlobals(Init);
@@ -64,6 +111,13 @@ namespace FunctionLogger
 
 	void InitializeHooks(::LESDK::Initializer& Init)
 	{
+		// UEngine::Exec hook for fl.* console commands
+		// ----------------------------------------
+		auto const UEngine_Exec_target = Init.ResolveTyped<t_UEngine_Exec>(BUILTIN_EXEC_PHOOK);
+		CHECK_RESOLVED(UEngine_Exec_target);
+		UEngine_Exec_orig = (t_UEngine_Exec*)Init.InstallHook("UEngine::Exec", UEngine_Exec_target, UEngine_Exec_hook);
+		CHECK_RESOLVED(UEngine_Exec_orig);
+
 		// UObject::ProcessEvent hook for UnrealScript function logging
 		// ----------------------------------------
 		auto const UObject_ProcessEvent_target = Init.ResolveTyped<t_UObject_ProcessEvent>(BUILTIN_PROCESSEVENT_PHOOK);
@@ -79,6 +133,9 @@ namespace FunctionLogger
 		CHECK_RESOLVED(UObject_ProcessInternal_orig);
 
 		LEASI_INFO("hooks initialized");
-		LEASI_WARN("Crash game as soon as possible to keep log size down");
+		if (FileLogger)
+			LEASI_WARN("Crash game as soon as possible to keep log size down");
+		else
+			LEASI_INFO("Decode the binary trace with FunctionLogger/Decoder");
 	}
 }
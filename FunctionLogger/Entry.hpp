@@ -9,4 +9,10 @@ namespace FunctionLogger
 {
     void InitializeGlobals(::LESDK::Initializer& Init);
     void InitializeHooks(::LESDK::Initializer& Init);
+
+    /// @brief      Unhandled exception filter which was installed before ours, chained to.
+    extern LPTOP_LEVEL_EXCEPTION_FILTER gp_previousFilter;
+
+    /// @brief      Unhandled exception filter which writes out queued calls before the game dies.
+    LONG WINAPI FlushOnCrash(EXCEPTION_POINTERS* ExceptionInfo);
 }
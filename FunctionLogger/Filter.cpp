@@ -0,0 +1,302 @@
+#include <algorithm>
+#include <chrono>
+#include <cwctype>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "Common/Objects.hpp"
+#include "FunctionLogger/Filter.hpp"
+
+namespace FunctionLogger
+{
+	namespace
+	{
+		constexpr wchar_t const* k_fieldNames[] = { L"package", L"class", L"function", L"path" };
+
+		wchar_t Fold(wchar_t const Char)
+		{
+			return static_cast<wchar_t>(std::towlower(static_cast<wint_t>(Char)));
+		}
+
+		bool EqualsNoCase(std::wstring_view const Left, std::wstring_view const Right)
+		{
+			return Left.size() == Right.size()
+				&& std::equal(Left.begin(), Left.end(), Right.begin(), [](wchar_t const A, wchar_t const B) { return Fold(A) == Fold(B); });
+		}
+
+		/// Matches names the way Unreal compares them, i.e. regardless of case, with @c * and @c ? wildcards.
+		bool MatchGlob(std::wstring_view const Pattern, std::wstring_view const Text)
+		{
+			std::size_t p = 0, t = 0;
+			std::size_t StarP = std::wstring_view::npos, StarT = 0;
+
+			while (t < Text.size())
+			{
+				if (p < Pattern.size() && Pattern[p] == L'*')
+				{
+					StarP = p++;
+					StarT = t;
+				}
+				else if (p < Pattern.size() && (Pattern[p] == L'?' || Fold(Pattern[p]) == Fold(Text[t])))
+				{
+					p++;
+					t++;
+				}
+				else if (StarP != std::wstring_view::npos)
+				{
+					// Let the last star swallow one more character, and try again from there.
+					p = StarP + 1;
+					t = ++StarT;
+				}
+				else
+				{
+					return false;
+				}
+			}
+
+			while (p < Pattern.size() && Pattern[p] == L'*')
+				p++;
+			return p == Pattern.size();
+		}
+
+		/// Splits the first word off, skipping blanks around it.
+		std::wstring_view NextWord(std::wstring_view& InOutText)
+		{
+			std::size_t const Start = (std::min)(InOutText.find_first_not_of(L" \t\r\n"), InOutText.size());
+			std::size_t const End = (std::min)(InOutText.find_first_of(L" \t\r\n", Start), InOutText.size());
+
+			std::wstring_view const Word = InOutText.substr(Start, End - Start);
+			InOutText.remove_prefix(End);
+			return Word;
+		}
+
+		std::wstring ToWide(FString const& InString)
+		{
+			wchar_t const* const Chars = *InString;
+			return Chars != nullptr ? std::wstring{ Chars } : std::wstring{};
+		}
+	}
+
+	FunctionFilter g_functionFilter{};
+
+
+	// ! FunctionFilter implementation.
+	// ========================================
+
+	void FunctionFilter::Load(wchar_t const* const InPath)
+	{
+		std::vector<Rule> Loaded{};
+
+		// Each line is a rule, e.g. "include class SFXPawn*", "exclude function *Tick" or "include path SFXGame.".
+		std::ifstream File{ std::filesystem::path{ InPath } };
+		if (!File)
+		{
+			LEASI_INFO(L"no function filters at {}, logging every function", InPath);
+		}
+
+		std::string Line{};
+		for (int nLine = 1; std::getline(File, Line); ++nLine)
+		{
+			if (std::size_t const Comment = Line.find_first_of(";#"); Comment != std::string::npos)
+				Line.erase(Comment);
+
+			// Rules are plain ASCII, as are the names they match.
+			std::wstring const WideLine(Line.begin(), Line.end());
+			std::wstring_view Rest{ WideLine };
+			if (NextWord(Rest).empty())
+				continue;
+
+			Rule Parsed{};
+			if (!ParseRule(WideLine, Parsed))
+			{
+				LEASI_WARN(L"{}:{}: expected '<include|exclude> <package|class|function|path> <pattern>'", InPath, nLine);
+				continue;
+			}
+
+			Loaded.push_back(std::move(Parsed));
+		}
+
+		std::scoped_lock Lock(Mutex);
+		Rules = std::move(Loaded);
+		Recompile();
+	}
+
+	bool FunctionFilter::AddRule(std::wstring_view const InRule)
+	{
+		Rule Parsed{};
+		if (!ParseRule(InRule, Parsed))
+		{
+			LEASI_WARN(L"invalid function filter '{}', expected '<include|exclude> <package|class|function|path> <pattern>'", InRule);
+			return false;
+		}
+
+		std::scoped_lock Lock(Mutex);
+		Rules.push_back(std::move(Parsed));
+		Recompile();
+		return true;
+	}
+
+	void FunctionFilter::Clear()
+	{
+		std::scoped_lock Lock(Mutex);
+		Rules.clear();
+		Recompile();
+	}
+
+	void FunctionFilter::LogRules() const
+	{
+		std::scoped_lock Lock(Mutex);
+
+		if (Rules.empty())
+		{
+			LEASI_INFO(L"no function filters, logging every function");
+			return;
+		}
+
+		LEASI_INFO(L"function filters, the last one matching a function applies:");
+		for (Rule const& Item : Rules)
+		{
+			LEASI_INFO(L" - {} {} {}", Item.bInclude ? L"include" : L"exclude",
+				k_fieldNames[static_cast<std::size_t>(Item.Field)], Item.Pattern);
+		}
+
+		if (bAnyInclude)
+			LEASI_INFO(L"functions which no filter matches are excluded");
+	}
+
+	FunctionFilter::Stats FunctionFilter::GetStats() const
+	{
+		std::scoped_lock Lock(Mutex);
+		return Counters;
+	}
+
+	bool FunctionFilter::ParseRule(std::wstring_view InRule, Rule& OutRule) const
+	{
+		std::wstring_view const Action = NextWord(InRule);
+		std::wstring_view const Field = NextWord(InRule);
+		std::wstring_view const Pattern = NextWord(InRule);
+
+		if (Pattern.empty() || !NextWord(InRule).empty())
+			return false;
+
+		if (EqualsNoCase(Action, L"include"))
+			OutRule.bInclude = true;
+		else if (EqualsNoCase(Action, L"exclude"))
+			OutRule.bInclude = false;
+		else
+			return false;
+
+		auto const Iter = std::find_if(std::begin(k_fieldNames), std::end(k_fieldNames),
+			[Field](wchar_t const* const Name) { return EqualsNoCase(Field, Name); });
+		if (Iter == std::end(k_fieldNames))
+			return false;
+
+		OutRule.Field = static_cast<RuleField>(Iter - std::begin(k_fieldNames));
+		OutRule.Pattern = Pattern;
+		return true;
+	}
+
+	bool FunctionFilter::Compile(UObject* const Function, int const Index)
+	{
+		std::scoped_lock Lock(Mutex);
+
+		// Another thread may have matched the function while this one waited.
+		auto const Slot = static_cast<std::size_t>(Index);
+		if (Slot < k_filterMaxObjects)
+		{
+			std::uint64_t const State = (GetVerdict(Slot) >> (Slot % k_slotsPerWord * 2)) & 3;
+			if (State != k_unknown)
+				return State == k_included;
+		}
+
+		return Match(Function, Index);
+	}
+
+	bool FunctionFilter::Match(UObject* const Function, int const Index)
+	{
+		bool bIncluded = !bAnyInclude;
+
+		if (!Rules.empty())
+		{
+			UObject* Package = Function;
+			while (Package->Outer != nullptr)
+				Package = Package->Outer;
+
+			// State functions are declared within a state, itself within the class.
+			UObject* Class = Function->Outer;
+			while (Class != nullptr && Class->Cast<UClass>() == nullptr)
+				Class = Class->Outer;
+
+			std::wstring const PackageName = ToWide(Package->Name.ToString());
+			std::wstring const ClassName = Class != nullptr ? ToWide(Class->Name.ToString()) : std::wstring{};
+			std::wstring const FunctionName = ToWide(Function->Name.ToString());
+			std::wstring const FunctionPath = bAnyPath ? ToWide(Function->GetFullPath()) : std::wstring{};
+
+			for (Rule const& Item : Rules)
+			{
+				bool bMatched = false;
+				switch (Item.Field)
+				{
+				case RuleField::Package:
+					bMatched = MatchGlob(Item.Pattern, PackageName);
+					break;
+				case RuleField::Class:
+					bMatched = MatchGlob(Item.Pattern, ClassName);
+					break;
+				case RuleField::Function:
+					bMatched = MatchGlob(Item.Pattern, FunctionName);
+					break;
+				case RuleField::Path:
+					bMatched = FunctionPath.size() >= Item.Pattern.size()
+						&& EqualsNoCase(std::wstring_view{ FunctionPath }.substr(0, Item.Pattern.size()), Item.Pattern);
+					break;
+				}
+
+				if (bMatched)
+					bIncluded = Item.bInclude;
+			}
+		}
+
+		Counters.Compiled++;
+		if (bIncluded)
+			Counters.Included++;
+
+		// Objects outside of the object array or past the table are matched on every call,
+		// which never happens in practice.
+		auto const Slot = static_cast<std::size_t>(Index);
+		if (Slot >= k_filterMaxObjects)
+			return bIncluded;
+
+		// Only written while holding the lock, readers see either verdict.
+		std::size_t const Shift = Slot % k_slotsPerWord * 2;
+		std::atomic<std::uint64_t>& Word = Verdicts[Slot / k_slotsPerWord];
+		Word.store((Word.load(std::memory_order_relaxed) & ~(std::uint64_t{ 3 } << Shift))
+			| ((bIncluded ? k_included : k_excluded) << Shift), std::memory_order_relaxed);
+
+		return bIncluded;
+	}
+
+	void FunctionFilter::Recompile()
+	{
+		auto const Start = std::chrono::steady_clock::now();
+
+		bAnyInclude = std::any_of(Rules.begin(), Rules.end(), [](Rule const& Item) { return Item.bInclude; });
+		bAnyPath = std::any_of(Rules.begin(), Rules.end(), [](Rule const& Item) { return Item.Field == RuleField::Path; });
+
+		for (std::atomic<std::uint64_t>& Word : Verdicts)
+			Word.store(0, std::memory_order_relaxed);
+		Counters = Stats{};
+		Counters.Rules = Rules.size();
+
+		// Functions loaded later are compiled the first time they are called.
+		for (Common::TypedObjectIterator<UFunction> Iterator{}; Iterator; ++Iterator)
+			Match(*Iterator, Common::GetObjectIndex(*Iterator));
+
+		Counters.LastRecompileSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+		LEASI_INFO("function filters compiled: {} rules, {} of {} functions included, in {:.3f} ms",
+			Counters.Rules, Counters.Included, Counters.Compiled, Counters.LastRecompileSeconds * 1000);
+	}
+}
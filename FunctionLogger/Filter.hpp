@@ -0,0 +1,129 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <LESDK/Headers.hpp>
+#include "Common/Base.hpp"
+
+
+namespace FunctionLogger
+{
+    // Path of the file function filters are loaded from, relative to the game's working directory.
+    static constexpr wchar_t const* k_functionFilterFile = L"FunctionLogFilters.ini";
+
+    // Number of object indices verdicts are kept for, well above the object count of a running game.
+    // Functions past it are matched again on every call.
+    static constexpr std::size_t k_filterMaxObjects = std::size_t{ 1 } << 22;
+
+    /// @brief      Decides which functions are logged, from include and exclude rules compiled per function index.
+    /// @remarks    Rules are matched against a function's package, class and name with globs, or against
+    ///             the start of its path. Every function is matched once, when rules change or when it is first
+    ///             called, and its verdict is kept in two bits at its object index. Checking a call then
+    ///             takes a single load and test, before any name is built.
+    /// @remarks    Verdicts are not revisited when an index is taken over by another function, which only
+    ///             happens once a package declaring functions is unloaded. Changing the rules clears them.
+    /// @remarks    Calls are checked from every thread running script. Verdicts live in a fixed table of
+    ///             atomic words, so checking never waits, while matching functions, changing rules and
+    ///             reading stats are serialized by a mutex. Calls checked while rules change may still
+    ///             get the verdict of the previous rules.
+    class FunctionFilter final : public NonCopyable
+    {
+    public:
+
+        enum class RuleField : std::uint8_t
+        {
+            Package,        // Glob on the outermost package name, e.g. "SFXGame".
+            Class,          // Glob on the declaring class name, e.g. "SFXPawn*".
+            Function,       // Glob on the function name, e.g. "*Tick".
+            Path,           // Start of the function path, e.g. "SFXGame.SFXPawn.".
+        };
+
+        struct Rule final
+        {
+            bool            bInclude;
+            RuleField       Field;
+            std::wstring    Pattern;
+        };
+
+        struct Stats final
+        {
+            std::size_t     Rules{ 0 };
+            std::uint64_t   Compiled{ 0 };          // Functions matched against the rules since they changed.
+            std::uint64_t   Included{ 0 };
+            double          LastRecompileSeconds{ 0. };
+        };
+
+        /// @brief      Replaces rules with those of a file, one per line, and recompiles.
+        /// @remarks    A missing file is not an error, invalid lines are logged and skipped.
+        void Load(wchar_t const* InPath);
+
+        /// @brief      Appends a rule, e.g. "include class SFXPawn*" or "exclude function *Tick", and recompiles.
+        /// @return     Whether the rule was valid, it is logged otherwise.
+        bool AddRule(std::wstring_view InRule);
+
+        /// @brief      Drops every rule, so that every function is logged.
+        void Clear();
+
+        /// @brief      Logs rules in the order they apply.
+        void LogRules() const;
+
+        /// @brief      Checks whether calls to a function are logged, from any thread.
+        /// @param[in]  Index - Object index of the function.
+        bool Allows(UObject* const Function, int const Index)
+        {
+            auto const Slot = static_cast<std::size_t>(Index);
+            if (Slot < k_filterMaxObjects)
+            {
+                std::uint64_t const State = (GetVerdict(Slot) >> (Slot % k_slotsPerWord * 2)) & 3;
+                if (State != k_unknown)
+                    return State == k_included;
+            }
+
+            return Compile(Function, Index);
+        }
+
+        Stats GetStats() const;
+
+    private:
+
+        static constexpr std::size_t k_slotsPerWord = 32;
+
+        // Verdict of a slot, two bits each.
+        static constexpr std::uint64_t k_unknown = 0;
+        static constexpr std::uint64_t k_excluded = 1;
+        static constexpr std::uint64_t k_included = 2;
+
+        std::uint64_t GetVerdict(std::size_t const Slot) const
+        {
+            return Verdicts[Slot / k_slotsPerWord].load(std::memory_order_relaxed);
+        }
+
+        bool ParseRule(std::wstring_view InRule, Rule& OutRule) const;
+        bool Compile(UObject* Function, int Index);
+
+        // Both called while holding @ref Mutex .
+        bool Match(UObject* Function, int Index);
+        void Recompile();
+
+        // Guards everything but the verdicts, which are only written while holding it.
+        mutable std::mutex              Mutex;
+
+        std::vector<Rule>               Rules{};
+        bool                            bAnyInclude{ false };   // Functions no rule matches are excluded if so.
+        bool                            bAnyPath{ false };      // Whether function paths are built at all.
+
+        // Two bits per object index, never reallocated so that checking calls needs no lock.
+        std::array<std::atomic<std::uint64_t>, k_filterMaxObjects / k_slotsPerWord> Verdicts{};
+
+        Stats                           Counters{};
+    };
+
+    extern FunctionFilter g_functionFilter;
+}
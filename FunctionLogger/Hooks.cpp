@@ -1,4 +1,7 @@
+#include <string_view>
+#include <utility>
 #include "Hooks.hpp"
+#include "Common/Objects.hpp"
 
 namespace FunctionLogger
 {
@@ -6,6 +9,99 @@ namespace FunctionLogger
 	// ========================================
 
 	std::unique_ptr<Common::ME3TweaksLogger> FileLogger = nullptr;
+	std::unique_ptr<TraceQueue> Queue = nullptr;
+
+	void ResolveName(TraceKind const Kind, void const* const Object, std::u16string& OutText)
+	{
+		auto* const Target = static_cast<UObject*>(const_cast<void*>(Object));
+		FString const Name = Kind == TraceKind::ObjectPath ? Target->GetFullPath() : Target->GetFullName();
+
+		static_assert(sizeof(wchar_t) == sizeof(char16_t));
+		OutText.assign(reinterpret_cast<char16_t const*>(Name.Chars()), static_cast<std::size_t>(Name.Length()));
+	}
+
+	// ! UEngine::Exec hook
+	// ========================================
+
+	namespace
+	{
+		bool IsCmd(std::wstring_view& Command, std::wstring_view const Check)
+		{
+			if (Command.size() < Check.size() || _wcsnicmp(Command.data(), Check.data(), Check.size()) != 0)
+				return false;
+
+			Command.remove_prefix(Check.size());
+			return Command.empty() || Command.front() == L' ' || Command.front() == L'\t';
+		}
+
+		void LogStats()
+		{
+			FunctionFilter::Stats const Filter = g_functionFilter.GetStats();
+			LEASI_INFO(L"(stats) function filters:                 {} rule(s)", Filter.Rules);
+			LEASI_INFO(L"(stats) functions included / compiled:    {} / {}", Filter.Included, Filter.Compiled);
+			LEASI_INFO(L"(stats) last recompile time:              {:.3f} ms", Filter.LastRecompileSeconds * 1000);
+
+			if (Queue)
+			{
+				TraceQueue::Stats const Totals = Queue->GetStats();
+				LEASI_INFO(L"(stats) calls queued / dropped / stalled: {} / {} / {}", Totals.Calls, Totals.Dropped, Totals.Stalls);
+				LEASI_INFO(L"(stats) records written:                  {}", Totals.Written);
+			}
+		}
+	}
+
+	t_UEngine_Exec* UEngine_Exec_orig = nullptr;
+	unsigned UEngine_Exec_hook(UEngine* Context, wchar_t* Command, void* Archive)
+	{
+		static bool sb_commandsLogged = false;
+		if (!std::exchange(sb_commandsLogged, true))
+		{
+			LEASI_INFO(L"Available extra commands:");
+			LEASI_INFO(L" - fl.include <package|class|function|path> <pattern> - logs matching functions only");
+			LEASI_INFO(L" - fl.exclude <package|class|function|path> <pattern> - stops logging matching functions");
+			LEASI_INFO(L" - fl.clear - drops every filter, logging every function");
+			LEASI_INFO(L" - fl.reload - loads filters from {} again", k_functionFilterFile);
+			LEASI_INFO(L" - fl.filters - logs filters in the order they apply");
+			LEASI_INFO(L" - fl.stats - logs how many functions and calls were logged");
+		}
+
+		if (Command != nullptr)
+		{
+			std::wstring_view Cmd{ Command };
+			while (!Cmd.empty() && (Cmd.front() == L' ' || Cmd.front() == L'\t'))
+				Cmd.remove_prefix(1);
+
+			if (std::wstring_view Rule = Cmd; IsCmd(Rule, L"fl.include") || IsCmd(Rule, L"fl.exclude"))
+			{
+				// Rules read the same as in the filters file, without the prefix.
+				g_functionFilter.AddRule(Cmd.substr(3));
+				return TRUE;
+			}
+			else if (IsCmd(Cmd, L"fl.clear"))
+			{
+				g_functionFilter.Clear();
+				return TRUE;
+			}
+			else if (IsCmd(Cmd, L"fl.reload"))
+			{
+				g_functionFilter.Load(k_functionFilterFile);
+				g_functionFilter.LogRules();
+				return TRUE;
+			}
+			else if (IsCmd(Cmd, L"fl.filters"))
+			{
+				g_functionFilter.LogRules();
+				return TRUE;
+			}
+			else if (IsCmd(Cmd, L"fl.stats"))
+			{
+				LogStats();
+				return TRUE;
+			}
+		}
+
+		return UEngine_Exec_orig(Context, Command, Archive);
+	}
 
 	// ! UObject::ProcessEvent hook
 	// ========================================
@@ -13,13 +109,10 @@ namespace FunctionLogger
 	t_UObject_ProcessEvent* UObject_ProcessEvent_orig = nullptr;
 	void UObject_ProcessEvent_hook(UObject* Context, UFunction* Function, void* Parms, void* Result)
 	{
-		if (FileLogger)
+		if (int const FunctionIndex = Common::GetObjectIndex(Function); Queue && g_functionFilter.Allows(Function, FunctionIndex))
 		{
-			auto contextPath = Context->GetFullPath();
-			auto functionName = Function->GetFullName();
-
-			FileLogger->log(L"[U] {}->{}()", contextPath, functionName);
-			FileLogger->flush();
+			Queue->Record(TraceKind::ScriptCall, Context, Common::GetObjectIndex(Context),
+				Function, FunctionIndex);
 		}
 
 		UObject_ProcessEvent_orig(Context, Function, Parms, Result);
@@ -31,13 +124,10 @@ namespace FunctionLogger
 	t_UObject_ProcessInternal* UObject_ProcessInternal_orig = nullptr;
 	void UObject_ProcessInternal_hook(UObject* Context, FFrame* Stack, void* Result)
 	{
-		if (FileLogger)
+		if (int const NodeIndex = Common::GetObjectIndex(Stack->Node); Queue && g_functionFilter.Allows(Stack->Node, NodeIndex))
 		{
-			auto contextPath = Context->GetFullPath();
-			auto nodeName = Stack->Node->GetFullName();
-
-			FileLogger->log(L"[N] {}->{}()", contextPath, nodeName);
-			FileLogger->flush();
+			Queue->Record(TraceKind::NativeCall, Context, Common::GetObjectIndex(Context),
+				Stack->Node, NodeIndex);
 		}
 
 		UObject_ProcessInternal_orig(Context, Stack, Result);
@@ -1,10 +1,13 @@
 #pragma once
 
 #include <memory>
+#include <string>
 #include <LESDK/Headers.hpp>
 #include <LESDK/Init.hpp>
 #include "Common/Base.hpp"
 #include "Common/ME3TweaksLogger.hpp"
+#include "FunctionLogger/Filter.hpp"
+#include "FunctionLogger/Queue.hpp"
 
 namespace FunctionLogger
 {
@@ -13,6 +16,21 @@ namespace FunctionLogger
 
     extern std::unique_ptr<Common::ME3TweaksLogger> FileLogger;
 
+    // ! Queue of calls, drained into the file logger or a binary trace with -functionlogbinary
+    // ========================================
+
+    extern std::unique_ptr<TraceQueue> Queue;
+
+    /// @brief      Resolves names of objects and functions the first time a hooked thread sees them.
+    void ResolveName(TraceKind Kind, void const* Object, std::u16string& OutText);
+
+    // ! UEngine::Exec hook for changing function filters live.
+    // ========================================
+
+    using t_UEngine_Exec = unsigned(UEngine* Context, wchar_t* Command, void* Archive);
+    extern t_UEngine_Exec* UEngine_Exec_orig;
+    unsigned UEngine_Exec_hook(UEngine* Context, wchar_t* Command, void* Archive);
+
     // ! UObject::ProcessEvent hook for logging UnrealScript function calls.
     // ========================================
 
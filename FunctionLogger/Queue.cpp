@@ -0,0 +1,367 @@
+#if defined(_WIN32)
+    #include <Windows.h>
+#else
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+#include <utility>
+
+#include <spdlog/details/os.h>
+
+#include "Common/Logging.hpp"
+#include "FunctionLogger/Queue.hpp"
+
+namespace FunctionLogger
+{
+	namespace
+	{
+		std::uint32_t GetThreadId()
+		{
+#if defined(_WIN32)
+			return ::GetCurrentThreadId();
+#else
+			return static_cast<std::uint32_t>(::syscall(SYS_gettid));
+#endif
+		}
+
+		bool IsNamed(std::vector<void const*> const& Named, void const* const Object, int const Index)
+		{
+			// Indices of objects which are not in the object array can't be named.
+			if (Index < 0)
+				return true;
+
+			auto const Slot = static_cast<std::size_t>(Index);
+			return Slot < Named.size() && Named[Slot] == Object;
+		}
+
+		void MarkNamed(std::vector<void const*>& Named, void const* const Object, int const Index)
+		{
+			auto const Slot = static_cast<std::size_t>(Index);
+			if (Slot >= Named.size())
+				Named.resize(Slot + 1, nullptr);
+
+			Named[Slot] = Object;
+		}
+
+		// Longest name recorded, in bytes, anything longer is cut.
+		constexpr std::size_t k_maxNameLength = 0xFFFE;
+
+		std::atomic<std::uint64_t> g_nextQueueId{ 1 };
+	}
+
+
+	// ! TraceClock implementation.
+	// ========================================
+
+	TraceClock TraceClock::Calibrate()
+	{
+		auto const Start = std::chrono::steady_clock::now();
+		std::uint64_t const StartTsc = ReadTsc();
+
+		// Spin for about 20 ms rather than sleeping, so that neither clock is read late.
+		auto Now = Start;
+		do Now = std::chrono::steady_clock::now();
+		while (Now - Start < std::chrono::milliseconds{ 20 });
+
+		std::uint64_t const Ticks = ReadTsc() - StartTsc;
+		double const Seconds = std::chrono::duration<double>(Now - Start).count();
+
+		return TraceClock{ StartTsc, static_cast<std::uint64_t>(static_cast<double>(Ticks) / Seconds) };
+	}
+
+
+	// ! TextSink implementation.
+	// ========================================
+
+	TextSink::TextSink(std::shared_ptr<spdlog::logger> InLogger)
+		: Logger{ std::move(InLogger) }
+		, Formatter{ false, spdlog::details::os::default_eol }
+	{
+		Block.reserve(k_traceTextBlock + 4096);
+	}
+
+	bool TextSink::Start(TraceClock const& Clock)
+	{
+		Formatter.SetClock(Clock.StartTsc, Clock.TscFrequency);
+		return Logger != nullptr;
+	}
+
+	void TextSink::Write(TraceRecord const* const Records, std::size_t const Count)
+	{
+		if (Formatter.Append(Records, Count, Block) != Count)
+			LEASI_WARN("function log skipped malformed records");
+
+		if (Block.size() >= k_traceTextBlock)
+			WriteBlock();
+	}
+
+	void TextSink::Flush()
+	{
+		WriteBlock();
+		Logger->flush();
+	}
+
+	void TextSink::WriteBlock()
+	{
+		if (Block.empty())
+			return;
+
+		// The logger ends the message with a line of its own.
+		std::string_view const LineEnd{ spdlog::details::os::default_eol };
+		Logger->log(spdlog::level::trace, std::string_view{ Block.data(), Block.size() - LineEnd.size() });
+		Block.clear();
+	}
+
+
+	// ! TraceQueue implementation.
+	// ========================================
+
+	struct TraceQueue::ThreadState final
+	{
+		RecordRing<k_traceRingSize> Ring{};
+		std::uint32_t               ThreadId{ GetThreadId() };
+
+		// Only used by the owning thread.
+		std::vector<void const*>    NamedObjects{};     // Object whose path was last recorded, by index.
+		std::vector<void const*>    NamedFunctions{};   // Function whose name was last recorded, by index.
+		std::vector<TraceRecord>    Batch{};
+		std::u16string              Text{};
+
+		// Only written by the owning thread.
+		std::atomic<std::uint64_t>  Calls{ 0 };
+		std::atomic<std::uint64_t>  Dropped{ 0 };
+		std::atomic<std::uint64_t>  Stalls{ 0 };
+
+		static void Bump(std::atomic<std::uint64_t>& Counter) noexcept
+		{
+			Counter.store(Counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		}
+	};
+
+	TraceQueue::TraceQueue(std::unique_ptr<TraceSink> InSink, NameResolver const InResolver, TraceOverflow const InOverflow)
+		: Sink{ std::move(InSink) }
+		, Resolver{ InResolver }
+		, Overflow{ InOverflow }
+		, Clock{ TraceClock::Calibrate() }
+		, Id{ g_nextQueueId.fetch_add(1, std::memory_order_relaxed) }
+	{
+		if (!Sink->Start(Clock))
+			return;
+
+		bRunning.store(true, std::memory_order_relaxed);
+		WriteThread = std::thread{ &TraceQueue::WriteMain, this };
+
+		LEASI_INFO("function log writer started, timestamp counter at {:.3f} GHz, {} when full",
+			static_cast<double>(Clock.TscFrequency) * 1e-9, Overflow == TraceOverflow::Block ? "blocking" : "dropping");
+	}
+
+	TraceQueue::~TraceQueue()
+	{
+		if (!WriteThread.joinable())
+			return;
+
+		bWantsExit.store(true, std::memory_order_release);
+		WriteThread.join();
+		bRunning.store(false, std::memory_order_relaxed);
+
+		Stats const Totals = GetStats();
+		LEASI_INFO("function log closed: {} threads, {} calls, {} dropped, {} stalls, {} records written",
+			Totals.Threads, Totals.Calls, Totals.Dropped, Totals.Stalls, Totals.Written);
+	}
+
+	void TraceQueue::Record(TraceKind const Kind, void const* const Context, int const ContextIndex, void const* const Function, int const FunctionIndex)
+	{
+		std::uint64_t const Tsc = ReadTsc();
+		ThreadState& State = GetThreadState();
+		TraceRecord const Call{ Tsc, State.ThreadId, Kind, 0, 0, ContextIndex, FunctionIndex };
+
+		bool const bNameContext = !IsNamed(State.NamedObjects, Context, ContextIndex);
+		bool const bNameFunction = !IsNamed(State.NamedFunctions, Function, FunctionIndex);
+
+		if (!bNameContext && !bNameFunction)
+		{
+			Push(State, &Call, 1);
+			return;
+		}
+
+		// Don't resolve names only to drop them with the call, the smallest batch being a name and its call.
+		if (Overflow == TraceOverflow::Drop && State.Ring.SizeApprox() + 3 > State.Ring.Capacity)
+		{
+			ThreadState::Bump(State.Dropped);
+			return;
+		}
+
+		// Names go in the same batch as the call, so that they are dropped together.
+		State.Batch.clear();
+		if (bNameContext)
+			AppendName(State, TraceKind::ObjectPath, Context, ContextIndex, Tsc);
+		if (bNameFunction)
+			AppendName(State, TraceKind::FunctionName, Function, FunctionIndex, Tsc);
+		State.Batch.push_back(Call);
+
+		if (!Push(State, State.Batch.data(), State.Batch.size()))
+			return;
+
+		if (bNameContext)
+			MarkNamed(State.NamedObjects, Context, ContextIndex);
+		if (bNameFunction)
+			MarkNamed(State.NamedFunctions, Function, FunctionIndex);
+	}
+
+	bool TraceQueue::Flush(std::chrono::milliseconds const InTimeout)
+	{
+		if (!IsRunning())
+			return false;
+
+		std::uint64_t const Request = FlushRequested.fetch_add(1, std::memory_order_acq_rel) + 1;
+		auto const Deadline = std::chrono::steady_clock::now() + InTimeout;
+
+		while (FlushCompleted.load(std::memory_order_acquire) < Request)
+		{
+			if (std::chrono::steady_clock::now() >= Deadline)
+				return false;
+			std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
+		}
+
+		return true;
+	}
+
+	TraceQueue::Stats TraceQueue::GetStats()
+	{
+		Stats Result{};
+		Result.Written = Written.load(std::memory_order_relaxed);
+
+		std::scoped_lock const Lock{ ThreadsMutex };
+		Result.Threads = Threads.size();
+		for (std::unique_ptr<ThreadState> const& State : Threads)
+		{
+			Result.Calls += State->Calls.load(std::memory_order_relaxed);
+			Result.Dropped += State->Dropped.load(std::memory_order_relaxed);
+			Result.Stalls += State->Stalls.load(std::memory_order_relaxed);
+		}
+
+		return Result;
+	}
+
+	TraceQueue::ThreadState& TraceQueue::GetThreadState()
+	{
+		struct Cached final
+		{
+			std::uint64_t       QueueId{ 0 };
+			ThreadState*        State{ nullptr };
+		};
+
+		thread_local Cached t_cached{};
+		if (t_cached.QueueId == Id)
+			return *t_cached.State;
+
+		// First call on this thread, which only takes the lock this once.
+		auto NewState = std::make_unique<ThreadState>();
+		t_cached = Cached{ Id, NewState.get() };
+
+		std::scoped_lock const Lock{ ThreadsMutex };
+		Threads.push_back(std::move(NewState));
+		return *t_cached.State;
+	}
+
+	void TraceQueue::AppendName(ThreadState& State, TraceKind const Kind, void const* const Object, int const Index, std::uint64_t const Tsc)
+	{
+		State.Text.clear();
+		Resolver(Kind, Object, State.Text);
+
+		std::size_t const Length = (std::min)(State.Text.size() * sizeof(char16_t), k_maxNameLength);
+		std::size_t const First = State.Batch.size();
+
+		// Text padding is zeroed, which keeps traces reproducible.
+		State.Batch.resize(First + 1 + GetTraceTextRecords(Length), TraceRecord{});
+		State.Batch[First] = TraceRecord{ Tsc, State.ThreadId, Kind, 0, static_cast<std::uint16_t>(Length), Index, -1 };
+		if (Length != 0)
+			std::memcpy(&State.Batch[First + 1], State.Text.data(), Length);
+	}
+
+	bool TraceQueue::Push(ThreadState& State, TraceRecord const* const Records, std::size_t const Count)
+	{
+		if (!State.Ring.TryPush(Records, Count))
+		{
+			if (Overflow == TraceOverflow::Drop || !IsRunning())
+			{
+				ThreadState::Bump(State.Dropped);
+				return false;
+			}
+
+			ThreadState::Bump(State.Stalls);
+			while (!State.Ring.TryPush(Records, Count))
+			{
+				if (!IsRunning())
+				{
+					ThreadState::Bump(State.Dropped);
+					return false;
+				}
+
+				std::this_thread::yield();
+			}
+		}
+
+		ThreadState::Bump(State.Calls);
+		return true;
+	}
+
+	void TraceQueue::WriteMain()
+	{
+		std::vector<TraceRecord> Scratch(k_traceRingSize);
+		std::vector<ThreadState*> Sources{};
+		bool bUnflushed = false;
+
+		while (true)
+		{
+			// Both are read before draining, so that everything recorded before either is drained too.
+			std::uint64_t const Request = FlushRequested.load(std::memory_order_acquire);
+			bool const bExit = bWantsExit.load(std::memory_order_acquire);
+
+			Sources.clear();
+			{
+				std::scoped_lock const Lock{ ThreadsMutex };
+				for (std::unique_ptr<ThreadState> const& State : Threads)
+					Sources.push_back(State.get());
+			}
+
+			std::size_t Drained = 0;
+			for (ThreadState* const State : Sources)
+			{
+				std::size_t const Count = State->Ring.PopAll(Scratch.data());
+				if (Count == 0)
+					continue;
+
+				Sink->Write(Scratch.data(), Count);
+				Drained += Count;
+			}
+
+			if (Drained != 0)
+			{
+				Written.fetch_add(Drained, std::memory_order_relaxed);
+				bUnflushed = true;
+			}
+
+			// Flush once idle rather than after every pass, so that busy periods are written in large blocks.
+			bool const bFlushRequested = Request != FlushCompleted.load(std::memory_order_relaxed);
+			if (bUnflushed && (Drained == 0 || bFlushRequested || bExit))
+			{
+				Sink->Flush();
+				bUnflushed = false;
+			}
+
+			if (bFlushRequested)
+				FlushCompleted.store(Request, std::memory_order_release);
+
+			if (bExit)
+				break;
+
+			if (Drained == 0)
+				std::this_thread::sleep_for(std::chrono::milliseconds{ k_traceIdleMs });
+		}
+	}
+}
@@ -0,0 +1,183 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#else
+    #include <x86intrin.h>
+#endif
+
+#include "FunctionLogger/Ring.hpp"
+#include "FunctionLogger/TraceFormat.hpp"
+#include "FunctionLogger/TraceText.hpp"
+
+// Note that this header intentionally does not depend on LESDK, so that the queue can be
+// exercised outside of the game, see the Benchmark folder.
+
+namespace spdlog
+{
+    class logger;
+}
+
+
+namespace FunctionLogger
+{
+    // Records buffered for every hooked thread, a power of two, i.e. 1.5 MiB each.
+    static constexpr std::size_t k_traceRingSize = 64 * 1024;
+
+    // Interval at which an idle writer looks for new records again.
+    static constexpr int k_traceIdleMs = 2;
+
+    // Bytes of text formatted before being handed to the logger at once.
+    static constexpr std::size_t k_traceTextBlock = 1024 * 1024;
+
+    /// @brief      What a hooked thread does when its ring is full.
+    enum class TraceOverflow : std::uint8_t
+    {
+        Drop,           // Drops the call, counting it.
+        Block,          // Waits for the writer to make room.
+    };
+
+    /// @brief      Reads the timestamp counter, which is what trace records are stamped with.
+    inline std::uint64_t ReadTsc() noexcept
+    {
+        return __rdtsc();
+    }
+
+    /// @brief      Time base of a trace.
+    struct TraceClock final
+    {
+        std::uint64_t   StartTsc{ 0 };
+        std::uint64_t   TscFrequency{ 1 };      // Timestamp counter ticks per second.
+
+        /// @brief      Starts a clock, measuring how fast the timestamp counter ticks against the steady clock.
+        static TraceClock Calibrate();
+    };
+
+
+    // ! Trace sinks.
+    // ========================================
+
+    /// @brief      Destination of records drained by the background writer, only ever used from its thread.
+    class TraceSink
+    {
+    public:
+
+        virtual ~TraceSink() = default;
+
+        /// @brief      Prepares the sink, before any record is written.
+        /// @return     Whether records can be written.
+        virtual bool Start(TraceClock const& Clock) = 0;
+
+        /// @brief      Writes records, which always end a batch.
+        virtual void Write(TraceRecord const* Records, std::size_t Count) = 0;
+
+        /// @brief      Hands everything written so far over to the system.
+        virtual void Flush() = 0;
+    };
+
+    /// @brief      Formats records into the lines of FunctionLog.log, and logs them in large blocks.
+    class TextSink final : public TraceSink
+    {
+    public:
+
+        /// @param[in]  InLogger - Logger which only writes messages as they are, i.e. with a "%v" pattern.
+        explicit TextSink(std::shared_ptr<spdlog::logger> InLogger);
+
+        bool Start(TraceClock const& Clock) override;
+        void Write(TraceRecord const* Records, std::size_t Count) override;
+        void Flush() override;
+
+    private:
+
+        void WriteBlock();
+
+        std::shared_ptr<spdlog::logger> Logger;
+        TraceFormatter              Formatter;
+        std::string                 Block{};
+    };
+
+
+    // ! Trace queue.
+    // ========================================
+
+    /// @brief      Hands calls from hooked threads over to a background writer.
+    /// @remarks    Every hooked thread appends records to a lock-free ring of its own, which the writer drains
+    ///             into the sink, so that hooks never format, allocate nor make a system call once warmed up.
+    ///             Names are only resolved the first time a thread sees an object index, and again when the
+    ///             index is taken over by another object, and travel in the same batch as the call.
+    class TraceQueue final
+    {
+    public:
+
+        struct Stats final
+        {
+            std::size_t     Threads{ 0 };
+            std::uint64_t   Calls{ 0 };
+            std::uint64_t   Dropped{ 0 };           // Calls which did not fit into a full ring.
+            std::uint64_t   Stalls{ 0 };            // Calls which waited for room in a full ring.
+            std::uint64_t   Written{ 0 };           // Records handed to the sink.
+        };
+
+        /// @brief      Resolves the text of a name record, called by hooked threads while the object is alive.
+        /// @param[in]  Kind - Either @ref TraceKind::ObjectPath or @ref TraceKind::FunctionName .
+        using NameResolver = void(*)(TraceKind Kind, void const* Object, std::u16string& OutText);
+
+        /// @param[in]  InSink - Destination of records, started before returning.
+        /// @param[in]  InResolver - Resolves names of objects the first time they show up.
+        /// @param[in]  InOverflow - What hooked threads do when their ring is full.
+        TraceQueue(std::unique_ptr<TraceSink> InSink, NameResolver InResolver, TraceOverflow InOverflow);
+        TraceQueue(TraceQueue const&) = delete;
+        TraceQueue& operator=(TraceQueue const&) = delete;
+
+        /// @brief      Drains every ring into the sink, and flushes it.
+        ~TraceQueue();
+
+        /// @brief      Whether the sink started, and the writer runs.
+        bool IsRunning() const noexcept { return bRunning.load(std::memory_order_relaxed); }
+
+        /// @brief      Records a call, called by any hooked thread.
+        /// @param[in]  Kind - Either @ref TraceKind::ScriptCall or @ref TraceKind::NativeCall .
+        void Record(TraceKind Kind, void const* Context, int ContextIndex, void const* Function, int FunctionIndex);
+
+        /// @brief      Waits for everything recorded so far to be written and flushed, e.g. on a fatal error.
+        /// @return     Whether it was, before the timeout.
+        bool Flush(std::chrono::milliseconds InTimeout);
+
+        Stats GetStats();
+
+    private:
+
+        struct ThreadState;
+
+        ThreadState& GetThreadState();
+        void AppendName(ThreadState& State, TraceKind Kind, void const* Object, int Index, std::uint64_t Tsc);
+        bool Push(ThreadState& State, TraceRecord const* Records, std::size_t Count);
+        void WriteMain();
+
+        std::unique_ptr<TraceSink>  Sink;
+        NameResolver                Resolver;
+        TraceOverflow               Overflow;
+        TraceClock                  Clock{};
+        std::uint64_t               Id;                     // Tells queues apart, even at the same address.
+
+        std::mutex                  ThreadsMutex;
+        std::vector<std::unique_ptr<ThreadState>> Threads{};   // Guarded by @ref ThreadsMutex .
+
+        std::atomic_bool            bRunning{ false };
+        std::atomic_bool            bWantsExit{ false };
+        std::atomic<std::uint64_t>  FlushRequested{ 0 };
+        std::atomic<std::uint64_t>  FlushCompleted{ 0 };
+        std::atomic<std::uint64_t>  Written{ 0 };
+        std::thread                 WriteThread{};
+    };
+}
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+
+#include "FunctionLogger/TraceFormat.hpp"
+
+// Note that this header intentionally does not depend on LESDK, like the trace format.
+
+
+namespace FunctionLogger
+{
+    /// @brief      Bounded lock-free queue of trace records between exactly one producer thread and one consumer thread.
+    /// @tparam     N - Capacity in records, which must be a power of two.
+    /// @remarks    Records are pushed in batches, e.g. a name followed by its text and the call which needs it,
+    ///             which the consumer only ever sees whole.
+    template<std::size_t N>
+    class RecordRing final
+    {
+        static_assert(N >= 2 && (N & (N - 1)) == 0, "capacity must be a power of two");
+
+        static constexpr std::size_t k_cacheLine = 64;
+
+        // Indices only ever increase, and are reduced modulo the capacity when accessing slots.
+        // Each is padded onto its own cache line, so that both sides don't invalidate each other.
+        std::atomic<std::size_t>    Head{ 0 };              // Next record to pop, written by the consumer.
+        char                        HeadPadding[k_cacheLine - sizeof(std::atomic<std::size_t>)]{};
+        std::atomic<std::size_t>    Tail{ 0 };              // Next record to push, written by the producer.
+        char                        TailPadding[k_cacheLine - sizeof(std::atomic<std::size_t>)]{};
+
+        std::size_t                 CachedHead{ 0 };        // Producer's last view of @ref Head .
+        char                        CachedHeadPadding[k_cacheLine - sizeof(std::size_t)]{};
+
+        std::unique_ptr<TraceRecord[]> Slots{ new TraceRecord[N] };
+
+    public:
+
+        static constexpr std::size_t Capacity = N;
+
+        RecordRing() = default;
+        RecordRing(RecordRing const&) = delete;
+        RecordRing& operator=(RecordRing const&) = delete;
+
+        /// @brief      Copies a batch of records into the ring, only called by the producer.
+        /// @return     Whether there was room for the whole batch, nothing is pushed otherwise.
+        bool TryPush(TraceRecord const* const Records, std::size_t const Count)
+        {
+            std::size_t const Position = Tail.load(std::memory_order_relaxed);
+
+            if (Position + Count - CachedHead > N)
+            {
+                CachedHead = Head.load(std::memory_order_acquire);
+                if (Position + Count - CachedHead > N)
+                    return false;
+            }
+
+            std::size_t const Offset = Position & (N - 1);
+            std::size_t const First = (std::min)(Count, N - Offset);
+            std::memcpy(&Slots[Offset], Records, First * sizeof(TraceRecord));
+            if (First != Count)
+                std::memcpy(&Slots[0], Records + First, (Count - First) * sizeof(TraceRecord));
+
+            Tail.store(Position + Count, std::memory_order_release);
+            return true;
+        }
+
+        /// @brief      Copies every record out of the ring, only called by the consumer.
+        /// @param[out] OutRecords - Receives the records, room for @ref Capacity of them is needed.
+        /// @return     Number of records, which only ever ends a batch.
+        std::size_t PopAll(TraceRecord* const OutRecords)
+        {
+            std::size_t const Position = Head.load(std::memory_order_relaxed);
+            std::size_t const Count = Tail.load(std::memory_order_acquire) - Position;
+            if (Count == 0)
+                return 0;
+
+            std::size_t const Offset = Position & (N - 1);
+            std::size_t const First = (std::min)(Count, N - Offset);
+            std::memcpy(OutRecords, &Slots[Offset], First * sizeof(TraceRecord));
+            if (First != Count)
+                std::memcpy(OutRecords + First, &Slots[0], (Count - First) * sizeof(TraceRecord));
+
+            Head.store(Position + Count, std::memory_order_release);
+            return Count;
+        }
+
+        /// @brief      Number of records, which may already be outdated when used by either side.
+        std::size_t SizeApprox() const noexcept
+        {
+            return Tail.load(std::memory_order_acquire) - Head.load(std::memory_order_acquire);
+        }
+    };
+}
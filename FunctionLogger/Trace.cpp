@@ -0,0 +1,138 @@
+#include <Windows.h>
+
+#include <cstring>
+#include <format>
+#include <utility>
+
+#include "Common/Logging.hpp"
+#include "FunctionLogger/Trace.hpp"
+
+namespace FunctionLogger
+{
+	// ! TraceWriter implementation.
+	// ========================================
+
+	TraceWriter::TraceWriter(std::wstring InBaseName)
+		: BaseName{ std::move(InBaseName) }
+	{
+	}
+
+	TraceWriter::~TraceWriter()
+	{
+		if (std::exchange(bOpen, false))
+			CloseSegment();
+
+		LEASI_INFO("trace closed: {} segments", nSegment + 1);
+	}
+
+	bool TraceWriter::Start(TraceClock const& InClock)
+	{
+		Clock = InClock;
+		bOpen = OpenSegment();
+
+		if (bOpen)
+			LEASI_INFO(L"tracing to {}.*.trace", BaseName);
+		return bOpen;
+	}
+
+	void TraceWriter::Write(TraceRecord const* const Records, std::size_t const Count)
+	{
+		std::size_t Position = 0;
+		while (bOpen && Position < Count)
+		{
+			// Only whole batches are copied, so that no name is split from its text across segments.
+			std::size_t const Room = (k_traceSegmentSize - Cursor) / sizeof(TraceRecord);
+			std::size_t End = Position;
+			while (End < Count && End + GetTraceRecordSpan(Records[End]) - Position <= Room)
+				End += GetTraceRecordSpan(Records[End]);
+
+			if (End != Position)
+			{
+				std::memcpy(View + Cursor, Records + Position, (End - Position) * sizeof(TraceRecord));
+				Cursor += (End - Position) * sizeof(TraceRecord);
+				Position = End;
+				continue;
+			}
+
+			CloseSegment();
+			nSegment++;
+
+			if (!OpenSegment())
+			{
+				LEASI_ERROR("tracing stopped at segment {}", nSegment);
+				bOpen = false;
+			}
+		}
+	}
+
+	void TraceWriter::Flush()
+	{
+		// Nothing to do, mapped pages are written back by the system.
+	}
+
+	bool TraceWriter::OpenSegment()
+	{
+		std::wstring const Path = std::format(L"{}.{:03}.trace", BaseName, nSegment);
+
+		HANDLE const FileHandle = ::CreateFileW(Path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ,
+			nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (FileHandle == INVALID_HANDLE_VALUE)
+		{
+			LEASI_ERROR(L"failed to create trace segment {}: error {}", Path, ::GetLastError());
+			return false;
+		}
+
+		// Mapping more than the file holds grows it, with zeroes.
+		ULARGE_INTEGER Size{};
+		Size.QuadPart = k_traceSegmentSize;
+		HANDLE const MappingHandle = ::CreateFileMappingW(FileHandle, nullptr, PAGE_READWRITE, Size.HighPart, Size.LowPart, nullptr);
+		if (MappingHandle == nullptr)
+		{
+			LEASI_ERROR(L"failed to preallocate trace segment {}: error {}", Path, ::GetLastError());
+			::CloseHandle(FileHandle);
+			return false;
+		}
+
+		void* const ViewPtr = ::MapViewOfFile(MappingHandle, FILE_MAP_WRITE, 0, 0, k_traceSegmentSize);
+		if (ViewPtr == nullptr)
+		{
+			LEASI_ERROR(L"failed to map trace segment {}: error {}", Path, ::GetLastError());
+			::CloseHandle(MappingHandle);
+			::CloseHandle(FileHandle);
+			return false;
+		}
+
+		File = FileHandle;
+		Mapping = MappingHandle;
+		View = static_cast<std::byte*>(ViewPtr);
+
+		auto* const Header = reinterpret_cast<TraceSegmentHeader*>(View);
+		Header->Magic = k_traceMagic;
+		Header->Version = k_traceVersion;
+		Header->Segment = nSegment;
+		Header->RecordSize = sizeof(TraceRecord);
+		Header->TscFrequency = Clock.TscFrequency;
+		Header->StartTsc = Clock.StartTsc;
+		Cursor = sizeof(TraceSegmentHeader);
+
+		return true;
+	}
+
+	void TraceWriter::CloseSegment()
+	{
+		::UnmapViewOfFile(View);
+		::CloseHandle(Mapping);
+
+		// Give back what was preallocated but never written.
+		LARGE_INTEGER End{};
+		End.QuadPart = static_cast<LONGLONG>(Cursor);
+		if (!::SetFilePointerEx(File, End, nullptr, FILE_BEGIN) || !::SetEndOfFile(File))
+			LEASI_WARN("failed to trim trace segment {}: error {}", nSegment, ::GetLastError());
+
+		::CloseHandle(File);
+
+		File = Mapping = nullptr;
+		View = nullptr;
+		Cursor = 0;
+	}
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "FunctionLogger/Queue.hpp"
+#include "FunctionLogger/TraceFormat.hpp"
+
+
+namespace FunctionLogger
+{
+    // Bytes preallocated for every segment file of a binary trace.
+    static constexpr std::size_t k_traceSegmentSize = 256 * 1024 * 1024;
+
+    /// @brief      Writes records as they are into memory-mapped, preallocated segment files.
+    /// @remarks    Segments are named @c <base>.000.trace , @c <base>.001.trace and so on, and are trimmed
+    ///             to the records written once full or closed. Mapped pages are written back by the system
+    ///             even if the game crashes, in which case the rest of the last segment stays zeroed.
+    ///             See the Decoder folder to turn traces into text.
+    class TraceWriter final : public TraceSink
+    {
+    public:
+
+        /// @param[in]  InBaseName - Path of the segment files, without their number and extension.
+        explicit TraceWriter(std::wstring InBaseName);
+        TraceWriter(TraceWriter const&) = delete;
+        TraceWriter& operator=(TraceWriter const&) = delete;
+        ~TraceWriter() override;
+
+        bool Start(TraceClock const& Clock) override;
+        void Write(TraceRecord const* Records, std::size_t Count) override;
+        void Flush() override;
+
+    private:
+
+        bool OpenSegment();
+        void CloseSegment();
+
+        std::wstring                BaseName;
+        TraceClock                  Clock{};
+
+        bool                        bOpen{ false };
+        std::uint32_t               nSegment{ 0 };
+        void*                       File{ nullptr };
+        void*                       Mapping{ nullptr };
+        std::byte*                  View{ nullptr };
+        std::size_t                 Cursor{ 0 };            // Bytes written to the current segment.
+    };
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Note that this header intentionally does not depend on LESDK, so that traces can be decoded
+// outside of the game, see the Decoder folder.
+
+
+namespace FunctionLogger
+{
+    // ! Binary trace layout.
+    // ========================================
+
+    // Identifies trace segments, "LEFT" when read as bytes.
+    static constexpr std::uint32_t k_traceMagic = 0x5446454C;
+    static constexpr std::uint32_t k_traceVersion = 1;
+
+    /// @brief      Kind of a trace record.
+    enum class TraceKind : std::uint8_t
+    {
+        None = 0,           // Unwritten space, which is where a segment of a crashed game ends.
+        ScriptCall,         // @c UObject::ProcessEvent , logged as [U].
+        NativeCall,         // @c UObject::ProcessInternal , logged as [N].
+        ObjectPath,         // Full path of the object at an index, followed by its text.
+        FunctionName,       // Full name of the function at an index, followed by its text.
+    };
+
+    /// @brief      Start of every segment file, followed by records up to the end of the file.
+    struct TraceSegmentHeader final
+    {
+        std::uint32_t   Magic;
+        std::uint32_t   Version;
+        std::uint32_t   Segment;            // Position of the segment within the trace, from zero.
+        std::uint32_t   RecordSize;
+        std::uint64_t   TscFrequency;       // Timestamp counter ticks per second.
+        std::uint64_t   StartTsc;           // Timestamp counter when tracing started, which is time zero.
+        std::uint8_t    Reserved[32];
+    };
+
+    static_assert(sizeof(TraceSegmentHeader) == 64);
+
+    /// @brief      Fixed-size trace record.
+    /// @remarks    Name records are followed by their UTF-16LE text, padded to whole records. Names belong to
+    ///             the thread which recorded them: a name record always precedes the first call record of
+    ///             its thread referring to its index, and is emitted again whenever another object takes the
+    ///             index over. Records of different threads may be written in any order.
+    struct TraceRecord final
+    {
+        std::uint64_t   Tsc;                // Timestamp counter when the call was made.
+        std::uint32_t   ThreadId;
+        TraceKind       Kind;
+        std::uint8_t    Reserved;
+        std::uint16_t   Length;             // Bytes of text following a name record.
+        std::int32_t    Object;             // Index of the context object, or of the named object.
+        std::int32_t    Function;           // Index of the called function.
+    };
+
+    static_assert(sizeof(TraceRecord) == 24);
+
+    /// @brief      Number of records taken up by text of a name record.
+    constexpr std::size_t GetTraceTextRecords(std::size_t const Length) noexcept
+    {
+        return (Length + sizeof(TraceRecord) - 1) / sizeof(TraceRecord);
+    }
+
+    /// @brief      Number of records taken up by a record, together with the text following it.
+    constexpr std::size_t GetTraceRecordSpan(TraceRecord const& Record) noexcept
+    {
+        bool const bName = Record.Kind == TraceKind::ObjectPath || Record.Kind == TraceKind::FunctionName;
+        return 1 + (bName ? GetTraceTextRecords(Record.Length) : 0);
+    }
+}
@@ -0,0 +1,156 @@
+#include <cinttypes>
+#include <cstdio>
+
+#include "FunctionLogger/TraceText.hpp"
+
+namespace FunctionLogger
+{
+	// ! TraceFormatter implementation.
+	// ========================================
+
+	TraceFormatter::TraceFormatter(bool const bInThreads, std::string_view const InLineEnd)
+		: bThreads{ bInThreads }
+		, LineEnd{ InLineEnd }
+	{
+	}
+
+	void TraceFormatter::SetClock(std::uint64_t const InStartTsc, std::uint64_t const InTscFrequency) noexcept
+	{
+		StartTsc = InStartTsc;
+		TscFrequency = InTscFrequency != 0 ? InTscFrequency : 1;
+	}
+
+	std::size_t TraceFormatter::Append(TraceRecord const* const Records, std::size_t const Count, std::string& OutText)
+	{
+		std::size_t Position = 0;
+		while (Position < Count)
+		{
+			TraceRecord const& Record = Records[Position];
+
+			switch (Record.Kind)
+			{
+			case TraceKind::ScriptCall:
+			case TraceKind::NativeCall:
+			{
+				// Same as ME3TweaksLogger::GetBootTimeString, with tracing having started at boot.
+				std::uint64_t const Delta = Record.Tsc > StartTsc ? Record.Tsc - StartTsc : 0;
+				auto const Milliseconds = static_cast<std::uint64_t>(static_cast<double>(Delta) * 1000.0 / static_cast<double>(TscFrequency));
+
+				char Prefix[64];
+				int const PrefixLength = bThreads
+					? std::snprintf(Prefix, sizeof Prefix, "[%04" PRIu64 ".%03" PRIu64 "] [%" PRIu32 "] ", Milliseconds / 1000, Milliseconds % 1000, Record.ThreadId)
+					: std::snprintf(Prefix, sizeof Prefix, "[%04" PRIu64 ".%03" PRIu64 "] ", Milliseconds / 1000, Milliseconds % 1000);
+
+				OutText.append(Prefix, static_cast<std::size_t>(PrefixLength));
+				ThreadNames const& Names = GetNames(Record.ThreadId);
+				OutText.append(Record.Kind == TraceKind::ScriptCall ? "[U] " : "[N] ");
+				AppendName(OutText, Names.ObjectPaths, Record.Object, "object");
+				OutText.append("->");
+				AppendName(OutText, Names.FunctionNames, Record.Function, "function");
+				OutText.append("()").append(LineEnd);
+
+				Counters.Calls++;
+				Position++;
+				break;
+			}
+
+			case TraceKind::ObjectPath:
+			case TraceKind::FunctionName:
+			{
+				std::size_t const TextRecords = GetTraceTextRecords(Record.Length);
+				if (Position + 1 + TextRecords > Count)
+					return Position;
+
+				ThreadNames& Thread = GetNames(Record.ThreadId);
+				std::vector<std::string>& Names = Record.Kind == TraceKind::ObjectPath ? Thread.ObjectPaths : Thread.FunctionNames;
+				if (Record.Object >= 0)
+				{
+					auto const Slot = static_cast<std::size_t>(Record.Object);
+					if (Slot >= Names.size())
+						Names.resize(Slot + 1);
+
+					Names[Slot].clear();
+					AppendUtf16(Names[Slot], reinterpret_cast<unsigned char const*>(Records + Position + 1), Record.Length);
+				}
+
+				Counters.Names++;
+				Position += 1 + TextRecords;
+				break;
+			}
+
+			default:
+				return Position;
+			}
+		}
+
+		return Position;
+	}
+
+	TraceFormatter::ThreadNames& TraceFormatter::GetNames(std::uint32_t const ThreadId)
+	{
+		if (LastNames == nullptr || ThreadId != LastThreadId)
+		{
+			LastNames = &Threads[ThreadId];
+			LastThreadId = ThreadId;
+		}
+
+		return *LastNames;
+	}
+
+	void TraceFormatter::AppendName(std::string& OutText, std::vector<std::string> const& Names, std::int32_t const Index, char const* const What) const
+	{
+		if (Index >= 0 && static_cast<std::size_t>(Index) < Names.size() && !Names[Index].empty())
+		{
+			OutText.append(Names[Index]);
+			return;
+		}
+
+		// Only happens when decoding without the segment which named the object.
+		OutText.append("<").append(What).append(" #").append(std::to_string(Index)).append(">");
+	}
+
+
+	// ! Text helpers.
+	// ========================================
+
+	void AppendUtf16(std::string& OutString, unsigned char const* const Text, std::size_t const Length)
+	{
+		for (std::size_t i = 0; i + 1 < Length; i += 2)
+		{
+			std::uint32_t Code = Text[i] | (Text[i + 1] << 8);
+
+			if (Code >= 0xD800 && Code < 0xDC00 && i + 3 < Length)
+			{
+				std::uint32_t const Low = Text[i + 2] | (Text[i + 3] << 8);
+				if (Low >= 0xDC00 && Low < 0xE000)
+				{
+					Code = 0x10000 + ((Code - 0xD800) << 10) + (Low - 0xDC00);
+					i += 2;
+				}
+			}
+
+			if (Code < 0x80)
+			{
+				OutString.push_back(static_cast<char>(Code));
+			}
+			else if (Code < 0x800)
+			{
+				OutString.push_back(static_cast<char>(0xC0 | (Code >> 6)));
+				OutString.push_back(static_cast<char>(0x80 | (Code & 0x3F)));
+			}
+			else if (Code < 0x10000)
+			{
+				OutString.push_back(static_cast<char>(0xE0 | (Code >> 12)));
+				OutString.push_back(static_cast<char>(0x80 | ((Code >> 6) & 0x3F)));
+				OutString.push_back(static_cast<char>(0x80 | (Code & 0x3F)));
+			}
+			else
+			{
+				OutString.push_back(static_cast<char>(0xF0 | (Code >> 18)));
+				OutString.push_back(static_cast<char>(0x80 | ((Code >> 12) & 0x3F)));
+				OutString.push_back(static_cast<char>(0x80 | ((Code >> 6) & 0x3F)));
+				OutString.push_back(static_cast<char>(0x80 | (Code & 0x3F)));
+			}
+		}
+	}
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "FunctionLogger/TraceFormat.hpp"
+
+// Note that this header intentionally does not depend on LESDK, like the trace format.
+
+
+namespace FunctionLogger
+{
+    /// @brief      Turns trace records back into lines of FunctionLog.log, remembering names along the way.
+    /// @remarks    Names are remembered per thread, like they are recorded. Records of different threads
+    ///             are not ordered with respect to each other, so a name recorded by one thread must not
+    ///             change what an index means in calls of another.
+    /// @remarks    Used by the background writer in text mode, and by the decoder for binary traces.
+    class TraceFormatter final
+    {
+    public:
+
+        struct Stats final
+        {
+            std::uint64_t   Calls{ 0 };
+            std::uint64_t   Names{ 0 };
+        };
+
+        /// @param[in]  bInThreads - Whether lines carry the ID of the thread which made the call.
+        /// @param[in]  InLineEnd - What every line ends with.
+        explicit TraceFormatter(bool bInThreads = false, std::string_view InLineEnd = "\n");
+
+        /// @brief      Sets the time base, which timestamps of formatted calls are relative to.
+        void SetClock(std::uint64_t InStartTsc, std::uint64_t InTscFrequency) noexcept;
+
+        /// @brief      Formats calls as lines of text, appending them to @c OutText .
+        /// @return     Number of records consumed, which is less than @c Count if a record is unused space
+        ///             ( @ref TraceKind::None ), of an unknown kind, or a name whose text is cut off.
+        std::size_t Append(TraceRecord const* Records, std::size_t Count, std::string& OutText);
+
+        Stats GetStats() const noexcept { return Counters; }
+
+    private:
+
+        struct ThreadNames final
+        {
+            std::vector<std::string> ObjectPaths{};         // UTF-8, by object index.
+            std::vector<std::string> FunctionNames{};       // UTF-8, by object index.
+        };
+
+        ThreadNames& GetNames(std::uint32_t ThreadId);
+        void AppendName(std::string& OutText, std::vector<std::string> const& Names, std::int32_t Index, char const* What) const;
+
+        bool                        bThreads;
+        std::string                 LineEnd;
+        std::uint64_t               StartTsc{ 0 };
+        std::uint64_t               TscFrequency{ 1 };
+
+        std::unordered_map<std::uint32_t, ThreadNames> Threads{};
+        ThreadNames*                LastNames{ nullptr };   // Of @ref LastThreadId , records come in runs of one thread.
+        std::uint32_t               LastThreadId{ 0 };
+
+        Stats                       Counters{};
+    };
+
+    /// @brief      Converts UTF-16LE text to UTF-8, appending it to @c OutString .
+    void AppendUtf16(std::string& OutString, unsigned char const* Text, std::size_t Length);
+}
@@ -0,0 +1,576 @@
+// Checks the parts of TextureOverride which don't depend on the game against known results,
+// and measures how fast they run.
+//
+// The benchmark runs on a Linux host, outside of the game and of the CMake project, e.g. from this folder:
+//   g++ -std=c++20 -O2 -I../.. Main.cpp ../BlockCompression.cpp ../CacheFormat.cpp ../Checksum.cpp -o benchmark
+//   ./benchmark [cache [records] | crc [MiB] | transcode [size]]
+//
+// Adding -DTEXTUREOVERRIDE_NO_SSE42 checks and measures the CRC-32C table implementation instead of SSE4.2.
+//
+// Every mode checks results first, and exits with 1 if any is wrong.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+#include "TextureOverride/BlockCompression.hpp"
+#include "TextureOverride/CacheFormat.hpp"
+#include "TextureOverride/Checksum.hpp"
+
+using namespace TextureOverride;
+
+
+namespace
+{
+    int g_failures = 0;
+
+    void Check(bool const bPassed, char const* const What)
+    {
+        if (!bPassed)
+        {
+            std::printf("FAILED: %s\n", What);
+            g_failures++;
+        }
+    }
+
+    double MillisecondsSince(std::chrono::steady_clock::time_point const Start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - Start).count();
+    }
+
+
+    // ! Payload cache file.
+    // ========================================
+
+    /// Builds cache files in memory, the same way the background writer appends to them.
+    struct CacheFileBuilder final
+    {
+        std::vector<unsigned char>  Bytes{};
+
+        CacheFileBuilder()
+        {
+            CCacheHeader Header{};
+            std::memcpy(Header.Magic, CCacheHeader::k_checkMagic, sizeof(CCacheHeader::k_checkMagic));
+            Header.Version = CCacheHeader::k_lastVersion;
+            Append(&Header, sizeof Header);
+        }
+
+        std::size_t AddRecord(ECacheRecordKind const Kind, std::uint32_t const Session, std::uint64_t const ManifestKey,
+            std::uint32_t const EntryIndex, std::uint32_t const MipIndex, std::uint32_t const Size)
+        {
+            CCacheRecord Record{};
+            Record.Magic = CCacheRecord::k_checkMagic;
+            Record.Kind = Kind;
+            Record.Session = Session;
+            Record.Size = Size;
+            Record.ManifestKey = ManifestKey;
+            Record.EntryIndex = EntryIndex;
+            Record.MipIndex = MipIndex;
+
+            std::size_t const Offset = Bytes.size();
+            Append(&Record, sizeof Record);
+            Bytes.resize(Offset + Record.GetStride(), static_cast<unsigned char>(EntryIndex));
+            return Offset;
+        }
+
+        void Append(void const* const Data, std::size_t const Size)
+        {
+            auto const First = static_cast<unsigned char const*>(Data);
+            Bytes.insert(Bytes.end(), First, First + Size);
+        }
+    };
+
+    void TestCacheScan()
+    {
+        std::unordered_set<std::uint64_t> const LiveManifests{ 1, 2 };
+        CacheFileBuilder File{};
+
+        std::size_t const First = File.AddRecord(ECR_Payload, 1, 1, 10, 0, 1000);
+        std::size_t const Orphan = File.AddRecord(ECR_Payload, 1, 3, 10, 0, 500);
+        std::size_t const Replaced = File.AddRecord(ECR_Payload, 2, 1, 11, 0, 64);
+        std::size_t const Touch = File.AddRecord(ECR_Touch, 4, 1, 10, 0, 0);
+        std::size_t const Latest = File.AddRecord(ECR_Payload, 3, 1, 11, 0, 80);
+        std::size_t const Other = File.AddRecord(ECR_Payload, 3, 2, 10, 1, 16);
+        std::size_t const End = File.Bytes.size();
+
+        CacheIndex Index{};
+        CacheScanResult const Scan = ScanCacheRecords(File.Bytes, LiveManifests, Index);
+
+        Check(Scan.ScannedSize == End, "whole file is scanned");
+        Check(Scan.LastSession == 4, "last session is the highest of any record");
+        Check(Index.size() == 3, "orphaned and replaced records are not indexed");
+        Check(!Index.contains(CacheRecordKey{ 3, 10, 0 }), "records of unloaded manifests are dropped");
+
+        auto const Touched = Index.find(CacheRecordKey{ 1, 10, 0 });
+        Check(Touched != Index.end() && Touched->second.Offset == First && Touched->second.LastSession == 4,
+            "touch records raise the last session of their payload");
+
+        auto const Superseded = Index.find(CacheRecordKey{ 1, 11, 0 });
+        Check(Superseded != Index.end() && Superseded->second.Offset == Latest, "later payload records replace earlier ones");
+
+        std::size_t const LiveBytes = (Orphan - First) + (Other - Latest) + (End - Other);
+        Check(Scan.LiveBytes == LiveBytes, "live bytes cover indexed records");
+        Check(Scan.LiveBytes + Scan.DeadBytes + sizeof(CCacheHeader) == End, "every byte is either live or dead");
+        Check(Scan.DeadBytes == (Replaced - Orphan) + (Touch - Replaced) + (Latest - Touch), "dead bytes cover the rest");
+
+        // An append torn by a crash, the record made it to the file but not its payload.
+        CacheFileBuilder Torn{ File };
+        Torn.AddRecord(ECR_Payload, 4, 2, 12, 0, 4096);
+        Torn.Bytes.resize(End + sizeof(CCacheRecord) + 100);
+
+        CacheScanResult const TornScan = ScanCacheRecords(Torn.Bytes, LiveManifests, Index);
+        Check(TornScan.ScannedSize == End, "scanning stops at a torn record");
+        Check(TornScan.DeadBytes == Scan.DeadBytes + sizeof(CCacheRecord) + 100, "torn bytes are dead");
+        Check(Index.size() == 3, "torn records are not indexed");
+
+        std::atomic_bool const bAbort{ true };
+        CacheScanResult const Aborted = ScanCacheRecords(File.Bytes, LiveManifests, Index, &bAbort);
+        Check(Aborted.ScannedSize == sizeof(CCacheHeader) && Index.empty(), "scanning stops once aborted");
+    }
+
+    void TestCacheCompaction()
+    {
+        std::unordered_set<std::uint64_t> const LiveManifests{ 1 };
+        CacheFileBuilder File{};
+
+        std::size_t const Old = File.AddRecord(ECR_Payload, 1, 1, 0, 0, 4096);
+        std::size_t const Recent = File.AddRecord(ECR_Payload, 1, 1, 1, 0, 4096);
+        std::size_t const Newest = File.AddRecord(ECR_Payload, 2, 1, 2, 0, 4096);
+        File.AddRecord(ECR_Touch, 3, 1, 1, 0, 0);
+
+        CacheIndex Index{};
+        ScanCacheRecords(File.Bytes, LiveManifests, Index);
+
+        std::size_t const Stride = Recent - Old;
+        std::vector<CacheIndexEntry> const All = PlanCacheCompaction(File.Bytes, Index, UINT64_MAX);
+        Check(All.size() == 3, "everything is kept within budget");
+        Check(All.size() == 3 && All[0].Offset == Recent && All[0].LastSession == 3 && All[1].Offset == Newest && All[2].Offset == Old,
+            "records are kept most recently used first");
+
+        std::vector<CacheIndexEntry> const Two = PlanCacheCompaction(File.Bytes, Index, sizeof(CCacheHeader) + 2 * Stride);
+        Check(Two.size() == 2 && Two[0].Offset == Recent && Two[1].Offset == Newest, "least recently used records are dropped first");
+
+        std::vector<CacheIndexEntry> const None = PlanCacheCompaction(File.Bytes, Index, sizeof(CCacheHeader) + Stride - 1);
+        Check(None.empty(), "records larger than the budget are dropped");
+    }
+
+    /// @brief      Measures the startup scan of a cache file with many records, which used to run on the loading thread.
+    void BenchmarkCacheScan(std::size_t const nRecords)
+    {
+        std::unordered_set<std::uint64_t> LiveManifests{};
+        for (std::uint64_t Key = 1; Key <= 64; ++Key)
+            LiveManifests.insert(Key);
+
+        // Mips of a few sizes, from 4 KiB to 256 KiB, a tenth of them for manifests no longer installed.
+        CacheFileBuilder File{};
+        for (std::size_t i = 0; i < nRecords; ++i)
+        {
+            auto const Size = static_cast<std::uint32_t>(4096u << (i % 7));
+            File.AddRecord(ECR_Payload, static_cast<std::uint32_t>(1 + i % 5), 1 + i % 70, static_cast<std::uint32_t>(i / 70), 0, Size);
+            if (i % 3 == 0)
+                File.AddRecord(ECR_Touch, 6, 1 + i % 70, static_cast<std::uint32_t>(i / 70), 0, 0);
+        }
+
+        CacheIndex Index{};
+        auto const Start = std::chrono::steady_clock::now();
+        CacheScanResult const Scan = ScanCacheRecords(File.Bytes, LiveManifests, Index);
+        double const ScanMs = MillisecondsSince(Start);
+
+        auto const PlanStart = std::chrono::steady_clock::now();
+        std::vector<CacheIndexEntry> const Plan = PlanCacheCompaction(File.Bytes, Index, File.Bytes.size() / 2);
+        double const PlanMs = MillisecondsSince(PlanStart);
+
+        std::printf("%-12s %zu records, %.0f MiB: scanned in %.2f ms (%.0f ns/record), %zu indexed, %.0f MiB dead\n",
+            "cache scan", nRecords, static_cast<double>(File.Bytes.size()) / 1048576.0, ScanMs,
+            ScanMs * 1e6 / static_cast<double>(nRecords), Index.size(), static_cast<double>(Scan.DeadBytes) / 1048576.0);
+        std::printf("%-12s planned %zu of %zu records in %.2f ms\n", "cache plan", Plan.size(), Index.size(), PlanMs);
+    }
+
+
+    // ! CRC-32C.
+    // ========================================
+
+    /// Bit by bit, as the definition goes, to check both implementations against.
+    std::uint32_t Crc32cReference(std::uint32_t Crc, std::span<unsigned char const> const Data)
+    {
+        Crc = ~Crc;
+        for (unsigned char const Byte : Data)
+        {
+            Crc ^= Byte;
+            for (int Bit = 0; Bit < 8; ++Bit)
+                Crc = (Crc >> 1) ^ ((Crc & 1) ? 0x82F63B78u : 0u);
+        }
+        return ~Crc;
+    }
+
+    void TestCrc32c()
+    {
+        // Check value of the catalogue of parametrised CRC algorithms, and the vectors of RFC 3720, B.4.
+        std::string_view const Digits{ "123456789" };
+        Check(Crc32c(0, { reinterpret_cast<unsigned char const*>(Digits.data()), Digits.size() }) == 0xE3069283, "CRC-32C of \"123456789\"");
+
+        unsigned char Vector[32]{};
+        Check(Crc32c(0, Vector) == 0x8A9136AA, "CRC-32C of 32 zero bytes");
+        std::memset(Vector, 0xFF, sizeof Vector);
+        Check(Crc32c(0, Vector) == 0x62A8AB43, "CRC-32C of 32 0xFF bytes");
+        for (unsigned char i = 0; i < 32; ++i)
+            Vector[i] = i;
+        Check(Crc32c(0, Vector) == 0x46DD794E, "CRC-32C of 32 incrementing bytes");
+        for (unsigned char i = 0; i < 32; ++i)
+            Vector[i] = static_cast<unsigned char>(31 - i);
+        Check(Crc32c(0, Vector) == 0x113FDB5C, "CRC-32C of 32 decrementing bytes");
+
+        Check(Crc32c(0, {}) == 0 && Crc32c(0x12345678, {}) == 0x12345678, "CRC-32C of nothing");
+
+        // Every length and misalignment around the 8-byte steps, in one call and split in two.
+        std::vector<unsigned char> Random(4096 + 64);
+        std::mt19937 Engine{ 42 };
+        for (unsigned char& Byte : Random)
+            Byte = static_cast<unsigned char>(Engine());
+
+        bool bMatches = true, bSplitMatches = true;
+        for (std::size_t Offset = 0; Offset < 8; ++Offset)
+        {
+            for (std::size_t Size = 0; Size < 200; ++Size)
+            {
+                std::span<unsigned char const> const Data{ Random.data() + Offset, Size };
+                std::uint32_t const Expected = Crc32cReference(0, Data);
+                bMatches = bMatches && Crc32c(0, Data) == Expected;
+                bSplitMatches = bSplitMatches && Crc32c(Crc32c(0, Data.first(Size / 3)), Data.subspan(Size / 3)) == Expected;
+            }
+        }
+
+        Check(bMatches, "CRC-32C matches the bitwise definition at every length and alignment");
+        Check(bSplitMatches, "CRC-32C can be updated in several calls");
+        Check(Crc32c(0, Random) == Crc32cReference(0, Random), "CRC-32C of 4 KiB");
+    }
+
+    /// @brief      Measures checksum throughput over payloads larger than the caches, as the verifier sees them.
+    void BenchmarkCrc32c(std::size_t const nMiB)
+    {
+        std::vector<unsigned char> Data(nMiB << 20);
+        std::mt19937_64 Engine{ 7 };
+        for (std::size_t i = 0; i + 8 <= Data.size(); i += 8)
+        {
+            std::uint64_t const Word = Engine();
+            std::memcpy(Data.data() + i, &Word, sizeof Word);
+        }
+
+        constexpr int k_passes = 5;
+        std::uint32_t Crc = 0;
+        auto const Start = std::chrono::steady_clock::now();
+        for (int Pass = 0; Pass < k_passes; ++Pass)
+            Crc = Crc32c(Crc, Data);
+        double const Seconds = MillisecondsSince(Start) / 1000.0;
+
+        // The bitwise reference stands in for what byte-at-a-time code costs, over a slice only.
+        std::span<unsigned char const> const Slice{ Data.data(), (std::min)(Data.size(), std::size_t{ 16 } << 20) };
+        auto const ReferenceStart = std::chrono::steady_clock::now();
+        std::uint32_t const ReferenceCrc = Crc32cReference(0, Slice);
+        double const ReferenceSeconds = MillisecondsSince(ReferenceStart) / 1000.0;
+
+        std::printf("%-12s %s: %.2f GB/s over %zu MiB (%08X), bitwise reference %.3f GB/s (%08X)\n", "crc32c",
+            IsCrc32cAccelerated() ? "sse4.2" : "slicing-by-8",
+            static_cast<double>(Data.size()) * k_passes / Seconds * 1e-9, nMiB, Crc,
+            static_cast<double>(Slice.size()) / ReferenceSeconds * 1e-9, ReferenceCrc);
+    }
+
+
+    // ! Block compression.
+    // ========================================
+
+    /// Decodes a BC1 block the way the encoder builds its palette.
+    void DecodeBlockBC1(unsigned char const* const Block, unsigned char (&OutPixels)[16][4])
+    {
+        std::uint16_t Color0, Color1;
+        std::uint32_t Indices;
+        std::memcpy(&Color0, Block, sizeof Color0);
+        std::memcpy(&Color1, Block + 2, sizeof Color1);
+        std::memcpy(&Indices, Block + 4, sizeof Indices);
+
+        int Palette[4][4]{};
+        for (int i = 0; i < 2; ++i)
+        {
+            std::uint16_t const Color = i == 0 ? Color0 : Color1;
+            int const R = (Color >> 11) & 31, G = (Color >> 5) & 63, B = Color & 31;
+            Palette[i][0] = (R << 3) | (R >> 2);
+            Palette[i][1] = (G << 2) | (G >> 4);
+            Palette[i][2] = (B << 3) | (B >> 2);
+            Palette[i][3] = 255;
+        }
+
+        for (int c = 0; c < 3; ++c)
+        {
+            if (Color0 > Color1)
+            {
+                Palette[2][c] = (2 * Palette[0][c] + Palette[1][c]) / 3;
+                Palette[3][c] = (Palette[0][c] + 2 * Palette[1][c]) / 3;
+            }
+            else
+            {
+                Palette[2][c] = (Palette[0][c] + Palette[1][c]) / 2;
+            }
+        }
+        Palette[2][3] = 255;
+        Palette[3][3] = Color0 > Color1 ? 255 : 0;
+
+        for (int Pixel = 0; Pixel < 16; ++Pixel)
+        {
+            for (int c = 0; c < 4; ++c)
+                OutPixels[Pixel][c] = static_cast<unsigned char>(Palette[(Indices >> (2 * Pixel)) & 3][c]);
+        }
+    }
+
+    /// Writes fields into a 128-bit block, least significant bit first, as BC7 stores them.
+    struct BlockBitWriter final
+    {
+        unsigned char   Block[16]{};
+        int             Position{ 0 };
+
+        void Write(std::uint32_t const Value, int const Count)
+        {
+            for (int Bit = 0; Bit < Count; ++Bit, ++Position)
+            {
+                if ((Value >> Bit) & 1)
+                    Block[Position / 8] |= static_cast<unsigned char>(1 << (Position % 8));
+            }
+        }
+    };
+
+    /// Squared RGB error between two sets of pixels.
+    std::uint64_t GetSquaredError(unsigned char const (&Left)[16][4], unsigned char const (&Right)[16][4])
+    {
+        std::uint64_t Error = 0;
+        for (int Pixel = 0; Pixel < 16; ++Pixel)
+        {
+            for (int c = 0; c < 3; ++c)
+            {
+                int const Delta = Left[Pixel][c] - Right[Pixel][c];
+                Error += static_cast<std::uint64_t>(Delta * Delta);
+            }
+        }
+        return Error;
+    }
+
+    double GetPSNR(std::uint64_t const SquaredError, std::size_t const Pixels)
+    {
+        if (SquaredError == 0)
+            return INFINITY;
+        double const MeanError = static_cast<double>(SquaredError) / (static_cast<double>(Pixels) * 3.0);
+        return 10.0 * std::log10(255.0 * 255.0 / MeanError);
+    }
+
+    /// Pixels of a block at some position of a synthetic image, smooth with some grain, like most game textures.
+    void MakeImageBlock(std::size_t const BlockX, std::size_t const BlockY, std::mt19937& Engine, unsigned char (&OutPixels)[16][4])
+    {
+        std::uniform_int_distribution<int> Grain{ -6, 6 };
+        for (int Pixel = 0; Pixel < 16; ++Pixel)
+        {
+            double const X = static_cast<double>(BlockX * 4 + Pixel % 4), Y = static_cast<double>(BlockY * 4 + Pixel / 4);
+            double const Base[3]
+            {
+                128.0 + 100.0 * std::sin(X * 0.021) * std::cos(Y * 0.013),
+                128.0 + 90.0 * std::sin((X + Y) * 0.017),
+                96.0 + 60.0 * std::cos(X * 0.009 - Y * 0.031),
+            };
+
+            for (int c = 0; c < 3; ++c)
+                OutPixels[Pixel][c] = static_cast<unsigned char>(std::clamp(static_cast<int>(Base[c]) + Grain(Engine), 0, 255));
+            OutPixels[Pixel][3] = 255;
+        }
+    }
+
+    void TestBlockCompression()
+    {
+        unsigned char Pixels[16][4]{}, Decoded[16][4]{}, Block[16]{};
+
+        // Reserved BC7 mode.
+        std::memset(Pixels, 0xCD, sizeof Pixels);
+        DecodeBlockBC7(Block, Pixels);
+        Check(std::all_of(&Pixels[0][0], &Pixels[0][0] + 64, [](unsigned char const Value) { return Value == 0; }),
+            "reserved BC7 mode decodes to transparent black");
+
+        // Mode 6, from black to opaque white, with every 4-bit index in turn.
+        BlockBitWriter Mode6{};
+        Mode6.Write(1 << 6, 7);
+        for (int Channel = 0; Channel < 4; ++Channel)
+        {
+            Mode6.Write(0, 7);
+            Mode6.Write(0x7F, 7);
+        }
+        Mode6.Write(0, 1);
+        Mode6.Write(1, 1);
+        Mode6.Write(0, 3);                      // Pixel 0 is the anchor, its index is one bit shorter.
+        for (std::uint32_t Pixel = 1; Pixel < 16; ++Pixel)
+            Mode6.Write(Pixel, 4);
+
+        DecodeBlockBC7(Mode6.Block, Pixels);
+        constexpr int k_weights4[16]{ 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+        bool bRamp = true;
+        for (int Pixel = 0; Pixel < 16; ++Pixel)
+        {
+            int const Expected = (k_weights4[Pixel] * 255 + 32) >> 6;
+            bRamp = bRamp && Pixels[Pixel][0] == Expected && Pixels[Pixel][1] == Expected
+                && Pixels[Pixel][2] == Expected && Pixels[Pixel][3] == Expected;
+        }
+        Check(bRamp, "BC7 mode 6 interpolates endpoints with the 4-bit weights");
+
+        // BC5 with eight-value palettes, X at its first endpoint and Y at its second.
+        unsigned char const Bc5[16]{ 200, 100, 0, 0, 0, 0, 0, 0,   50, 180, 0x49, 0x92, 0x24, 0x49, 0x92, 0x24 };
+        DecodeBlockBC5(Bc5, Pixels);
+        double const X = 200 / 127.5 - 1.0, Y = 180 / 127.5 - 1.0;
+        auto const Z = static_cast<int>(std::lround((std::sqrt(1.0 - X * X - Y * Y) + 1.0) * 127.5));
+        Check(Pixels[0][0] == 200 && Pixels[15][0] == 200 && Pixels[0][1] == 180 && Pixels[15][1] == 180,
+            "BC5 decodes both channels from their palettes");
+        Check(std::abs(Pixels[0][2] - Z) <= 1 && Pixels[0][3] == 255, "BC5 reconstructs the normal's Z and opaque alpha");
+
+        // Random blocks, which cover every BC7 mode, decode to the same pixels as the scalar decoders did.
+        std::mt19937 Random{ 5 };
+        std::uint64_t Bc7Digest = 0xCBF29CE484222325, Bc5Digest = 0xCBF29CE484222325;
+        auto const Digest = [](std::uint64_t& InOutDigest, unsigned char const (&InPixels)[16][4])
+            {
+                for (unsigned char const Value : std::string_view{ reinterpret_cast<char const*>(InPixels), sizeof InPixels })
+                    InOutDigest = (InOutDigest ^ Value) * 0x100000001B3;
+            };
+        for (int i = 0; i < 1 << 20; ++i)
+        {
+            for (unsigned char& Byte : Block)
+                Byte = static_cast<unsigned char>(Random());
+            DecodeBlockBC7(Block, Pixels);
+            Digest(Bc7Digest, Pixels);
+            DecodeBlockBC5(Block, Pixels);
+            Digest(Bc5Digest, Pixels);
+        }
+        Check(Bc7Digest == 0x2EE10AC4C174E07A, "BC7 decodes random blocks like the scalar decoder");
+        Check(Bc5Digest == 0xAD4A1E805AF2BF2F, "BC5 decodes random blocks like the scalar decoder");
+
+        // Flat colors representable in RGB565 come out exact.
+        for (auto& Pixel : Pixels)
+        {
+            Pixel[0] = 255; Pixel[1] = 0; Pixel[2] = 0; Pixel[3] = 255;
+        }
+        Check(EncodeBlockBC1(Pixels, Block) == 0, "flat BC1 blocks are exact");
+        DecodeBlockBC1(Block, Decoded);
+        Check(GetSquaredError(Pixels, Decoded) == 0 && Decoded[0][3] == 255, "flat BC1 blocks decode to their color, opaque");
+
+        // On textures, the reported error is the actual error, and stays within what DXT1 usually achieves.
+        std::mt19937 Engine{ 3 };
+        std::uint64_t Reported = 0, Actual = 0;
+        bool bOpaque = true;
+        for (std::size_t Y0 = 0; Y0 < 64; ++Y0)
+        {
+            for (std::size_t X0 = 0; X0 < 64; ++X0)
+            {
+                MakeImageBlock(X0, Y0, Engine, Pixels);
+                Reported += EncodeBlockBC1(Pixels, Block);
+                DecodeBlockBC1(Block, Decoded);
+                Actual += GetSquaredError(Pixels, Decoded);
+                for (auto const& Pixel : Decoded)
+                    bOpaque = bOpaque && Pixel[3] == 255;
+            }
+        }
+
+        double const PSNR = GetPSNR(Actual, 64 * 64 * 16);
+        Check(Reported == Actual, "BC1 encoder reports the error of what it encoded");
+        Check(bOpaque, "BC1 blocks never select the transparent color");
+        Check(PSNR > 36.0, "BC1 quality on a grainy gradient is above 36 dB");
+        std::printf("%-12s %.2f dB on a 256x256 grainy gradient\n", "bc1 quality", PSNR);
+    }
+
+    /// @brief      Measures the kernels over a texture of a given size, as one transcoded mip.
+    void BenchmarkBlockCompression(std::size_t const Size)
+    {
+        std::size_t const Blocks = (Size / 4) * (Size / 4);
+        std::mt19937 Engine{ 11 };
+
+        // Random bytes are valid BC7 and BC5, and cover every BC7 mode.
+        std::vector<unsigned char> Compressed(Blocks * 16);
+        for (unsigned char& Byte : Compressed)
+            Byte = static_cast<unsigned char>(Engine());
+
+        std::vector<unsigned char> Encoded(Blocks * 8);
+        unsigned char Pixels[16][4];
+        std::uint64_t Sink = 0;
+
+        auto const Measure = [&](char const* const Name, auto const& Kernel)
+            {
+                auto const Start = std::chrono::steady_clock::now();
+                for (std::size_t i = 0; i < Blocks; ++i)
+                    Kernel(i);
+                double const Ms = MillisecondsSince(Start);
+                std::printf("%-12s %zu blocks in %.1f ms, %.1f Mpixel/s\n", Name, Blocks, Ms,
+                    static_cast<double>(Blocks) * 16 / Ms * 1e-3);
+            };
+
+        Measure("bc7 decode", [&](std::size_t const i) { DecodeBlockBC7(&Compressed[i * 16], Pixels); Sink += Pixels[i % 16][0]; });
+        Measure("bc5 decode", [&](std::size_t const i) { DecodeBlockBC5(&Compressed[i * 16], Pixels); Sink += Pixels[i % 16][2]; });
+
+        std::vector<std::array<unsigned char, 64>> Source(Blocks);
+        for (std::size_t i = 0; i < Blocks; ++i)
+        {
+            MakeImageBlock(i % (Size / 4), i / (Size / 4), Engine, Pixels);
+            std::memcpy(Source[i].data(), Pixels, sizeof Pixels);
+        }
+
+        Measure("bc1 encode", [&](std::size_t const i)
+            {
+                std::memcpy(Pixels, Source[i].data(), sizeof Pixels);
+                Sink += EncodeBlockBC1(Pixels, &Encoded[i * 8]);
+            });
+
+        std::printf("%-12s checksum %llu\n", "transcode", static_cast<unsigned long long>(Sink));
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    std::string_view const Mode = argc > 1 ? argv[1] : "all";
+    bool const bAll = Mode == "all";
+
+    if (bAll || Mode == "cache")
+    {
+        std::size_t const nRecords = !bAll && argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 20'000;
+        TestCacheScan();
+        TestCacheCompaction();
+        BenchmarkCacheScan(nRecords);
+    }
+
+    if (bAll || Mode == "crc")
+    {
+        std::size_t const nMiB = !bAll && argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 256;
+        TestCrc32c();
+        BenchmarkCrc32c(nMiB);
+    }
+
+    if (bAll || Mode == "transcode")
+    {
+        std::size_t const Size = !bAll && argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 2048;
+        TestBlockCompression();
+        BenchmarkBlockCompression((std::max)(Size, std::size_t{ 4 }));
+    }
+
+    if (!bAll && Mode != "cache" && Mode != "crc" && Mode != "transcode")
+    {
+        std::fprintf(stderr, "usage: %s [cache|crc|transcode] [records|MiB|size]\n", argv[0]);
+        return 2;
+    }
+
+    if (g_failures != 0)
+    {
+        std::printf("%d check(s) failed\n", g_failures);
+        return 1;
+    }
+
+    std::printf("all checks passed\n");
+    return 0;
+}
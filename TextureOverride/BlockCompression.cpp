@@ -0,0 +1,644 @@
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <emmintrin.h>
+#include "TextureOverride/BlockCompression.hpp"
+
+namespace
+{
+    // ! BC7 tables.
+    // ========================================
+
+    struct CBc7Mode
+    {
+        std::uint8_t    Subsets;
+        std::uint8_t    PartitionBits;
+        std::uint8_t    RotationBits;
+        std::uint8_t    IndexSelectionBits;
+        std::uint8_t    ColorBits;
+        std::uint8_t    AlphaBits;
+        std::uint8_t    EndpointPBits;
+        std::uint8_t    SharedPBits;
+        std::uint8_t    IndexBits;
+        std::uint8_t    IndexBits2;
+    };
+
+    constexpr CBc7Mode k_bc7Modes[8]
+    {
+        { 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+        { 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+        { 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+        { 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+        { 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+        { 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+        { 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+        { 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 },
+    };
+
+    // Subset of each pixel for two-subset partitions, one bit per pixel.
+    constexpr std::uint16_t k_bc7Partitions2[64]
+    {
+        0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80,
+        0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+        0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE,
+        0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C,
+        0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696, 0xA55A,
+        0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660,
+        0x0272, 0x04E4, 0x4E40, 0x2720, 0xC936, 0x936C, 0x39C6, 0x639C,
+        0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22,
+    };
+
+    // Subset of each pixel for three-subset partitions.
+    constexpr std::uint8_t k_bc7Partitions3[64][16]
+    {
+        { 0, 0, 1, 1, 0, 0, 1, 1, 0, 2, 2, 1, 2, 2, 2, 2 },
+        { 0, 0, 0, 1, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2, 2, 1 },
+        { 0, 0, 0, 0, 2, 0, 0, 1, 2, 2, 1, 1, 2, 2, 1, 1 },
+        { 0, 2, 2, 2, 0, 0, 2, 2, 0, 0, 1, 1, 0, 1, 1, 1 },
+        { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2 },
+        { 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 2, 2, 0, 0, 2, 2 },
+        { 0, 0, 2, 2, 0, 0, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1 },
+        { 0, 0, 1, 1, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2, 1, 1 },
+        { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2 },
+        { 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2 },
+        { 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2 },
+        { 0, 0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2 },
+        { 0, 1, 1, 2, 0, 1, 1, 2, 0, 1, 1, 2, 0, 1, 1, 2 },
+        { 0, 1, 2, 2, 0, 1, 2, 2, 0, 1, 2, 2, 0, 1, 2, 2 },
+        { 0, 0, 1, 1, 0, 1, 1, 2, 1, 1, 2, 2, 1, 2, 2, 2 },
+        { 0, 0, 1, 1, 2, 0, 0, 1, 2, 2, 0, 0, 2, 2, 2, 0 },
+        { 0, 0, 0, 1, 0, 0, 1, 1, 0, 1, 1, 2, 1, 1, 2, 2 },
+        { 0, 1, 1, 1, 0, 0, 1, 1, 2, 0, 0, 1, 2, 2, 0, 0 },
+        { 0, 0, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2, 1, 1, 2, 2 },
+        { 0, 0, 2, 2, 0, 0, 2, 2, 0, 0, 2, 2, 1, 1, 1, 1 },
+        { 0, 1, 1, 1, 0, 1, 1, 1, 0, 2, 2, 2, 0, 2, 2, 2 },
+        { 0, 0, 0, 1, 0, 0, 0, 1, 2, 2, 2, 1, 2, 2, 2, 1 },
+        { 0, 0, 0, 0, 0, 0, 1, 1, 0, 1, 2, 2, 0, 1, 2, 2 },
+        { 0, 0, 0, 0, 1, 1, 0, 0, 2, 2, 1, 0, 2, 2, 1, 0 },
+        { 0, 1, 2, 2, 0, 1, 2, 2, 0, 0, 1, 1, 0, 0, 0, 0 },
+        { 0, 0, 1, 2, 0, 0, 1, 2, 1, 1, 2, 2, 2, 2, 2, 2 },
+        { 0, 1, 1, 0, 1, 2, 2, 1, 1, 2, 2, 1, 0, 1, 1, 0 },
+        { 0, 0, 0, 0, 0, 1, 1, 0, 1, 2, 2, 1, 1, 2, 2, 1 },
+        { 0, 0, 2, 2, 1, 1, 0, 2, 1, 1, 0, 2, 0, 0, 2, 2 },
+        { 0, 1, 1, 0, 0, 1, 1, 0, 2, 0, 0, 2, 2, 2, 2, 2 },
+        { 0, 0, 1, 1, 0, 1, 2, 2, 0, 1, 2, 2, 0, 0, 1, 1 },
+        { 0, 0, 0, 0, 2, 0, 0, 0, 2, 2, 1, 1, 2, 2, 2, 1 },
+        { 0, 0, 0, 0, 0, 0, 0, 2, 1, 1, 2, 2, 1, 2, 2, 2 },
+        { 0, 2, 2, 2, 0, 0, 2, 2, 0, 0, 1, 2, 0, 0, 1, 1 },
+        { 0, 0, 1, 1, 0, 0, 1, 2, 0, 0, 2, 2, 0, 2, 2, 2 },
+        { 0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2, 0 },
+        { 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 0, 0, 0, 0 },
+        { 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0 },
+        { 0, 1, 2, 0, 2, 0, 1, 2, 1, 2, 0, 1, 0, 1, 2, 0 },
+        { 0, 0, 1, 1, 2, 2, 0, 0, 1, 1, 2, 2, 0, 0, 1, 1 },
+        { 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 0, 0, 0, 0, 1, 1 },
+        { 0, 1, 0, 1, 0, 1, 0, 1, 2, 2, 2, 2, 2, 2, 2, 2 },
+        { 0, 0, 0, 0, 0, 0, 0, 0, 2, 1, 2, 1, 2, 1, 2, 1 },
+        { 0, 0, 2, 2, 1, 1, 2, 2, 0, 0, 2, 2, 1, 1, 2, 2 },
+        { 0, 0, 2, 2, 0, 0, 1, 1, 0, 0, 2, 2, 0, 0, 1, 1 },
+        { 0, 2, 2, 0, 1, 2, 2, 1, 0, 2, 2, 0, 1, 2, 2, 1 },
+        { 0, 1, 0, 1, 2, 2, 2, 2, 2, 2, 2, 2, 0, 1, 0, 1 },
+        { 0, 0, 0, 0, 2, 1, 2, 1, 2, 1, 2, 1, 2, 1, 2, 1 },
+        { 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 2, 2, 2, 2 },
+        { 0, 2, 2, 2, 0, 1, 1, 1, 0, 2, 2, 2, 0, 1, 1, 1 },
+        { 0, 0, 0, 2, 1, 1, 1, 2, 0, 0, 0, 2, 1, 1, 1, 2 },
+        { 0, 0, 0, 0, 2, 1, 1, 2, 2, 1, 1, 2, 2, 1, 1, 2 },
+        { 0, 2, 2, 2, 0, 1, 1, 1, 0, 1, 1, 1, 0, 2, 2, 2 },
+        { 0, 0, 0, 2, 1, 1, 1, 2, 1, 1, 1, 2, 0, 0, 0, 2 },
+        { 0, 1, 1, 0, 0, 1, 1, 0, 0, 1, 1, 0, 2, 2, 2, 2 },
+        { 0, 0, 0, 0, 0, 0, 0, 0, 2, 1, 1, 2, 2, 1, 1, 2 },
+        { 0, 1, 1, 0, 0, 1, 1, 0, 2, 2, 2, 2, 2, 2, 2, 2 },
+        { 0, 0, 2, 2, 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 2, 2 },
+        { 0, 0, 2, 2, 1, 1, 2, 2, 1, 1, 2, 2, 0, 0, 2, 2 },
+        { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 1, 1, 2 },
+        { 0, 0, 0, 2, 0, 0, 0, 1, 0, 0, 0, 2, 0, 0, 0, 1 },
+        { 0, 2, 2, 2, 1, 2, 2, 2, 0, 2, 2, 2, 1, 2, 2, 2 },
+        { 0, 1, 0, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2 },
+        { 0, 1, 1, 1, 2, 0, 1, 1, 2, 2, 0, 1, 2, 2, 2, 0 },
+    };
+
+    // Pixels whose index is stored with one bit less, besides pixel 0.
+    constexpr std::uint8_t k_bc7Anchors2[64]
+    {
+        15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+        15,  2,  8,  2,  2,  8,  8, 15,  2,  8,  2,  2,  8,  8,  2,  2,
+        15, 15,  6,  8,  2,  8, 15, 15,  2,  8,  2,  2,  2, 15, 15,  6,
+         6,  2,  6,  8, 15, 15,  2,  2, 15, 15, 15, 15, 15,  2,  2, 15,
+    };
+
+    constexpr std::uint8_t k_bc7Anchors3First[64]
+    {
+         3,  3, 15, 15,  8,  3, 15, 15,  8,  8,  6,  6,  6,  5,  3,  3,
+         3,  3,  8, 15,  3,  3,  6, 10,  5,  8,  8,  6,  8,  5, 15, 15,
+         8, 15,  3,  5,  6, 10,  8, 15, 15,  3, 15,  5, 15, 15, 15, 15,
+         3, 15,  5,  5,  5,  8,  5, 10,  5, 10,  8, 13, 15, 12,  3,  3,
+    };
+
+    constexpr std::uint8_t k_bc7Anchors3Second[64]
+    {
+        15,  8,  8,  3, 15, 15,  3,  8, 15, 15, 15, 15, 15, 15, 15,  8,
+        15,  8, 15,  3, 15,  8, 15,  8,  3, 15,  6, 10, 15, 15, 10,  8,
+        15,  3, 15, 10, 10,  8,  9, 10,  6, 15,  8, 15,  3,  6,  6,  8,
+        15,  3, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,  3, 15, 15,  8,
+    };
+
+    // Every anchor must belong to the subset it anchors.
+    constexpr bool ValidateBc7Anchors()
+    {
+        for (int Partition = 0; Partition < 64; ++Partition)
+        {
+            if (((k_bc7Partitions2[Partition] >> k_bc7Anchors2[Partition]) & 1) != 1 || (k_bc7Partitions2[Partition] & 1) != 0)
+                return false;
+            if (k_bc7Partitions3[Partition][k_bc7Anchors3First[Partition]] != 1
+                || k_bc7Partitions3[Partition][k_bc7Anchors3Second[Partition]] != 2
+                || k_bc7Partitions3[Partition][0] != 0)
+                return false;
+        }
+        return true;
+    }
+    static_assert(ValidateBc7Anchors(), "BC7 anchor tables do not match partition tables");
+
+    constexpr std::uint8_t k_bc7Weights2[4]{ 0, 21, 43, 64 };
+    constexpr std::uint8_t k_bc7Weights3[8]{ 0, 9, 18, 27, 37, 46, 55, 64 };
+    constexpr std::uint8_t k_bc7Weights4[16]{ 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    std::uint8_t const* GetBc7Weights(int const IndexBits) noexcept
+    {
+        return IndexBits == 2 ? k_bc7Weights2 : IndexBits == 3 ? k_bc7Weights3 : k_bc7Weights4;
+    }
+
+    class BlockBitReader final
+    {
+        std::uint64_t   Low{ 0 };
+        std::uint64_t   High{ 0 };
+        int             Position{ 0 };
+
+    public:
+
+        explicit BlockBitReader(unsigned char const* const Block) noexcept
+        {
+            std::memcpy(&Low, Block, sizeof Low);
+            std::memcpy(&High, Block + 8, sizeof High);
+        }
+
+        inline void Skip(int const Count) noexcept { Position += Count; }
+
+        inline std::uint32_t Read(int const Count) noexcept
+        {
+            if (Count == 0)
+                return 0;
+
+            std::uint64_t Value;
+            if (Position >= 64)
+                Value = High >> (Position - 64);
+            else if (Position + Count <= 64)
+                Value = Low >> Position;
+            else
+                Value = (Low >> Position) | (High << (64 - Position));
+
+            Position += Count;
+            return static_cast<std::uint32_t>(Value & ((1ull << Count) - 1));
+        }
+    };
+
+    inline std::uint8_t ExpandBits(std::uint32_t Value, int const Precision) noexcept
+    {
+        Value <<= (8 - Precision);
+        return static_cast<std::uint8_t>(Value | (Value >> Precision));
+    }
+
+    /** Interpolates eight channels at once, as 16-bit lanes: @c ((64 - Weight) * Left + Weight * Right + 32) >> 6 . */
+    inline __m128i InterpolateBc7(__m128i const Left, __m128i const Right, __m128i const Weight) noexcept
+    {
+        __m128i const Sum = _mm_add_epi16(_mm_mullo_epi16(Left, _mm_sub_epi16(_mm_set1_epi16(64), Weight)), _mm_mullo_epi16(Right, Weight));
+        return _mm_srli_epi16(_mm_add_epi16(Sum, _mm_set1_epi16(32)), 6);
+    }
+
+
+    // ! BC1 encoding helpers.
+    // ========================================
+
+    struct CBc1Palette
+    {
+        std::uint16_t   Color0;
+        std::uint16_t   Color1;
+        int             Colors[4][3];
+    };
+
+    inline std::uint16_t QuantizeRGB565(float const R, float const G, float const B) noexcept
+    {
+        auto const Quantize = [](float const Value, int const Max) -> std::uint16_t
+            {
+                float const Clamped = std::clamp(Value, 0.f, 255.f);
+                return static_cast<std::uint16_t>(std::lround(Clamped * Max / 255.f));
+            };
+
+        return static_cast<std::uint16_t>((Quantize(R, 31) << 11) | (Quantize(G, 63) << 5) | Quantize(B, 31));
+    }
+
+    inline void ExpandRGB565(std::uint16_t const Color, int (&OutColor)[3]) noexcept
+    {
+        int const R = (Color >> 11) & 31, G = (Color >> 5) & 63, B = Color & 31;
+        OutColor[0] = (R << 3) | (R >> 2);
+        OutColor[1] = (G << 2) | (G >> 4);
+        OutColor[2] = (B << 3) | (B >> 2);
+    }
+
+    /** Builds a four-color palette, the endpoints must be ordered @c Color0 > @c Color1 . */
+    CBc1Palette MakeBc1Palette(std::uint16_t const Color0, std::uint16_t const Color1) noexcept
+    {
+        CBc1Palette Palette{ Color0, Color1, {} };
+        ExpandRGB565(Color0, Palette.Colors[0]);
+        ExpandRGB565(Color1, Palette.Colors[1]);
+
+        for (int c = 0; c < 3; ++c)
+        {
+            Palette.Colors[2][c] = (2 * Palette.Colors[0][c] + Palette.Colors[1][c]) / 3;
+            Palette.Colors[3][c] = (Palette.Colors[0][c] + 2 * Palette.Colors[1][c]) / 3;
+        }
+
+        return Palette;
+    }
+
+    /** Picks the nearest palette color for every pixel, four pixels at a time. */
+    std::uint64_t SelectBc1Indices(unsigned char const (&Pixels)[16][4], CBc1Palette const& Palette, std::uint32_t& OutIndices) noexcept
+    {
+        std::uint64_t TotalError = 0;
+        OutIndices = 0;
+
+        for (int Quad = 0; Quad < 4; ++Quad)
+        {
+            unsigned char const (&P)[4][4] = *reinterpret_cast<unsigned char const (*)[4][4]>(&Pixels[Quad * 4]);
+
+            // Red and green interleaved per pixel, and blue paired with zero, as 16-bit lanes.
+            __m128i const RG = _mm_setr_epi16(P[0][0], P[0][1], P[1][0], P[1][1], P[2][0], P[2][1], P[3][0], P[3][1]);
+            __m128i const B0 = _mm_setr_epi16(P[0][2], 0, P[1][2], 0, P[2][2], 0, P[3][2], 0);
+
+            __m128i BestError = _mm_set1_epi32(INT32_MAX);
+            __m128i BestIndex = _mm_setzero_si128();
+
+            for (int Index = 0; Index < 4; ++Index)
+            {
+                int const (&C)[3] = Palette.Colors[Index];
+                __m128i const DeltaRG = _mm_sub_epi16(RG, _mm_setr_epi16(
+                    static_cast<short>(C[0]), static_cast<short>(C[1]), static_cast<short>(C[0]), static_cast<short>(C[1]),
+                    static_cast<short>(C[0]), static_cast<short>(C[1]), static_cast<short>(C[0]), static_cast<short>(C[1])));
+                __m128i const DeltaB0 = _mm_sub_epi16(B0, _mm_setr_epi16(
+                    static_cast<short>(C[2]), 0, static_cast<short>(C[2]), 0, static_cast<short>(C[2]), 0, static_cast<short>(C[2]), 0));
+
+                __m128i const Error = _mm_add_epi32(_mm_madd_epi16(DeltaRG, DeltaRG), _mm_madd_epi16(DeltaB0, DeltaB0));
+                __m128i const Better = _mm_cmplt_epi32(Error, BestError);
+
+                BestError = _mm_or_si128(_mm_and_si128(Better, Error), _mm_andnot_si128(Better, BestError));
+                BestIndex = _mm_or_si128(_mm_and_si128(Better, _mm_set1_epi32(Index)), _mm_andnot_si128(Better, BestIndex));
+            }
+
+            alignas(16) std::int32_t Errors[4], Indices[4];
+            _mm_store_si128(reinterpret_cast<__m128i*>(Errors), BestError);
+            _mm_store_si128(reinterpret_cast<__m128i*>(Indices), BestIndex);
+
+            for (int i = 0; i < 4; ++i)
+            {
+                TotalError += static_cast<std::uint64_t>(Errors[i]);
+                OutIndices |= static_cast<std::uint32_t>(Indices[i]) << (2 * (Quad * 4 + i));
+            }
+        }
+
+        return TotalError;
+    }
+
+    /** Orders endpoints for four-color mode, remapping indices if they had to be swapped. */
+    void FinalizeBc1Block(std::uint16_t Color0, std::uint16_t Color1, std::uint32_t Indices, unsigned char* const OutBlock) noexcept
+    {
+        if (Color0 < Color1)
+        {
+            std::swap(Color0, Color1);
+            Indices ^= 0x55555555;  // 0 <-> 1, 2 <-> 3
+        }
+        else if (Color0 == Color1)
+        {
+            Indices = 0;  // Equal endpoints select three-color mode, where index 3 is transparent.
+        }
+
+        std::memcpy(OutBlock + 0, &Color0, sizeof Color0);
+        std::memcpy(OutBlock + 2, &Color1, sizeof Color1);
+        std::memcpy(OutBlock + 4, &Indices, sizeof Indices);
+    }
+}
+
+namespace TextureOverride
+{
+    // ! Block compression kernels.
+    // ========================================
+
+    void DecodeBlockBC7(unsigned char const* const Block, unsigned char (&OutPixels)[16][4]) noexcept
+    {
+        if (Block[0] == 0)
+        {
+            // Reserved mode, decodes to transparent black.
+            std::memset(OutPixels, 0, sizeof OutPixels);
+            return;
+        }
+
+        int Mode = 0;
+        while (((Block[0] >> Mode) & 1) == 0)
+            Mode++;
+
+        CBc7Mode const& Info = k_bc7Modes[Mode];
+        BlockBitReader Reader{ Block };
+        Reader.Skip(Mode + 1);
+
+        std::uint32_t const Partition = Reader.Read(Info.PartitionBits);
+        std::uint32_t const Rotation = Reader.Read(Info.RotationBits);
+        std::uint32_t const IndexSelection = Reader.Read(Info.IndexSelectionBits);
+
+        int const EndpointCount = Info.Subsets * 2;
+        std::uint32_t Raw[6][4]{};
+
+        for (int Channel = 0; Channel < 3; ++Channel)
+        {
+            for (int Endpoint = 0; Endpoint < EndpointCount; ++Endpoint)
+                Raw[Endpoint][Channel] = Reader.Read(Info.ColorBits);
+        }
+
+        for (int Endpoint = 0; Endpoint < EndpointCount && Info.AlphaBits != 0; ++Endpoint)
+            Raw[Endpoint][3] = Reader.Read(Info.AlphaBits);
+
+        std::uint32_t PBits[6]{};
+        if (Info.EndpointPBits)
+        {
+            for (int Endpoint = 0; Endpoint < EndpointCount; ++Endpoint)
+                PBits[Endpoint] = Reader.Read(1);
+        }
+        else if (Info.SharedPBits)
+        {
+            for (int Subset = 0; Subset < Info.Subsets; ++Subset)
+                PBits[Subset * 2] = PBits[Subset * 2 + 1] = Reader.Read(1);
+        }
+
+        bool const bHasPBits = Info.EndpointPBits || Info.SharedPBits;
+        std::uint8_t Endpoints[6][4]{};
+
+        for (int Endpoint = 0; Endpoint < EndpointCount; ++Endpoint)
+        {
+            for (int Channel = 0; Channel < 4; ++Channel)
+            {
+                int Precision = Channel < 3 ? Info.ColorBits : Info.AlphaBits;
+                if (Precision == 0)
+                {
+                    Endpoints[Endpoint][Channel] = 255;
+                    continue;
+                }
+
+                std::uint32_t Value = Raw[Endpoint][Channel];
+                if (bHasPBits)
+                {
+                    Value = (Value << 1) | PBits[Endpoint];
+                    Precision++;
+                }
+
+                Endpoints[Endpoint][Channel] = ExpandBits(Value, Precision);
+            }
+        }
+
+        auto const GetSubset = [&](int const Pixel) -> int
+            {
+                switch (Info.Subsets)
+                {
+                case 2: return (k_bc7Partitions2[Partition] >> Pixel) & 1;
+                case 3: return k_bc7Partitions3[Partition][Pixel];
+                default: return 0;
+                }
+            };
+
+        // Anchor pixels store their index with one bit less.
+        std::uint32_t Anchors = 1;
+        if (Info.Subsets == 2)
+            Anchors |= 1u << k_bc7Anchors2[Partition];
+        else if (Info.Subsets == 3)
+            Anchors |= (1u << k_bc7Anchors3First[Partition]) | (1u << k_bc7Anchors3Second[Partition]);
+
+        std::uint8_t Indices[16]{}, Indices2[16]{};
+        for (int Pixel = 0; Pixel < 16; ++Pixel)
+            Indices[Pixel] = static_cast<std::uint8_t>(Reader.Read(Info.IndexBits - static_cast<int>((Anchors >> Pixel) & 1)));
+        for (int Pixel = 0; Pixel < 16 && Info.IndexBits2 != 0; ++Pixel)
+            Indices2[Pixel] = static_cast<std::uint8_t>(Reader.Read(Info.IndexBits2 - (Pixel == 0 ? 1 : 0)));
+
+        // Mode 4 can swap which index set drives color and which drives alpha.
+        bool const bSwapIndices = Info.IndexBits2 != 0 && IndexSelection != 0;
+        int const ColorBits = bSwapIndices ? Info.IndexBits2 : Info.IndexBits;
+        int const AlphaBits = Info.IndexBits2 == 0 ? Info.IndexBits : (bSwapIndices ? Info.IndexBits : Info.IndexBits2);
+        std::uint8_t const* const ColorWeights = GetBc7Weights(ColorBits);
+        std::uint8_t const* const AlphaWeights = GetBc7Weights(AlphaBits);
+
+        // Endpoints and weights of every pixel as RGBA words, so that four pixels are interpolated per vector.
+        std::uint32_t EndpointWords[6]{};
+        std::memcpy(EndpointWords, Endpoints, sizeof EndpointWords);
+
+        alignas(16) std::uint32_t Lefts[16], Rights[16], Weights[16];
+        for (int Pixel = 0; Pixel < 16; ++Pixel)
+        {
+            int const Subset = GetSubset(Pixel);
+            Lefts[Pixel] = EndpointWords[Subset * 2];
+            Rights[Pixel] = EndpointWords[Subset * 2 + 1];
+
+            std::uint8_t const ColorIndex = Info.IndexBits2 == 0 ? Indices[Pixel] : (bSwapIndices ? Indices2[Pixel] : Indices[Pixel]);
+            std::uint8_t const AlphaIndex = Info.IndexBits2 == 0 ? Indices[Pixel] : (bSwapIndices ? Indices[Pixel] : Indices2[Pixel]);
+            Weights[Pixel] = ColorWeights[ColorIndex] * 0x010101u | static_cast<std::uint32_t>(AlphaWeights[AlphaIndex]) << 24;
+        }
+
+        __m128i const Zero = _mm_setzero_si128();
+        for (int Quad = 0; Quad < 4; ++Quad)
+        {
+            __m128i const Left = _mm_load_si128(reinterpret_cast<__m128i const*>(&Lefts[Quad * 4]));
+            __m128i const Right = _mm_load_si128(reinterpret_cast<__m128i const*>(&Rights[Quad * 4]));
+            __m128i const Weight = _mm_load_si128(reinterpret_cast<__m128i const*>(&Weights[Quad * 4]));
+
+            __m128i const Low = InterpolateBc7(_mm_unpacklo_epi8(Left, Zero), _mm_unpacklo_epi8(Right, Zero), _mm_unpacklo_epi8(Weight, Zero));
+            __m128i const High = InterpolateBc7(_mm_unpackhi_epi8(Left, Zero), _mm_unpackhi_epi8(Right, Zero), _mm_unpackhi_epi8(Weight, Zero));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&OutPixels[Quad * 4]), _mm_packus_epi16(Low, High));
+        }
+
+        if (Rotation != 0)
+        {
+            for (unsigned char (&Out)[4] : OutPixels)
+                std::swap(Out[3], Out[Rotation - 1]);
+        }
+    }
+
+    void DecodeBlockBC5(unsigned char const* const Block, unsigned char (&OutPixels)[16][4]) noexcept
+    {
+        auto const DecodeChannel = [&](unsigned char const* const Half, int const Channel)
+            {
+                int const Left = Half[0], Right = Half[1];
+                int Palette[8]{ Left, Right };
+
+                if (Left > Right)
+                {
+                    for (int i = 2; i < 8; ++i)
+                        Palette[i] = ((8 - i) * Left + (i - 1) * Right) / 7;
+                }
+                else
+                {
+                    for (int i = 2; i < 6; ++i)
+                        Palette[i] = ((6 - i) * Left + (i - 1) * Right) / 5;
+                    Palette[6] = 0;
+                    Palette[7] = 255;
+                }
+
+                std::uint64_t Bits = 0;
+                std::memcpy(&Bits, Half + 2, 6);
+
+                for (int Pixel = 0; Pixel < 16; ++Pixel)
+                    OutPixels[Pixel][Channel] = static_cast<unsigned char>(Palette[(Bits >> (3 * Pixel)) & 7]);
+            };
+
+        DecodeChannel(Block, 0);
+        DecodeChannel(Block + 8, 1);
+
+        // Z of four pixels at a time, with the same float operations as one at a time would take.
+        __m128 const Scale = _mm_set1_ps(127.5f), One = _mm_set1_ps(1.f);
+        __m128i const Mask = _mm_set1_epi32(0xFF);
+
+        for (int Quad = 0; Quad < 4; ++Quad)
+        {
+            __m128i const Texels = _mm_loadu_si128(reinterpret_cast<__m128i const*>(&OutPixels[Quad * 4]));
+            __m128 const X = _mm_sub_ps(_mm_div_ps(_mm_cvtepi32_ps(_mm_and_si128(Texels, Mask)), Scale), One);
+            __m128 const Y = _mm_sub_ps(_mm_div_ps(_mm_cvtepi32_ps(_mm_and_si128(_mm_srli_epi32(Texels, 8), Mask)), Scale), One);
+            __m128 const Z = _mm_sqrt_ps(_mm_max_ps(_mm_setzero_ps(), _mm_sub_ps(_mm_sub_ps(One, _mm_mul_ps(X, X)), _mm_mul_ps(Y, Y))));
+
+            // Rounds half away from zero like std::lround , values are positive.
+            __m128i const Blue = _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(_mm_add_ps(Z, One), Scale), _mm_set1_ps(0.5f)));
+
+            __m128i const RG = _mm_and_si128(Texels, _mm_set1_epi32(0xFFFF));
+            __m128i const Out = _mm_or_si128(_mm_or_si128(RG, _mm_slli_epi32(Blue, 16)), _mm_set1_epi32(static_cast<int>(0xFF000000u)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(&OutPixels[Quad * 4]), Out);
+        }
+    }
+
+    std::uint64_t EncodeBlockBC1(unsigned char const (&Pixels)[16][4], unsigned char* const OutBlock) noexcept
+    {
+        // Principal axis of the block's colors, by power iteration over the covariance matrix.
+        float Mean[3]{};
+        for (auto const& Pixel : Pixels)
+        {
+            for (int c = 0; c < 3; ++c)
+                Mean[c] += Pixel[c];
+        }
+        for (float& Value : Mean)
+            Value /= 16.f;
+
+        float Covariance[6]{};
+        for (auto const& Pixel : Pixels)
+        {
+            float const R = Pixel[0] - Mean[0], G = Pixel[1] - Mean[1], B = Pixel[2] - Mean[2];
+            Covariance[0] += R * R; Covariance[1] += R * G; Covariance[2] += R * B;
+            Covariance[3] += G * G; Covariance[4] += G * B; Covariance[5] += B * B;
+        }
+
+        float Axis[3]{ 1.f, 1.f, 1.f };
+        for (int Iteration = 0; Iteration < 4; ++Iteration)
+        {
+            float const Next[3]
+            {
+                Covariance[0] * Axis[0] + Covariance[1] * Axis[1] + Covariance[2] * Axis[2],
+                Covariance[1] * Axis[0] + Covariance[3] * Axis[1] + Covariance[4] * Axis[2],
+                Covariance[2] * Axis[0] + Covariance[4] * Axis[1] + Covariance[5] * Axis[2],
+            };
+
+            float const Length = std::max({ std::abs(Next[0]), std::abs(Next[1]), std::abs(Next[2]) });
+            if (Length < 1e-6f)
+                break;
+
+            for (int c = 0; c < 3; ++c)
+                Axis[c] = Next[c] / Length;
+        }
+
+        float const AxisLength = Axis[0] * Axis[0] + Axis[1] * Axis[1] + Axis[2] * Axis[2];
+        float MinT = 0.f, MaxT = 0.f;
+        for (auto const& Pixel : Pixels)
+        {
+            float const T = ((Pixel[0] - Mean[0]) * Axis[0] + (Pixel[1] - Mean[1]) * Axis[1] + (Pixel[2] - Mean[2]) * Axis[2]) / AxisLength;
+            MinT = std::min(MinT, T);
+            MaxT = std::max(MaxT, T);
+        }
+
+        // Inset the endpoints slightly, as the extremes are rarely worth a full palette step.
+        float const Inset = (MaxT - MinT) / 16.f;
+        MinT += Inset;
+        MaxT -= Inset;
+
+        std::uint16_t Color0 = QuantizeRGB565(Mean[0] + Axis[0] * MaxT, Mean[1] + Axis[1] * MaxT, Mean[2] + Axis[2] * MaxT);
+        std::uint16_t Color1 = QuantizeRGB565(Mean[0] + Axis[0] * MinT, Mean[1] + Axis[1] * MinT, Mean[2] + Axis[2] * MinT);
+        if (Color0 < Color1)
+            std::swap(Color0, Color1);
+
+        std::uint32_t Indices = 0;
+        std::uint64_t Error = SelectBc1Indices(Pixels, MakeBc1Palette(Color0, Color1), Indices);
+
+        // Refit both endpoints to the chosen indices with least squares, keeping the result if it helps.
+        if (Color0 != Color1 && Error != 0)
+        {
+            static constexpr float k_weights[4]{ 1.f, 0.f, 2.f / 3.f, 1.f / 3.f };
+
+            float AA = 0.f, AB = 0.f, BB = 0.f, AX[3]{}, BX[3]{};
+            for (int Pixel = 0; Pixel < 16; ++Pixel)
+            {
+                float const A = k_weights[(Indices >> (2 * Pixel)) & 3], B = 1.f - A;
+                AA += A * A; AB += A * B; BB += B * B;
+                for (int c = 0; c < 3; ++c)
+                {
+                    AX[c] += A * Pixels[Pixel][c];
+                    BX[c] += B * Pixels[Pixel][c];
+                }
+            }
+
+            float const Determinant = AA * BB - AB * AB;
+            if (std::abs(Determinant) > 1e-6f)
+            {
+                float Refit0[3], Refit1[3];
+                for (int c = 0; c < 3; ++c)
+                {
+                    Refit0[c] = (AX[c] * BB - BX[c] * AB) / Determinant;
+                    Refit1[c] = (BX[c] * AA - AX[c] * AB) / Determinant;
+                }
+
+                std::uint16_t Refined0 = QuantizeRGB565(Refit0[0], Refit0[1], Refit0[2]);
+                std::uint16_t Refined1 = QuantizeRGB565(Refit1[0], Refit1[1], Refit1[2]);
+                if (Refined0 < Refined1)
+                    std::swap(Refined0, Refined1);
+
+                if (Refined0 != Refined1)
+                {
+                    std::uint32_t RefinedIndices = 0;
+                    std::uint64_t const RefinedError = SelectBc1Indices(Pixels, MakeBc1Palette(Refined0, Refined1), RefinedIndices);
+
+                    if (RefinedError < Error)
+                    {
+                        Color0 = Refined0;
+                        Color1 = Refined1;
+                        Indices = RefinedIndices;
+                        Error = RefinedError;
+                    }
+                }
+            }
+        }
+
+        if (Color0 == Color1)
+        {
+            // Flat block, palette collapses to the first endpoint.
+            int Flat[3];
+            ExpandRGB565(Color0, Flat);
+
+            Error = 0;
+            for (auto const& Pixel : Pixels)
+            {
+                for (int c = 0; c < 3; ++c)
+                    Error += static_cast<std::uint64_t>((Pixel[c] - Flat[c]) * (Pixel[c] - Flat[c]));
+            }
+        }
+
+        FinalizeBc1Block(Color0, Color1, Indices, OutBlock);
+        return Error;
+    }
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+
+
+namespace TextureOverride
+{
+    // ! Block compression kernels.
+    // ========================================
+
+    /** Decodes a 16-byte BC7 block into 16 RGBA8 pixels, in row-major order. */
+    void DecodeBlockBC7(unsigned char const* Block, unsigned char (&OutPixels)[16][4]) noexcept;
+
+    /** Decodes a 16-byte BC5 block into 16 RGBA8 pixels, reconstructing the normal's Z into blue. */
+    void DecodeBlockBC5(unsigned char const* Block, unsigned char (&OutPixels)[16][4]) noexcept;
+
+    /**
+     * @brief       Encodes 16 RGBA8 pixels into an 8-byte opaque BC1 (DXT1) block, ignoring alpha.
+     * @return      Sum of squared RGB errors of the encoded block.
+     */
+    std::uint64_t EncodeBlockBC1(unsigned char const (&Pixels)[16][4], unsigned char* OutBlock) noexcept;
+}
@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <Windows.h>
+#include <Psapi.h>
+#include "Common/Objects.hpp"
+#include "TextureOverride/Budget.hpp"
+
+namespace
+{
+    std::uint64_t GetProcessCommitBytes()
+    {
+        PROCESS_MEMORY_COUNTERS_EX Counters{};
+        if (0 == ::K32GetProcessMemoryInfo(::GetCurrentProcess(), reinterpret_cast<PPROCESS_MEMORY_COUNTERS>(&Counters), sizeof Counters))
+            return 0;
+        return static_cast<std::uint64_t>(Counters.PrivateUsage);
+    }
+}
+
+namespace TextureOverride
+{
+    MipBudget g_mipBudget{};
+
+
+    // ! MipBudget implementation.
+    // ========================================
+
+    void MipBudget::Configure(EBudgetPolicy const InPolicy, std::uint64_t const InLimit, int const InTrimCount)
+    {
+        Policy = InPolicy;
+        Limit = InLimit;
+        TrimCount = std::max(InTrimCount, 1);
+    }
+
+    int MipBudget::GetTrimCount(ManifestLoader const& Manifest, CTextureEntry const& Entry, UTexture2D const* const Texture) const
+    {
+        int const MaxTrimCount = std::max(Entry.MipCount - 1, 0);
+        if (MaxTrimCount == 0)
+            return 0;
+
+        switch (Policy)
+        {
+        case EBudgetPolicy::GlobalCap:
+        {
+            // Bytes already held by this texture are about to be replaced.
+            std::uint64_t HeldBytes = Counters.HeldBytes;
+            if (auto const Iter = Textures.find(Texture); Iter != Textures.end())
+                HeldBytes -= Iter->second.InstalledBytes;
+
+            std::uint64_t EntryBytes = 0;
+            for (int i = 0; i < Entry.MipCount; ++i)
+                EntryBytes += static_cast<std::uint64_t>(Manifest.GetEntryMip(Entry, i).Entry.UncompressedSize);
+
+            return HeldBytes + EntryBytes > Limit ? std::min(TrimCount, MaxTrimCount) : 0;
+        }
+
+        case EBudgetPolicy::MaxDimension:
+        {
+            int Trimmed = 0;
+            while (Trimmed < MaxTrimCount)
+            {
+                CMipEntry const Mip = Manifest.GetEntryMip(Entry, Trimmed).Entry;
+                if (static_cast<std::uint64_t>(std::max(Mip.Width, Mip.Height)) <= Limit)
+                    break;
+                Trimmed++;
+            }
+            return Trimmed;
+        }
+
+        case EBudgetPolicy::ProcessCommit:
+            return GetProcessCommitBytes() > Limit ? std::min(TrimCount, MaxTrimCount) : 0;
+
+        default:
+            return 0;
+        }
+    }
+
+    void MipBudget::Track(UTexture2D* const Texture, std::uint64_t const InstalledBytes, std::uint64_t const TrimmedBytes)
+    {
+        if (auto const Iter = Textures.find(Texture); Iter != Textures.end())
+        {
+            Forget(Iter->second);
+            Textures.erase(Iter);
+        }
+
+        Textures.emplace(Texture, TextureRecord{ Common::GetObjectIndex(Texture), InstalledBytes, TrimmedBytes });
+
+        Counters.HeldBytes += InstalledBytes;
+        Counters.SavedBytes += TrimmedBytes;
+        Counters.TotalSavedBytes += TrimmedBytes;
+        if (TrimmedBytes > 0)
+            Counters.TrimmedTextures++;
+    }
+
+    void MipBudget::Collect()
+    {
+        for (auto Iter = Textures.begin(); Iter != Textures.end();)
+        {
+            if (Common::IsObjectAlive(Iter->first, Iter->second.TextureIndex))
+            {
+                ++Iter;
+                continue;
+            }
+
+            Forget(Iter->second);
+            Iter = Textures.erase(Iter);
+        }
+    }
+
+    MipBudget::Stats MipBudget::GetStats() const
+    {
+        return Counters;
+    }
+
+    void MipBudget::Forget(TextureRecord const& Record)
+    {
+        Counters.HeldBytes -= Record.InstalledBytes;
+        Counters.SavedBytes -= Record.TrimmedBytes;
+        if (Record.TrimmedBytes > 0)
+            Counters.TrimmedTextures--;
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <LESDK/Headers.hpp>
+#include "Common/Base.hpp"
+#include "TextureOverride/Manifest.hpp"
+
+
+namespace TextureOverride
+{
+    // ! Override memory budget.
+    // ========================================
+
+    enum class EBudgetPolicy
+    {
+        None,                   // All override mips are always installed.
+        GlobalCap,              // Top mips are trimmed while bytes held by override mips exceed a cap.
+        MaxDimension,           // Top mips are trimmed until both dimensions fit a limit.
+        ProcessCommit,          // Top mips are trimmed while the process commit charge exceeds a limit.
+    };
+
+    /**
+     * @brief   Decides how many of the largest mips of an override entry to leave out.
+     * @remarks Bytes held by override mips are tracked per texture, replacing the previous
+     *          amount when a texture is overridden again, and dropped by @ref Collect once
+     *          the texture has been destroyed.
+     */
+    class MipBudget final : public NonCopyable
+    {
+    public:
+
+        struct Stats final
+        {
+            std::uint64_t   HeldBytes{ 0 };             // Bytes of installed override mips of live textures.
+            std::uint64_t   SavedBytes{ 0 };            // Bytes of trimmed mips of live textures.
+            std::uint64_t   TrimmedTextures{ 0 };       // Number of live textures installed with trimmed mips.
+            std::uint64_t   TotalSavedBytes{ 0 };       // Bytes of trimmed mips over the whole session.
+        };
+
+        MipBudget() = default;
+
+        /**
+         * @brief       Selects the budget policy.
+         * @param[in]   InPolicy - policy to apply to subsequent overrides.
+         * @param[in]   InLimit - byte cap, dimension in pixels or commit charge in bytes, depending on policy.
+         * @param[in]   InTrimCount - number of top mips left out once a byte limit is exceeded.
+         */
+        void Configure(EBudgetPolicy InPolicy, std::uint64_t InLimit, int InTrimCount);
+
+        inline EBudgetPolicy GetPolicy() const noexcept { return Policy; }
+        inline bool IsEnabled() const noexcept { return Policy != EBudgetPolicy::None; }
+
+        /**
+         * @brief       Calculates how many of the largest mips of an entry should be left out.
+         * @return      Number of leading mips to skip, always leaving at least one mip installed.
+         */
+        int GetTrimCount(ManifestLoader const& Manifest, CTextureEntry const& Entry, UTexture2D const* Texture) const;
+
+        /** Records bytes installed and trimmed for a texture, replacing its previous record. */
+        void Track(UTexture2D* Texture, std::uint64_t InstalledBytes, std::uint64_t TrimmedBytes);
+
+        /** Drops records of textures which have been destroyed. */
+        void Collect();
+
+        Stats GetStats() const;
+
+    private:
+
+        struct TextureRecord final
+        {
+            int             TextureIndex{ -1 };
+            std::uint64_t   InstalledBytes{ 0 };
+            std::uint64_t   TrimmedBytes{ 0 };
+        };
+
+        void Forget(TextureRecord const& Record);
+
+        EBudgetPolicy   Policy{ EBudgetPolicy::None };
+        std::uint64_t   Limit{ 0 };
+        int             TrimCount{ 1 };
+
+        std::unordered_map<UTexture2D const*, TextureRecord> Textures{};
+        Stats           Counters{};
+    };
+
+    // Budget applied by @ref UpdateTextureFromManifest, configured via "-texturebudget*" command line arguments.
+    extern MipBudget g_mipBudget;
+}
@@ -0,0 +1,449 @@
+#include <chrono>
+#include <cstring>
+#include <utility>
+#include "TextureOverride/Cache.hpp"
+#include "TextureOverride/Payload.hpp"
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    bool WriteAt(HANDLE const FileHandle, std::uint64_t const Offset, void const* const Data, std::size_t const Size)
+    {
+        OVERLAPPED Overlapped{};
+        Overlapped.Offset = static_cast<DWORD>(Offset & 0xFFFFFFFFull);
+        Overlapped.OffsetHigh = static_cast<DWORD>(Offset >> 32);
+
+        DWORD Written = 0;
+        return 0 != ::WriteFile(FileHandle, Data, static_cast<DWORD>(Size), &Written, &Overlapped)
+            && Written == static_cast<DWORD>(Size);
+    }
+
+    bool WriteRecord(HANDLE const FileHandle, std::uint64_t const Offset, TextureOverride::CCacheRecord const& Record, void const* const Payload)
+    {
+        static constexpr unsigned char k_padding[TextureOverride::CCacheRecord::k_alignment]{};
+        std::size_t const PaddingSize = Record.GetStride() - sizeof(Record) - Record.Size;
+
+        return WriteAt(FileHandle, Offset, &Record, sizeof(Record))
+            && (Record.Size == 0 || WriteAt(FileHandle, Offset + sizeof(Record), Payload, Record.Size))
+            && (PaddingSize == 0 || WriteAt(FileHandle, Offset + sizeof(Record) + Record.Size, k_padding, PaddingSize));
+    }
+}
+
+namespace TextureOverride
+{
+    PayloadCache g_payloadCache{};
+    std::uint64_t g_payloadCacheCapacity{ 0 };
+
+
+    // ! PayloadCache implementation.
+    // ========================================
+
+    PayloadCache::~PayloadCache()
+    {
+        Close();
+    }
+
+    bool PayloadCache::Open(fs::path const& InPath, std::uint64_t const InCapacity, std::vector<ManifestLoaderPointer> const& Manifests)
+    {
+        LEASI_CHECKA(!IsOpen() && !OpenerThread.joinable(), "cache already open", "");
+
+        Path = InPath;
+        Capacity = InCapacity;
+
+        // Keys are taken now, as manifests may be unloaded before the scan is done.
+        std::unordered_set<std::uint64_t> LiveManifests{};
+        for (ManifestLoaderPointer const& Manifest : Manifests)
+            LiveManifests.insert(GetManifestKey(*Manifest));
+
+        bOpenerExit.store(false, std::memory_order_relaxed);
+        OpenerThread = std::thread(&PayloadCache::OpenerMain, this, std::move(LiveManifests));
+        return true;
+    }
+
+    void PayloadCache::Close()
+    {
+        if (OpenerThread.joinable())
+        {
+            bOpenerExit.store(true, std::memory_order_relaxed);
+            OpenerThread.join();
+        }
+
+        bReady.store(false, std::memory_order_relaxed);
+
+        if (WriterThread.joinable())
+        {
+            {
+                std::scoped_lock WriteLock(WriteMutex);
+                bWriterExit = true;
+            }
+
+            WriteCondition.notify_all();
+            WriterThread.join();
+            bWriterExit = false;
+        }
+
+        Unmap();
+        Index.clear();
+    }
+
+    bool PayloadCache::Lookup
+    (
+        ManifestLoader const&   Manifest,
+        std::uint32_t const     EntryIndex,
+        std::uint32_t const     MipIndex,
+        void* const             Destination,
+        std::size_t const       Size
+    )
+    {
+        if (!IsOpen())
+            return false;
+
+        auto const Iter = Index.find(CacheRecordKey{ GetManifestKey(Manifest), EntryIndex, MipIndex });
+        if (Iter == Index.end() || Iter->second.Offset == SIZE_MAX)
+        {
+            Counters.MissCount++;
+            return false;
+        }
+
+        CacheIndexEntry& Found = Iter->second;
+        auto const Record = reinterpret_cast<CCacheRecord const*>(static_cast<unsigned char const*>(View) + Found.Offset);
+        auto const Payload = reinterpret_cast<unsigned char const*>(Record + 1);
+
+        if (Record->Size != Size)
+        {
+            Counters.MissCount++;
+            return false;
+        }
+
+        if (HashPayload({ Payload, Size }) != Record->Checksum)
+        {
+            LEASI_WARN(L"payload cache record at 0x{:X} is corrupted, ignoring it", Found.Offset);
+            Index.erase(Iter);
+            Counters.MissCount++;
+            return false;
+        }
+
+        std::memcpy(Destination, Payload, Size);
+        Counters.HitCount++;
+        Counters.HitBytes += Size;
+
+        // Let the next compaction know this record is still in use.
+        if (!std::exchange(Found.bTouched, true) && Found.LastSession != Session)
+        {
+            PendingWrite Touch{};
+            Touch.Record = *Record;
+            Touch.Record.Kind = ECR_Touch;
+            Touch.Record.Session = Session;
+            Touch.Record.Size = 0;
+            Touch.Record.Checksum = 0;
+
+            {
+                // Touches are written even past capacity, but count against it like any other record.
+                std::scoped_lock WriteLock(WriteMutex);
+                FileSize += Touch.Record.GetStride();
+            }
+
+            Found.LastSession = Session;
+            QueueWrite(std::move(Touch));
+        }
+
+        return true;
+    }
+
+    void PayloadCache::Store
+    (
+        ManifestLoader const&   Manifest,
+        std::uint32_t const     EntryIndex,
+        std::uint32_t const     MipIndex,
+        void const* const       Data,
+        std::size_t const       Size
+    )
+    {
+        if (!IsOpen())
+            return;
+
+        CacheRecordKey const Key{ GetManifestKey(Manifest), EntryIndex, MipIndex };
+        if (Index.contains(Key))
+            return;
+
+        PendingWrite Append{};
+        Append.Record.Magic = CCacheRecord::k_checkMagic;
+        Append.Record.Kind = ECR_Payload;
+        Append.Record.Session = Session;
+        Append.Record.Size = static_cast<std::uint32_t>(Size);
+        Append.Record.ManifestKey = Key.ManifestKey;
+        Append.Record.EntryIndex = EntryIndex;
+        Append.Record.MipIndex = MipIndex;
+
+        std::size_t const Stride = Append.Record.GetStride();
+
+        {
+            std::scoped_lock WriteLock(WriteMutex);
+            if (FileSize + Stride > Capacity || WriteQueueBytes + Size > k_payloadCacheMaxBacklog)
+            {
+                Counters.SkippedBytes += Size;
+                return;
+            }
+
+            FileSize += Stride;
+        }
+
+        // Only records mapped on open can be served, so this one is just marked as present.
+        Index.emplace(Key, CacheIndexEntry{ SIZE_MAX, Session, true });
+
+        auto const Bytes = static_cast<unsigned char const*>(Data);
+        Append.Payload.assign(Bytes, Bytes + Size);
+        QueueWrite(std::move(Append));
+
+        Counters.StoredCount++;
+        Counters.StoredBytes += Size;
+    }
+
+    PayloadCache::Stats PayloadCache::GetStats() const
+    {
+        return Counters;
+    }
+
+    std::uint64_t PayloadCache::GetManifestKey(ManifestLoader const& Manifest)
+    {
+        struct
+        {
+            std::uint64_t   Size;
+            std::uint64_t   LastWriteTime;
+            std::uint32_t   TargetHash;
+            std::uint32_t   MetadataCRC;
+        } const Identity
+        {
+            Manifest.GetMappedView().size(),
+            Manifest.GetLastWriteTime(),
+            Manifest.GetMappedHeader().TargetHash,
+            Manifest.GetMappedHeader().MetadataCRC,
+        };
+
+        std::wstring_view const DlcName = Manifest.GetDlcName();
+        std::uint64_t const IdentityHash = HashPayload({ reinterpret_cast<unsigned char const*>(&Identity), sizeof Identity });
+        std::uint64_t const NameHash = HashPayload({ reinterpret_cast<unsigned char const*>(DlcName.data()), DlcName.size() * sizeof(wchar_t) });
+        return IdentityHash ^ (NameHash * 0x9E3779B185EBCA87ull);
+    }
+
+    void PayloadCache::OpenerMain(std::unordered_set<std::uint64_t> const LiveManifests)
+    {
+        auto const Start = std::chrono::steady_clock::now();
+
+        CacheScanResult Scan{};
+        if (!MapAndScan(Scan, LiveManifests))
+        {
+            Unmap();
+            LEASI_WARN(L"payload cache disabled for this session");
+            return;
+        }
+
+        if (MappedSize > Capacity || Scan.DeadBytes > MappedSize / 4 || ScannedSize != MappedSize)
+        {
+            LEASI_INFO(L"compacting payload cache: {} live byte(s), {} dead byte(s), capacity {}",
+                Scan.LiveBytes, Scan.DeadBytes, Capacity);
+
+            if (!Compact() || !MapAndScan(Scan, LiveManifests))
+            {
+                Unmap();
+                LEASI_WARN(L"payload cache disabled for this session");
+                return;
+            }
+        }
+
+        FileSize = ScannedSize;
+        Counters.MappedBytes = MappedSize;
+        WriterThread = std::thread(&PayloadCache::WriterMain, this);
+
+        // Everything above is visible to the game thread once it sees the cache open.
+        bReady.store(true, std::memory_order_release);
+
+        LEASI_INFO(L"payload cache opened: {} record(s), {} byte(s), session {}, in {} ms",
+            Index.size(), MappedSize, Session,
+            std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - Start).count());
+    }
+
+    bool PayloadCache::MapAndScan(CacheScanResult& OutScan, std::unordered_set<std::uint64_t> const& LiveManifests)
+    {
+        Index.clear();
+
+        FileHandle = ::CreateFileW(Path.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (FileHandle == INVALID_HANDLE_VALUE)
+        {
+            LEASI_WARN(L"failed to open payload cache {}, error = {}", Path.c_str(), ::GetLastError());
+            return false;
+        }
+
+        LARGE_INTEGER OutFileSize{};
+        if (0 == GetFileSizeEx(FileHandle, &OutFileSize))
+        {
+            LEASI_WARN(L"failed to read payload cache size, error = {}", ::GetLastError());
+            return false;
+        }
+
+        CCacheHeader Header{};
+        DWORD HeaderRead = 0;
+        bool const bValidHeader = OutFileSize.QuadPart >= LONGLONG(sizeof Header)
+            && 0 != ::ReadFile(FileHandle, &Header, sizeof Header, &HeaderRead, NULL) && HeaderRead == sizeof Header
+            && 0 == std::memcmp(Header.Magic, CCacheHeader::k_checkMagic, sizeof(CCacheHeader::k_checkMagic))
+            && Header.Version == CCacheHeader::k_lastVersion;
+
+        if (!bValidHeader)
+        {
+            // Start over with an empty cache file, nothing in it can be trusted.
+            std::memcpy(Header.Magic, CCacheHeader::k_checkMagic, sizeof(CCacheHeader::k_checkMagic));
+            Header.Version = CCacheHeader::k_lastVersion;
+            Header.Reserved = 0;
+
+            LARGE_INTEGER const Zero{};
+            if (0 == ::SetFilePointerEx(FileHandle, Zero, NULL, FILE_BEGIN) || 0 == ::SetEndOfFile(FileHandle)
+                || !WriteAt(FileHandle, 0, &Header, sizeof Header))
+            {
+                LEASI_WARN(L"failed to initialize payload cache, error = {}", ::GetLastError());
+                return false;
+            }
+
+            OutFileSize.QuadPart = sizeof Header;
+        }
+
+        MappingHandle = ::CreateFileMappingW(FileHandle, NULL, PAGE_READONLY, 0u, 0u, NULL);
+        if (MappingHandle == NULL)
+        {
+            LEASI_WARN(L"failed to create payload cache mapping, error = {}", ::GetLastError());
+            return false;
+        }
+
+        View = ::MapViewOfFile(MappingHandle, FILE_MAP_READ, 0u, 0u, 0u);
+        if (View == NULL)
+        {
+            LEASI_WARN(L"failed to map payload cache view, error = {}", ::GetLastError());
+            return false;
+        }
+
+        MappedSize = static_cast<std::size_t>(OutFileSize.QuadPart);
+
+        OutScan = ScanCacheRecords({ static_cast<unsigned char const*>(View), MappedSize }, LiveManifests, Index, &bOpenerExit);
+        if (bOpenerExit.load(std::memory_order_relaxed))
+            return false;
+
+        if (OutScan.ScannedSize < MappedSize)
+            LEASI_WARN(L"payload cache has {} byte(s) of torn records at 0x{:X}", MappedSize - OutScan.ScannedSize, OutScan.ScannedSize);
+
+        ScannedSize = OutScan.ScannedSize;
+        Session = OutScan.LastSession + 1;
+        return true;
+    }
+
+    bool PayloadCache::Compact()
+    {
+        // Leave some room for this session's appends.
+        std::vector<CacheIndexEntry> const Entries = PlanCacheCompaction({ static_cast<unsigned char const*>(View), MappedSize }, Index, Capacity / 4 * 3);
+
+        fs::path TempPath{ Path };
+        TempPath += L".tmp";
+
+        HANDLE const TempHandle = ::CreateFileW(TempPath.c_str(), GENERIC_WRITE, 0u, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (TempHandle == INVALID_HANDLE_VALUE)
+        {
+            LEASI_WARN(L"failed to create payload cache {}, error = {}", TempPath.c_str(), ::GetLastError());
+            return false;
+        }
+
+        CCacheHeader Header{};
+        std::memcpy(Header.Magic, CCacheHeader::k_checkMagic, sizeof(CCacheHeader::k_checkMagic));
+        Header.Version = CCacheHeader::k_lastVersion;
+
+        std::uint64_t Written = sizeof Header;
+        bool bSuccess = WriteAt(TempHandle, 0, &Header, sizeof Header);
+
+        for (CacheIndexEntry const& Entry : Entries)
+        {
+            if (!bSuccess || bOpenerExit.load(std::memory_order_relaxed)) break;
+
+            auto const Record = reinterpret_cast<CCacheRecord const*>(static_cast<unsigned char const*>(View) + Entry.Offset);
+
+            // Fold touch records into the payload record itself.
+            CCacheRecord Compacted = *Record;
+            Compacted.Session = Entry.LastSession;
+
+            bSuccess = WriteRecord(TempHandle, Written, Compacted, Record + 1);
+            Written += Record->GetStride();
+        }
+
+        ::CloseHandle(TempHandle);
+        Unmap();
+
+        if (bOpenerExit.load(std::memory_order_relaxed))
+        {
+            // Interrupted by closing, the original file is still whole.
+            ::DeleteFileW(TempPath.c_str());
+            return false;
+        }
+
+        if (!bSuccess || 0 == ::MoveFileExW(TempPath.c_str(), Path.c_str(), MOVEFILE_REPLACE_EXISTING))
+        {
+            LEASI_WARN(L"failed to compact payload cache, error = {}", ::GetLastError());
+            ::DeleteFileW(TempPath.c_str());
+            ::DeleteFileW(Path.c_str());
+            return false;
+        }
+
+        LEASI_INFO(L"payload cache compacted to {} byte(s)", Written);
+        return true;
+    }
+
+    void PayloadCache::Unmap()
+    {
+        if (View != NULL)
+            ::UnmapViewOfFile(std::exchange(View, reinterpret_cast<LPVOID>(NULL)));
+        if (MappingHandle != NULL)
+            ::CloseHandle(std::exchange(MappingHandle, reinterpret_cast<HANDLE>(NULL)));
+        if (FileHandle != INVALID_HANDLE_VALUE)
+            ::CloseHandle(std::exchange(FileHandle, reinterpret_cast<HANDLE>(INVALID_HANDLE_VALUE)));
+
+        MappedSize = ScannedSize = 0;
+    }
+
+    void PayloadCache::QueueWrite(PendingWrite&& InWrite)
+    {
+        {
+            std::scoped_lock WriteLock(WriteMutex);
+            WriteQueueBytes += InWrite.Payload.size();
+            WriteQueue.push_back(std::move(InWrite));
+        }
+
+        WriteCondition.notify_one();
+    }
+
+    void PayloadCache::WriterMain()
+    {
+        std::uint64_t AppendOffset = ScannedSize;
+
+        while (true)
+        {
+            std::unique_lock WriteLock(WriteMutex);
+            WriteCondition.wait(WriteLock, [this]() -> bool { return bWriterExit || !WriteQueue.empty(); });
+
+            // Pending writes are drained before exiting.
+            if (WriteQueue.empty())
+                break;
+
+            PendingWrite Next = std::move(WriteQueue.front());
+            WriteQueue.pop_front();
+            WriteQueueBytes -= Next.Payload.size();
+            WriteLock.unlock();
+
+            if (Next.Record.Kind == ECR_Payload)
+                Next.Record.Checksum = HashPayload(Next.Payload);
+
+            if (!WriteRecord(FileHandle, AppendOffset, Next.Record, Next.Payload.data()))
+            {
+                LEASI_WARN(L"failed to append to payload cache, error = {}", ::GetLastError());
+                continue;
+            }
+
+            AppendOffset += Next.Record.GetStride();
+        }
+    }
+}
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+#include <Windows.h>
+#include <LESDK/Headers.hpp>
+#include "Common/Base.hpp"
+#include "TextureOverride/CacheFormat.hpp"
+#include "TextureOverride/Manifest.hpp"
+
+
+namespace TextureOverride
+{
+    // ! Decompressed payload cache.
+    // ========================================
+
+    /**
+     * @brief   Append-only, memory-mapped file of decompressed mip payloads shared across sessions.
+     * @remarks Records written in previous sessions are mapped read-only on @ref Open and served
+     *          by copy, while records produced this session are appended by a background writer.
+     *          Records are keyed by manifest identity (which changes whenever a .btp is rewritten),
+     *          entry and mip index. Least recently used and orphaned records are dropped by
+     *          rewriting the file when it outgrows its size cap.
+     * @remarks The file is scanned, and rewritten if needed, on a background thread started by @ref Open ,
+     *          so that a large cache never holds up loading. Lookups miss and stores are skipped until
+     *          the index is complete, after which it is only used from the game thread.
+     */
+    class PayloadCache final : public NonCopyable
+    {
+    public:
+
+        struct Stats final
+        {
+            std::uint64_t   HitCount{ 0 };
+            std::uint64_t   HitBytes{ 0 };
+            std::uint64_t   MissCount{ 0 };
+            std::uint64_t   StoredCount{ 0 };
+            std::uint64_t   StoredBytes{ 0 };
+            std::uint64_t   SkippedBytes{ 0 };      // Bytes not stored due to the size cap or writer backlog.
+            std::uint64_t   MappedBytes{ 0 };
+        };
+
+        PayloadCache() = default;
+        ~PayloadCache();
+
+        /**
+         * @brief       Starts opening (or creating) the cache file in the background, compacting it first if needed.
+         * @param[in]   InPath - path to the cache file.
+         * @param[in]   InCapacity - maximum number of bytes the cache file may occupy.
+         * @param[in]   Manifests - currently loaded manifests, records for any other manifest are dropped.
+         * @return      Whether opening started, failures to open are logged by the background thread.
+         */
+        bool Open(std::filesystem::path const& InPath, std::uint64_t InCapacity, std::vector<ManifestLoaderPointer> const& Manifests);
+
+        /** Waits for pending appends to be written and closes the cache file, cancelling any unfinished scan. */
+        void Close();
+
+        /** Checks whether the cache finished opening, after which lookups and stores are served. */
+        inline bool IsOpen() const noexcept { return bReady.load(std::memory_order_acquire); }
+
+        /**
+         * @brief       Copies a cached decompressed payload into a destination buffer.
+         * @param[in]   Manifest - manifest containing the entry.
+         * @param[in]   EntryIndex - index of the texture entry, see @ref ManifestLoader::GetEntryIndex .
+         * @param[in]   MipIndex - index of the mip within the entry.
+         * @param[out]  Destination - buffer receiving exactly @c Size bytes.
+         * @param[in]   Size - expected decompressed size of the mip.
+         * @return      Whether the payload was found and copied.
+         */
+        bool Lookup(ManifestLoader const& Manifest, std::uint32_t EntryIndex, std::uint32_t MipIndex, void* Destination, std::size_t Size);
+
+        /** Queues a decompressed payload to be appended to the cache file. */
+        void Store(ManifestLoader const& Manifest, std::uint32_t EntryIndex, std::uint32_t MipIndex, void const* Data, std::size_t Size);
+
+        Stats GetStats() const;
+
+        /** Calculates the identity of a manifest file, which changes whenever the file is rewritten. */
+        static std::uint64_t GetManifestKey(ManifestLoader const& Manifest);
+
+    private:
+
+        struct PendingWrite final
+        {
+            CCacheRecord                Record{};
+            std::vector<unsigned char>  Payload{};
+        };
+
+        void OpenerMain(std::unordered_set<std::uint64_t> LiveManifests);
+        bool MapAndScan(CacheScanResult& OutScan, std::unordered_set<std::uint64_t> const& LiveManifests);
+        bool Compact();
+        void Unmap();
+        void QueueWrite(PendingWrite&& InWrite);
+        void WriterMain();
+
+        std::filesystem::path       Path{};
+        std::uint64_t               Capacity{ 0 };
+        std::uint32_t               Session{ 1 };
+
+        HANDLE                      FileHandle{ INVALID_HANDLE_VALUE };
+        HANDLE                      MappingHandle{ NULL };
+        LPVOID                      View{ NULL };
+        std::size_t                 MappedSize{ 0 };
+        std::size_t                 ScannedSize{ 0 };       // End of the last intact record, where appends start.
+        CacheIndex                  Index{};
+
+        std::thread                 OpenerThread{};
+        std::atomic_bool            bOpenerExit{ false };
+        std::atomic_bool            bReady{ false };        // Set once the index is complete and the writer runs.
+
+        std::mutex                  WriteMutex{};
+        std::condition_variable     WriteCondition{};
+        std::deque<PendingWrite>    WriteQueue{};
+        std::size_t                 WriteQueueBytes{ 0 };
+        std::uint64_t               FileSize{ 0 };
+        bool                        bWriterExit{ false };
+        std::thread                 WriterThread{};
+
+        Stats                       Counters{};
+    };
+
+    // Cache shared by all manifests, opened via "-texturecache" command line argument.
+    extern PayloadCache g_payloadCache;
+    // Size cap of the cache file in bytes, zero if the cache is disabled.
+    extern std::uint64_t g_payloadCacheCapacity;
+
+    static constexpr std::wstring_view k_payloadCachePath = L"TextureOverride.cache";
+    static constexpr std::uint64_t k_payloadCacheDefaultCapacity = 4ull << 30;
+    // Maximum number of bytes waiting to be appended before further stores are skipped.
+    static constexpr std::size_t k_payloadCacheMaxBacklog = 256ull << 20;
+}
@@ -0,0 +1,98 @@
+#include <algorithm>
+#include "TextureOverride/CacheFormat.hpp"
+
+namespace TextureOverride
+{
+    // ! Cache file index implementation.
+    // ========================================
+
+    CacheScanResult ScanCacheRecords
+    (
+        std::span<unsigned char const> const        View,
+        std::unordered_set<std::uint64_t> const&    LiveManifests,
+        CacheIndex&                                 OutIndex,
+        std::atomic_bool const* const               bAbort
+    )
+    {
+        CacheScanResult Result{};
+        OutIndex.clear();
+
+        std::size_t Offset = sizeof(CCacheHeader);
+        while (Offset + sizeof(CCacheRecord) <= View.size())
+        {
+            if (bAbort != nullptr && bAbort->load(std::memory_order_relaxed))
+                break;
+
+            auto const Record = reinterpret_cast<CCacheRecord const*>(View.data() + Offset);
+            std::size_t const Stride = Record->GetStride();
+
+            // Anything past a torn append is garbage.
+            if (Record->Magic != CCacheRecord::k_checkMagic || Offset + Stride > View.size())
+                break;
+
+            Result.LastSession = (std::max)(Result.LastSession, Record->Session);
+            CacheRecordKey const Key{ Record->ManifestKey, Record->EntryIndex, Record->MipIndex };
+
+            if (Record->Kind == ECR_Payload && LiveManifests.contains(Record->ManifestKey))
+            {
+                auto [Iter, bInserted] = OutIndex.try_emplace(Key, CacheIndexEntry{ Offset, Record->Session, false });
+                if (!bInserted)
+                {
+                    auto const Superseded = reinterpret_cast<CCacheRecord const*>(View.data() + Iter->second.Offset);
+                    Result.LiveBytes -= Superseded->GetStride();
+                    Result.DeadBytes += Superseded->GetStride();
+                    Iter->second = CacheIndexEntry{ Offset, (std::max)(Iter->second.LastSession, Record->Session), false };
+                }
+
+                Result.LiveBytes += Stride;
+            }
+            else if (Record->Kind == ECR_Touch)
+            {
+                if (auto const Iter = OutIndex.find(Key); Iter != OutIndex.end())
+                    Iter->second.LastSession = (std::max)(Iter->second.LastSession, Record->Session);
+
+                Result.DeadBytes += Stride;
+            }
+            else
+            {
+                Result.DeadBytes += Stride;
+            }
+
+            Offset += Stride;
+        }
+
+        Result.DeadBytes += View.size() - (std::min)(Offset, View.size());
+        Result.ScannedSize = Offset;
+        return Result;
+    }
+
+    std::vector<CacheIndexEntry> PlanCacheCompaction(std::span<unsigned char const> const View, CacheIndex const& Index, std::uint64_t const Budget)
+    {
+        // Most recently used records are kept first, ties going to the latest appended.
+        std::vector<CacheIndexEntry> Entries{};
+        Entries.reserve(Index.size());
+        for (auto const& [_, Entry] : Index)
+            Entries.push_back(Entry);
+
+        std::sort(Entries.begin(), Entries.end(), [](CacheIndexEntry const& Left, CacheIndexEntry const& Right)
+            {
+                return Left.LastSession != Right.LastSession
+                    ? Left.LastSession > Right.LastSession
+                    : Left.Offset > Right.Offset;
+            });
+
+        std::vector<CacheIndexEntry> Kept{};
+        std::uint64_t Planned = sizeof(CCacheHeader);
+        for (CacheIndexEntry const& Entry : Entries)
+        {
+            std::size_t const Stride = reinterpret_cast<CCacheRecord const*>(View.data() + Entry.Offset)->GetStride();
+            if (Planned + Stride > Budget)
+                continue;
+
+            Kept.push_back(Entry);
+            Planned += Stride;
+        }
+
+        return Kept;
+    }
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+
+namespace TextureOverride
+{
+    // ! Cache file structs.
+    // ========================================
+
+#pragma pack(push, 1)
+
+    struct CCacheHeader
+    {
+        unsigned char   Magic[8];               // Magic bytes of 'LETOCACH'.
+        std::uint32_t   Version;                // Cache file version, mismatching files are discarded.
+        std::uint32_t   Reserved;
+
+        static constexpr decltype(Magic)        k_checkMagic{ 'L', 'E', 'T', 'O', 'C', 'A', 'C', 'H' };
+        static constexpr decltype(Version)      k_lastVersion{ 1 };
+    };
+    static_assert(sizeof(CCacheHeader) == 16);
+
+    enum ECacheRecordKind : std::uint16_t
+    {
+        ECR_Payload                     = 1,    // Record is followed by decompressed mip contents.
+        ECR_Touch                       = 2,    // Record marks a payload as used in a later session.
+    };
+
+    struct CCacheRecord
+    {
+        std::uint32_t   Magic;                  // Always @ref k_checkMagic, used to detect torn appends.
+        ECacheRecordKind Kind;
+        std::uint16_t   Reserved0;
+        std::uint32_t   Session;                // Number of the session which appended this record.
+        std::uint32_t   Size;                   // Number of payload bytes following this record.
+        std::uint64_t   ManifestKey;            // See @ref PayloadCache::GetManifestKey .
+        std::uint32_t   EntryIndex;             // Index of the texture entry in its manifest.
+        std::uint32_t   MipIndex;               // Index of the mip within its texture entry.
+        std::uint64_t   Checksum;               // Hash of the payload bytes following this record.
+        std::uint64_t   Reserved1;
+
+        static constexpr std::uint32_t k_checkMagic = 0x52434F54;  // 'TOCR'
+        static constexpr std::size_t k_alignment = 16;
+
+        /** Retrieves the number of bytes occupied by this record, including its aligned payload. */
+        inline std::size_t GetStride() const noexcept
+        {
+            return sizeof(CCacheRecord) + ((std::size_t(Size) + k_alignment - 1) & ~(k_alignment - 1));
+        }
+    };
+    static_assert(sizeof(CCacheRecord) == 48);
+
+#pragma pack(pop)
+
+
+    // ! Cache file index.
+    // ========================================
+
+    struct CacheRecordKey final
+    {
+        std::uint64_t   ManifestKey{ 0 };
+        std::uint32_t   EntryIndex{ 0 };
+        std::uint32_t   MipIndex{ 0 };
+
+        inline bool operator==(CacheRecordKey const& Other) const noexcept
+        {
+            return ManifestKey == Other.ManifestKey && EntryIndex == Other.EntryIndex && MipIndex == Other.MipIndex;
+        }
+    };
+
+    struct CacheRecordKeyHash final
+    {
+        inline std::size_t operator()(CacheRecordKey const& Key) const noexcept
+        {
+            std::uint64_t const Combined = Key.ManifestKey
+                ^ ((std::uint64_t(Key.EntryIndex) << 16 | Key.MipIndex) * 0xC2B2AE3D27D4EB4Full);
+            return static_cast<std::size_t>(Combined ^ (Combined >> 29));
+        }
+    };
+
+    struct CacheIndexEntry final
+    {
+        std::size_t     Offset{ 0 };            // Offset of the payload record within the mapped view.
+        std::uint32_t   LastSession{ 0 };       // Last session the payload was appended or used in.
+        bool            bTouched{ false };      // Whether a touch record was already queued this session.
+    };
+
+    using CacheIndex = std::unordered_map<CacheRecordKey, CacheIndexEntry, CacheRecordKeyHash>;
+
+    struct CacheScanResult final
+    {
+        std::size_t     LiveBytes{ 0 };         // Bytes of payload records in the index.
+        std::size_t     DeadBytes{ 0 };         // Bytes of touch, superseded, orphaned and torn records.
+        std::size_t     ScannedSize{ 0 };       // End of the last intact record, where appends start.
+        std::uint32_t   LastSession{ 0 };
+    };
+
+    /**
+     * @brief       Indexes the payload records of a mapped cache file, header included.
+     * @remarks     Scanning stops at the first torn record, anything past it is counted as dead.
+     * @param[in]   View - whole cache file, starting with a valid @ref CCacheHeader .
+     * @param[in]   LiveManifests - keys of the loaded manifests, records for any other manifest are dropped.
+     * @param[out]  OutIndex - receives the latest payload record of every key, emptied first.
+     * @param[in]   bAbort - checked between records, scanning stops early once set.
+     */
+    CacheScanResult ScanCacheRecords(std::span<unsigned char const> View, std::unordered_set<std::uint64_t> const& LiveManifests,
+        CacheIndex& OutIndex, std::atomic_bool const* bAbort = nullptr);
+
+    /**
+     * @brief       Picks the records a compacted cache file keeps, most recently used first.
+     * @param[in]   View - whole cache file the index was scanned from.
+     * @param[in]   Index - see @ref ScanCacheRecords .
+     * @param[in]   Budget - maximum size of the compacted file, header included.
+     * @return      Entries to copy in order, each with the session its record should carry.
+     */
+    std::vector<CacheIndexEntry> PlanCacheCompaction(std::span<unsigned char const> View, CacheIndex const& Index, std::uint64_t Budget);
+}
@@ -0,0 +1,123 @@
+#include <array>
+#include <cstring>
+#include <nmmintrin.h>
+#if defined(_MSC_VER)
+    #include <intrin.h>
+#else
+    #include <cpuid.h>
+#endif
+#include "TextureOverride/Checksum.hpp"
+
+// Other compilers only emit SSE4.2 instructions in functions which ask for them.
+#if defined(_MSC_VER)
+    #define TEXTUREOVERRIDE_TARGET_SSE42
+#else
+    #define TEXTUREOVERRIDE_TARGET_SSE42 __attribute__((target("sse4.2")))
+#endif
+
+namespace
+{
+    constexpr std::uint32_t k_crc32cPolynomial = 0x82F63B78;  // Reflected 0x1EDC6F41.
+
+    constexpr auto MakeCrc32cTables()
+    {
+        std::array<std::array<std::uint32_t, 256>, 8> Tables{};
+
+        for (std::uint32_t i = 0; i < 256; ++i)
+        {
+            std::uint32_t Value = i;
+            for (int Bit = 0; Bit < 8; ++Bit)
+                Value = (Value >> 1) ^ ((Value & 1) ? k_crc32cPolynomial : 0);
+            Tables[0][i] = Value;
+        }
+
+        for (std::uint32_t i = 0; i < 256; ++i)
+        {
+            for (std::size_t Slice = 1; Slice < 8; ++Slice)
+                Tables[Slice][i] = (Tables[Slice - 1][i] >> 8) ^ Tables[0][Tables[Slice - 1][i] & 0xFF];
+        }
+
+        return Tables;
+    }
+
+    constexpr auto k_crc32cTables = MakeCrc32cTables();
+
+    std::uint32_t Crc32cSoftware(std::uint32_t Crc, unsigned char const* Data, std::size_t Size) noexcept
+    {
+        auto const& T = k_crc32cTables;
+
+        while (Size >= 8)
+        {
+            std::uint32_t Low, High;
+            std::memcpy(&Low, Data, sizeof Low);
+            std::memcpy(&High, Data + 4, sizeof High);
+            Low ^= Crc;
+
+            Crc = T[7][Low & 0xFF] ^ T[6][(Low >> 8) & 0xFF] ^ T[5][(Low >> 16) & 0xFF] ^ T[4][Low >> 24]
+                ^ T[3][High & 0xFF] ^ T[2][(High >> 8) & 0xFF] ^ T[1][(High >> 16) & 0xFF] ^ T[0][High >> 24];
+
+            Data += 8;
+            Size -= 8;
+        }
+
+        while (Size-- > 0)
+            Crc = (Crc >> 8) ^ T[0][(Crc ^ *Data++) & 0xFF];
+
+        return Crc;
+    }
+
+    TEXTUREOVERRIDE_TARGET_SSE42
+    std::uint32_t Crc32cHardware(std::uint32_t Crc, unsigned char const* Data, std::size_t Size) noexcept
+    {
+        std::uint64_t Wide = Crc;
+
+        while (Size >= 8)
+        {
+            std::uint64_t Word;
+            std::memcpy(&Word, Data, sizeof Word);
+            Wide = _mm_crc32_u64(Wide, Word);
+
+            Data += 8;
+            Size -= 8;
+        }
+
+        Crc = static_cast<std::uint32_t>(Wide);
+        while (Size-- > 0)
+            Crc = _mm_crc32_u8(Crc, *Data++);
+
+        return Crc;
+    }
+
+    bool DetectSse42() noexcept
+    {
+#if defined(TEXTUREOVERRIDE_NO_SSE42)
+        return false;  // Lets host builds check the table implementation.
+#elif defined(_MSC_VER)
+        int CpuInfo[4]{};
+        __cpuid(CpuInfo, 1);
+        return (CpuInfo[2] & (1 << 20)) != 0;
+#else
+        unsigned int Eax = 0, Ebx = 0, Ecx = 0, Edx = 0;
+        return __get_cpuid(1, &Eax, &Ebx, &Ecx, &Edx) != 0 && (Ecx & bit_SSE4_2) != 0;
+#endif
+    }
+}
+
+namespace TextureOverride
+{
+    std::uint32_t Crc32c(std::uint32_t const Crc, std::span<unsigned char const> const Data) noexcept
+    {
+        static bool const s_bAccelerated = DetectSse42();
+
+        std::uint32_t const Inverted = ~Crc;
+        return ~(s_bAccelerated
+            ? Crc32cHardware(Inverted, Data.data(), Data.size())
+            : Crc32cSoftware(Inverted, Data.data(), Data.size()));
+    }
+
+    bool IsCrc32cAccelerated() noexcept
+    {
+        static bool const s_bAccelerated = DetectSse42();
+        return s_bAccelerated;
+    }
+}
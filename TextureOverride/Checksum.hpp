@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+
+namespace TextureOverride
+{
+    // ! CRC-32C (Castagnoli).
+    // ========================================
+
+    /**
+     * @brief       Updates a CRC-32C checksum with more bytes.
+     * @remarks     Uses the SSE4.2 @c crc32 instruction when the CPU supports it,
+     *              and a slicing-by-8 table implementation otherwise. Both produce identical results.
+     * @param[in]   Crc - checksum of the preceding bytes, zero for the first call.
+     * @param[in]   Data - bytes to append.
+     * @return      Checksum of all bytes so far.
+     */
+    std::uint32_t Crc32c(std::uint32_t Crc, std::span<unsigned char const> Data) noexcept;
+
+    /** Checks whether @ref Crc32c is hardware-accelerated on this CPU. */
+    bool IsCrc32cAccelerated() noexcept;
+}
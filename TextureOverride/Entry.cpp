@@ -1,11 +1,19 @@
+#include <algorithm>
+#include <cwchar>
+#include <string>
 #include <spdlog/details/windows_include.h>
 #include <spdlog/sinks/basic_file_sink.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 
 #include "Common/Base.hpp"
+#include "TextureOverride/Budget.hpp"
+#include "TextureOverride/Cache.hpp"
 #include "TextureOverride/Entry.hpp"
 #include "TextureOverride/Hooks.hpp"
 #include "TextureOverride/Loading.hpp"
+#include "TextureOverride/Payload.hpp"
+#include "TextureOverride/Transcode.hpp"
+#include "TextureOverride/Verify.hpp"
 
 SPI_PLUGINSIDE_SUPPORT(SDK_TARGET_NAME_W L"TextureOverride", L"d00telemental", L"0.1.0", SPI_GAME_SDK_TARGET, SPI_VERSION_ANY);
 SPI_PLUGINSIDE_POSTLOAD;
@@ -30,6 +38,8 @@ SPI_IMPLEMENT_ATTACH
 SPI_IMPLEMENT_DETACH
 {
     LEASI_UNUSED(InterfacePtr);
+    ::TextureOverride::g_payloadVerifier.Stop();
+    ::TextureOverride::g_payloadCache.Close();
 #ifdef _DEBUG
     ::LESDK::TerminateConsole();
 #endif
@@ -37,6 +47,35 @@ SPI_IMPLEMENT_DETACH
 }
 
 
+namespace
+{
+    /** Reads the integer value of a " -name=value " command line argument. */
+    bool TryReadIntegerArg(FString const& CmdArgs, wchar_t const* const Prefix, long long& OutValue)
+    {
+        wchar_t const* const Found = std::wcsstr(*CmdArgs, Prefix);
+        if (Found == nullptr)
+            return false;
+
+        wchar_t* End = nullptr;
+        wchar_t const* const Value = Found + std::wcslen(Prefix);
+        OutValue = std::wcstoll(Value, &End, 10);
+        return End != Value;
+    }
+
+    /** Reads the text value of a " -name=value " command line argument, up to the next space. */
+    bool TryReadStringArg(FString const& CmdArgs, wchar_t const* const Prefix, std::wstring& OutValue)
+    {
+        wchar_t const* const Found = std::wcsstr(*CmdArgs, Prefix);
+        if (Found == nullptr)
+            return false;
+
+        std::wstring_view const Rest{ Found + std::wcslen(Prefix) };
+        OutValue = Rest.substr(0, Rest.find(L' '));
+        return !OutValue.empty();
+    }
+}
+
+
 namespace TextureOverride
 {
     void InitializeLogger()
@@ -142,5 +181,67 @@ namespace TextureOverride
             LEASI_WARN(L"texture override disabled via cmd args");
             LEASI_WARN(L"manifests will still be processed");
         }
+
+        if (std::wstring Formats{}; TryReadStringArg(CmdArgs, L" -texturetranscode=", Formats))
+        {
+            long long MinDimension = 0;
+            TryReadIntegerArg(CmdArgs, L" -texturetranscodemin=", MinDimension);
+
+            bool const bBC7 = Formats.find(L"bc7") != std::wstring::npos || Formats.find(L"BC7") != std::wstring::npos;
+            bool const bBC5 = Formats.find(L"bc5") != std::wstring::npos || Formats.find(L"BC5") != std::wstring::npos;
+            g_mipTranscoder.Configure(bBC7, bBC5, static_cast<int>(std::clamp(MinDimension, 0ll, 16384ll)));
+
+            if (g_mipTranscoder.IsEnabled())
+                LEASI_INFO(L"override mips will be transcoded to DXT1 (bc7: {}, bc5: {}, min size: {})", bBC7, bBC5, MinDimension);
+            else
+                LEASI_WARN(L"no known formats in -texturetranscode={}, expected bc7 and/or bc5", Formats);
+        }
+
+        if (CmdArgs.Contains(L" -notextureverify ", true))
+        {
+            g_payloadVerifier.SetEnabled(false);
+            LEASI_WARN(L"background payload verification disabled via cmd args");
+        }
+
+        if (CmdArgs.Contains(L" -texturededup ", true))
+        {
+            g_payloadPool.SetEnabled(true);
+            LEASI_INFO(L"identical mip payloads will be shared between textures");
+        }
+
+        if (CmdArgs.Contains(L" -texturecache ", true))
+        {
+            g_payloadCacheCapacity = k_payloadCacheDefaultCapacity;
+
+            if (long long CapacityMB = 0; TryReadIntegerArg(CmdArgs, L" -texturecachesize=", CapacityMB))
+            {
+                if (CapacityMB > 0)
+                    g_payloadCacheCapacity = static_cast<std::uint64_t>(CapacityMB) << 20;
+                else
+                    LEASI_WARN(L"ignoring invalid texture cache size {} MB", CapacityMB);
+            }
+
+            LEASI_INFO(L"decompressed mip payloads will be cached, up to {} MB", g_payloadCacheCapacity >> 20);
+        }
+
+        long long BudgetTrimCount = 1;
+        TryReadIntegerArg(CmdArgs, L" -texturebudgettrim=", BudgetTrimCount);
+
+        // Only one budget policy can be active, the first one given below wins.
+        if (long long BudgetMB = 0; TryReadIntegerArg(CmdArgs, L" -texturebudget=", BudgetMB) && BudgetMB > 0)
+        {
+            g_mipBudget.Configure(EBudgetPolicy::GlobalCap, static_cast<std::uint64_t>(BudgetMB) << 20, static_cast<int>(BudgetTrimCount));
+            LEASI_INFO(L"override mips will be trimmed once they hold more than {} MB", BudgetMB);
+        }
+        else if (long long MaxDimension = 0; TryReadIntegerArg(CmdArgs, L" -texturemaxdim=", MaxDimension) && MaxDimension > 0)
+        {
+            g_mipBudget.Configure(EBudgetPolicy::MaxDimension, static_cast<std::uint64_t>(MaxDimension), 1);
+            LEASI_INFO(L"override mips larger than {} px will be trimmed", MaxDimension);
+        }
+        else if (long long CommitMB = 0; TryReadIntegerArg(CmdArgs, L" -texturebudgetcommit=", CommitMB) && CommitMB > 0)
+        {
+            g_mipBudget.Configure(EBudgetPolicy::ProcessCommit, static_cast<std::uint64_t>(CommitMB) << 20, static_cast<int>(BudgetTrimCount));
+            LEASI_INFO(L"override mips will be trimmed once process commit exceeds {} MB", CommitMB);
+        }
     }
 }
@@ -1,7 +1,13 @@
 #include <thread>
 #include <chrono>
+#include "TextureOverride/Budget.hpp"
+#include "TextureOverride/Cache.hpp"
+#include "TextureOverride/Checksum.hpp"
 #include "TextureOverride/Hooks.hpp"
 #include "TextureOverride/Loading.hpp"
+#include "TextureOverride/Payload.hpp"
+#include "TextureOverride/Transcode.hpp"
+#include "TextureOverride/Verify.hpp"
 namespace fs = std::filesystem;
 
 namespace TextureOverride
@@ -17,25 +23,93 @@ namespace TextureOverride
 			if (CommandCopy.Contains(L"to.disable"))
 			{
 				g_enableLoadingManifest = false;
+				g_manifestsPendingReload = false;
+				std::size_t const ReclaimedBytes = UnloadDlcManifests({});
 				LEASI_WARN(L"texture override disabled via console command");
-				LEASI_WARN(L"manifests will still be processed");
+				LEASI_WARN(L"manifests unloaded, {:.2f} MiB reclaimed", ReclaimedBytes / 1048576.0);
 			}
 			else if (CommandCopy.Contains(L"to.enable"))
 			{
 				g_enableLoadingManifest = true;
+				g_manifestsPendingReload = true;
 				LEASI_WARN(L"texture override re-enabled via console command");
+				LEASI_WARN(L"unloaded manifests will be reloaded on next texture load");
+			}
+			else if (CommandView.size() > 10 && (CommandView.starts_with(L"to.unload ") || CommandView.starts_with(L"TO.UNLOAD ")))
+			{
+				std::wstring_view const DlcName = CommandView.substr(10);
+				std::size_t const ReclaimedBytes = UnloadDlcManifests(DlcName);
+				LEASI_WARN(L"manifest for '{}' unloaded via console command, {:.2f} MiB reclaimed", DlcName, ReclaimedBytes / 1048576.0);
 			}
-#ifdef _DEBUG
 			else if (CommandCopy.Contains(L"to.stats"))
 			{
+#ifdef _DEBUG
 				g_statTextureSerializeCount = std::max<int>(g_statTextureSerializeCount, 1);
 
 				LEASI_INFO(L"(stats) UTexture2D::Serialize time added:     {:.4f} ms", g_statTextureSerializeSeconds * 1000);
 				LEASI_INFO(L"(stats) UTexture2D::Serialize active count:   {}", g_statTextureSerializeCount);
 				LEASI_INFO(L"(stats) ==================================================");
 				LEASI_INFO(L"(stats) AVERAGE TIME ADDED:                   {:.4f} ms", g_statTextureSerializeSeconds * 1000 / g_statTextureSerializeCount);
-			}
 #endif
+
+				if (g_payloadPool.IsEnabled())
+				{
+					g_payloadPool.Collect();
+					PayloadPool::Stats const Pool = g_payloadPool.GetStats();
+
+					LEASI_INFO(L"(stats) payload dedup unique buffers:         {} ({:.2f} MiB)", Pool.UniqueCount, Pool.UniqueBytes / 1048576.0);
+					LEASI_INFO(L"(stats) payload dedup shared mips:            {} ({} hit(s) total)", Pool.OwnerCount, Pool.TotalHits);
+					LEASI_INFO(L"(stats) payload dedup freed after release:    {:.2f} MiB", Pool.TotalFreedBytes / 1048576.0);
+					LEASI_INFO(L"(stats) ==================================================");
+					LEASI_INFO(L"(stats) DEDUPLICATED BYTES:                   {:.2f} MiB", Pool.DeduplicatedBytes / 1048576.0);
+				}
+
+				if (g_payloadCache.IsOpen())
+				{
+					PayloadCache::Stats const Cache = g_payloadCache.GetStats();
+
+					LEASI_INFO(L"(stats) payload cache mapped at open:         {:.2f} MiB", Cache.MappedBytes / 1048576.0);
+					LEASI_INFO(L"(stats) payload cache hits / misses:          {} / {}", Cache.HitCount, Cache.MissCount);
+					LEASI_INFO(L"(stats) payload cache stored:                 {} ({:.2f} MiB)", Cache.StoredCount, Cache.StoredBytes / 1048576.0);
+					LEASI_INFO(L"(stats) payload cache skipped (cap/backlog):  {:.2f} MiB", Cache.SkippedBytes / 1048576.0);
+					LEASI_INFO(L"(stats) ==================================================");
+					LEASI_INFO(L"(stats) DECOMPRESSION AVOIDED:                {:.2f} MiB", Cache.HitBytes / 1048576.0);
+				}
+
+				if (g_payloadVerifier.IsEnabled())
+				{
+					PayloadVerifier::Stats const Verify = g_payloadVerifier.GetStats();
+
+					LEASI_INFO(L"(stats) payload entries verified:             {} ({} bad)", Verify.VerifiedEntries, Verify.BadEntries);
+					LEASI_INFO(L"(stats) payload bytes checksummed (crc32c):   {:.2f} MiB ({})", Verify.ChecksummedBytes / 1048576.0,
+						IsCrc32cAccelerated() ? L"sse4.2" : L"table");
+					LEASI_INFO(L"(stats) payload bytes trial-decoded:          {:.2f} MiB", Verify.DecodedBytes / 1048576.0);
+				}
+
+				if (g_mipTranscoder.IsEnabled())
+				{
+					MipTranscoder::Stats const Transcode = g_mipTranscoder.GetStats();
+
+					LEASI_INFO(L"(stats) transcoded to dxt1:                   {} texture(s), {} skipped", Transcode.TranscodedTextures, Transcode.SkippedTextures);
+					LEASI_INFO(L"(stats) transcoding time:                     {:.4f} ms", Transcode.Seconds * 1000);
+					LEASI_INFO(L"(stats) transcoded mips shared:               {}", Transcode.SharedMips);
+					LEASI_INFO(L"(stats) transcoding quality (psnr):           {:.2f} dB", Transcode.GetPSNR());
+					LEASI_INFO(L"(stats) ==================================================");
+					LEASI_INFO(L"(stats) BYTES SAVED BY TRANSCODING:           {:.2f} MiB", Transcode.SavedBytes / 1048576.0);
+				}
+
+				if (g_mipBudget.IsEnabled())
+				{
+					g_mipBudget.Collect();
+					MipBudget::Stats const Budget = g_mipBudget.GetStats();
+
+					LEASI_INFO(L"(stats) override mips held:                   {:.2f} MiB", Budget.HeldBytes / 1048576.0);
+					LEASI_INFO(L"(stats) override textures trimmed:            {}", Budget.TrimmedTextures);
+					LEASI_INFO(L"(stats) override mips trimmed this session:   {:.2f} MiB", Budget.TotalSavedBytes / 1048576.0);
+					LEASI_INFO(L"(stats) ==================================================");
+					LEASI_INFO(L"(stats) BYTES SAVED BY BUDGET:                {:.2f} MiB", Budget.SavedBytes / 1048576.0);
+				}
+			}
 		}
 
 		return UGameEngine_Exec_orig(Context, Command, Archive);
@@ -58,6 +132,12 @@ namespace TextureOverride
 			g_remainingAllowedStalls--;
 		}
 
+		if (g_manifestsPendingReload)
+		{
+			g_manifestsPendingReload = false;
+			ReloadDlcManifests();
+		}
+
 		FString const& TextureFullName = GetTextureFullName(Context);
 		// LEASI_DEBUG(L"UTexture2D::Serialize: {}", *TextureFullName);
 
@@ -76,6 +156,18 @@ namespace TextureOverride
 		}
 #endif
 
+		if (g_payloadPool.IsEnabled() || g_mipBudget.IsEnabled())
+		{
+			// Periodically drop references held by textures the engine has since destroyed.
+			static int s_serializeSinceCollect = 0;
+			if (++s_serializeSinceCollect >= k_payloadCollectInterval)
+			{
+				s_serializeSinceCollect = 0;
+				g_payloadPool.Collect();
+				g_mipBudget.Collect();
+			}
+		}
+
 		if (g_enableLoadingManifest)
 		{
 #ifdef _DEBUG
@@ -84,8 +176,14 @@ namespace TextureOverride
 
 			for (ManifestLoaderPointer const& Manifest : g_loadedManifests)
 			{
+				if (!Manifest->IsLoaded()) continue;
 				CTextureEntry const* const Entry = Manifest->FindEntry(TextureFullName);
 				if (Entry == nullptr) continue;
+				if (!Manifest->IsEntryInBounds(*Entry) || g_payloadVerifier.IsEntryBad(*Manifest, *Entry))
+				{
+					LEASI_WARN(L"UTexture2D::Serialize: skipping corrupted override for {} in '{}'", *TextureFullName, Manifest->GetDlcName());
+					continue;
+				}
 				LEASI_INFO(L"UTexture2D::Serialize: replacing {}", *TextureFullName);
 				UpdateTextureFromManifest(Context, *Manifest, *Entry);
 				return;  // apply only the highest-priority manifest mount
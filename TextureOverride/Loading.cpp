@@ -1,10 +1,16 @@
 #include <filesystem>
 #include <array>
+#include <vector>
 
+#include "TextureOverride/Budget.hpp"
+#include "TextureOverride/Cache.hpp"
 #include "TextureOverride/Loading.hpp"
 #include "TextureOverride/Manifest.hpp"
 #include "TextureOverride/Mount.hpp"
 #include "TextureOverride/Hooks.hpp"
+#include "TextureOverride/Payload.hpp"
+#include "TextureOverride/Transcode.hpp"
+#include "TextureOverride/Verify.hpp"
 #include <stack>
 
 namespace fs = std::filesystem;
@@ -16,6 +22,7 @@ namespace TextureOverride
     std::vector<ManifestLoaderPointer> g_loadedManifests{};
 	int g_remainingAllowedStalls{ 25 }; // 5 seconds maximum stall time at 200ms per delay
 	bool g_manifestsFinishedLoading{ false }; // Used to stall for texture loading
+    bool g_manifestsPendingReload{ false };
 
     int32_t g_statTextureSerializeCount{ 0 };
     float g_statTextureSerializeSeconds{ 0.f };
@@ -73,10 +80,64 @@ namespace TextureOverride
 
         // Sort manifests into descending mount priority order.
         std::sort(g_loadedManifests.begin(), g_loadedManifests.end(), ManifestLoader::CompareReverse);
+
+        // Records of manifests which are no longer installed are dropped when opening.
+        if (g_payloadCacheCapacity != 0 && !g_payloadCache.Open(k_payloadCachePath, g_payloadCacheCapacity, g_loadedManifests))
+            LEASI_WARN(L"payload cache disabled for this session");
+
+        // Verification state must be in place before texture loads go ahead and look entries up.
+        g_payloadVerifier.Start(g_loadedManifests);
+
         g_manifestsFinishedLoading = true;
         LEASI_INFO(L"manifests loaded");
     }
 
+    std::size_t UnloadDlcManifests(std::wstring_view const DlcName)
+    {
+        std::size_t ReclaimedBytes = 0;
+        g_payloadVerifier.Stop();
+
+        for (ManifestLoaderPointer const& Manifest : g_loadedManifests)
+        {
+            if (!Manifest->IsLoaded() || (!DlcName.empty() && Manifest->GetDlcName() != DlcName))
+                continue;
+
+            // Installed mips own copies of their payloads, only pooled buffers still point into the view.
+            g_payloadPool.ForgetSources(Manifest->GetMappedView());
+
+            std::size_t const ManifestBytes = Manifest->Unload();
+            LEASI_INFO(L"unloaded manifest for '{}', {} byte(s) reclaimed", Manifest->GetDlcName(), ManifestBytes);
+            ReclaimedBytes += ManifestBytes;
+        }
+
+        g_payloadVerifier.Start(g_loadedManifests);
+        return ReclaimedBytes;
+    }
+
+    void ReloadDlcManifests()
+    {
+        FString LoadError{};
+        g_payloadVerifier.Stop();
+
+        for (ManifestLoaderPointer const& Manifest : g_loadedManifests)
+        {
+            if (Manifest->IsLoaded())
+                continue;
+
+            LoadError.Clear();
+            if (!Manifest->Reload(LoadError))
+            {
+                LEASI_ERROR(L"failed to reload manifest for '{}'", Manifest->GetDlcName());
+                LEASI_ERROR(L"error: {}", *LoadError);
+                continue;
+            }
+
+            LEASI_INFO(L"reloaded manifest for '{}'", Manifest->GetDlcName());
+        }
+
+        g_payloadVerifier.Start(g_loadedManifests);
+    }
+
     FString const& GetTextureFullName(UTexture2D* const InObject)
     {
         static FString OutString{};
@@ -110,6 +171,27 @@ namespace TextureOverride
         return OutString;
     }
 
+    namespace
+    {
+        /** Frees an indirect mip record, along with its data unless it is pooled or owned by the engine. */
+        void FreeMip(CMipMapInfo* const Mip)
+        {
+            if (g_payloadPool.IsOwner(Mip))
+            {
+                // Shared buffers are only freed by the pool once their last owner is gone.
+                g_payloadPool.ReleaseOwner(Mip);
+                Mip->Data = nullptr;
+            }
+            else if (Mip->bNeedsFree)
+            {
+                (*GMalloc)->Free(Mip->Data);
+                Mip->Data = nullptr;
+            }
+
+            (*GMalloc)->Free(Mip);
+        }
+    }
+
     void UpdateTextureFromManifest(UTexture2D* const InTexture,
         ManifestLoader const& Manifest, CTextureEntry const& Entry)
     {
@@ -128,120 +210,173 @@ namespace TextureOverride
             //LEASI_WARN("UpdateTextureFromManifest: updating with different mip count, not well-tested");
         }
 
-        // Assuming the first mip is the largest so we can use its size.
-        auto const& [FirstEntry, FirstContents] = Manifest.GetEntryMip(Entry, 0);
+        // Under memory pressure the largest mips are left out entirely.
+        int const TrimCount = g_mipBudget.GetTrimCount(Manifest, Entry, InTexture);
 
-        InTexture->TextureFileCacheGuid = InTexture->TFCFileGuid = Manifest.GetTfcGuid(&Entry);
-        InTexture->TextureFileCacheName = SFXName(*Manifest.GetTfcName(&Entry), 0);
-        InTexture->OriginalSizeX = InTexture->SizeX = FirstEntry.Width;
-        InTexture->OriginalSizeY = InTexture->SizeY = FirstEntry.Height;
-        InTexture->Format = (unsigned char)Entry.Format;
+        // Assuming the first mip is the largest so we can use its size.
+        auto const& [FirstEntry, FirstContents] = Manifest.GetEntryMip(Entry, TrimCount);
 
+        auto& OldMips = *(TArray<CMipMapInfo*>*) &InTexture->Mips;
         void* PreservedVftable = nullptr;
 
-        // Deallocate the existing indirect mip array.
+        for (CMipMapInfo* Mip : OldMips)
         {
-            auto& Mips = *(TArray<CMipMapInfo*>*) &InTexture->Mips;
-            for (CMipMapInfo* Mip : Mips)
+            if (PreservedVftable == nullptr)
             {
-                if (PreservedVftable == nullptr)
+                // The first vftable encountered is likely correct.
+                PreservedVftable = Mip->Vftable;
+            }
+            else if (PreservedVftable != Mip->Vftable)
+            {
+                LEASI_WARN("UpdateTextureFromManifest: different vftables encountered: {} != {}",
+                    (void*)PreservedVftable, (void*)Mip->Vftable);
+            }
+        }
+
+        // Build the new mips before touching the texture, so that a payload which fails to materialize
+        // leaves the original mips in place instead of a mip without data.
+        std::vector<CMipMapInfo*> NewMips{};
+        std::uint64_t InstalledBytes = 0, TrimmedBytes = 0;
+        bool bMaterialized = true;
+
+        bool const bTranscode = g_mipTranscoder.IsEnabled() && g_mipTranscoder.ShouldTranscode(Entry, FirstEntry);
+
+        for (int i = 0; i < TrimCount; ++i)
+            TrimmedBytes += static_cast<std::uint64_t>(Manifest.GetEntryMip(Entry, i).Entry.UncompressedSize);
+
+        for (int i = TrimCount; i < Entry.MipCount && bMaterialized; ++i)
+        {
+            auto const [MipEntry, MipContents] = Manifest.GetEntryMip(Entry, i);
+            InstalledBytes += static_cast<std::uint64_t>(MipEntry.UncompressedSize);
+
+            auto const NextMip = new CMipMapInfo();
+            std::memset(NextMip, 0, sizeof *NextMip);
+            NewMips.push_back(NextMip);
+
+            NextMip->Vftable = PreservedVftable;
+            NextMip->Flags = ETF_SingleUse; //GUseSeekFreeLoading
+            if (MipEntry.IsExternal())
+            {
+                auto const ExternalFlags = ETF_External | ETF_OodleCompression;
+                NextMip->Flags = static_cast<ETextureFlags>(NextMip->Flags | ExternalFlags);
+            }
+            NextMip->Elements = MipEntry.UncompressedSize;
+            NextMip->CompressedSize = MipEntry.CompressedSize;
+
+            if (MipEntry.ShouldHavePayload())
+            {
+                LEASI_CHECKW(!MipContents.empty(), L"empty mip payload", L"");
+
+                // Either way, the mip is now stored uncompressed.
+                NextMip->CompressedOffset = 0;
+                NextMip->CompressedSize = NextMip->Elements;
+
+                if (g_payloadPool.IsEnabled())
                 {
-                    // The first vftable encountered is likely correct.
-                    PreservedVftable = Mip->Vftable;
+                    // Pooled buffers must never be handed over to (and freed by) the engine.
+                    NextMip->Flags = static_cast<ETextureFlags>(NextMip->Flags & ~ETF_SingleUse);
+                    NextMip->Data = g_payloadPool.Acquire(Manifest, Entry, static_cast<std::size_t>(i), InTexture, NextMip, bTranscode);
+                    NextMip->bNeedsFree = FALSE;
                 }
-                else if (PreservedVftable != Mip->Vftable)
+                else
                 {
-                    LEASI_WARN("UpdateTextureFromManifest: different vftables encountered: {} != {}",
-                        (void*)PreservedVftable, (void*)Mip->Vftable);
-                }
+                    NextMip->Data = (*GMalloc)->Malloc(DWORD(MipEntry.UncompressedSize), UN_DEFAULT_ALIGNMENT);
+                    NextMip->bNeedsFree = TRUE;
 
+                    if (!MaterializeMipPayload(Manifest, Entry, static_cast<std::size_t>(i), NextMip->Data))
+                    {
+                        (*GMalloc)->Free(std::exchange(NextMip->Data, nullptr));
+                        NextMip->bNeedsFree = FALSE;
+                    }
+                }
 
-                if (Mip->bNeedsFree)
+                if (NextMip->Data == nullptr)
                 {
-                    (*GMalloc)->Free(Mip->Data);
-                    Mip->Data = nullptr;
+                    LEASI_ERROR(L"error materializing mip {}x{} payload for '{}', keeping original mips",
+                        MipEntry.Width, MipEntry.Height, *Entry.GetFullPath());
+                    bMaterialized = false;
                 }
-
-                (*GMalloc)->Free(Mip);
+            }
+            else
+            {
+                LEASI_VERIFYW(MipEntry.CompressedOffset < INT32_MAX, L"invalid offset {} for tfc mip", MipEntry.CompressedOffset);
+                NextMip->CompressedOffset = static_cast<int32_t>(MipEntry.CompressedOffset);
+                NextMip->Data = nullptr;
+                NextMip->bNeedsFree = FALSE;
             }
 
-            Mips.Clear();
-            Mips.Shrink();
+            NextMip->Archive = nullptr;
+            NextMip->Width = MipEntry.Width;
+            NextMip->Height = MipEntry.Height;
         }
 
-        // Allocate a new indirect mip array.
+        // Transcoded before touching the texture too, as pooled mips may have been given a shared transcoded
+        // form right away, which has to be undone if the texture is left as it is.
+        std::uint64_t SavedBytes = 0;
+        if (bMaterialized && bTranscode)
         {
-            auto& Mips = *new ((void*)&InTexture->Mips) TArray<CMipMapInfo*>();
-            for (int i = 0; i < Entry.MipCount; ++i)
-            {
-                auto const [MipEntry, MipContents] = Manifest.GetEntryMip(Entry, i);
+            SavedBytes = g_mipTranscoder.Transcode(Entry.Format, NewMips);
 
-                auto const NextMip = new CMipMapInfo();
-                std::memset(NextMip, 0, sizeof *NextMip);
+            for (std::size_t k = 0; k < NewMips.size() && SavedBytes == 0 && bMaterialized; ++k)
+            {
+                CMipMapInfo* const Mip = NewMips[k];
+                if (!g_payloadPool.IsTranscoded(Mip))
+                    continue;
 
-                NextMip->Vftable = PreservedVftable;
-                NextMip->Flags = ETF_SingleUse; //GUseSeekFreeLoading
-                if (MipEntry.IsExternal())
+                Mip->Data = g_payloadPool.RestoreDecompressed(Manifest, Entry, static_cast<std::size_t>(TrimCount) + k, Mip);
+                if (Mip->Data == nullptr)
                 {
-                    auto const ExternalFlags = ETF_External | ETF_OodleCompression;
-                    NextMip->Flags = static_cast<ETextureFlags>(NextMip->Flags | ExternalFlags);
+                    LEASI_ERROR(L"error materializing mip {}x{} payload for '{}', keeping original mips",
+                        Mip->Width, Mip->Height, *Entry.GetFullPath());
+                    bMaterialized = false;
                 }
-                NextMip->Elements = MipEntry.UncompressedSize;
-                NextMip->CompressedSize = MipEntry.CompressedSize;
+            }
+        }
 
-                if (MipEntry.ShouldHavePayload())
-                {
-                    LEASI_CHECKW(!MipContents.empty(), L"empty mip payload", L"");
+        if (!bMaterialized)
+        {
+            for (CMipMapInfo* const Mip : NewMips)
+                FreeMip(Mip);
+            return;
+        }
 
-                    if (MipEntry.IsOodleCompressed())
-                    {
-                        // Mip was converted to oodle compressed during serialization.
-                        // We can't seem to use oodle texture decompression, so we instead
-                        // decompress this entirely.
-                        // LEASI_TRACE(L"decompressing mip {}x{}", MipEntry.Width, MipEntry.Height);
-
-                        // Allocate decompressed space
-                        NextMip->Data = (*GMalloc)->Malloc(DWORD(MipEntry.UncompressedSize), UN_DEFAULT_ALIGNMENT);
-                        void* const Result = OodleDecompress(0x400, NextMip->Data, MipEntry.UncompressedSize, (void*) MipContents.data(), MipEntry.CompressedSize);
-                        if (Result == 0)
-                        {
-                            LEASI_ERROR(L"error decompressing oodle data for '{}'", *Entry.GetFullPath());
-                        }
-                        NextMip->CompressedOffset = 0;
-                        NextMip->CompressedSize = NextMip->Elements; // Mip is now decompressed
-                        NextMip->bNeedsFree = TRUE;
-
-                        // Verify
-                        /*auto data = (int*)NextMip->Data;
-                        auto textureTag = data[0];
-                        if (textureTag != 0x9E2A83C1) // not sure what tag is... this doesn't seem right
-                        {
-                            LEASI_WARN(L"Decompressed mip has wrong texture tag");
-                        }*/
-                    }
-                    else
-                    {
+        InTexture->TextureFileCacheGuid = InTexture->TFCFileGuid = Manifest.GetTfcGuid(&Entry);
+        InTexture->TextureFileCacheName = SFXName(*Manifest.GetTfcName(&Entry), 0);
+        InTexture->OriginalSizeX = InTexture->SizeX = FirstEntry.Width;
+        InTexture->OriginalSizeY = InTexture->SizeY = FirstEntry.Height;
+        InTexture->Format = (unsigned char)Entry.Format;
 
-                        NextMip->CompressedOffset = 0;
-                        NextMip->Data = (*GMalloc)->Malloc(DWORD(MipEntry.CompressedSize), UN_DEFAULT_ALIGNMENT);
-                        std::copy_n(MipContents.data(), MipEntry.CompressedSize, (BYTE*)NextMip->Data);
-                        //NextMip->Data = (void*)MipContents.data();
-                        NextMip->bNeedsFree = TRUE;
-                    }
-                }
-                else
-                {
-                    LEASI_VERIFYW(MipEntry.CompressedOffset < INT32_MAX, L"invalid offset {} for tfc mip", MipEntry.CompressedOffset);
-                    NextMip->CompressedOffset = static_cast<int32_t>(MipEntry.CompressedOffset);
-                    NextMip->Data = nullptr;
-                    NextMip->bNeedsFree = FALSE;
-                }
+        // Deallocate the existing indirect mip array.
+        {
+            for (CMipMapInfo* Mip : OldMips)
+                FreeMip(Mip);
 
-                NextMip->Archive = nullptr;
-                NextMip->Width = MipEntry.Width;
-                NextMip->Height = MipEntry.Height;
+            OldMips.Clear();
+            OldMips.Shrink();
+        }
+
+        // Install the new indirect mip array.
+        {
+            auto& Mips = *new ((void*)&InTexture->Mips) TArray<CMipMapInfo*>();
+            for (CMipMapInfo* const Mip : NewMips)
+                Mips.Add(Mip);
 
-                Mips.Add(NextMip);
+            // Format must follow the mips, which are either all transcoded or left as they are.
+            if (SavedBytes > 0)
+            {
+                InstalledBytes -= SavedBytes;
+                InTexture->Format = (unsigned char)PF_DXT1;
+            }
+
+            if (g_mipBudget.IsEnabled())
+            {
+                g_mipBudget.Track(InTexture, InstalledBytes, TrimmedBytes);
+
+                if (TrimCount > 0)
+                {
+                    LEASI_DEBUG(L"UpdateTextureFromManifest: trimmed {} top mip(s) of '{}', saving {} byte(s)",
+                        TrimCount, *Entry.GetFullPath(), TrimmedBytes);
+                }
             }
         }
 
@@ -250,7 +385,8 @@ namespace TextureOverride
 
         // Update InternalFormatLODBias to allow higher than LOD level mips to show without
         // package edits.
-        InTexture->InternalFormatLODBias = Entry.InternalFormatLODBias;
+        // Trimmed mips no longer need to be skipped by the bias.
+        InTexture->InternalFormatLODBias = std::max(Entry.InternalFormatLODBias - TrimCount, 0);
 
         // Update NeverStream based on incoming texture entry.
         // Validation of this will come from our editor tools, don't make it our
@@ -262,6 +398,50 @@ namespace TextureOverride
         InTexture->MipTailBaseIdx = InTexture->Mips.ArrayNum - 1;
     }
 
+    bool MaterializeMipPayload(ManifestLoader const& Manifest, CTextureEntry const& Entry, std::size_t const MipIndex, void* const Destination)
+    {
+        auto const [Mip, Source] = Manifest.GetEntryMip(Entry, MipIndex);
+
+        LEASI_CHECKA(Mip.ShouldHavePayload(), "mip has no embedded payload", "");
+        LEASI_CHECKA(Destination != nullptr, "", "");
+
+        if (Mip.IsOodleCompressed())
+        {
+            auto const Size = static_cast<std::size_t>(Mip.UncompressedSize);
+            auto const EntryIndex = Manifest.GetEntryIndex(Entry);
+
+            // Previously decompressed payloads can be copied straight out of the cache file.
+            if (g_payloadCache.Lookup(Manifest, EntryIndex, static_cast<std::uint32_t>(MipIndex), Destination, Size))
+                return true;
+
+            // Mip was converted to oodle compressed during serialization.
+            // We can't seem to use oodle texture decompression, so we instead
+            // decompress this entirely.
+            // LEASI_TRACE(L"decompressing mip {}x{}", Mip.Width, Mip.Height);
+            void* const Result = OodleDecompress(0x400, Destination, Mip.UncompressedSize, (void*)Source.data(), Mip.CompressedSize);
+            if (Result == 0)
+                return false;
+
+            g_payloadCache.Store(Manifest, EntryIndex, static_cast<std::uint32_t>(MipIndex), Destination, Size);
+            return true;
+
+            // Verify
+            /*auto data = (int*)Destination;
+            auto textureTag = data[0];
+            if (textureTag != 0x9E2A83C1) // not sure what tag is... this doesn't seem right
+            {
+                LEASI_WARN(L"Decompressed mip has wrong texture tag");
+            }*/
+        }
+
+        if (Source.size() < static_cast<std::size_t>(Mip.CompressedSize))
+            return false;
+
+        // Stored uncompressed, so both sizes are expected to match.
+        std::copy_n(Source.data(), std::min(Mip.CompressedSize, Mip.UncompressedSize), static_cast<BYTE*>(Destination));
+        return true;
+    }
+
     // ! ScopedTimer implementation.
     // ========================================
 
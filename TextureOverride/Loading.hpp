@@ -69,6 +69,8 @@ namespace TextureOverride
     extern std::vector<ManifestLoaderPointer> g_loadedManifests;
 
     extern bool g_manifestsFinishedLoading;
+    // Set when unloaded manifests should be loaded again by the next UTexture2D::Serialize call.
+    extern bool g_manifestsPendingReload;
     extern int g_remainingAllowedStalls;
 
     extern int32_t g_statTextureSerializeCount;
@@ -78,9 +80,29 @@ namespace TextureOverride
 
     void LoadDlcManifests();
 
+    /**
+     * @brief       Unmaps manifests and releases their indexes, keeping them registered for reloading.
+     * @param[in]   DlcName - name of the DLC folder whose manifest to unload, or empty to unload all.
+     * @return      Approximate number of bytes reclaimed.
+     */
+    std::size_t UnloadDlcManifests(std::wstring_view DlcName);
+    /** Loads all previously unloaded manifests again. */
+    void ReloadDlcManifests();
+
     FString const& GetTextureFullName(UTexture2D* InObject);
     void UpdateTextureFromManifest(UTexture2D* InTexture, ManifestLoader const& Manifest, CTextureEntry const& Entry);
 
+    /**
+     * @brief       Writes the uncompressed contents of an embedded mip payload.
+     * @remarks     Oodle payloads are served from and stored to @ref g_payloadCache when it is open.
+     * @param[in]   Manifest - manifest containing the entry.
+     * @param[in]   Entry - texture entry, whose mip must satisfy @ref CMipEntry::ShouldHavePayload .
+     * @param[in]   MipIndex - index of the mip within the entry.
+     * @param[out]  Destination - buffer of at least @c UncompressedSize bytes.
+     * @return      Whether the payload could be decompressed or copied.
+     */
+    bool MaterializeMipPayload(ManifestLoader const& Manifest, CTextureEntry const& Entry, std::size_t MipIndex, void* Destination);
+
 
     // ! Loading utilities.
     // ========================================
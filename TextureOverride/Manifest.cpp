@@ -100,8 +100,17 @@ namespace TextureOverride
 
     ManifestLoader::~ManifestLoader()
     {
+        Unload();
+    }
+
+    std::size_t ManifestLoader::Unload()
+    {
+        std::size_t ReclaimedBytes = 0;
+
         if (FileHandle != INVALID_HANDLE_VALUE || MappingHandle || View)
         {
+            ReclaimedBytes += CachedSize;
+
             if (0 == UnmapViewOfFile(View))
             {
                 auto const Error = FString::Printf(L"failed to unmap manifest view, error = %d", ::GetLastError());
@@ -126,7 +135,25 @@ namespace TextureOverride
             View = NULL;
             MappingHandle = NULL;
             FileHandle = INVALID_HANDLE_VALUE;
+            CachedSize = 0;
         }
+
+        // Approximate heap usage of the index: buckets, nodes and key strings.
+        ReclaimedBytes += TextureMap.bucket_count() * sizeof(void*);
+        for (auto const& [Key, _] : TextureMap)
+            ReclaimedBytes += sizeof(TextureMap_t::value_type) + 2 * sizeof(void*) + (Key.Length() + 1) * sizeof(wchar_t);
+
+        TextureMap_t{}.swap(TextureMap);
+        TfcRefTable = {};
+
+        return ReclaimedBytes;
+    }
+
+    bool ManifestLoader::Reload(FString& OutError)
+    {
+        LEASI_CHECKA(!IsLoaded(), "manifest already loaded", "");
+        std::wstring const InPath{ Path }, InDlcName{ DlcName };
+        return Load(InPath, InDlcName, OutError);
     }
 
     bool ManifestLoader::Load
@@ -183,6 +210,17 @@ namespace TextureOverride
             return false;
         }
 
+        FILETIME OutWriteTime{};
+        if (0 == GetFileTime(FileHandle, NULL, NULL, &OutWriteTime))
+        {
+            CLOSE_ERROR(L"failed to cache manifest file write time");
+            return false;
+        }
+
+        LastWriteTime = (std::uint64_t(OutWriteTime.dwHighDateTime) << 32) | OutWriteTime.dwLowDateTime;
+        Path = InPath;
+        DlcName = InDlcName;
+
         auto const Header = (CManifestHeader const*)View;
         if (0 != std::memcmp(Header->Magic, CManifestHeader::k_checkMagic, sizeof(CManifestHeader::k_checkMagic))
             || Header->Version > CManifestHeader::k_lastVersion)
@@ -327,6 +365,36 @@ namespace TextureOverride
         return std::span<unsigned char const>(ViewPointer, CachedSize);
     }
 
+    bool ManifestLoader::IsEntryInBounds(CTextureEntry const& InEntry) const noexcept
+    {
+        if (!ValidateEntry(InEntry) || InEntry.MipCount < 0
+            || static_cast<std::size_t>(InEntry.MipCount) > CTextureEntry::k_maxMipCount)
+            return false;
+
+        for (int i = 0; i < InEntry.MipCount; ++i)
+        {
+            CMipEntry const& Mip = InEntry.Mips[i];
+            if (!Mip.ShouldHavePayload())
+                continue;
+
+            if (Mip.CompressedSize <= 0 || Mip.UncompressedSize <= 0 || Mip.CompressedOffset < 0
+                || static_cast<std::uint64_t>(Mip.CompressedOffset) + static_cast<std::uint64_t>(Mip.CompressedSize) > CachedSize)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    std::uint32_t ManifestLoader::GetEntryIndex(CTextureEntry const& InEntry) const
+    {
+        LEASI_CHECKA(ValidateEntry(InEntry), "mismatched entry provenance", "");
+
+        auto const* const TextureEntryStart = (CTextureEntry const*)((unsigned char const*)View + sizeof(CManifestHeader));
+        return static_cast<std::uint32_t>(&InEntry - TextureEntryStart);
+    }
+
     FGuid ManifestLoader::GetTfcGuid(CTextureEntry const* const Entry) const
     {
         LEASI_CHECKA(Entry != nullptr, "", "");
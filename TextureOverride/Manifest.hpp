@@ -197,6 +197,9 @@ namespace TextureOverride
         TextureMap_t    TextureMap{};
         TfcRefTable_t   TfcRefTable{};
         int             MountPriority{ 0 };
+        std::wstring    Path{};
+        std::wstring    DlcName{};
+        std::uint64_t   LastWriteTime{ 0 };
 
     public:
 
@@ -214,6 +217,19 @@ namespace TextureOverride
          */
         bool Load(std::wstring_view InPath, std::wstring_view InDlcName, FString& OutError);
 
+        /**
+         * @brief       Releases the mapped view and the texture index, keeping what's needed to @ref Reload .
+         * @return      Approximate number of bytes of address space and heap reclaimed.
+         * @warning     No pointers into the mapped view may be used after this call.
+         */
+        std::size_t Unload();
+
+        /** Loads this manifest again from the path and DLC it was last loaded from. */
+        bool Reload(FString& OutError);
+
+        /** Checks whether the manifest view is mapped and can be queried. */
+        inline bool IsLoaded() const noexcept { return View != NULL; }
+
 #pragma pack(push, 8)
         struct ResolvedMip final
         {
@@ -248,11 +264,22 @@ namespace TextureOverride
         /** Retrieves the mapped memory view. */
         std::span<unsigned char const> GetMappedView() const;
 
+        /** Checks that every embedded payload of an entry lies within the mapped view. */
+        bool IsEntryInBounds(CTextureEntry const& InEntry) const noexcept;
+
+        /** Retrieves the position of an entry within the manifest's entry table. */
+        std::uint32_t GetEntryIndex(CTextureEntry const& InEntry) const;
+
         /** Retrieves an entry's texture file cache GUID. */
         FGuid GetTfcGuid(CTextureEntry const* Entry) const;
         /** Retrieves an entry's texture file cache name as an Unreal string. */
         FString GetTfcName(CTextureEntry const* Entry) const;
 
+        /** Retrieves the name of the DLC folder this manifest was loaded from. */
+        inline std::wstring_view GetDlcName() const { return DlcName; }
+        /** Retrieves the manifest file's last write time, as a Win32 @c FILETIME value. */
+        inline std::uint64_t GetLastWriteTime() const { return LastWriteTime; }
+
         inline int GetMountPriority() const { return MountPriority; }
         inline void SetMountPriority(int const InMountPriority) { MountPriority = InMountPriority; }
 
@@ -0,0 +1,370 @@
+#include <bit>
+#include <cstring>
+#include <utility>
+#include "Common/Objects.hpp"
+#include "TextureOverride/Payload.hpp"
+
+namespace TextureOverride
+{
+    PayloadPool g_payloadPool{};
+
+
+    // ! Utilities.
+    // ========================================
+
+    std::uint64_t HashPayload(std::span<unsigned char const> const Payload) noexcept
+    {
+        static constexpr std::uint64_t k_prime0 = 0x9E3779B185EBCA87ull;
+        static constexpr std::uint64_t k_prime1 = 0xC2B2AE3D27D4EB4Full;
+
+        std::uint64_t Value = k_prime0 ^ (Payload.size() * k_prime1);
+        std::size_t const WordCount = Payload.size() / sizeof(std::uint64_t);
+
+        for (std::size_t i = 0; i < WordCount; ++i)
+        {
+            std::uint64_t Word;
+            std::memcpy(&Word, Payload.data() + i * sizeof Word, sizeof Word);
+            Value = std::rotl(Value ^ (Word * k_prime1), 31) * k_prime0;
+        }
+
+        for (std::size_t i = WordCount * sizeof(std::uint64_t); i < Payload.size(); ++i)
+        {
+            Value = std::rotl(Value ^ (Payload[i] * k_prime0), 11) * k_prime1;
+        }
+
+        // Final avalanche, same as MurmurHash3's fmix64.
+        Value ^= Value >> 33;
+        Value *= 0xFF51AFD7ED558CCDull;
+        Value ^= Value >> 33;
+        Value *= 0xC4CEB9FE1A85EC53ull;
+        Value ^= Value >> 33;
+        return Value;
+    }
+
+
+    // ! PayloadPool implementation.
+    // ========================================
+
+    void* PayloadPool::Acquire(ManifestLoader const& Manifest, CTextureEntry const& Entry, std::size_t const MipIndex,
+        UTexture2D* const Owner, CMipMapInfo* const OwnerMip, bool const bAcceptTranscoded)
+    {
+        auto const [Mip, Source] = Manifest.GetEntryMip(Entry, MipIndex);
+
+        LEASI_CHECKA(Owner != nullptr && OwnerMip != nullptr, "", "");
+        LEASI_CHECKA(!Source.empty(), "empty mip payload", "");
+
+        PayloadKey const Key{ HashPayload(Source), Mip.CompressedSize, Mip.UncompressedSize, Mip.IsOodleCompressed() };
+        void* Data = nullptr;
+
+        auto const [RangeBegin, RangeEnd] = Buffers.equal_range(Key);
+        for (auto Iter = RangeBegin; Iter != RangeEnd; ++Iter)
+        {
+            Buffer& Candidate = Iter->second;
+
+            // Hash matches are confirmed against the bytes the buffer was materialized from.
+            if (Candidate.Source.size() != Source.size()
+                || 0 != std::memcmp(Candidate.Source.data(), Source.data(), Source.size()))
+            {
+                continue;
+            }
+
+            if (Candidate.Data == nullptr && bAcceptTranscoded)
+            {
+                // Only the transcoded form is still in use, which is what the mip is about to become anyway.
+                Counters.TotalHits++;
+                Counters.DeduplicatedBytes += static_cast<std::uint64_t>(Candidate.Transcoded.Size);
+
+                Candidate.TranscodedRefCount++;
+                Data = Candidate.Transcoded.Data;
+                break;
+            }
+
+            if (Candidate.Data == nullptr)
+            {
+                // Only the transcoded form was still in use, the decompressed one is needed again.
+                if (!Materialize(Candidate, Manifest, Entry, MipIndex))
+                    return nullptr;
+            }
+            else
+            {
+                Counters.TotalHits++;
+                Counters.DeduplicatedBytes += static_cast<std::uint64_t>(Mip.UncompressedSize);
+            }
+
+            Candidate.RefCount++;
+            Data = Candidate.Data;
+            break;
+        }
+
+        if (Data == nullptr)
+        {
+            Data = (*GMalloc)->Malloc(DWORD(Mip.UncompressedSize), UN_DEFAULT_ALIGNMENT);
+            if (!MaterializeMipPayload(Manifest, Entry, MipIndex, Data))
+            {
+                (*GMalloc)->Free(Data);
+                return nullptr;
+            }
+
+            Buffers.emplace(Key, Buffer{ Data, Source, 1u, TranscodedPayload{}, 0u });
+
+            Counters.UniqueCount++;
+            Counters.UniqueBytes += static_cast<std::uint64_t>(Mip.UncompressedSize);
+        }
+
+        // The engine may have destroyed a tracked mip and handed its memory back to us.
+        if (auto const Stale = Owners.find(OwnerMip); Stale != Owners.end())
+        {
+            OwnerRecord const StaleRecord = Stale->second;
+            Owners.erase(Stale);
+            Release(StaleRecord.Key, StaleRecord.Data);
+        }
+
+        Owners.emplace(OwnerMip, OwnerRecord{ Owner, Common::GetObjectIndex(Owner), Data, Key });
+        Counters.OwnerCount = Owners.size();
+        return Data;
+    }
+
+    void PayloadPool::ReleaseOwner(CMipMapInfo const* const OwnerMip)
+    {
+        auto const Iter = Owners.find(OwnerMip);
+        if (Iter == Owners.end())
+            return;
+
+        OwnerRecord const Record = Iter->second;
+        Owners.erase(Iter);
+        Counters.OwnerCount = Owners.size();
+
+        Release(Record.Key, Record.Data);
+    }
+
+    bool PayloadPool::IsOwner(CMipMapInfo const* const OwnerMip) const
+    {
+        return Owners.contains(OwnerMip);
+    }
+
+    bool PayloadPool::IsTranscoded(CMipMapInfo const* const OwnerMip) const
+    {
+        auto const Owner = Owners.find(OwnerMip);
+        if (Owner == Owners.end())
+            return false;
+
+        OwnerRecord const& Record = Owner->second;
+        auto const [RangeBegin, RangeEnd] = Buffers.equal_range(Record.Key);
+        for (auto Iter = RangeBegin; Iter != RangeEnd; ++Iter)
+        {
+            if (Iter->second.Transcoded.Data == Record.Data)
+                return true;
+        }
+
+        return false;
+    }
+
+    bool PayloadPool::FindTranscoded(CMipMapInfo const* const OwnerMip, TranscodedPayload& OutTranscoded) const
+    {
+        auto const Owner = Owners.find(OwnerMip);
+        if (Owner == Owners.end())
+            return false;
+
+        OwnerRecord const& Record = Owner->second;
+        auto const [RangeBegin, RangeEnd] = Buffers.equal_range(Record.Key);
+        for (auto Iter = RangeBegin; Iter != RangeEnd; ++Iter)
+        {
+            Buffer const& Pooled = Iter->second;
+            if (Pooled.Data != Record.Data && Pooled.Transcoded.Data != Record.Data)
+                continue;
+
+            OutTranscoded = Pooled.Transcoded;
+            return Pooled.Transcoded.Data != nullptr;
+        }
+
+        return false;
+    }
+
+    void* PayloadPool::UseTranscoded(CMipMapInfo const* const OwnerMip, TranscodedPayload const& Transcoded)
+    {
+        auto const Owner = Owners.find(OwnerMip);
+        LEASI_CHECKA(Owner != Owners.end(), "mip does not reference a pooled buffer", "");
+
+        OwnerRecord& Record = Owner->second;
+        auto const Iter = FindBuffer(Record.Key, Record.Data);
+        LEASI_CHECKA(Iter != Buffers.end(), "pooled payload not found", "");
+
+        Buffer& Pooled = Iter->second;
+        if (Record.Data == Pooled.Transcoded.Data)
+            return Record.Data;
+
+        auto const Size = static_cast<std::uint64_t>(Transcoded.Size);
+        if (Pooled.Transcoded.Data == nullptr)
+        {
+            Pooled.Transcoded = Transcoded;
+            Counters.UniqueBytes += Size;
+        }
+        else
+        {
+            LEASI_CHECKA(Pooled.Transcoded.Data == Transcoded.Data, "payload transcoded twice", "");
+            Counters.TotalHits++;
+            Counters.DeduplicatedBytes += Size;
+        }
+
+        // Buffers are only erased once both forms are gone, so the transcoded form outlives this release.
+        Pooled.TranscodedRefCount++;
+        void* const Decompressed = std::exchange(Record.Data, Pooled.Transcoded.Data);
+        Release(Record.Key, Decompressed);
+        return Record.Data;
+    }
+
+    void* PayloadPool::RestoreDecompressed(ManifestLoader const& Manifest, CTextureEntry const& Entry, std::size_t const MipIndex,
+        CMipMapInfo const* const OwnerMip)
+    {
+        auto const Owner = Owners.find(OwnerMip);
+        LEASI_CHECKA(Owner != Owners.end(), "mip does not reference a pooled buffer", "");
+
+        OwnerRecord& Record = Owner->second;
+        auto const Iter = FindBuffer(Record.Key, Record.Data);
+        LEASI_CHECKA(Iter != Buffers.end(), "pooled payload not found", "");
+
+        Buffer& Pooled = Iter->second;
+        if (Record.Data == Pooled.Data)
+            return Record.Data;
+
+        if (Pooled.Data == nullptr)
+        {
+            if (!Materialize(Pooled, Manifest, Entry, MipIndex))
+                return nullptr;
+        }
+        else
+        {
+            Counters.TotalHits++;
+            Counters.DeduplicatedBytes += static_cast<std::uint64_t>(Record.Key.UncompressedSize);
+        }
+
+        // Buffers are only erased once both forms are gone, so the decompressed form outlives this release.
+        Pooled.RefCount++;
+        void* const Transcoded = std::exchange(Record.Data, Pooled.Data);
+        Release(Record.Key, Transcoded);
+        return Record.Data;
+    }
+
+    void PayloadPool::Collect()
+    {
+        std::size_t ReleasedCount = 0;
+
+        for (auto Iter = Owners.begin(); Iter != Owners.end();)
+        {
+            if (!IsOwnerStale(Iter->first, Iter->second))
+            {
+                ++Iter;
+                continue;
+            }
+
+            OwnerRecord const Record = Iter->second;
+            Iter = Owners.erase(Iter);
+            Release(Record.Key, Record.Data);
+            ReleasedCount++;
+        }
+
+        Counters.OwnerCount = Owners.size();
+
+        if (ReleasedCount > 0)
+        {
+            LEASI_DEBUG(L"payload pool: released {} stale owner(s), {} buffer(s) remain",
+                ReleasedCount, Counters.UniqueCount);
+        }
+    }
+
+    void PayloadPool::ForgetSources(std::span<unsigned char const> const View)
+    {
+        for (auto& [_, Pooled] : Buffers)
+        {
+            // Buffers themselves stay alive until their owners are released, they just can't be shared anymore.
+            if (!Pooled.Source.empty() && Pooled.Source.data() >= View.data() && Pooled.Source.data() < View.data() + View.size())
+                Pooled.Source = {};
+        }
+    }
+
+    PayloadPool::Stats PayloadPool::GetStats() const
+    {
+        return Counters;
+    }
+
+    PayloadPool::BufferMap_t::iterator PayloadPool::FindBuffer(PayloadKey const& Key, void const* const Data)
+    {
+        auto const [RangeBegin, RangeEnd] = Buffers.equal_range(Key);
+        for (auto Iter = RangeBegin; Iter != RangeEnd; ++Iter)
+        {
+            if (Iter->second.Data == Data || Iter->second.Transcoded.Data == Data)
+                return Iter;
+        }
+
+        return Buffers.end();
+    }
+
+    bool PayloadPool::Materialize(Buffer& Pooled, ManifestLoader const& Manifest, CTextureEntry const& Entry, std::size_t const MipIndex)
+    {
+        auto const Size = Manifest.GetEntryMip(Entry, MipIndex).Entry.UncompressedSize;
+
+        void* const Restored = (*GMalloc)->Malloc(DWORD(Size), UN_DEFAULT_ALIGNMENT);
+        if (!MaterializeMipPayload(Manifest, Entry, MipIndex, Restored))
+        {
+            (*GMalloc)->Free(Restored);
+            return false;
+        }
+
+        Pooled.Data = Restored;
+        Counters.UniqueBytes += static_cast<std::uint64_t>(Size);
+        return true;
+    }
+
+    void PayloadPool::Release(PayloadKey const& Key, void* const Data)
+    {
+        auto const Iter = FindBuffer(Key, Data);
+        if (Iter == Buffers.end())
+        {
+            LEASI_WARN(L"payload pool: released unknown buffer {}", Data);
+            return;
+        }
+
+        Buffer& Pooled = Iter->second;
+        bool const bTranscoded = Data == Pooled.Transcoded.Data;
+        std::uint32_t& RefCount = bTranscoded ? Pooled.TranscodedRefCount : Pooled.RefCount;
+        auto const Size = static_cast<std::uint64_t>(bTranscoded ? Pooled.Transcoded.Size : Key.UncompressedSize);
+
+        LEASI_CHECKA(RefCount > 0, "pooled payload over-released", "");
+        if (--RefCount > 0)
+        {
+            Counters.DeduplicatedBytes -= Size;
+            return;
+        }
+
+        (*GMalloc)->Free(Data);
+        if (bTranscoded)
+            Pooled.Transcoded = TranscodedPayload{};
+        else
+            Pooled.Data = nullptr;
+
+        Counters.UniqueBytes -= Size;
+        Counters.TotalFreedBytes += Size;
+
+        if (Pooled.Data == nullptr && Pooled.Transcoded.Data == nullptr)
+        {
+            Buffers.erase(Iter);
+            Counters.UniqueCount--;
+        }
+    }
+
+    bool PayloadPool::IsOwnerStale(CMipMapInfo const* const OwnerMip, OwnerRecord const& Record) const
+    {
+        // Never dereference a texture before making sure it has not been destroyed.
+        if (!Common::IsObjectAlive(Record.Texture, Record.TextureIndex))
+            return true;
+
+        auto& Mips = *(TArray<CMipMapInfo*>*) &Record.Texture->Mips;
+        for (CMipMapInfo const* const Mip : Mips)
+        {
+            if (Mip == OwnerMip)
+                return Mip->Data != Record.Data;
+        }
+
+        return true;
+    }
+}
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <LESDK/Headers.hpp>
+#include "Common/Base.hpp"
+#include "TextureOverride/Loading.hpp"
+#include "TextureOverride/Manifest.hpp"
+
+
+namespace TextureOverride
+{
+    // ! Payload deduplication.
+    // ========================================
+
+    /** Identifies embedded mip payloads by their stored (possibly compressed) contents. */
+    struct PayloadKey final
+    {
+        std::uint64_t   Hash{ 0 };
+        std::int32_t    CompressedSize{ 0 };
+        std::int32_t    UncompressedSize{ 0 };
+        bool            bOodleCompressed{ false };
+
+        inline bool operator==(PayloadKey const& Other) const noexcept
+        {
+            return Hash == Other.Hash && CompressedSize == Other.CompressedSize
+                && UncompressedSize == Other.UncompressedSize && bOodleCompressed == Other.bOodleCompressed;
+        }
+    };
+
+    struct PayloadKeyHash final
+    {
+        inline std::size_t operator()(PayloadKey const& Key) const noexcept
+        {
+            return static_cast<std::size_t>(Key.Hash);
+        }
+    };
+
+    /** Calculates a 64-bit content hash of a mip payload, in 8-byte steps. */
+    std::uint64_t HashPayload(std::span<unsigned char const> Payload) noexcept;
+
+    /**
+     * @brief   Shares one decompressed buffer between all byte-identical mip payloads.
+     * @remarks Pooled buffers are owned by the pool, not by the engine: mips pointing to them
+     *          are installed without @ref ETF_SingleUse and with @c bNeedsFree cleared,
+     *          so the engine only ever copies out of them. Every installed mip is tracked
+     *          as an owner, and a buffer is freed once its last owner is released either
+     *          explicitly (@ref ReleaseOwner) or by @ref Collect noticing that the owning
+     *          texture has been destroyed or no longer points to the buffer.
+     * @remarks A buffer can also hold the transcoded form of its payload, see @ref MipTranscoder ,
+     *          so that a payload shared by several textures is only transcoded once. The decompressed
+     *          form is freed as soon as no owner uses it anymore, and is only materialized again for
+     *          mips which are not going to be transcoded.
+     */
+    class PayloadPool final : public NonCopyable
+    {
+    public:
+
+        using Payload_t = std::span<unsigned char const>;
+
+        struct TranscodedPayload final
+        {
+            void*           Data{ nullptr };
+            std::int32_t    Size{ 0 };
+            std::uint64_t   SquaredError{ 0 };      // See @ref EncodeBlockBC1 , summed over the mip.
+        };
+
+        struct Stats final
+        {
+            std::uint64_t   UniqueCount{ 0 };           // Number of buffers currently pooled.
+            std::uint64_t   UniqueBytes{ 0 };           // Bytes held by currently pooled buffers.
+            std::uint64_t   OwnerCount{ 0 };            // Number of installed mips referencing pooled buffers.
+            std::uint64_t   DeduplicatedBytes{ 0 };     // Bytes that would be held additionally without sharing.
+            std::uint64_t   TotalHits{ 0 };             // Number of acquisitions served from an existing buffer.
+            std::uint64_t   TotalFreedBytes{ 0 };       // Bytes returned to GMalloc after their last owner was gone.
+        };
+
+        PayloadPool() = default;
+
+        inline bool IsEnabled() const noexcept { return bEnabled; }
+        inline void SetEnabled(bool const bInEnabled) noexcept { bEnabled = bInEnabled; }
+
+        /**
+         * @brief       Retrieves a shared decompressed buffer for a mip payload, materializing it if needed.
+         * @param[in]   Manifest - manifest containing the entry.
+         * @param[in]   Entry - texture entry the payload belongs to.
+         * @param[in]   MipIndex - index of the mip within the entry.
+         * @param[in]   Owner - texture the mip is being installed into.
+         * @param[in]   OwnerMip - engine mip record which will point to the returned buffer.
+         * @param[in]   bAcceptTranscoded - whether the mip is about to be transcoded, in which case the transcoded
+         *              form is returned if it is the only one left, see @ref IsTranscoded .
+         * @return      Buffer of @c UncompressedSize bytes, the transcoded form, or @c nullptr if materialization failed.
+         */
+        void* Acquire(ManifestLoader const& Manifest, CTextureEntry const& Entry, std::size_t MipIndex, UTexture2D* Owner,
+            CMipMapInfo* OwnerMip, bool bAcceptTranscoded);
+
+        /** Releases the buffer referenced by a mip record being deallocated, if it is pooled. */
+        void ReleaseOwner(CMipMapInfo const* OwnerMip);
+
+        /** Checks whether a mip record currently references a pooled buffer. */
+        bool IsOwner(CMipMapInfo const* OwnerMip) const;
+
+        /** Checks whether a mip record currently references the transcoded form of a pooled buffer. */
+        bool IsTranscoded(CMipMapInfo const* OwnerMip) const;
+
+        /**
+         * @brief       Looks up the transcoded form of the pooled buffer a mip references.
+         * @return      Whether the buffer was transcoded before, in which case @c OutTranscoded is set.
+         */
+        bool FindTranscoded(CMipMapInfo const* OwnerMip, TranscodedPayload& OutTranscoded) const;
+
+        /**
+         * @brief       Repoints an owner from the decompressed form of its buffer to the transcoded one.
+         * @param[in]   OwnerMip - engine mip record referencing a pooled buffer.
+         * @param[in]   Transcoded - transcoded form, taken over by the pool unless it came from @ref FindTranscoded .
+         * @return      Transcoded buffer the mip must point to.
+         */
+        void* UseTranscoded(CMipMapInfo const* OwnerMip, TranscodedPayload const& Transcoded);
+
+        /**
+         * @brief       Repoints an owner given the transcoded form back to the decompressed one, materializing it if needed.
+         * @remarks     For mips acquired for transcoding, whose texture ended up left as it is.
+         * @return      Buffer of @c UncompressedSize bytes the mip must point to, or @c nullptr if materialization
+         *              failed, in which case the owner keeps the transcoded form until it is released.
+         */
+        void* RestoreDecompressed(ManifestLoader const& Manifest, CTextureEntry const& Entry, std::size_t MipIndex, CMipMapInfo const* OwnerMip);
+
+        /** Releases references held by destroyed textures or mips which were repointed by the engine. */
+        void Collect();
+
+        /** Stops matching new payloads against pooled buffers materialized from a manifest view being unmapped. */
+        void ForgetSources(std::span<unsigned char const> View);
+
+        Stats GetStats() const;
+
+    private:
+
+        struct Buffer final
+        {
+            void*           Data{ nullptr };        // Decompressed form, null once only the transcoded form is used.
+            Payload_t       Source{};               // Bytes compared on hash match, within a mapped manifest view.
+            std::uint32_t   RefCount{ 0 };          // Owners of the decompressed form.
+
+            TranscodedPayload Transcoded{};
+            std::uint32_t   TranscodedRefCount{ 0 };
+        };
+
+        struct OwnerRecord final
+        {
+            UTexture2D*     Texture{ nullptr };
+            int             TextureIndex{ -1 };
+            void*           Data{ nullptr };
+            PayloadKey      Key{};
+        };
+
+        using BufferMap_t = std::unordered_multimap<PayloadKey, Buffer, PayloadKeyHash>;
+        using OwnerMap_t = std::unordered_map<CMipMapInfo const*, OwnerRecord>;
+
+        BufferMap_t::iterator FindBuffer(PayloadKey const& Key, void const* Data);
+        bool Materialize(Buffer& Pooled, ManifestLoader const& Manifest, CTextureEntry const& Entry, std::size_t MipIndex);
+        void Release(PayloadKey const& Key, void* Data);
+        bool IsOwnerStale(CMipMapInfo const* OwnerMip, OwnerRecord const& Record) const;
+
+        bool            bEnabled{ false };
+        BufferMap_t     Buffers{};
+        OwnerMap_t      Owners{};
+        Stats           Counters{};
+    };
+
+    // Pool shared by all texture overrides, enabled via "-texturededup" command line argument.
+    extern PayloadPool g_payloadPool;
+
+    // Number of UTexture2D::Serialize calls between sweeps for stale pool owners.
+    static constexpr int k_payloadCollectInterval = 512;
+}
@@ -0,0 +1,285 @@
+#include <algorithm>
+#include <cmath>
+#include "TextureOverride/Payload.hpp"
+#include "TextureOverride/Transcode.hpp"
+
+namespace TextureOverride
+{
+    MipTranscoder g_mipTranscoder{};
+
+
+    // ! MipTranscoder implementation.
+    // ========================================
+
+    double MipTranscoder::Stats::GetPSNR() const
+    {
+        if (PixelCount == 0 || SquaredError == 0)
+            return 0.0;
+
+        double const MeanError = static_cast<double>(SquaredError) / (static_cast<double>(PixelCount) * 3.0);
+        return 10.0 * std::log10(255.0 * 255.0 / MeanError);
+    }
+
+    MipTranscoder::~MipTranscoder()
+    {
+        {
+            std::scoped_lock TaskLock(TaskMutex);
+            bWorkersExit = true;
+        }
+
+        TaskCondition.notify_all();
+        for (std::thread& Worker : Workers)
+            Worker.join();
+    }
+
+    void MipTranscoder::Configure(bool const bInBC7, bool const bInBC5, int const InMinDimension)
+    {
+        bBC7 = bInBC7;
+        bBC5 = bInBC5;
+        MinDimension = std::max(InMinDimension, 0);
+    }
+
+    bool MipTranscoder::ShouldTranscode(CTextureEntry const& Entry, CMipEntry const& FirstInstalled) const noexcept
+    {
+        bool const bFormatSelected = (Entry.Format == PF_BC7 && bBC7) || (Entry.Format == PF_BC5 && bBC5);
+        return bFormatSelected && std::max(FirstInstalled.Width, FirstInstalled.Height) >= MinDimension;
+    }
+
+    std::uint64_t MipTranscoder::Transcode(EPixelFormat const Format, std::span<CMipMapInfo* const> const Mips)
+    {
+        LEASI_CHECKA(Format == PF_BC7 || Format == PF_BC5, "unsupported transcoding format", "");
+        ScopedTimer const Timer{};
+
+        struct MipJob final
+        {
+            CMipMapInfo*    Mip{ nullptr };
+            std::size_t     BlocksX{ 0 };
+            std::size_t     BlocksY{ 0 };
+            void*           Output{ nullptr };
+            std::uint64_t   Error{ 0 };
+            bool            bShared{ false };   // Output is the pooled form transcoded for another texture.
+        };
+
+        std::vector<MipJob> Jobs{};
+        std::size_t TotalBlocks = 0;
+
+        for (CMipMapInfo* const Mip : Mips)
+        {
+            // Mips streamed from texture file caches would arrive in the original format.
+            if ((Mip->Flags & ETF_External) != 0 || Mip->Data == nullptr)
+            {
+                Counters.SkippedTextures++;
+                return 0;
+            }
+
+            std::size_t const BlocksX = std::max((Mip->Width + 3) / 4, 1);
+            std::size_t const BlocksY = std::max((Mip->Height + 3) / 4, 1);
+            if (static_cast<std::size_t>(Mip->Elements) < BlocksX * BlocksY * 16)
+            {
+                Counters.SkippedTextures++;
+                return 0;
+            }
+
+            Jobs.push_back(MipJob{ Mip, BlocksX, BlocksY, nullptr, 0, false });
+            TotalBlocks += BlocksX * BlocksY;
+        }
+
+        std::size_t EncodedBlocks = 0;
+        for (MipJob& Job : Jobs)
+        {
+            // Payloads shared with a texture transcoded before are not transcoded again.
+            PayloadPool::TranscodedPayload Shared{};
+            if (g_payloadPool.FindTranscoded(Job.Mip, Shared))
+            {
+                Job.Output = Shared.Data;
+                Job.Error = Shared.SquaredError;
+                Job.bShared = true;
+                continue;
+            }
+
+            Job.Output = (*GMalloc)->Malloc(DWORD(Job.BlocksX * Job.BlocksY * 8), UN_DEFAULT_ALIGNMENT);
+            EncodedBlocks += Job.BlocksX * Job.BlocksY;
+        }
+
+        // One task per block row, each mip's rows in order.
+        std::vector<std::pair<std::size_t, std::size_t>> Rows{};
+        for (std::size_t JobIndex = 0; JobIndex < Jobs.size(); ++JobIndex)
+        {
+            for (std::size_t Y = 0; Y < Jobs[JobIndex].BlocksY && !Jobs[JobIndex].bShared; ++Y)
+                Rows.emplace_back(JobIndex, Y);
+        }
+
+        std::atomic<bool> bHasAlpha{ false };
+        std::vector<std::uint64_t> RowErrors(Rows.size(), 0);
+
+        auto const EncodeRow = [&](std::size_t const RowIndex)
+            {
+                auto const [JobIndex, Y] = Rows[RowIndex];
+                MipJob const& Job = Jobs[JobIndex];
+
+                auto const Source = static_cast<unsigned char const*>(Job.Mip->Data) + Y * Job.BlocksX * 16;
+                auto const Destination = static_cast<unsigned char*>(Job.Output) + Y * Job.BlocksX * 8;
+
+                unsigned char Pixels[16][4];
+                for (std::size_t X = 0; X < Job.BlocksX && !bHasAlpha.load(std::memory_order_relaxed); ++X)
+                {
+                    if (Format == PF_BC7)
+                        DecodeBlockBC7(Source + X * 16, Pixels);
+                    else
+                        DecodeBlockBC5(Source + X * 16, Pixels);
+
+                    for (auto const& Pixel : Pixels)
+                    {
+                        if (Pixel[3] != 255)
+                            bHasAlpha.store(true, std::memory_order_relaxed);
+                    }
+
+                    RowErrors[RowIndex] += EncodeBlockBC1(Pixels, Destination + X * 8);
+                }
+            };
+
+        if (EncodedBlocks >= k_transcodeParallelBlocks)
+        {
+            ParallelFor(Rows.size(), EncodeRow);
+        }
+        else
+        {
+            for (std::size_t RowIndex = 0; RowIndex < Rows.size(); ++RowIndex)
+                EncodeRow(RowIndex);
+        }
+
+        if (bHasAlpha)
+        {
+            for (MipJob const& Job : Jobs)
+            {
+                if (!Job.bShared)
+                    (*GMalloc)->Free(Job.Output);
+            }
+
+            Counters.SkippedTextures++;
+            return 0;
+        }
+
+        for (std::size_t RowIndex = 0; RowIndex < Rows.size(); ++RowIndex)
+            Jobs[Rows[RowIndex].first].Error += RowErrors[RowIndex];
+
+        std::uint64_t SavedBytes = 0, SquaredError = 0;
+        for (MipJob const& Job : Jobs)
+        {
+            CMipMapInfo* const Mip = Job.Mip;
+            auto const NewSize = static_cast<std::int32_t>(Job.BlocksX * Job.BlocksY * 8);
+
+            SavedBytes += static_cast<std::uint64_t>(Mip->Elements - NewSize);
+            SquaredError += Job.Error;
+
+            if (g_payloadPool.IsOwner(Mip))
+            {
+                // Pooled mips keep pointing into the pool, which owns the transcoded form from now on.
+                Mip->Data = g_payloadPool.UseTranscoded(Mip, PayloadPool::TranscodedPayload{ Job.Output, NewSize, Job.Error });
+                Counters.SharedMips += Job.bShared ? 1 : 0;
+            }
+            else
+            {
+                if (Mip->bNeedsFree)
+                    (*GMalloc)->Free(Mip->Data);
+
+                // Transcoded buffers are never shared, hand them over like any other materialized payload.
+                Mip->Data = Job.Output;
+                Mip->bNeedsFree = TRUE;
+                Mip->Flags = static_cast<ETextureFlags>(Mip->Flags | ETF_SingleUse);
+            }
+
+            Mip->Elements = Mip->CompressedSize = NewSize;
+        }
+
+        Counters.TranscodedTextures++;
+        Counters.SavedBytes += SavedBytes;
+        Counters.SquaredError += SquaredError;
+        Counters.PixelCount += TotalBlocks * 16;
+        Counters.Seconds += Timer.GetSeconds();
+        return SavedBytes;
+    }
+
+    MipTranscoder::Stats MipTranscoder::GetStats() const
+    {
+        return Counters;
+    }
+
+    void MipTranscoder::ParallelFor(std::size_t const InTaskCount, std::function<void(std::size_t)> const& Task)
+    {
+        if (Workers.empty())
+        {
+            unsigned const WorkerCount = std::clamp(std::thread::hardware_concurrency() / 2, 1u, 8u);
+            for (unsigned i = 0; i < WorkerCount; ++i)
+                Workers.emplace_back(&MipTranscoder::WorkerMain, this);
+        }
+
+        {
+            std::scoped_lock TaskLock(TaskMutex);
+            CurrentTask = &Task;
+            TaskCount = InTaskCount;
+            NextTask = 0;
+            DoneCount = 0;
+            Generation++;
+        }
+
+        TaskCondition.notify_all();
+
+        // The calling thread helps out instead of idling.
+        RunTasks();
+
+        std::unique_lock TaskLock(TaskMutex);
+        DoneCondition.wait(TaskLock, [this]() -> bool { return DoneCount == TaskCount && ActiveCount == 0; });
+        CurrentTask = nullptr;
+    }
+
+    void MipTranscoder::WorkerMain()
+    {
+        std::uint64_t SeenGeneration = 0;
+
+        while (true)
+        {
+            {
+                std::unique_lock TaskLock(TaskMutex);
+                TaskCondition.wait(TaskLock, [&]() -> bool { return bWorkersExit || Generation != SeenGeneration; });
+                if (bWorkersExit)
+                    return;
+                SeenGeneration = Generation;
+            }
+
+            RunTasks();
+        }
+    }
+
+    void MipTranscoder::RunTasks()
+    {
+        std::function<void(std::size_t)> const* Task;
+        std::size_t Count;
+
+        {
+            std::scoped_lock TaskLock(TaskMutex);
+            Task = CurrentTask;
+            Count = TaskCount;
+
+            if (Task == nullptr)
+                return;
+
+            // Keeps the caller from returning (and destroying the task) while this thread still uses it.
+            ActiveCount++;
+        }
+
+        std::size_t Completed = 0;
+        for (std::size_t Index = NextTask++; Index < Count; Index = NextTask++)
+        {
+            (*Task)(Index);
+            Completed++;
+        }
+
+        std::scoped_lock TaskLock(TaskMutex);
+        DoneCount += Completed;
+        ActiveCount--;
+
+        if (DoneCount == TaskCount && ActiveCount == 0)
+            DoneCondition.notify_all();
+    }
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+#include <LESDK/Headers.hpp>
+#include "Common/Base.hpp"
+#include "TextureOverride/BlockCompression.hpp"
+#include "TextureOverride/Loading.hpp"
+#include "TextureOverride/Manifest.hpp"
+
+
+namespace TextureOverride
+{
+    // ! Transcoding.
+    // ========================================
+
+    /**
+     * @brief   Transcodes embedded BC7 / BC5 mips to BC1 before they are handed to the engine.
+     * @remarks Blocks are spread over a small pool of worker threads, the calling thread waits for
+     *          them to finish. Textures with any non-opaque pixel are left untouched, as are entries
+     *          with mips stored in texture file caches, which the engine would load in the original format.
+     * @remarks Pooled payloads are transcoded once, later textures sharing them reuse the pooled result.
+     */
+    class MipTranscoder final : public NonCopyable
+    {
+    public:
+
+        struct Stats final
+        {
+            std::uint64_t   TranscodedTextures{ 0 };
+            std::uint64_t   SkippedTextures{ 0 };       // Selected textures left untouched (alpha, bad sizes).
+            std::uint64_t   SharedMips{ 0 };            // Pooled mips transcoded once for an earlier texture.
+            std::uint64_t   SavedBytes{ 0 };
+            std::uint64_t   SquaredError{ 0 };          // Sum of squared RGB errors over all transcoded pixels.
+            std::uint64_t   PixelCount{ 0 };
+            float           Seconds{ 0.f };
+
+            /** Calculates peak signal-to-noise ratio of all transcoded pixels, in decibels. */
+            double GetPSNR() const;
+        };
+
+        MipTranscoder() = default;
+        ~MipTranscoder();
+
+        /**
+         * @brief       Selects which textures get transcoded.
+         * @param[in]   bInBC7 - whether @ref PF_BC7 entries are transcoded.
+         * @param[in]   bInBC5 - whether @ref PF_BC5 entries are transcoded.
+         * @param[in]   InMinDimension - minimum size of the largest installed mip, in pixels.
+         */
+        void Configure(bool bInBC7, bool bInBC5, int InMinDimension);
+
+        inline bool IsEnabled() const noexcept { return bBC7 || bBC5; }
+
+        /** Checks whether an entry is selected by format and size, see @ref Configure . */
+        bool ShouldTranscode(CTextureEntry const& Entry, CMipEntry const& FirstInstalled) const noexcept;
+
+        /**
+         * @brief       Transcodes installed mips in place, replacing their buffers.
+         * @param[in]   Format - pixel format of the mips, @ref PF_BC7 or @ref PF_BC5 .
+         * @param[in]   Mips - engine mip records about to be installed.
+         * @return      Number of bytes saved, or zero if the texture was left untouched.
+         */
+        std::uint64_t Transcode(EPixelFormat Format, std::span<CMipMapInfo* const> Mips);
+
+        Stats GetStats() const;
+
+    private:
+
+        void ParallelFor(std::size_t TaskCount, std::function<void(std::size_t)> const& Task);
+        void WorkerMain();
+        void RunTasks();
+
+        bool                        bBC7{ false };
+        bool                        bBC5{ false };
+        int                         MinDimension{ 0 };
+
+        std::vector<std::thread>    Workers{};
+        std::mutex                  TaskMutex{};
+        std::condition_variable     TaskCondition{};
+        std::condition_variable     DoneCondition{};
+        std::function<void(std::size_t)> const* CurrentTask{ nullptr };
+        std::size_t                 TaskCount{ 0 };
+        std::atomic<std::size_t>    NextTask{ 0 };
+        std::size_t                 DoneCount{ 0 };
+        std::size_t                 ActiveCount{ 0 };
+        std::uint64_t               Generation{ 0 };
+        bool                        bWorkersExit{ false };
+
+        Stats                       Counters{};
+    };
+
+    // Transcoder used by @ref UpdateTextureFromManifest, configured via "-texturetranscode=" command line argument.
+    extern MipTranscoder g_mipTranscoder;
+
+    // Minimum number of blocks in a texture before work is spread over worker threads.
+    static constexpr std::size_t k_transcodeParallelBlocks = 1024;
+}
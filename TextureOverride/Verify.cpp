@@ -0,0 +1,267 @@
+#include <cstring>
+#include <string>
+#include "TextureOverride/Cache.hpp"
+#include "TextureOverride/Checksum.hpp"
+#include "TextureOverride/Hooks.hpp"
+#include "TextureOverride/Verify.hpp"
+
+namespace
+{
+    using namespace TextureOverride;
+
+    std::wstring GetSidecarPath(ManifestLoader const& Manifest)
+    {
+        return std::wstring{ L"TextureOverride." } + std::wstring{ Manifest.GetDlcName() } + L".verify";
+    }
+
+    std::vector<CVerifyRecord> ReadSidecar(ManifestLoader const& Manifest, std::uint64_t const Key, std::uint32_t const EntryCount)
+    {
+        std::vector<CVerifyRecord> Records{};
+
+        HANDLE const FileHandle = ::CreateFileW(GetSidecarPath(Manifest).c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, 0u, NULL);
+        if (FileHandle == INVALID_HANDLE_VALUE)
+            return Records;
+
+        CVerifyHeader Header{};
+        DWORD Read = 0;
+        bool const bValidHeader = 0 != ::ReadFile(FileHandle, &Header, sizeof Header, &Read, NULL) && Read == sizeof Header
+            && 0 == std::memcmp(Header.Magic, CVerifyHeader::k_checkMagic, sizeof(CVerifyHeader::k_checkMagic))
+            && Header.Version == CVerifyHeader::k_lastVersion && Header.ManifestKey == Key && Header.EntryCount == EntryCount;
+
+        if (bValidHeader)
+        {
+            Records.resize(EntryCount);
+            DWORD const Size = static_cast<DWORD>(Records.size() * sizeof(CVerifyRecord));
+            if (0 == ::ReadFile(FileHandle, Records.data(), Size, &Read, NULL) || Read != Size)
+                Records.clear();
+        }
+
+        ::CloseHandle(FileHandle);
+        return Records;
+    }
+
+    void WriteSidecar(ManifestLoader const& Manifest, std::uint64_t const Key, std::vector<CVerifyRecord> const& Records)
+    {
+        HANDLE const FileHandle = ::CreateFileW(GetSidecarPath(Manifest).c_str(), GENERIC_WRITE, 0u, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (FileHandle == INVALID_HANDLE_VALUE)
+        {
+            LEASI_DEBUG(L"failed to create verification sidecar for '{}', error = {}", Manifest.GetDlcName(), ::GetLastError());
+            return;
+        }
+
+        CVerifyHeader Header{};
+        std::memcpy(Header.Magic, CVerifyHeader::k_checkMagic, sizeof(CVerifyHeader::k_checkMagic));
+        Header.Version = CVerifyHeader::k_lastVersion;
+        Header.EntryCount = static_cast<std::uint32_t>(Records.size());
+        Header.ManifestKey = Key;
+
+        DWORD Written = 0;
+        DWORD const Size = static_cast<DWORD>(Records.size() * sizeof(CVerifyRecord));
+        if (0 == ::WriteFile(FileHandle, &Header, sizeof Header, &Written, NULL)
+            || 0 == ::WriteFile(FileHandle, Records.data(), Size, &Written, NULL))
+        {
+            LEASI_DEBUG(L"failed to write verification sidecar for '{}', error = {}", Manifest.GetDlcName(), ::GetLastError());
+        }
+
+        ::CloseHandle(FileHandle);
+    }
+}
+
+namespace TextureOverride
+{
+    PayloadVerifier g_payloadVerifier{};
+
+
+    // ! PayloadVerifier implementation.
+    // ========================================
+
+    PayloadVerifier::~PayloadVerifier()
+    {
+        Stop();
+    }
+
+    void PayloadVerifier::Start(std::vector<ManifestLoaderPointer> const& InManifests)
+    {
+        LEASI_CHECKA(!WorkerThread.joinable(), "verification already running", "");
+        if (!bEnabled)
+            return;
+
+        // Keep results for manifests which are still loaded and unchanged. Rebuilding is quick,
+        // lookups simply wait for it.
+        std::scoped_lock ManifestsLock(ManifestsMutex);
+        std::unordered_map<ManifestLoader const*, ManifestState> Previous{};
+        Previous.swap(Manifests);
+
+        bool bAnyIncomplete = false;
+        for (ManifestLoaderPointer const& Manifest : InManifests)
+        {
+            if (!Manifest->IsLoaded())
+                continue;
+
+            std::uint64_t const Key = PayloadCache::GetManifestKey(*Manifest);
+            if (auto const Iter = Previous.find(Manifest.get()); Iter != Previous.end() && Iter->second.Key == Key)
+            {
+                bAnyIncomplete = bAnyIncomplete || !Iter->second.bComplete;
+                Manifests.emplace(Manifest.get(), std::move(Iter->second));
+                continue;
+            }
+
+            ManifestState State{};
+            State.Manifest = Manifest;
+            State.Key = Key;
+            State.EntryCount = Manifest->GetMappedHeader().TextureCount;
+            State.States = std::make_unique<std::atomic<EEntryState>[]>(State.EntryCount);
+
+            bAnyIncomplete = true;
+            Manifests.emplace(Manifest.get(), std::move(State));
+        }
+
+        if (bAnyIncomplete)
+        {
+            bStopRequested = false;
+            WorkerThread = std::thread(&PayloadVerifier::WorkerMain, this);
+        }
+    }
+
+    void PayloadVerifier::Stop()
+    {
+        if (!WorkerThread.joinable())
+            return;
+
+        bStopRequested = true;
+        WorkerThread.join();
+    }
+
+    bool PayloadVerifier::IsEntryBad(ManifestLoader const& Manifest, CTextureEntry const& Entry) const
+    {
+        std::scoped_lock ManifestsLock(ManifestsMutex);
+        auto const Iter = Manifests.find(&Manifest);
+        if (Iter == Manifests.end())
+            return false;
+
+        std::uint32_t const Index = Manifest.GetEntryIndex(Entry);
+        return Index < Iter->second.EntryCount
+            && Iter->second.States[Index].load(std::memory_order_relaxed) == EES_Bad;
+    }
+
+    PayloadVerifier::Stats PayloadVerifier::GetStats() const
+    {
+        return Stats{ VerifiedEntries.load(), BadEntries.load(), ChecksummedBytes.load(), DecodedBytes.load() };
+    }
+
+    void PayloadVerifier::WorkerMain()
+    {
+        // Stay out of the way of the game, both for CPU time and disk access.
+        ::SetThreadPriority(::GetCurrentThread(), THREAD_MODE_BACKGROUND_BEGIN);
+        ::SetThreadPriority(::GetCurrentThread(), THREAD_PRIORITY_LOWEST);
+
+        std::vector<unsigned char> Scratch{};
+        for (auto& [_, State] : Manifests)
+        {
+            if (State.bComplete)
+                continue;
+            if (!VerifyManifest(State, Scratch))
+                break;
+        }
+
+        ::SetThreadPriority(::GetCurrentThread(), THREAD_MODE_BACKGROUND_END);
+    }
+
+    bool PayloadVerifier::VerifyManifest(ManifestState& State, std::vector<unsigned char>& Scratch)
+    {
+        ManifestLoader const& Manifest = *State.Manifest;
+        auto const Entries = reinterpret_cast<CTextureEntry const*>(Manifest.GetMappedView().data() + sizeof(CManifestHeader));
+
+        std::vector<CVerifyRecord> Records = ReadSidecar(Manifest, State.Key, State.EntryCount);
+        bool const bHadSidecar = !Records.empty();
+        bool bChanged = !bHadSidecar;
+        Records.resize(State.EntryCount);
+
+        std::uint64_t BadCount = 0;
+        for (std::uint32_t i = 0; i < State.EntryCount; ++i)
+        {
+            if (bStopRequested.load(std::memory_order_relaxed))
+            {
+                if (bChanged)
+                    WriteSidecar(Manifest, State.Key, Records);
+                return false;
+            }
+
+            CTextureEntry const& Entry = Entries[i];
+            CVerifyRecord& Record = Records[i];
+            EEntryState Verdict = State.States[i].load(std::memory_order_relaxed);
+
+            if (Verdict == EES_Unknown && Manifest.IsEntryInBounds(Entry))
+            {
+                std::uint32_t Crc = 0;
+                for (int Mip = 0; Mip < Entry.MipCount; ++Mip)
+                {
+                    auto const [MipEntry, Payload] = Manifest.GetEntryMip(Entry, static_cast<std::size_t>(Mip));
+                    if (MipEntry.ShouldHavePayload())
+                    {
+                        Crc = Crc32c(Crc, Payload);
+                        ChecksummedBytes += Payload.size();
+                    }
+                }
+
+                // A matching checksum means the previous session's outcome still holds.
+                if (Record.State != EES_Unknown && Record.Crc == Crc)
+                {
+                    Verdict = Record.State;
+                }
+                else
+                {
+                    Verdict = VerifyEntry(Manifest, Entry, Scratch);
+                    Record.Crc = Crc;
+                    Record.State = Verdict;
+                    bChanged = true;
+                }
+            }
+            else if (Verdict == EES_Unknown)
+            {
+                Verdict = EES_Bad;
+                bChanged = bChanged || Record.State != EES_Bad;
+                Record.State = EES_Bad;
+            }
+
+            if (Verdict == EES_Bad)
+            {
+                LEASI_WARN(L"payload verification failed for '{}' in '{}'", *Entry.GetFullPath(), Manifest.GetDlcName());
+                BadEntries++;
+                BadCount++;
+            }
+
+            State.States[i].store(Verdict, std::memory_order_relaxed);
+            VerifiedEntries++;
+        }
+
+        if (bChanged)
+            WriteSidecar(Manifest, State.Key, Records);
+
+        State.bComplete = true;
+        LEASI_INFO(L"verified {} entries of '{}' ({}), {} bad",
+            State.EntryCount, Manifest.GetDlcName(), bHadSidecar ? L"checksums" : L"full decode", BadCount);
+        return true;
+    }
+
+    EEntryState PayloadVerifier::VerifyEntry(ManifestLoader const& Manifest, CTextureEntry const& Entry, std::vector<unsigned char>& Scratch)
+    {
+        for (int Mip = 0; Mip < Entry.MipCount; ++Mip)
+        {
+            auto const [MipEntry, Payload] = Manifest.GetEntryMip(Entry, static_cast<std::size_t>(Mip));
+            if (!MipEntry.ShouldHavePayload() || !MipEntry.IsOodleCompressed())
+                continue;
+
+            Scratch.resize(static_cast<std::size_t>(MipEntry.UncompressedSize));
+            void* const Result = OodleDecompress(0x400, Scratch.data(), MipEntry.UncompressedSize,
+                const_cast<unsigned char*>(Payload.data()), MipEntry.CompressedSize);
+
+            if (Result == 0)
+                return EES_Bad;
+
+            DecodedBytes += static_cast<std::uint64_t>(MipEntry.UncompressedSize);
+        }
+
+        return EES_Good;
+    }
+}
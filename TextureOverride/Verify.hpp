@@ -0,0 +1,127 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <LESDK/Headers.hpp>
+#include "Common/Base.hpp"
+#include "TextureOverride/Manifest.hpp"
+
+
+namespace TextureOverride
+{
+    // ! Verification sidecar structs.
+    // ========================================
+
+#pragma pack(push, 1)
+
+    struct CVerifyHeader
+    {
+        unsigned char   Magic[8];               // Magic bytes of 'LETOVRFY'.
+        std::uint32_t   Version;                // Sidecar file version, mismatching files are discarded.
+        std::uint32_t   EntryCount;             // Number of @ref CVerifyRecord structs after this header.
+        std::uint64_t   ManifestKey;            // See @ref PayloadCache::GetManifestKey , covers @c MetadataCRC .
+
+        static constexpr decltype(Magic)        k_checkMagic{ 'L', 'E', 'T', 'O', 'V', 'R', 'F', 'Y' };
+        static constexpr decltype(Version)      k_lastVersion{ 1 };
+    };
+    static_assert(sizeof(CVerifyHeader) == 24);
+
+    enum EEntryState : std::uint8_t
+    {
+        EES_Unknown                     = 0,    // Entry has not been verified yet.
+        EES_Good                        = 1,    // Payloads are in bounds and decode successfully.
+        EES_Bad                         = 2,    // Payloads are out of bounds or fail to decode.
+    };
+
+    struct CVerifyRecord
+    {
+        std::uint32_t   Crc;                    // CRC-32C of all embedded payloads of the entry, in mip order.
+        EEntryState     State;
+        unsigned char   Reserved[3];
+    };
+    static_assert(sizeof(CVerifyRecord) == 8);
+
+#pragma pack(pop)
+
+
+    // ! Background payload verification.
+    // ========================================
+
+    /**
+     * @brief   Verifies embedded payloads of loaded manifests on a low-priority background thread.
+     * @remarks The first time a manifest is seen, every entry is bounds-checked and its Oodle payloads
+     *          are trial-decoded. The outcome is saved together with a CRC-32C of the payloads in a
+     *          sidecar file, so later sessions only need to checksum the payloads again.
+     *          Entries which have not been verified yet are not held back.
+     */
+    class PayloadVerifier final : public NonCopyable
+    {
+    public:
+
+        struct Stats final
+        {
+            std::uint64_t   VerifiedEntries{ 0 };
+            std::uint64_t   BadEntries{ 0 };
+            std::uint64_t   ChecksummedBytes{ 0 };
+            std::uint64_t   DecodedBytes{ 0 };
+        };
+
+        PayloadVerifier() = default;
+        ~PayloadVerifier();
+
+        inline bool IsEnabled() const noexcept { return bEnabled; }
+        inline void SetEnabled(bool const bInEnabled) noexcept { bEnabled = bInEnabled; }
+
+        /**
+         * @brief       Starts verifying loaded manifests which have not been fully verified yet.
+         * @remarks     Must not be called while verification is running, see @ref Stop .
+         *              Entries of the given manifests can be checked with @ref IsEntryBad once this returns.
+         */
+        void Start(std::vector<ManifestLoaderPointer> const& InManifests);
+
+        /** Interrupts verification and waits until no manifest views are being accessed. */
+        void Stop();
+
+        /** Checks whether an entry has been found to be corrupted. */
+        bool IsEntryBad(ManifestLoader const& Manifest, CTextureEntry const& Entry) const;
+
+        Stats GetStats() const;
+
+    private:
+
+        struct ManifestState final
+        {
+            ManifestLoaderPointer                       Manifest{};
+            std::uint64_t                               Key{ 0 };
+            std::uint32_t                               EntryCount{ 0 };
+            std::unique_ptr<std::atomic<EEntryState>[]> States{};
+            bool                                        bComplete{ false };
+        };
+
+        void WorkerMain();
+        bool VerifyManifest(ManifestState& State, std::vector<unsigned char>& Scratch);
+        EEntryState VerifyEntry(ManifestLoader const& Manifest, CTextureEntry const& Entry, std::vector<unsigned char>& Scratch);
+
+        bool                    bEnabled{ true };
+        std::atomic<bool>       bStopRequested{ false };
+        std::thread             WorkerThread{};
+
+        // Only modified while the worker is not running, and under the lock since the game thread
+        // may look entries up while manifests are still loading.
+        mutable std::mutex      ManifestsMutex{};
+        std::unordered_map<ManifestLoader const*, ManifestState> Manifests{};
+
+        std::atomic<std::uint64_t>  VerifiedEntries{ 0 };
+        std::atomic<std::uint64_t>  BadEntries{ 0 };
+        std::atomic<std::uint64_t>  ChecksummedBytes{ 0 };
+        std::atomic<std::uint64_t>  DecodedBytes{ 0 };
+    };
+
+    // Verifier of all loaded manifests, disabled via "-notextureverify" command line argument.
+    extern PayloadVerifier g_payloadVerifier;
+}